@@ -0,0 +1,215 @@
+#pragma once
+
+// PURPOSE: Uniform interface every benchmarked data structure is driven through
+//
+// CLASSES:
+//  Benchmark::StdAllocator: Allocator choice tag for the STL allocator
+//  Benchmark::MIMAllocator: Allocator choice tag for Microsoft's mimalloc STL allocator
+//  Benchmark::AdapterBase:  Defaults for optional adapter operations
+//
+// An adapter wraps one instance of a data structure so that the timed loops in 'Benchmark::Phase' are written once
+// and compiled, fully inlined, against each structure. Adapters are not polymorphic: the loops are templates on the
+// adapter type and call it directly. An adapter provides:
+//
+//   typedef char|unsigned char KeyType;
+//     // Character type keys are sliced with
+//
+//   enum { k_VALUES, k_CAN_ERASE, k_CAN_SCAN, k_CAN_COMPACT, k_FIND_BATCH, k_MT_INSERT, k_ALLOCATOR, k_STATIC };
+//     // Non-zero if the adapter stores 'bin-text-kv' values, implements 'erase, scan, compact', overlaps the lookups
+//     // of a 'findBatch', allows concurrent insert from many threads, honors '-a', and finds inserted keys only
+//     // after 'seal' respectively. 'AdapterBase' defaults all to 0.
+//
+//   explicit Adapter(const Config& config);
+//     // Create an empty structure. Destruction frees everything the structure holds.
+//
+//   bool insert(Slice<KeyType>& key);
+//   bool find(Slice<KeyType>& key);
+//   bool update(Slice<KeyType>& key);
+//   bool erase(Slice<KeyType>& key);
+//     // Return true if specified 'key' was inserted, found, updated or erased and false otherwise. 'update'
+//     // overwrites whatever the structure holds for 'key' inserting it if absent.
+//
+//   unsigned scan(Slice<KeyType>& key, unsigned length);
+//     // Visit, in key order, at most 'length' keys starting at the first key '>=key' returning the number visited
+//
+//   bool compact();
+//     // Return true if the structure was rebuilt, keys unchanged, into memory holding only what it needs
+//
+//   bool seal();
+//     // Return true if the structure was built from every key inserted so far so 'find, scan' see them. Read-only
+//     // structures stage keys on 'insert' and are sealed once after each insert phase, untimed by it.
+//
+//   void findBatch(Slice<KeyType> *keys, bool *results, unsigned count);
+//     // Set 'results[i]' to 'find(keys[i])' for each 'i<count'. Hash, or otherwise locate, every key and prefetch
+//     // the memory it needs before resolving any so that the cache misses of the batch overlap
+//
+//   size_t size() const;
+//   size_t memory() const;
+//     // Return the number of keys held and bytes of memory used, or 0 if the structure cannot tell cheaply
+//
+//   void threads(unsigned count);
+//   bool findMT(unsigned thread, Slice<KeyType>& key);
+//   bool insertMT(unsigned thread, Slice<KeyType>& key);
+//     // Prepare for 'count' threads then run 'find, insert' from thread 'thread' in '[0, count)'
+//
+// Adapters for 'bin-text-kv' additionally provide:
+//
+//   bool insert(Slice<KeyType>& key, Slice<KeyType>& value);
+//   bool find(Slice<KeyType>& key, Slice<KeyType>& value);
+//   bool update(Slice<KeyType>& key, Slice<KeyType>& value);
+//     // Return true if specified 'key' was inserted with a copy of 'value', found holding a value equal to 'value'
+//     // reading every byte, or found and its value overwritten with 'value' respectively, and false otherwise.
+
+#include <benchmark_config.h>
+#include <benchmark_slice.h>
+
+#include <mimalloc.h>
+
+#include <memory>
+#include <string>
+
+namespace Benchmark {
+
+struct StdAllocator {
+  // TYPES
+  template<typename T>
+  using Type = std::allocator<T>;
+
+  typedef std::string String;
+};
+
+struct MIMAllocator {
+  // TYPES
+  template<typename T>
+  using Type = mi_stl_allocator<T>;
+
+  // Value payloads come from the same allocator as the structure holding them
+  typedef std::basic_string<char, std::char_traits<char>, mi_stl_allocator<char>> String;
+};
+
+template<typename ADAPTER>
+class AdapterBase {
+  // Derive 'ADAPTER' from 'AdapterBase<ADAPTER>' to inherit the following defaults. Hide any of them by
+  // redeclaring it in 'ADAPTER'.
+
+public:
+  // ENUMS
+  enum {
+    k_VALUES      = 0,
+    k_CAN_ERASE   = 0,
+    k_CAN_SCAN    = 0,
+    k_CAN_COMPACT = 0,
+    k_FIND_BATCH  = 0,
+    k_MT_INSERT   = 0,
+    k_ALLOCATOR   = 0,
+    k_STATIC      = 0,
+  };
+
+  // ACCESSORS
+  size_t size() const;
+    // Return 0
+
+  size_t memory() const;
+    // Return 0
+
+  // MANIPULATORS
+  template<typename T>
+  bool erase(Slice<T>& key);
+    // Return false. Behavior is defined provided 'ADAPTER::k_CAN_ERASE' is 0.
+
+  template<typename T>
+  unsigned scan(Slice<T>& key, unsigned length);
+    // Return 0. Behavior is defined provided 'ADAPTER::k_CAN_SCAN' is 0.
+
+  bool compact();
+    // Return false. Behavior is defined provided 'ADAPTER::k_CAN_COMPACT' is 0.
+
+  bool seal();
+    // Return true: inserted keys are found at once
+
+  template<typename T>
+  void findBatch(Slice<T> *keys, bool *results, unsigned count);
+    // Set 'results[i]' to 'ADAPTER::find(keys[i])' for each 'i<count' one key after another
+
+  void threads(unsigned count);
+    // Do nothing: by default there is no per-thread state
+
+  template<typename T>
+  bool findMT(unsigned thread, Slice<T>& key);
+    // Return 'ADAPTER::find(key)'
+
+  template<typename T>
+  bool insertMT(unsigned thread, Slice<T>& key);
+    // Return 'ADAPTER::insert(key)'. Behavior is defined provided 'ADAPTER::k_MT_INSERT' is non-zero.
+};
+
+// INLINE DEFINITIONS
+// ACCESSORS
+template<typename ADAPTER>
+inline
+size_t AdapterBase<ADAPTER>::size() const {
+  return 0;
+}
+
+template<typename ADAPTER>
+inline
+size_t AdapterBase<ADAPTER>::memory() const {
+  return 0;
+}
+
+// MANIPULATORS
+template<typename ADAPTER>
+template<typename T>
+inline
+bool AdapterBase<ADAPTER>::erase(Slice<T>&) {
+  return false;
+}
+
+template<typename ADAPTER>
+template<typename T>
+inline
+unsigned AdapterBase<ADAPTER>::scan(Slice<T>&, unsigned) {
+  return 0;
+}
+
+template<typename ADAPTER>
+inline
+bool AdapterBase<ADAPTER>::compact() {
+  return false;
+}
+
+template<typename ADAPTER>
+inline
+bool AdapterBase<ADAPTER>::seal() {
+  return true;
+}
+
+template<typename ADAPTER>
+template<typename T>
+inline
+void AdapterBase<ADAPTER>::findBatch(Slice<T> *keys, bool *results, unsigned count) {
+  for (unsigned i=0; i<count; ++i) {
+    results[i] = static_cast<ADAPTER*>(this)->find(keys[i]);
+  }
+}
+
+template<typename ADAPTER>
+inline
+void AdapterBase<ADAPTER>::threads(unsigned) {
+}
+
+template<typename ADAPTER>
+template<typename T>
+inline
+bool AdapterBase<ADAPTER>::findMT(unsigned, Slice<T>& key) {
+  return static_cast<ADAPTER*>(this)->find(key);
+}
+
+template<typename ADAPTER>
+template<typename T>
+inline
+bool AdapterBase<ADAPTER>::insertMT(unsigned, Slice<T>& key) {
+  return static_cast<ADAPTER*>(this)->insert(key);
+}
+
+} // namespace Benchmark
@@ -1,104 +1,149 @@
 #include <benchmark_art.h>
-#include <benchmark_hashable_keys.h>
-#include <benchmark_textscan.h>
+#include <benchmark_adapter.h>
+#include <benchmark_driver.h>
+#include <benchmark_kvrecord.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#include <art.h>
+#pragma GCC diagnostic pop
 
 #include <intel_skylake_pmu.h>
 
-#pragma GCC diagnostic push                                                                                             
-#pragma GCC diagnostic ignored "-Wpedantic"                                                                             
-#include <art.h>
-#pragma GCC diagnostic pop 
+namespace {
 
-template<typename T>
-static int art_test_text_insert(unsigned runNumber, T& map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+class ARTAdapter: public Benchmark::AdapterBase<ARTAdapter> {
+  // ART trie whose leaves point at the key itself. Key lengths exclude the terminating 0.
 
-  char label[128];
-  snprintf(label, sizeof(label), "insert run %u", runNumber);
+  // DATA
+  art_tree d_tree;
 
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-  
-  // Benchmark running: do insert
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    art_insert(&map, (unsigned char*)word.data(), word.size()-1, (void*)word.data()); 
+  // PRIVATE TYPES
+  struct ScanState {
+    unsigned d_length;    // keys to visit
+    unsigned d_visited;   // keys visited so far
+  };
+
+  // PRIVATE CLASS METHODS
+  static int visitKey(void *data, const unsigned char *key, uint32_t, void *) {
+    // Touch one key in a scan. Return non-zero to stop the iteration once 'd_length' keys were visited
+    ScanState *state = static_cast<ScanState*>(data);
+    Intel::DoNotOptimize(key);
+    return ++state->d_visited>=state->d_length;
   }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+public:
+  // TYPES
+  typedef char KeyType;
 
-  return 0;
-}
+  // ENUMS
+  enum {
+    k_CAN_ERASE = 1,
+    k_CAN_SCAN  = 1,    // 'art_iter_from' walks leaves in key order from a lower bound
+  };
+
+  // CREATORS
+  explicit ARTAdapter(const Benchmark::Config&) {
+    art_tree_init(&d_tree);
+  }
+
+  ~ARTAdapter() {
+    art_tree_destroy(&d_tree);
+  }
+
+  // ACCESSORS
+  size_t size() const {
+    return d_tree.size;
+  }
+
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<char>& key) {
+    return art_insert(&d_tree, (unsigned char*)key.data(), key.size()-1, (void*)key.data())==0;
+  }
+
+  bool find(Benchmark::Slice<char>& key) {
+    return art_search(&d_tree, (unsigned char*)key.data(), key.size()-1)!=0;
+  }
+
+  bool update(Benchmark::Slice<char>& key) {
+    art_insert(&d_tree, (unsigned char*)key.data(), key.size()-1, (void*)key.data());
+    return true;
+  }
 
-template<typename T>
-static int art_test_text_find(unsigned runNumber, T& map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  unsigned int errors(0);
-  char label[128];
-  snprintf(label, sizeof(label), "find run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-
-  // Benchmark running: do find
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    auto val = art_search(&map, (unsigned char*)word.data(), word.size()-1);
-    if (val==0) {
-      ++errors;
+  bool erase(Benchmark::Slice<char>& key) {
+    return art_delete(&d_tree, (unsigned char*)key.data(), key.size()-1)!=0;
+  }
+
+  unsigned scan(Benchmark::Slice<char>& key, unsigned length) {
+    ScanState state = { length, 0 };
+    if (length) {
+      art_iter_from(&d_tree, (unsigned char*)key.data(), key.size()-1, visitKey, &state);
     }
+    return state.d_visited;
   }
+};
+
+class ARTKVAdapter: public Benchmark::AdapterBase<ARTKVAdapter> {
+  // ART trie holding one pointer per key so it points to a copied record
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  // DATA
+  art_tree d_tree;
 
-  if (errors) {
-    printf("searchErrors: %u\n", errors);
+  // PRIVATE CLASS METHODS
+  static int destroyRecord(void *, const unsigned char *, uint32_t, void *value) {
+    // Free KVRecord held by one leaf. Return 0 to continue the iteration
+    Benchmark::KVRecord::destroy(static_cast<char*>(value));
+    return 0;
   }
 
-  return 0;
-}
+public:
+  // TYPES
+  typedef char KeyType;
+
+  // ENUMS
+  enum {
+    k_VALUES = 1,
+  };
+
+  // CREATORS
+  explicit ARTKVAdapter(const Benchmark::Config&) {
+    art_tree_init(&d_tree);
+  }
+
+  ~ARTKVAdapter() {
+    art_iter(&d_tree, destroyRecord, 0);
+    art_tree_destroy(&d_tree);
+  }
 
-int Benchmark::ART::start() {
-  // Default start is to load file
-  int rc = Benchmark::Report::start();
-  if (rc!=0) {
-    return rc;
-  }
-
-  if (d_config.d_format == "bin-text-kv") {
-    // We have KV pairs to play with
-    // Not implemented yet
-    return rc;
-  } else if (d_config.d_format=="bin-text") {
-    // We have a text file therefore we can only benchamrk key ins/upd/fnd/del on keys.
-    // Make a cuckoo map with the smallest possible value type (bool) and set it to a 
-    // constant value throughout all tests.
-    if (d_config.d_customAllocator) {
-      return rc;
-    } else {
-      for (unsigned i=0; i<d_config.d_runs; ++i) {
-        if (d_config.d_verbosity>0) {
-          printf("execute run set %u...\n", i);
-        }
-        art_tree artTrie;
-        art_tree_init(&artTrie);
-        art_test_text_insert(i, artTrie, d_insertStats, d_file);
-        art_test_text_find(i, artTrie, d_findStats, d_file);
-        rusage(std::cout);
-        art_tree_destroy(&artTrie);
-      }
+  // ACCESSORS
+  size_t size() const {
+    return d_tree.size;
+  }
+
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    char *record = Benchmark::KVRecord::create(key, value);
+    void *old = art_insert(&d_tree, (unsigned char*)key.data(), key.size()-1, record);
+    if (old) {
+      Benchmark::KVRecord::destroy(static_cast<char*>(old));
+      return false;
     }
+    return true;
+  }
+
+  bool find(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    auto record = static_cast<const char*>(art_search(&d_tree, (unsigned char*)key.data(), key.size()-1));
+    return record!=0 && Benchmark::KVRecord::equal(record, value);
   }
-  return rc;
+
+  bool update(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    auto record = static_cast<char*>(art_search(&d_tree, (unsigned char*)key.data(), key.size()-1));
+    return record!=0 && Benchmark::KVRecord::assign(record, value);
+  }
+};
+
+} // anonymous namespace
+
+int Benchmark::ART::run(const Config& config, const std::string& description) {
+  return Dispatch::plain<ARTAdapter, ARTKVAdapter>(config, description);
 }
@@ -2,24 +2,17 @@
 
 // PURPOSE: Benchmark ART: Adaptive Radix Trie
 
-#include <benchmark_report.h>
+#include <benchmark_config.h>
 
-namespace Benchmark {
-
-class ART: public Report {
-public:
-  // CREATORS
-  ART(const Config& config, const std::string& description)
-  : Report(config, description)
-  {
-  }
+#include <string>
 
-  virtual ~ART() = default;
+namespace Benchmark {
 
-  // MANIPULATORS
-  virtual int start();
-    // Return 0 if all benchmarks were run and non-zero otherwise. Note a non-zero code usually indicates
-    // bad configuration.
+struct ART {
+  // STATIC FUNCTIONS
+  static int run(const Config& config, const std::string& description);
+    // Return 0 if all benchmarks per specified 'config' were run then reported under specified 'description' and
+    // non-zero otherwise. Note a non-zero code usually indicates bad configuration.
 };
 
 } // namespace Benchmark
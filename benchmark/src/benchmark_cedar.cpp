@@ -1,103 +1,144 @@
 #include <benchmark_cedar.h>
-#include <benchmark_hashable_keys.h>
-#include <benchmark_textscan.h>
+#include <benchmark_adapter.h>
+#include <benchmark_driver.h>
 
-#include <cedarpp.h>                                                                                                    
+#include <cedarpp.h>
 
 #include <intel_skylake_pmu.h>
 
-#include <sys/time.h>
-#include <sys/resource.h>
-
-static int cedar_test_text_insert(unsigned runNumber, cedar::da<int>& map, Intel::Stats& stats, Benchmark::LoadFile& file) {
-  // file.load("dist.bin.char");
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  char label[128];
-  snprintf(label, sizeof(label), "insert run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-  
-  // Benchmark running: do insert
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    map.update(word.data(), word.size(), scanner.index());
+#include <string>
+#include <vector>
+
+#include <string.h>
+
+namespace {
+
+class CedarAdapter: public Benchmark::AdapterBase<CedarAdapter> {
+  // Double array trie holding a constant for each key
+
+  // TYPES
+  typedef cedar::da<int> Map;
+
+  // DATA
+  Map d_map;
+
+public:
+  // TYPES
+  typedef char KeyType;
+
+  // ENUMS
+  enum {
+    k_CAN_ERASE = 1,
+    k_CAN_SCAN  = 1,    // from an existing key only: cedar has no lower bound
+  };
+
+  // CREATORS
+  explicit CedarAdapter(const Benchmark::Config&) {
   }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  // ACCESSORS
+  size_t size() const {
+    return d_map.num_keys();
+  }
 
-  return 0;
-}
+  size_t memory() const {
+    return d_map.total_size();
+  }
+
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<char>& key) {
+    d_map.update(key.data(), key.size(), 1);
+    return true;
+  }
+
+  bool find(Benchmark::Slice<char>& key) {
+    return d_map.exactMatchSearch<int>(key.data(), key.size())!=Map::CEDAR_NO_VALUE;
+  }
 
-static int cedar_test_text_find(unsigned runNumber, cedar::da<int>& map, Intel::Stats& stats, Benchmark::LoadFile& file) {
-  // file.load("skew.bin.char");
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  unsigned int errors(0);
-  char label[128];
-  snprintf(label, sizeof(label), "find run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-
-  // Benchmark running: do find
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    auto val = map.exactMatchSearch<int>(word.data(), word.size());
-    if (val!=scanner.index()) {
-      ++errors;
+  bool update(Benchmark::Slice<char>& key) {
+    d_map.update(key.data(), key.size(), 1);
+    return true;
+  }
+
+  bool erase(Benchmark::Slice<char>& key) {
+    return d_map.erase(key.data(), key.size())==0;
+  }
+  unsigned scan(Benchmark::Slice<char>& key, unsigned length) {
+    // Find 'key' then follow 'next' through the keys after it in order. A start key not in the trie visits nothing.
+    // 'begin' leaves the node 'traverse' stopped on as 'next' expects it whether the key ends on the trie or a tail
+    cedar::npos_t from(0);
+    size_t len(0);
+    const int found = d_map.traverse(key.data(), from, len, key.size());
+    if (length==0 || found==Map::CEDAR_NO_VALUE || found==Map::CEDAR_NO_PATH) {
+      return 0;
+    }
+    int value = d_map.begin(from, len);
+    Intel::DoNotOptimize(value);
+    unsigned i(1);
+    for (; i<length && (value = d_map.next(from, len))!=Map::CEDAR_NO_PATH; ++i) {
+      Intel::DoNotOptimize(value);
     }
+    return i;
   }
+};
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+class CedarKVAdapter: public Benchmark::AdapterBase<CedarKVAdapter> {
+  // cedar values are 'int' so each key holds 1 + the index of its value's copy in 'd_values'. New keys start at 0.
 
-  if (errors) {
-    printf("searchErrors: %u\n", errors);
+  // DATA
+  cedar::da<int>            d_map;
+  std::vector<std::string>  d_values;
+
+public:
+  // TYPES
+  typedef char KeyType;
+
+  // ENUMS
+  enum {
+    k_VALUES = 1,
+  };
+
+  // CREATORS
+  explicit CedarKVAdapter(const Benchmark::Config&) {
   }
 
-  return 0;
-}
+  // ACCESSORS
+  size_t size() const {
+    return d_values.size();
+  }
 
-int Benchmark::Cedar::start() {
-  // Default start is to load file                                                                                      
-  int rc = Benchmark::Report::start();                                                                                  
-  if (rc!=0) {                                                                                                          
-    return rc;                                                                                                          
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    int& slot = d_map.update(key.data(), key.size());
+    if (slot!=0) {
+      return false;
+    }
+    d_values.emplace_back(value.data(), value.size());
+    slot = d_values.size();
+    return true;
   }
 
-  if (d_config.d_format == "bin-text-kv") {
-    // We have KV pairs to play with
-    // Not implemented yet
-    return rc;
-  } else if (d_config.d_format=="bin-text") {
-    // We have a text file therefore we can only benchamrk key ins/upd/fnd/del on keys.
-    // Make a cuckoo map with the smallest possible value type (bool) and set it to a 
-    // constant value throughout all tests.
-    if (d_config.d_customAllocator) {
-      return rc;
-    } else {
-      for (unsigned i=0; i<d_config.d_runs; ++i) {
-        if (d_config.d_verbosity>0) {
-          printf("execute run set %u...\n", i);
-        }
-        cedar::da<int> map;
-        Benchmark::LoadFile& file = const_cast<Benchmark::LoadFile&>(d_file);
-        cedar_test_text_insert(i, map, d_insertStats, file);
-        cedar_test_text_find(i, map, d_findStats, file);
-        rusage(std::cout);
-      }
+  bool find(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    auto slot = d_map.exactMatchSearch<int>(key.data(), key.size());
+    if (slot<=0) {
+      return false;
     }
+    const std::string& held = d_values[slot-1];
+    return held.size()==value.size() && 0==memcmp(held.data(), value.data(), value.size());
   }
-  return rc;
+
+  bool update(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    auto slot = d_map.exactMatchSearch<int>(key.data(), key.size());
+    if (slot<=0) {
+      return false;
+    }
+    d_values[slot-1].assign(value.data(), value.size());
+    return true;
+  }
+};
+
+} // anonymous namespace
+
+int Benchmark::Cedar::run(const Config& config, const std::string& description) {
+  return Dispatch::plain<CedarAdapter, CedarKVAdapter>(config, description);
 }
@@ -1,24 +1,16 @@
 #pragma once
 
-#include <benchmark_report.h>
+#include <benchmark_config.h>
 
-namespace Benchmark {
-
-class Cedar: public Report {
-public:
-  // CREATORS
-  Cedar(const Config& config, const std::string& description)
-  : Report(config, description)
-  {
-  }
+#include <string>
 
-  virtual ~Cedar() = default;
-    // Destroy this object
+namespace Benchmark {
 
-  // MANIPULATORS
-  virtual int start();
-    // Return 0 if all benchmarks were run and non-zero otherwise. Note a non-zero code usually indicates
-    // bad configuration.
+struct Cedar {
+  // STATIC FUNCTIONS
+  static int run(const Config& config, const std::string& description);
+    // Return 0 if all benchmarks per specified 'config' were run then reported under specified 'description' and
+    // non-zero otherwise. Note a non-zero code usually indicates bad configuration.
 };
 
 } // namespace Benchmark
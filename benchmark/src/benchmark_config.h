@@ -8,9 +8,16 @@
 #include <string>
 #include <iostream>
 
+#include <unistd.h>
+
 namespace Benchmark {
 
 struct Config {
+  // ENUMS
+  enum {
+    k_MAX_FIND_BATCH = 256,         // largest 'd_findBatch'
+  };
+
   // DATA
   std::string   d_filename;         // file containing data for benchmarking
   unsigned long d_fileSizeBytes;    // size of input file in bytes
@@ -26,11 +33,32 @@ struct Config {
   int           d_cpu1;             // Optional cpu coreId for pinning thread(s)
   int           d_cpu2;             // Optional cpu coreId for pinning thread(s)
   int           d_cpu3;             // Optional cpu coreId for pinning thread(s)
+  unsigned      d_threads;          // If non-zero run multi-threaded phases over this many pinned threads
+  unsigned      d_writers;          // If non-zero with 'd_threads' also time this many threads inserting while the rest find
+  std::string   d_delegate;         // If non-empty with 'd_threads' also time delegating to owner threads per this spec
+  unsigned      d_latencySampling;  // If non-zero time every d_latencySampling-th operation for latency percentiles
+  std::string   d_workload;         // If non-empty run this YCSB-style mix instead of the insert then find phases
+  std::string   d_keyDistribution;  // Key choice distribution for 'd_workload'; empty for the workload's default
+  std::string   d_numa;             // NUMA placement of the loaded file: empty, 'local', 'replicate' or a node number
+  bool          d_persistent;       // True if the loaded file stays in shared memory for later runs to attach
+  std::string   d_keyOrder;         // If non-empty find phases look keys up in this 'KeyIndex' order
+  std::string   d_missFile;         // If non-empty run a miss phase probing this file's keys or 'mutate'd keys
+  std::string   d_erase;            // If non-empty erase then reinsert keys after find: 'drain' or a random percent
+  bool          d_compact;          // True if find is timed again before and after compacting the structure
+  std::string   d_scanLengths;      // If non-empty time range scans of each of these ',' separated key counts
+  unsigned      d_findBatch;        // If non-zero the single threaded find phase looks up this many keys per 'findBatch'
+  bool          d_hashMemo;         // True if hashmaps use hashes computed before timing and each hash is timed alone
 
   // CREATORS
   Config();
     // Create Config object with default values
 
+  // ACCESSORS
+  int threadCore(unsigned thread) const;
+    // Return the cpu coreId specified 'thread' in '[0, d_threads)' is pinned to. Threads 0-3 use 'd_cpu0..d_cpu3'.
+    // Higher threads continue after 'd_cpu3' with the same stride as 'd_cpu2, d_cpu3' (at least 1) wrapping at the
+    // number of online cores.
+
   // ASPECTS
   void print() const;
     // Pretty-print configuration to stdout.
@@ -47,9 +75,31 @@ Config::Config()
 , d_cpu1(4)
 , d_cpu2(6)
 , d_cpu3(8)
+, d_threads(0)
+, d_writers(0)
+, d_latencySampling(0)
+, d_persistent(false)
+, d_compact(false)
+, d_findBatch(0)
+, d_hashMemo(false)
 {
 }
 
+// ACCESSORS
+inline
+int Config::threadCore(unsigned thread) const {
+  switch (thread) {
+    case 0: return d_cpu0;
+    case 1: return d_cpu1;
+    case 2: return d_cpu2;
+    case 3: return d_cpu3;
+    default: break;
+  }
+  const int stride = d_cpu3>d_cpu2 ? d_cpu3-d_cpu2 : 1;
+  const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return static_cast<int>((d_cpu3 + stride*(thread-3)) % (cores>0 ? cores : 1));
+}
+
 // ASPECTS
 inline
 void Config::print() const {
@@ -67,7 +117,22 @@ void Config::print() const {
   printf("  coreId0      : %d,\n", d_cpu0);
   printf("  coreId1      : %d,\n", d_cpu1);
   printf("  coreId2      : %d,\n", d_cpu2);
-  printf("  coreId3      : %d\n", d_cpu3);
+  printf("  coreId3      : %d,\n", d_cpu3);
+  printf("  threads      : %u,\n", d_threads);
+  printf("  writers      : %u,\n", d_writers);
+  printf("  delegate     : \"%s\"\n", d_delegate.c_str());
+  printf("  latencyEvery : %u,\n", d_latencySampling);
+  printf("  workload     : \"%s\"\n", d_workload.c_str());
+  printf("  keyDistrib   : \"%s\"\n", !d_keyDistribution.empty() ? d_keyDistribution.c_str() : "workload default");
+  printf("  numa         : \"%s\"\n", !d_numa.empty() ? d_numa.c_str() : "kernel default");
+  printf("  persistent   : %s,\n", d_persistent ? "true": "false" );
+  printf("  keyOrder     : \"%s\"\n", !d_keyOrder.empty() ? d_keyOrder.c_str() : "file scan");
+  printf("  missKeys     : \"%s\"\n", d_missFile.c_str());
+  printf("  erase        : \"%s\"\n", d_erase.c_str());
+  printf("  compact      : %s,\n", d_compact ? "true": "false" );
+  printf("  scanLengths  : \"%s\"\n", d_scanLengths.c_str());
+  printf("  findBatch    : %u,\n", d_findBatch);
+  printf("  hashMemo     : %s,\n", d_hashMemo ? "true": "false" );
   printf("}\n");
 }
 
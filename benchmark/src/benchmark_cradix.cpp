@@ -1,204 +1,221 @@
 #include <benchmark_cradix.h>
+#include <benchmark_adapter.h>
+#include <benchmark_driver.h>
+#include <benchmark_kvrecord.h>
 #include <benchmark_textscan.h>
 
 #include <cradix_tree.h>
+#include <cradix_concurrenttree.h>
 #include <cradix_memmanager.h>
 
-#include <ringbuffer_spsc.h>
-
 #include <intel_skylake_pmu.h>
 
-template<typename T>
-static int cradix_test_text_insert(unsigned runNumber, T* map, Intel::Stats& stats, const Benchmark::LoadFile& file,
-  int coreId0) {
+#include <memory>
 
-  char label[128];
-  snprintf(label, sizeof(label), "insert run %u", runNumber);
+#include <assert.h>
 
-  Intel::SkyLake::PMU::pinToHWCore(coreId0);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+namespace {
 
-  timespec startTime, endTime;
-  Benchmark::TextScan<unsigned char> scanner(file);
+class CRadixAdapter: public Benchmark::AdapterBase<CRadixAdapter> {
+  // CRadix tree over its own memory manager holding keys only
 
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
+  // DATA
+  std::unique_ptr<CRadix::MemManager> d_mem;
+  CRadix::Tree                        d_tree;
 
-  // Benchmark running: do insert
-  RingBuffer::Op op;
-  Benchmark::Slice<unsigned char> word;
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    map->insert(word);
-  }
+public:
+  // TYPES
+  typedef unsigned char KeyType;
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  // ENUMS
+  enum {
+    k_CAN_ERASE   = 1,
+    k_CAN_SCAN    = 1,
+    k_CAN_COMPACT = 1,
+    k_FIND_BATCH  = 1,    // interleave lookups prefetching each one's next node
+  };
 
-  return 0;
-}
+  // CREATORS
+  explicit CRadixAdapter(const Benchmark::Config&)
+  : d_mem(new CRadix::MemManager(0xFFFFFFFFU, 4))
+  , d_tree(d_mem.get())
+  {
+  }
 
-template<typename T>
-static int cradix_test_text_find(unsigned runNumber, T* map, Intel::Stats& stats, const Benchmark::LoadFile& file,
-  int coreId0) {
+  // ACCESSORS
+  size_t memory() const {
+    // Bytes taken from the arena. Dead nodes on free lists are counted until reused
+    return d_mem->d_offset;
+  }
 
-  char label[128];
-  snprintf(label, sizeof(label), "find run %u", runNumber);
-  
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-  Intel::SkyLake::PMU::pinToHWCore(coreId0);
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<unsigned char>& key) {
+    return d_tree.insert(key)==CRadix::e_OK;
+  }
 
-  timespec startTime, endTime;
-  Benchmark::TextScan<unsigned char> scanner(file);
+  bool find(Benchmark::Slice<unsigned char>& key) {
+    return d_tree.find(key)==CRadix::e_EXISTS;
+  }
 
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
+  bool update(Benchmark::Slice<unsigned char>& key) {
+    d_tree.insert(key);
+    return true;
+  }
 
-  // Benchmark running: do find
-  RingBuffer::Op op;
-  Benchmark::Slice<unsigned char> word;
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    map->find(word);
+  void findBatch(Benchmark::Slice<unsigned char> *keys, bool *results, unsigned count) {
+    int rc[Benchmark::Config::k_MAX_FIND_BATCH];
+    assert(count<=Benchmark::Config::k_MAX_FIND_BATCH);
+    d_tree.findBatch(keys, rc, count);
+    for (unsigned i=0; i<count; ++i) {
+      results[i] = rc[i]==CRadix::e_EXISTS;
+    }
   }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  bool erase(Benchmark::Slice<unsigned char>& key) {
+    return d_tree.remove(key)==CRadix::e_OK;
+  }
 
-  return 0;
-}
+  unsigned scan(Benchmark::Slice<unsigned char>& key, unsigned length) {
+    auto visitor = [](const u_int8_t *word, u_int16_t size) {
+      Intel::DoNotOptimize(word);
+      Intel::DoNotOptimize(size);
+    };
+    return static_cast<unsigned>(d_tree.scan(key, Benchmark::Slice<unsigned char>(), length, visitor));
+  }
 
-template<typename T>
-static int cradix_test_text_insert_queue(unsigned runNumber, T* map, Intel::Stats& stats, const Benchmark::LoadFile& file,
-  int coreId0, int coreId1) {
-  RingBuffer::SPSC queue;
-  auto t = std::thread([&] {
-    Intel::SkyLake::PMU::pinToHWCore(coreId0);
-    RingBuffer::Op op;
-    for(;;) {
-      while (!queue.read(op));
-      if (op.d_op==2) {
-        return;
-      } else {
-        Benchmark::Slice<unsigned char> word(op.d_arg0);
-        map->insert(word);
-      }
+  bool compact() {
+    // Copy live nodes into a fresh arena then drop the old one with its dead nodes and spare capacity
+    std::unique_ptr<CRadix::MemManager> mem(new CRadix::MemManager(0xFFFFFFFFU, 4));
+    if (d_tree.compact(mem.get())!=CRadix::e_OK) {
+      return false;
     }
-  });
-  
-  char label[128];
-  snprintf(label, sizeof(label), "insert run %u", runNumber);
+    d_mem.swap(mem);
+    return true;
+  }
+
+};
 
-  Intel::SkyLake::PMU::pinToHWCore(coreId1);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+class CRadixOLCAdapter: public Benchmark::AdapterBase<CRadixOLCAdapter> {
+  // CRadix tree threads insert into and search at once: finds lock nothing, inserts lock the nodes they change
 
-  timespec startTime, endTime;
-  Benchmark::TextScan<unsigned char> scanner(file);
+  // DATA
+  CRadix::MemManager      d_mem;
+  CRadix::ConcurrentTree  d_tree;
 
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
+public:
+  // TYPES
+  typedef unsigned char KeyType;
 
-  // Benchmark running: do insert
-  RingBuffer::Op op;
-  Benchmark::Slice<unsigned char> word;
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    op.d_op = 0;
-    op.d_arg0 = word.rawValue();
-    while(!queue.append(op));
+  // ENUMS
+  enum {
+    k_CAN_SCAN    = 1,    // single threaded phases only
+    k_MT_INSERT   = 1,
+  };
+
+  // CREATORS
+  explicit CRadixOLCAdapter(const Benchmark::Config&)
+  : d_mem(0xFFFFFFFFU, 4)
+  , d_tree(&d_mem)
+  {
   }
-  op.d_op = 2;
-  while(!queue.append(op));
 
-  t.join();
+  // ACCESSORS
+  size_t memory() const {
+    // Bytes taken from the arena plus the node versions
+    return d_mem.d_offset + CRadix::VersionLocks::k_STRIPES*sizeof(u_int64_t);
+  }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<unsigned char>& key) {
+    return d_tree.insert(key)==CRadix::e_OK;
+  }
 
-  return 0;
-}
+  bool find(Benchmark::Slice<unsigned char>& key) {
+    return d_tree.find(key)==CRadix::e_EXISTS;
+  }
 
-template<typename T>
-static int cradix_test_text_find_queue(unsigned runNumber, T* map, Intel::Stats& stats, const Benchmark::LoadFile& file,
-  int coreId0, int coreId1) {
-  RingBuffer::SPSC queue;
-  auto t = std::thread([&] {
-    Intel::SkyLake::PMU::pinToHWCore(coreId0);
-    RingBuffer::Op op;
-    for(;;) {
-      while (!queue.read(op));
-      if (op.d_op==2) {
-        return;
-      } else {
-        Benchmark::Slice<unsigned char> word(op.d_arg0);
-        map->find(word);
+  bool update(Benchmark::Slice<unsigned char>& key) {
+    d_tree.insert(key);
+    return true;
+  }
+
+  unsigned scan(Benchmark::Slice<unsigned char>& key, unsigned length) {
+    auto visitor = [](const u_int8_t *word, u_int16_t size) {
+      Intel::DoNotOptimize(word);
+      Intel::DoNotOptimize(size);
+    };
+    return static_cast<unsigned>(d_tree.tree().scan(key, Benchmark::Slice<unsigned char>(), length, visitor));
+  }
+};
+
+class CRadixKVAdapter: public Benchmark::AdapterBase<CRadixKVAdapter> {
+  // CRadix tree holding one 64-bit value per key so it points to a copied record
+
+  // DATA
+  CRadix::MemManager  d_mem;
+  CRadix::Tree        d_tree;
+
+public:
+  // TYPES
+  typedef unsigned char KeyType;
+
+  // ENUMS
+  enum {
+    k_VALUES = 1,
+  };
+
+  // CREATORS
+  explicit CRadixKVAdapter(const Benchmark::Config&)
+  : d_mem(0xFFFFFFFFU, 4)
+  , d_tree(&d_mem)
+  {
+  }
+
+  ~CRadixKVAdapter() {
+    u_int64_t record;
+    for (CRadix::Iterator iter = d_tree.begin(); !iter.end(); iter.next()) {
+      Benchmark::Slice<unsigned char> key(iter.key(), iter.keySize());
+      if (d_tree.find(key, &record)==CRadix::e_EXISTS) {
+        Benchmark::KVRecord::destroy(reinterpret_cast<char*>(record));
       }
     }
-  });
-
-  char label[128];
-  snprintf(label, sizeof(label), "find run %u", runNumber);
-  
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-  Intel::SkyLake::PMU::pinToHWCore(coreId1);
+  }
 
-  timespec startTime, endTime;
-  Benchmark::TextScan<unsigned char> scanner(file);
+  // ACCESSORS
+  size_t memory() const {
+    // Bytes taken from the arena plus value ids. Records are not counted
+    return d_mem.d_offset + d_tree.valueSizeBytes();
+  }
 
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<unsigned char>& key, Benchmark::Slice<unsigned char>& value) {
+    char *record = Benchmark::KVRecord::create(key, value);
+    if (d_tree.insert(key, reinterpret_cast<u_int64_t>(record))!=CRadix::e_OK) {
+      Benchmark::KVRecord::destroy(record);
+      return false;
+    }
+    return true;
+  }
 
-  // Benchmark running: do find
-  RingBuffer::Op op;
-  Benchmark::Slice<unsigned char> word;
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    op.d_op = 0;
-    op.d_arg0 = word.rawValue();
-    while(!queue.append(op));
+  bool find(Benchmark::Slice<unsigned char>& key, Benchmark::Slice<unsigned char>& value) {
+    u_int64_t record;
+    return d_tree.find(key, &record)==CRadix::e_EXISTS &&
+      Benchmark::KVRecord::equal(reinterpret_cast<const char*>(record), value);
   }
-  op.d_op = 2;
-  while(!queue.append(op));
 
-  t.join();
+  bool update(Benchmark::Slice<unsigned char>& key, Benchmark::Slice<unsigned char>& value) {
+    u_int64_t record;
+    return d_tree.find(key, &record)==CRadix::e_EXISTS &&
+      Benchmark::KVRecord::assign(reinterpret_cast<char*>(record), value);
+  }
+};
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+} // anonymous namespace
 
-  return 0;
+int Benchmark::cradix::run(const Config& config, const std::string& description) {
+  return Dispatch::plain<CRadixAdapter, CRadixKVAdapter>(config, description);
 }
 
-int Benchmark::cradix::start() {
-  // Default start is to load file                                                                                      
-  int rc = Benchmark::Report::start();                                                                                  
-  if (rc!=0) {                                                                                                          
-    return rc;                                                                                                          
-  }
-
-  if (d_config.d_format == "bin-text-kv") {
-    // We have KV pairs to play with
-    // Not implemented yet
-    return rc;
-  } else if (d_config.d_format=="bin-text") {
-    // We have a text file therefore we can only benchamrk key ins/upd/fnd/del on keys.
-    // Make a cuckoo map with the smallest possible value type (bool) and set it to a 
-    // constant value throughout all tests.
-    if (d_config.d_customAllocator) {
-      return rc;
-    } else {
-      for (unsigned i=0; i<d_config.d_runs; ++i) {
-        if (d_config.d_verbosity>0) {
-          printf("execute run set %u...\n", i);
-        }
-        CRadix::MemManager mem(0xFFFFFFFFU, 4);;
-        CRadix::Tree cradixTree(&mem);
-        cradix_test_text_insert(i, &cradixTree, d_insertStats, d_file, d_config.d_cpu0);
-        cradix_test_text_find(i, &cradixTree, d_findStats, d_file, d_config.d_cpu0);
-        // cradix_test_text_insert_queue(i, &cradixTree, d_insertStatsWithQueue, d_file, d_config.d_cpu0, d_config.d_cpu1);
-        // cradix_test_text_find_queue(i, &cradixTree, d_findStatsWithQueue, d_file, d_config.d_cpu0, d_config.d_cpu1);
-        rusage(std::cout);
-      }
-    }
-  }
-  return rc;
+int Benchmark::cradixOLC::run(const Config& config, const std::string& description) {
+  return Dispatch::plain<CRadixOLCAdapter, CRadixKVAdapter>(config, description);
 }
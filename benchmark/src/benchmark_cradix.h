@@ -1,24 +1,23 @@
 #pragma once
 
-#include <benchmark_report.h>
+#include <benchmark_config.h>
+
+#include <string>
 
 namespace Benchmark {
 
-class cradix: public Report {
-public:
-  // CREATORS                                                                                                           
-  cradix(const Config& config, const std::string& description)
-  : Report(config, description)
-  {
-  }
-                                                                                                                        
-  virtual ~cradix() = default;                                                                                                   
-    // Destory this object 
+struct cradix {
+  // STATIC FUNCTIONS
+  static int run(const Config& config, const std::string& description);
+    // Return 0 if all benchmarks per specified 'config' were run then reported under specified 'description' and
+    // non-zero otherwise. Note a non-zero code usually indicates bad configuration.
+};
 
-  // MANIPULATORS
-  virtual int start();
-    // Return 0 if all benchmarks were run and non-zero otherwise. Note a non-zero code usually indicates
-    // bad configuration.
+struct cradixOLC {
+  // STATIC FUNCTIONS
+  static int run(const Config& config, const std::string& description);
+    // Return 0 if all benchmarks per specified 'config' were run on the concurrent CRadix tree then reported under
+    // specified 'description' and non-zero otherwise. 'bin-text-kv' runs the single threaded tree as 'cradix' does.
 };
 
 } // namespace Benchmark
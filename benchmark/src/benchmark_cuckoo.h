@@ -5,25 +5,17 @@
 // CLASSES:
 //  Benchmark::Cuckoo: Benchmark the Cuckoo hashing algorithm
 
-#include <benchmark_report.h>
+#include <benchmark_config.h>
 
-namespace Benchmark {
+#include <string>
 
-class Cuckoo: public Report {
-public:
-  // CREATORS                                                                                                           
-  Cuckoo(const Config& config, const std::string& description)                                     
-  : Report(config, description)                                                                                   
-  {                                                                                                                     
-  }                                                                                                                     
-                                                                                                                        
-  virtual ~Cuckoo() = default;                                                                                                   
-    // Destory this object 
+namespace Benchmark {
 
-  // MANIPULATORS
-  virtual int start();
-    // Return 0 if all benchmarks were run and non-zero otherwise. Note a non-zero code usually indicates
-    // bad configuration.
+struct Cuckoo {
+  // STATIC FUNCTIONS
+  static int run(const Config& config, const std::string& description);
+    // Return 0 if all benchmarks per specified 'config' were run then reported under specified 'description' and
+    // non-zero otherwise. Note a non-zero code usually indicates bad configuration.
 };
 
 } // namespace Benchmark
@@ -0,0 +1,68 @@
+#include <benchmark_delegation.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int Benchmark::DelegationSpec::configure(const std::string& spec) {
+  d_owners = 0;
+  d_ring = e_SPSC;
+  d_shard = e_HASH;
+  d_batch = 0;
+  d_reply = false;
+
+  const char *ptr = spec.c_str();
+  char *end(0);
+  const unsigned long owners = strtoul(ptr, &end, 10);
+  if (end==ptr || owners==0 || owners>k_MAX_OWNERS || (*end!=',' && *end!=0)) {
+    return 1;
+  }
+
+  // Each ',' separated word after the owner count names a ring, a sharding, a batch or 'reply' at most once
+  bool ring(false);
+  bool shard(false);
+  bool batch(false);
+  for (ptr=end; *ptr==',';) {
+    const char *begin = ++ptr;
+    while (*ptr && *ptr!=',') {
+      ++ptr;
+    }
+    const std::string word(begin, ptr-begin);
+    if (!ring && (word==ringName(e_SPSC) || word==ringName(e_MPSC))) {
+      d_ring = word==ringName(e_SPSC) ? e_SPSC : e_MPSC;
+      ring = true;
+    } else if (!shard && (word==shardName(e_HASH) || word==shardName(e_RANGE))) {
+      d_shard = word==shardName(e_HASH) ? e_HASH : e_RANGE;
+      shard = true;
+    } else if (!batch && !word.empty() && word.find_first_not_of("0123456789")==std::string::npos &&
+      word.size()<4 && atoi(word.c_str())>0 && atoi(word.c_str())<=k_MAX_BATCH) {
+      d_batch = atoi(word.c_str());
+      batch = true;
+    } else if (!d_reply && word=="reply") {
+      d_reply = true;
+    } else {
+      d_ring = e_SPSC;
+      d_shard = e_HASH;
+      d_batch = 0;
+      d_reply = false;
+      return 1;
+    }
+  }
+
+  d_spec = spec;
+  d_owners = static_cast<unsigned>(owners);
+  return 0;
+}
+
+void Benchmark::DelegationSpec::print() const {
+  printf("delegation: '%s' owners %u ring %s capacity %u shard %s batch %u message %s reply %s\n", d_spec.c_str(),
+    d_owners, ringName(d_ring), d_ring==e_SPSC ? k_SPSC_CAPACITY : k_MPSC_CAPACITY, shardName(d_shard), d_batch,
+    d_batch ? "8 byte word" : "64 byte op", d_reply ? "yes" : "no");
+}
+
+const char *Benchmark::DelegationSpec::ringName(Ring ring) {
+  return ring==e_SPSC ? "spsc" : "mpsc";
+}
+
+const char *Benchmark::DelegationSpec::shardName(Shard shard) {
+  return shard==e_HASH ? "hash" : "range";
+}
@@ -0,0 +1,766 @@
+#pragma once
+
+// PURPOSE: Delegate every operation on a data structure to owner threads each holding one shard of it
+//
+// CLASSES:
+//  Benchmark::DelegationSpec: Parse how many owners there are, the rings reaching them, and how keys are sharded
+//  Benchmark::Delegation:     Run client threads sending operations over ring buffers to owner threads each running
+//                             its own single threaded adapter instance
+//
+// Shared-memory concurrency (see 'Scaling') has every thread run operations on one structure. Delegation instead
+// gives each of K owner threads its own instance holding one shard of the keys. Clients never touch a structure:
+// they route each key to the owner of its shard as a 'RingBuffer::Op' holding the key's 'Slice::rawValue'. An
+// owner's shard stays in its own core's cache and needs no locking, so any adapter can be delegated to whether or
+// not it is thread-safe. 'insert, find' phases are fire-and-forget: owners apply operations but send nothing back,
+// so they measure owners' throughput.
+//
+// Unbatched, each operation is one cache line 'RingBuffer::Op' handed off by itself. Batched, a phase's operation is
+// known to owners so each key travels as its 8 byte 'Slice::rawValue' alone ('RingBuffer::Word'). A client buffers
+// words per owner and appends a full batch with one publication of the ring's index; owners read all queued at once.
+//
+// With 'reply' each client, owner pair also gets an SPSC ring back to the client and a 'roundTrip' phase measures
+// finds as a client sees them. Owners answer each key with a word 1 if found and 0 if not. Clients run a closed
+// loop keeping at most one batch, or one key unbatched, in flight per owner and time each key from the append that
+// sends it to reading its answer. Owners learn who sent a key from the ring it came over, from 'RingBuffer::Op'
+// 'd_arg1' on an unbatched MPSC ring, or from a tag word batched on an MPSC ring: 'client+1' which cannot be a
+// 'Slice::rawValue' because its upper 16 bits are 0. It precedes each run of words a client appends.
+
+#include <benchmark_config.h>
+#include <benchmark_numa.h>
+#include <benchmark_scaling.h>
+#include <benchmark_slice.h>
+#include <benchmark_textscan.h>
+
+#include <intel_latency_recorder.h>
+#include <intel_skylake_pmu.h>
+
+#include <ringbuffer_mpsc.h>
+#include <ringbuffer_op.h>
+#include <ringbuffer_spsc.h>
+
+#include <xxhash.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+#include <assert.h>
+#include <sys/types.h>
+
+namespace Benchmark {
+
+class DelegationSpec {
+public:
+  // ENUMS
+  enum Ring {
+    e_SPSC    = 0,            // one SPSC ring per client, owner pair
+    e_MPSC    = 1,            // one MPSC ring per owner all clients append to
+  };
+
+  enum Shard {
+    e_HASH    = 0,            // owner of a key is 'XXH3_64bits(key)%owners'
+    e_RANGE   = 1,            // owners split the values of a key's first byte into equal, contiguous ranges
+  };
+
+  enum {
+    k_MAX_OWNERS      = 256,  // largest 'owners'
+    k_MAX_BATCH       = 256,  // largest 'batch'
+    k_SPSC_CAPACITY   = 1024, // slots in each client, owner ring
+    k_MPSC_CAPACITY   = 4096, // slots in each owner's ring
+  };
+
+private:
+  // DATA
+  std::string   d_spec;       // spec as given e.g. '4,mpsc,range'
+  unsigned      d_owners;     // number of owner threads or 0 if not configured
+  Ring          d_ring;       // rings from clients to owners
+  Shard         d_shard;      // how keys map to owners
+  unsigned      d_batch;      // words per append or 0 to send one 'RingBuffer::Op' per append
+  bool          d_reply;      // true if owners answer finds over rings back to clients
+
+public:
+  // CREATORS
+  DelegationSpec();
+    // Create an unconfigured spec
+
+  DelegationSpec(const DelegationSpec& other) = delete;
+    // Copy constructor not provided
+
+  ~DelegationSpec() = default;
+    // Destroy this object
+
+  // ACCESSORS
+  bool empty() const;
+    // Return true if 'configure' did not succeed and false otherwise
+
+  unsigned owners() const;
+    // Return the number of owner threads
+
+  Ring ring() const;
+    // Return the rings clients reach owners through
+
+  Shard shard() const;
+    // Return how keys map to owners
+
+  unsigned batch() const;
+    // Return the number of keys a client sends an owner per append, or 0 if each key is sent alone as one
+    // 'RingBuffer::Op'
+
+  bool reply() const;
+    // Return true if owners answer finds so 'Delegation::roundTrip' may run and false otherwise
+
+  const std::string& spec() const;
+    // Return the spec given to 'configure'
+
+  unsigned owner(const void *key, unsigned size) const;
+    // Return the owner in '[0, owners())' of the shard holding specified 'key' of specified 'size'. Behavior is
+    // defined provided 'size>0'.
+
+  // MANIPULATORS
+  int configure(const std::string& spec);
+    // Return 0 if specified 'spec' is '<owners>[,spsc|mpsc][,hash|range][,<batch>][,reply]' with
+    // '0<owners<=k_MAX_OWNERS' and '0<batch<=k_MAX_BATCH' configuring this object accordingly, and non-zero
+    // otherwise. Rings default to 'spsc', sharding to 'hash', keys are sent one 'RingBuffer::Op' at a time without
+    // 'batch', and owners answer nothing without 'reply'.
+
+  DelegationSpec& operator=(const DelegationSpec& rhs) = delete;
+    // Assignment operator not provided
+
+  // ASPECTS
+  void print() const;
+    // Print to stdout a human readable summary of the spec
+
+  // STATIC FUNCTIONS
+  static const char *ringName(Ring ring);
+  static const char *shardName(Shard shard);
+    // Return the name of specified 'ring' or 'shard' as 'configure' accepts it
+};
+
+template<typename ADAPTER>
+class Delegation {
+  // Owner threads are started on construction and each creates its 'ADAPTER' shard on its own core so the shard's
+  // memory is first touched, and placed, there. Shards persist from one phase to the next, so an 'insert' phase
+  // followed by a 'find' phase finds what was inserted. Shards of a 'k_STATIC' adapter are sealed at the end of each
+  // 'insert' phase. Destruction stops the owners which destroy their shards.
+
+  // TYPES
+  typedef typename ADAPTER::KeyType T;
+
+  // ENUMS
+  enum {
+    e_INSERT  = 0,            // 'RingBuffer::Op::d_op': insert key 'd_arg0'
+    e_FIND    = 1,            // find key 'd_arg0'
+    e_STOP    = 2,            // sending client has no more operations this phase; the word 0 when batched
+    e_REPLY   = 3,            // find key 'd_arg0' answering client 'd_arg1'
+  };
+
+  // DATA
+  const Config&                                 d_config;
+  const DelegationSpec&                         d_spec;
+  const NumaReplicas&                           d_files;
+  const unsigned                                d_clients;  // 'd_config.d_threads'
+  std::vector<std::unique_ptr<RingBuffer::SPSC>> d_pairs;   // 'e_SPSC' unbatched: ring 'client*owners+owner'
+  std::vector<std::unique_ptr<RingBuffer::MPSC>> d_queues;  // 'e_MPSC' unbatched: ring 'owner'
+  std::vector<std::unique_ptr<RingBuffer::WordSPSC>> d_wordPairs;  // 'e_SPSC' batched: as 'd_pairs'
+  std::vector<std::unique_ptr<RingBuffer::WordMPSC>> d_wordQueues; // 'e_MPSC' batched: as 'd_queues'
+  std::vector<std::unique_ptr<RingBuffer::WordSPSC>> d_replies;    // with 'reply': ring 'client*owners+owner' back
+  u_int64_t                                     d_op;       // operation of current phase
+  std::vector<ScalingResult>                    d_results;  // per owner: what it did last phase
+  std::atomic<unsigned>                         d_idle;     // owners done with the last phase
+  std::atomic<unsigned>                         d_phase;    // bumped to start a phase
+  std::atomic<bool>                             d_exit;     // owners return on next phase if set
+  std::vector<std::thread>                      d_owners;
+
+public:
+  // CREATORS
+  Delegation(const Config& config, const DelegationSpec& spec, const NumaReplicas& files);
+    // Create Delegation of 'spec.owners()' owner threads, owner 'i' pinned to 'config.threadCore(config.d_threads+i)',
+    // serving 'config.d_threads' client threads pinned as 'Scaling::run' pins them. Clients read the keys of
+    // specified 'files'. Behavior is defined provided 'config.d_threads>0' and '!spec.empty()'.
+
+  Delegation(const Delegation& other) = delete;
+    // Copy constructor not provided
+
+  ~Delegation();
+    // Stop and join the owner threads after they destroy their shards
+
+  // ACCESSORS
+  const DelegationSpec& spec() const;
+    // Return the spec given at construction
+
+  // MANIPULATORS
+  void insert(const char *desc, ScalingStats& stats);
+  void find(const char *desc, ScalingStats& stats);
+    // Run one phase: clients split the words of 'files' as 'Scaling::run' does sending each to the owner of its
+    // shard which applies 'ADAPTER::insert' or 'ADAPTER::find' respectively. Owners' results, each timed from the
+    // common start signal to applying its last operation, are recorded in specified 'stats' under specified 'desc'.
+
+  u_int64_t roundTrip(const char *desc, ScalingStats& stats);
+    // Return the number of keys owners answered found after running one phase in which clients split the words of
+    // 'files' as 'find' does but wait for owners' answers. Clients' results, each timed from the common start signal
+    // to reading its last answer, and every key's round trip latency are recorded in specified 'stats' under
+    // specified 'desc'. Behavior is defined provided 'spec().reply()'.
+
+  Delegation& operator=(const Delegation& rhs) = delete;
+    // Assignment operator not provided
+
+private:
+  // PRIVATE MANIPULATORS
+  u_int64_t run(const char *desc, u_int64_t op, ScalingStats& stats);
+    // Return the number of keys owners answered found after running one phase of specified 'op' recording owners'
+    // results, or clients' results and latency for 'e_REPLY', in specified 'stats' under specified 'desc'
+
+  u_int64_t request(unsigned client, unsigned begin, unsigned end, TextScan<T>& scanner,
+    Intel::LatencyRecorder& latency);
+    // Return the number of keys owners answered found after specified 'client' sends words 'begin' to 'end' of
+    // specified 'scanner', positioned at 'begin', to their owners and reads every answer, recording each key's
+    // round trip time in specified 'latency'
+
+  void own(unsigned owner);
+    // Run owner thread 'owner' until 'd_exit'
+
+  void send(unsigned client, unsigned owner, const RingBuffer::Op& op);
+    // Append specified 'op' from specified 'client' to the ring reaching specified 'owner' waiting while it's full
+
+  void send(unsigned client, unsigned owner, const RingBuffer::Word *words, unsigned count);
+    // Append specified 'count' 'words' from specified 'client' to the word ring reaching specified 'owner' waiting
+    // while it's full
+
+  unsigned receive(unsigned client, unsigned owner, RingBuffer::Word *words, unsigned count);
+    // Return the number of words, at most specified 'count', read into specified 'words' from the word ring reaching
+    // specified 'owner' from specified 'client'. 'client' is ignored for 'e_MPSC'.
+
+  void sendTagged(unsigned owner, RingBuffer::Word *words, unsigned count);
+    // Append specified 'count' 'words', the first a client's tag, to the word ring of specified 'owner' waiting while
+    // it's full. Should a partial append let other clients' words in, the rest is tagged again. Behavior is defined
+    // provided 'count>1'. Note that 'words' is overwritten.
+
+  void answer(unsigned client, unsigned owner, const RingBuffer::Word *words, unsigned count);
+    // Append specified 'count' 'words' from specified 'owner' to the ring back to specified 'client' waiting while
+    // it's full
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+inline
+DelegationSpec::DelegationSpec()
+: d_owners(0)
+, d_ring(e_SPSC)
+, d_shard(e_HASH)
+, d_batch(0)
+, d_reply(false)
+{
+}
+
+// ACCESSORS
+inline
+bool DelegationSpec::empty() const {
+  return d_owners==0;
+}
+
+inline
+unsigned DelegationSpec::owners() const {
+  return d_owners;
+}
+
+inline
+DelegationSpec::Ring DelegationSpec::ring() const {
+  return d_ring;
+}
+
+inline
+DelegationSpec::Shard DelegationSpec::shard() const {
+  return d_shard;
+}
+
+inline
+unsigned DelegationSpec::batch() const {
+  return d_batch;
+}
+
+inline
+bool DelegationSpec::reply() const {
+  return d_reply;
+}
+
+inline
+const std::string& DelegationSpec::spec() const {
+  return d_spec;
+}
+
+inline
+unsigned DelegationSpec::owner(const void *key, unsigned size) const {
+  assert(key);
+  assert(size>0);
+  if (d_shard==e_RANGE) {
+    return (static_cast<unsigned>(*static_cast<const u_int8_t*>(key))*d_owners)>>8;
+  }
+  return static_cast<unsigned>(XXH3_64bits(key, size)%d_owners);
+}
+
+template<typename ADAPTER>
+Delegation<ADAPTER>::Delegation(const Config& config, const DelegationSpec& spec, const NumaReplicas& files)
+: d_config(config)
+, d_spec(spec)
+, d_files(files)
+, d_clients(config.d_threads)
+, d_op(e_INSERT)
+, d_results(spec.owners())
+, d_idle(0)
+, d_phase(0)
+, d_exit(false)
+{
+  assert(d_clients>0);
+  assert(!spec.empty());
+
+  const bool batched = spec.batch()>0;
+  if (spec.ring()==DelegationSpec::e_SPSC) {
+    for (unsigned i=0; i<d_clients*spec.owners(); ++i) {
+      if (batched) {
+        d_wordPairs.emplace_back(new RingBuffer::WordSPSC(DelegationSpec::k_SPSC_CAPACITY));
+      } else {
+        d_pairs.emplace_back(new RingBuffer::SPSC(DelegationSpec::k_SPSC_CAPACITY));
+      }
+    }
+  } else {
+    for (unsigned i=0; i<spec.owners(); ++i) {
+      if (batched) {
+        d_wordQueues.emplace_back(new RingBuffer::WordMPSC(DelegationSpec::k_MPSC_CAPACITY));
+      } else {
+        d_queues.emplace_back(new RingBuffer::MPSC(DelegationSpec::k_MPSC_CAPACITY));
+      }
+    }
+  }
+
+  if (spec.reply()) {
+    // At most one batch is in flight per pair so answers never fill these
+    for (unsigned i=0; i<d_clients*spec.owners(); ++i) {
+      d_replies.emplace_back(new RingBuffer::WordSPSC(DelegationSpec::k_SPSC_CAPACITY));
+    }
+  }
+
+  for (unsigned i=0; i<spec.owners(); ++i) {
+    d_owners.emplace_back(&Delegation<ADAPTER>::own, this, i);
+  }
+}
+
+template<typename ADAPTER>
+Delegation<ADAPTER>::~Delegation() {
+  while (d_idle.load(std::memory_order_acquire)!=d_spec.owners()) {
+    __builtin_ia32_pause();
+  }
+  d_exit.store(true, std::memory_order_relaxed);
+  d_phase.fetch_add(1, std::memory_order_release);
+  for (auto& owner: d_owners) {
+    owner.join();
+  }
+}
+
+// ACCESSORS
+template<typename ADAPTER>
+inline
+const DelegationSpec& Delegation<ADAPTER>::spec() const {
+  return d_spec;
+}
+
+// MANIPULATORS
+template<typename ADAPTER>
+inline
+void Delegation<ADAPTER>::insert(const char *desc, ScalingStats& stats) {
+  run(desc, e_INSERT, stats);
+}
+
+template<typename ADAPTER>
+inline
+void Delegation<ADAPTER>::find(const char *desc, ScalingStats& stats) {
+  run(desc, e_FIND, stats);
+}
+
+template<typename ADAPTER>
+inline
+u_int64_t Delegation<ADAPTER>::roundTrip(const char *desc, ScalingStats& stats) {
+  assert(d_spec.reply());
+  return run(desc, e_REPLY, stats);
+}
+
+template<typename ADAPTER>
+u_int64_t Delegation<ADAPTER>::run(const char *desc, u_int64_t op, ScalingStats& stats) {
+  const unsigned owners = d_spec.owners();
+  const unsigned available = TextScan<T>(d_files.primary()).available();
+
+  // Owners idle means every ring is empty and 'd_results' holds the last phase
+  while (d_idle.load(std::memory_order_acquire)!=owners) {
+    __builtin_ia32_pause();
+  }
+  d_idle.store(0, std::memory_order_relaxed);
+  d_op = op;
+  const unsigned phase = d_phase.load(std::memory_order_relaxed);
+  const unsigned batch = d_spec.batch();
+
+  std::atomic<unsigned> ready(0);
+  std::atomic<u_int64_t> found(0);
+  std::vector<std::thread> clients;
+  std::vector<ScalingResult> results(d_clients);                      // per client: what it did for 'e_REPLY'
+  std::vector<std::unique_ptr<Intel::LatencyRecorder>> latencies;     // per client: round trips for 'e_REPLY'
+
+  for (unsigned i=0; i<d_clients; ++i) {
+    latencies.emplace_back(new Intel::LatencyRecorder(1));
+    clients.emplace_back([&, i]() {
+      const int core = d_config.threadCore(i);
+      Intel::SkyLake::PMU::pinToHWCore(core);
+
+      // Position scanner on first word of this client's part
+      const unsigned begin = static_cast<unsigned>((u_int64_t)available*i/d_clients);
+      const unsigned end = static_cast<unsigned>((u_int64_t)available*(i+1)/d_clients);
+      Slice<T> word;
+      TextScan<T> scanner(d_files.forCore(core));
+      for (unsigned j=0; j<begin; ++j) {
+        scanner.next(word);
+      }
+      std::vector<RingBuffer::Word> pending(batch*owners);  // per owner: words not yet sent
+      std::vector<unsigned> count(owners, 0);
+
+      ++ready;
+      while (d_phase.load(std::memory_order_acquire)==phase) {
+      }
+
+      // Benchmark running: route each word to its shard's owner then tell every owner this client is done
+      if (op==e_REPLY) {
+        ScalingResult& result = results[i];
+        result.d_core = core;
+        timespec_get(&result.d_start, TIME_UTC);
+        found += request(i, begin, end, scanner, *latencies[i]);
+        timespec_get(&result.d_end, TIME_UTC);
+        result.d_iterations = end-begin;
+      } else if (batch==0) {
+        for (unsigned j=begin; j<end; ++j) {
+          scanner.next(word);
+          send(i, d_spec.owner(word.data(), word.size()), RingBuffer::Op(op, word.rawValue()));
+        }
+        for (unsigned j=0; j<owners; ++j) {
+          send(i, j, RingBuffer::Op(e_STOP, 0));
+        }
+      } else {
+        for (unsigned j=begin; j<end; ++j) {
+          scanner.next(word);
+          const unsigned owner = d_spec.owner(word.data(), word.size());
+          RingBuffer::Word *words = pending.data()+owner*batch;
+          words[count[owner]++] = word.rawValue();
+          if (count[owner]==batch) {
+            send(i, owner, words, batch);
+            count[owner] = 0;
+          }
+        }
+        for (unsigned j=0; j<owners; ++j) {
+          // A flushed buffer always has room for the stop word
+          RingBuffer::Word *words = pending.data()+j*batch;
+          words[count[j]++] = 0;
+          send(i, j, words, count[j]);
+        }
+      }
+    });
+  }
+
+  while (ready.load()!=d_clients) {
+  }
+
+  // Latency is sampled in 'rdtsc' cycles: convert with the phase's own ratio of elapsed time to cycles
+  timespec start;
+  timespec_get(&start, TIME_UTC);
+  const u_int64_t startCycles = __rdtsc();
+  d_phase.fetch_add(1, std::memory_order_release);
+
+  for (auto& client: clients) {
+    client.join();
+  }
+  const u_int64_t cycles = __rdtsc()-startCycles;
+  timespec end;
+  timespec_get(&end, TIME_UTC);
+
+  while (d_idle.load(std::memory_order_acquire)!=owners) {
+    __builtin_ia32_pause();
+  }
+
+  if (op==e_REPLY) {
+    for (unsigned i=1; i<d_clients; ++i) {
+      latencies[0]->merge(*latencies[i]);
+    }
+    const double elapsedNs = (double)(end.tv_sec-start.tv_sec)*1000000000.0 + (double)(end.tv_nsec-start.tv_nsec);
+    stats.record(desc, results, *latencies[0], cycles ? elapsedNs/(double)cycles : 0.0);
+  } else {
+    stats.record(desc, d_results);
+  }
+  return found.load();
+}
+
+template<typename ADAPTER>
+void Delegation<ADAPTER>::own(unsigned owner) {
+  ScalingResult& result = d_results[owner];
+  result.d_core = d_config.threadCore(d_clients+owner);
+  Intel::SkyLake::PMU::pinToHWCore(result.d_core);
+
+  const unsigned owners = d_spec.owners();
+  const bool pairs = d_spec.ring()==DelegationSpec::e_SPSC;
+  const bool batched = d_spec.batch()>0;
+  ADAPTER shard(d_config);
+  RingBuffer::Op op;
+  RingBuffer::Word words[DelegationSpec::k_MAX_BATCH];
+  RingBuffer::Word answers[DelegationSpec::k_MAX_BATCH];
+
+  for (unsigned phase = d_phase.load(std::memory_order_relaxed);; ++phase) {
+    d_idle.fetch_add(1, std::memory_order_release);
+    while (d_phase.load(std::memory_order_acquire)==phase) {
+      __builtin_ia32_pause();
+    }
+    if (d_exit.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    timespec_get(&result.d_start, TIME_UTC);
+
+    // Benchmark running: drain each ring in turn until every client said stop
+    u_int64_t iterations(0);
+    if (!batched) {
+      for (unsigned stops=0; stops<d_clients;) {
+        for (unsigned i=0; i<(pairs ? d_clients : 1); ++i) {
+          while (pairs ? d_pairs[i*owners+owner]->read(op) : d_queues[owner]->read(op)) {
+            if (op.d_op==e_STOP) {
+              ++stops;
+              continue;
+            }
+            Slice<T> word(op.d_arg0);
+            if (op.d_op==e_INSERT) {
+              shard.insert(word);
+            } else if (op.d_op==e_FIND) {
+              bool found = shard.find(word);
+              Intel::DoNotOptimize(found);
+            } else {
+              const RingBuffer::Word found = shard.find(word);
+              answer(static_cast<unsigned>(op.d_arg1), owner, &found, 1);
+            }
+            ++iterations;
+          }
+        }
+      }
+    } else {
+      const bool insert = d_op==e_INSERT;
+      const bool reply = d_op==e_REPLY;
+      unsigned client(0);   // sender of the words read: the ring's client or the last tag's on an owner's ring
+      for (unsigned stops=0; stops<d_clients;) {
+        for (unsigned i=0; i<(pairs ? d_clients : 1); ++i) {
+          if (pairs) {
+            client = i;
+          }
+          unsigned count;
+          while ((count = receive(i, owner, words, DelegationSpec::k_MAX_BATCH))>0) {
+            unsigned answered(0);
+            for (unsigned j=0; j<count; ++j) {
+              if (words[j]==0) {
+                ++stops;
+                continue;
+              }
+              if ((words[j]>>48)==0) {
+                // Tag: words up to the next tag come from another client
+                if (answered>0) {
+                  answer(client, owner, answers, answered);
+                  answered = 0;
+                }
+                client = static_cast<unsigned>(words[j]-1);
+                continue;
+              }
+              Slice<T> word(words[j]);
+              if (insert) {
+                shard.insert(word);
+              } else if (reply) {
+                answers[answered++] = shard.find(word);
+              } else {
+                bool found = shard.find(word);
+                Intel::DoNotOptimize(found);
+              }
+              ++iterations;
+            }
+            if (answered>0) {
+              answer(client, owner, answers, answered);
+            }
+          }
+        }
+      }
+    }
+
+    timespec_get(&result.d_end, TIME_UTC);
+    result.d_iterations = iterations;
+
+    if constexpr (ADAPTER::k_STATIC) {
+      // A read-only shard is built from its keys once they are all in, outside the owner's timing
+      if (d_op==e_INSERT) {
+        shard.seal();
+      }
+    }
+  }
+}
+
+template<typename ADAPTER>
+u_int64_t Delegation<ADAPTER>::request(unsigned client, unsigned begin, unsigned end, TextScan<T>& scanner,
+  Intel::LatencyRecorder& latency) {
+  const unsigned owners = d_spec.owners();
+  const unsigned batch = d_spec.batch();
+  const unsigned size = batch ? batch : 1;
+  const bool tagged = batch>0 && d_spec.ring()==DelegationSpec::e_MPSC;
+  std::vector<RingBuffer::Word> pending((size+1)*owners, client+1); // per owner: tag then words not yet sent
+  std::vector<unsigned> count(owners, 0);                           // per owner: words not yet sent
+  std::vector<unsigned> inFlight(owners, 0);                        // per owner: words sent not yet answered
+  std::vector<u_int64_t> sentAt(owners, 0);                         // per owner: 'rdtsc' sending those in flight
+  RingBuffer::Word answers[DelegationSpec::k_MAX_BATCH];
+  u_int64_t found(0);
+
+  // Read every answer already back timing each from its key's send
+  auto collect = [&]() {
+    for (unsigned j=0; j<owners; ++j) {
+      if (inFlight[j]==0) {
+        continue;
+      }
+      const unsigned n = static_cast<unsigned>(d_replies[client*owners+j]->read(answers, inFlight[j]));
+      if (n>0) {
+        const u_int64_t cycles = __rdtsc()-sentAt[j];
+        for (unsigned k=0; k<n; ++k) {
+          found += answers[k];
+          latency.record(cycles);
+        }
+        inFlight[j] -= n;
+      }
+    }
+  };
+
+  // Send what is pending for 'owner' once its last batch is answered
+  auto flush = [&](unsigned owner) {
+    collect();
+    while (inFlight[owner]>0) {
+      __builtin_ia32_pause();
+      collect();
+    }
+    RingBuffer::Word *words = pending.data()+owner*(size+1);
+    sentAt[owner] = __rdtsc();
+    if (batch==0) {
+      send(client, owner, RingBuffer::Op(e_REPLY, words[1], client));
+    } else if (tagged) {
+      sendTagged(owner, words, count[owner]+1);
+    } else {
+      send(client, owner, words+1, count[owner]);
+    }
+    inFlight[owner] = count[owner];
+    count[owner] = 0;
+  };
+
+  Slice<T> word;
+  for (unsigned j=begin; j<end; ++j) {
+    scanner.next(word);
+    // Time answers as they arrive, not when the next batch fills
+    collect();
+    const unsigned owner = d_spec.owner(word.data(), word.size());
+    pending[owner*(size+1) + ++count[owner]] = word.rawValue();
+    if (count[owner]==size) {
+      flush(owner);
+    }
+  }
+  for (unsigned j=0; j<owners; ++j) {
+    if (count[j]>0) {
+      flush(j);
+    }
+  }
+  for (unsigned j=0; j<owners; ++j) {
+    while (inFlight[j]>0) {
+      __builtin_ia32_pause();
+      collect();
+    }
+  }
+
+  // Every answer read: tell every owner this client is done
+  for (unsigned j=0; j<owners; ++j) {
+    if (batch==0) {
+      send(client, j, RingBuffer::Op(e_STOP, 0));
+    } else {
+      const RingBuffer::Word stop(0);
+      send(client, j, &stop, 1);
+    }
+  }
+  return found;
+}
+
+template<typename ADAPTER>
+inline
+void Delegation<ADAPTER>::send(unsigned client, unsigned owner, const RingBuffer::Op& op) {
+  if (d_spec.ring()==DelegationSpec::e_SPSC) {
+    RingBuffer::SPSC& ring = *d_pairs[client*d_spec.owners()+owner];
+    while (!ring.append(op)) {
+      __builtin_ia32_pause();
+    }
+  } else {
+    RingBuffer::MPSC& ring = *d_queues[owner];
+    while (!ring.append(op)) {
+      __builtin_ia32_pause();
+    }
+  }
+}
+
+template<typename ADAPTER>
+inline
+void Delegation<ADAPTER>::send(unsigned client, unsigned owner, const RingBuffer::Word *words, unsigned count) {
+  while (count>0) {
+    const unsigned sent = d_spec.ring()==DelegationSpec::e_SPSC
+      ? d_wordPairs[client*d_spec.owners()+owner]->append(words, count)
+      : d_wordQueues[owner]->append(words, count);
+    if (sent==0) {
+      __builtin_ia32_pause();
+    }
+    words += sent;
+    count -= sent;
+  }
+}
+
+template<typename ADAPTER>
+inline
+unsigned Delegation<ADAPTER>::receive(unsigned client, unsigned owner, RingBuffer::Word *words, unsigned count) {
+  return d_spec.ring()==DelegationSpec::e_SPSC
+    ? d_wordPairs[client*d_spec.owners()+owner]->read(words, count)
+    : d_wordQueues[owner]->read(words, count);
+}
+
+template<typename ADAPTER>
+inline
+void Delegation<ADAPTER>::sendTagged(unsigned owner, RingBuffer::Word *words, unsigned count) {
+  const RingBuffer::Word tag = words[0];
+  RingBuffer::WordMPSC& ring = *d_wordQueues[owner];
+  for (;;) {
+    const unsigned sent = static_cast<unsigned>(ring.append(words, count));
+    if (sent==count) {
+      return;
+    }
+    if (sent==0) {
+      __builtin_ia32_pause();
+      continue;
+    }
+    // Other clients' words may come between this append and the next: tag the rest again over the last word sent
+    words += sent-1;
+    count -= sent-1;
+    words[0] = tag;
+  }
+}
+
+template<typename ADAPTER>
+inline
+void Delegation<ADAPTER>::answer(unsigned client, unsigned owner, const RingBuffer::Word *words, unsigned count) {
+  RingBuffer::WordSPSC& ring = *d_replies[client*d_spec.owners()+owner];
+  while (count>0) {
+    const unsigned sent = static_cast<unsigned>(ring.append(words, count));
+    if (sent==0) {
+      __builtin_ia32_pause();
+    }
+    words += sent;
+    count -= sent;
+  }
+}
+
+} // namespace Benchmark
@@ -0,0 +1 @@
+#include <benchmark_driver.h>
@@ -0,0 +1,318 @@
+#pragma once
+
+// PURPOSE: Run every configured benchmark phase on one data structure through its adapters
+//
+// CLASSES:
+//  Benchmark::Driver:   Report which runs 'Benchmark::Phase' loops on fresh adapter instances each run
+//  Benchmark::Dispatch: Instantiate adapters over every hash and allocator choice and pick one per 'Config'
+
+#include <benchmark_adapter.h>
+#include <benchmark_config.h>
+#include <benchmark_hashable_keys.h>
+#include <benchmark_hashmemo.h>
+#include <benchmark_phase.h>
+#include <benchmark_report.h>
+
+#include <intel_skylake_pmu.h>
+
+#include <iostream>
+#include <string>
+
+#include <stdio.h>
+
+namespace Benchmark {
+
+template<typename ADAPTER, typename KV_ADAPTER>
+class Driver: public Report {
+  // 'ADAPTER' is used for 'bin-text' and 'KV_ADAPTER' for 'bin-text-kv'. Both are constructed anew for each run so
+  // no run sees state left behind by another.
+
+public:
+  // CREATORS
+  Driver(const Config& config, const std::string& description);
+    // Create Driver benchmark object with specified 'config, description'
+
+  virtual ~Driver() = default;
+    // Destroy this object
+
+  // ACCESSORS
+  virtual bool supportsScan() const;
+    // Return true if 'ADAPTER' can scan and false otherwise
+
+  // MANIPULATORS
+  virtual int start();
+    // Return 0 if all benchmarks were run and non-zero otherwise. Note a non-zero code usually indicates
+    // bad configuration.
+
+  // STATIC FUNCTIONS
+  static int run(const Config& config, const std::string& description);
+    // Return 0 after running then reporting all benchmarks per specified 'config' titled by specified
+    // 'description', and non-zero otherwise
+};
+
+struct Dispatch {
+  // STATIC FUNCTIONS
+  template<template<typename HASH, typename ALLOCATOR, typename VALUE> class ADAPTER>
+  static int hashed(const Config& config, const std::string& description);
+    // Return 'Driver<ADAPTER<HASH, ALLOCATOR, bool>, ADAPTER<HASH, ALLOCATOR, ALLOCATOR::String>>::run' where
+    // 'HASH' is picked by 'config.d_hashAlgo' and 'ALLOCATOR' by 'config.d_customAllocator'. 'config.d_hashMemo'
+    // wraps 'HASH' in 'char_slice_memo'. All twelve combinations are compiled so each runs the same fully inlined
+    // loops.
+
+  template<template<typename HASH, typename ALLOCATOR, typename VALUE> class ADAPTER, typename HASH,
+    typename ALLOCATOR>
+  static int hashedWith(const Config& config, const std::string& description);
+    // Return 'hashed' for specified 'HASH' and 'ALLOCATOR' already picked
+
+  template<typename ADAPTER, typename KV_ADAPTER>
+  static int plain(const Config& config, const std::string& description);
+    // Return 'Driver<ADAPTER, KV_ADAPTER>::run' for a data structure which comes with its own allocator and hashing
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+template<typename ADAPTER, typename KV_ADAPTER>
+inline
+Driver<ADAPTER, KV_ADAPTER>::Driver(const Config& config, const std::string& description)
+: Report(config, description)
+{
+}
+
+// ACCESSORS
+template<typename ADAPTER, typename KV_ADAPTER>
+inline
+bool Driver<ADAPTER, KV_ADAPTER>::supportsScan() const {
+  return ADAPTER::k_CAN_SCAN;
+}
+
+// MANIPULATORS
+template<typename ADAPTER, typename KV_ADAPTER>
+int Driver<ADAPTER, KV_ADAPTER>::start() {
+  // Default start is to load file
+  int rc = Report::start();
+  if (rc!=0) {
+    return rc;
+  }
+
+  if (d_config.d_customAllocator && !ADAPTER::k_ALLOCATOR) {
+    printf("note: %s comes with its own allocator; '-a %s' not supported\n", d_description.c_str(),
+      d_config.d_allocator.c_str());
+    return rc;
+  }
+
+  // Every structure runs its single threaded phases on the same core
+  Intel::SkyLake::PMU::pinToHWCore(d_config.d_cpu0);
+
+  if (d_config.d_format == "bin-text-kv") {
+    if (!KV_ADAPTER::k_VALUES) {
+      printf("note: %s stores keys only; values in '%s' are not inserted\n", d_description.c_str(),
+        d_config.d_filename.c_str());
+    }
+    for (unsigned i=0; i<d_config.d_runs; ++i) {
+      if (d_config.d_verbosity>0) {
+        printf("execute run set %u...\n", i);
+      }
+      KV_ADAPTER adapter(d_config);
+      Phase::kvInsert(i, adapter, d_insertStats, d_file);
+      if constexpr (KV_ADAPTER::k_STATIC) {
+        rc |= Phase::seal(i, adapter);
+      }
+      Phase::kvFind(i, adapter, d_findStats, d_file);
+      if constexpr (KV_ADAPTER::k_VALUES) {
+        Phase::kvUpdate(i, adapter, d_updateStats, d_file);
+      }
+      rusage(std::cout);
+    }
+  } else if (d_config.d_format=="bin-text") {
+    if (d_eraseCount && !ADAPTER::k_CAN_ERASE) {
+      printf("note: %s cannot erase; '-e %s' not supported\n", d_description.c_str(), d_config.d_erase.c_str());
+    }
+    if (d_config.d_findBatch && (d_config.d_threads || !d_config.d_workload.empty())) {
+      printf("note: '-B' batches the single threaded find phase only; ignored with '-t' or '-w'\n");
+    } else if (d_config.d_findBatch && !ADAPTER::k_FIND_BATCH) {
+      printf("note: %s has no batched find; '-B %u' finds one key after another\n", d_description.c_str(),
+        d_config.d_findBatch);
+    }
+    if (!d_scanLengths.empty() && !ADAPTER::k_CAN_SCAN) {
+      printf("note: %s cannot scan; '-s %s' not supported\n", d_description.c_str(),
+        d_config.d_scanLengths.c_str());
+    } else if (!d_scanLengths.empty() && !d_config.d_workload.empty()) {
+      printf("note: '-s' runs after find; ignored with '-w'\n");
+    }
+    if (d_config.d_writers && !ADAPTER::k_MT_INSERT) {
+      printf("note: %s has no thread-safe insert; '-W %u' not supported\n", d_description.c_str(),
+        d_config.d_writers);
+    }
+    if (d_config.d_compact && !ADAPTER::k_CAN_COMPACT) {
+      printf("note: %s cannot compact; '-c' not supported\n", d_description.c_str());
+    } else if (d_config.d_compact && (d_config.d_threads || !d_config.d_workload.empty())) {
+      printf("note: '-c' runs with single threaded phases only; ignored with '-t' or '-w'\n");
+    }
+    if (!d_config.d_workload.empty() && ADAPTER::k_STATIC) {
+      printf("note: %s finds keys only once all are inserted; '-w %s' not supported\n", d_description.c_str(),
+        d_config.d_workload.c_str());
+    }
+    for (unsigned i=0; i<d_config.d_runs; ++i) {
+      if (d_config.d_verbosity>0) {
+        printf("execute run set %u...\n", i);
+      }
+      if (d_config.d_hashMemo) {
+        // Each hash alone over the same keys: what memoizing takes out of the hashmap's phases
+        Phase::hash<char_slice_xxhash_xx3_64bits>(i, d_xxhashStats, d_file, "xxhash:XX3_64bits");
+        Phase::hash<char_slice_t1ha>(i, d_t1haStats, d_file, "t1ha::t1ha");
+        Phase::hash<char_slice_city_cityhash64>(i, d_cityStats, d_file, "city::cityhash64");
+      }
+      ADAPTER adapter(d_config);
+      if (!d_config.d_workload.empty()) {
+        if constexpr (!ADAPTER::k_STATIC) {
+          Phase::workload(i, adapter, d_workload, d_workloadStats);
+        }
+      } else if (d_config.d_threads) {
+        adapter.threads(d_config.d_threads);
+        if constexpr (ADAPTER::k_MT_INSERT) {
+          Phase::insertMT(i, adapter, d_insertScaling, d_config, d_replicas);
+        } else {
+          Phase::insert(i, adapter, d_insertStats, d_file);
+        }
+        if constexpr (ADAPTER::k_STATIC) {
+          rc |= Phase::seal(i, adapter);
+        }
+        Phase::findMT(i, adapter, d_findScaling, d_config, d_replicas);
+        if (!d_missKeys.empty()) {
+          Phase::miss(i, adapter, d_missStats, d_missKeys);
+        }
+        if constexpr (ADAPTER::k_CAN_SCAN) {
+          for (unsigned j=0; j<d_scanLengths.size(); ++j) {
+            Phase::scan(i, adapter, d_scanStats[j], d_scanIndex, d_scanCounts[j], d_scanLengths[j]);
+          }
+        }
+        if constexpr (ADAPTER::k_CAN_ERASE) {
+          if (d_eraseCount) {
+            Phase::erase(i, adapter, d_eraseStats, d_eraseIndex, d_eraseCount);
+            Phase::reinsert(i, adapter, d_reinsertStats, d_eraseIndex, d_eraseCount);
+          }
+        }
+        if constexpr (ADAPTER::k_MT_INSERT) {
+          if (d_config.d_writers) {
+            // Empty structure so every insert adds a key while finds run
+            ADAPTER mixed(d_config);
+            mixed.threads(d_config.d_threads);
+            Phase::mixedMT(i, mixed, d_mixedInsertScaling, d_mixedFindScaling, d_config, d_replicas);
+          }
+        }
+        if (!d_delegation.empty()) {
+          // Owners build their own shards so nothing above is reused
+          Delegation<ADAPTER> delegation(d_config, d_delegation, d_replicas);
+          Phase::delegate(i, delegation, d_delegatedInsertScaling, d_delegatedFindScaling,
+            d_delegatedRoundTripScaling);
+        }
+      } else {
+        Phase::insert(i, adapter, d_insertStats, d_file);
+        if constexpr (ADAPTER::k_STATIC) {
+          rc |= Phase::seal(i, adapter);
+        }
+        if (d_config.d_findBatch && d_keyIndex.empty()) {
+          Phase::findBatch(i, adapter, d_findStats, d_file, d_config.d_findBatch);
+        } else if (d_config.d_findBatch) {
+          Phase::findBatch(i, adapter, d_findStats, d_keyIndex, d_config.d_findBatch);
+        } else if (d_keyIndex.empty()) {
+          Phase::find(i, adapter, d_findStats, d_file);
+        } else {
+          Phase::find(i, adapter, d_findStats, d_keyIndex);
+        }
+        if (!d_missKeys.empty()) {
+          Phase::miss(i, adapter, d_missStats, d_missKeys);
+        }
+        if constexpr (ADAPTER::k_CAN_SCAN) {
+          for (unsigned j=0; j<d_scanLengths.size(); ++j) {
+            Phase::scan(i, adapter, d_scanStats[j], d_scanIndex, d_scanCounts[j], d_scanLengths[j]);
+          }
+        }
+        if constexpr (ADAPTER::k_CAN_ERASE) {
+          if (d_eraseCount) {
+            Phase::erase(i, adapter, d_eraseStats, d_eraseIndex, d_eraseCount);
+            Phase::reinsert(i, adapter, d_reinsertStats, d_eraseIndex, d_eraseCount);
+          }
+        }
+        if constexpr (ADAPTER::k_CAN_COMPACT) {
+          if (d_config.d_compact) {
+            // Same keys in the same order either side so only memory layout differs
+            if (d_keyIndex.empty()) {
+              Phase::find(i, adapter, d_findBeforeCompactStats, d_file);
+              rc |= Phase::compact(i, adapter);
+              Phase::find(i, adapter, d_findAfterCompactStats, d_file);
+            } else {
+              Phase::find(i, adapter, d_findBeforeCompactStats, d_keyIndex);
+              rc |= Phase::compact(i, adapter);
+              Phase::find(i, adapter, d_findAfterCompactStats, d_keyIndex);
+            }
+          }
+        }
+      }
+      if (d_config.d_verbosity>1) {
+        printf("size: %lu memoryBytes: %lu\n", adapter.size(), adapter.memory());
+      }
+      rusage(std::cout);
+    }
+  }
+
+  return rc;
+}
+
+// STATIC FUNCTIONS
+template<typename ADAPTER, typename KV_ADAPTER>
+int Driver<ADAPTER, KV_ADAPTER>::run(const Config& config, const std::string& description) {
+  Driver<ADAPTER, KV_ADAPTER> test(config, description);
+  int rc = test.start();
+  test.report();
+  return rc;
+}
+
+template<template<typename HASH, typename ALLOCATOR, typename VALUE> class ADAPTER>
+int Dispatch::hashed(const Config& config, const std::string& description) {
+  typedef char_slice_xxhash_xx3_64bits XXHash;
+  typedef char_slice_t1ha T1ha;
+  typedef char_slice_city_cityhash64 City;
+
+  if (config.d_customAllocator) {
+    if (config.d_hashAlgo=="xxhash:XX3_64bits") {
+      return hashedWith<ADAPTER, XXHash, MIMAllocator>(config, description);
+    } else if (config.d_hashAlgo=="t1ha::t1ha") {
+      return hashedWith<ADAPTER, T1ha, MIMAllocator>(config, description);
+    } else if (config.d_hashAlgo=="city::cityhash64") {
+      return hashedWith<ADAPTER, City, MIMAllocator>(config, description);
+    }
+  } else {
+    if (config.d_hashAlgo=="xxhash:XX3_64bits") {
+      return hashedWith<ADAPTER, XXHash, StdAllocator>(config, description);
+    } else if (config.d_hashAlgo=="t1ha::t1ha") {
+      return hashedWith<ADAPTER, T1ha, StdAllocator>(config, description);
+    } else if (config.d_hashAlgo=="city::cityhash64") {
+      return hashedWith<ADAPTER, City, StdAllocator>(config, description);
+    }
+  }
+
+  printf("error: unknown hash algorithm '%s'\n", config.d_hashAlgo.c_str());
+  return 1;
+}
+
+template<template<typename HASH, typename ALLOCATOR, typename VALUE> class ADAPTER, typename HASH,
+  typename ALLOCATOR>
+int Dispatch::hashedWith(const Config& config, const std::string& description) {
+  typedef char_slice_memo<HASH> Memo;
+
+  if (config.d_hashMemo) {
+    return Driver<ADAPTER<Memo, ALLOCATOR, bool>,
+      ADAPTER<Memo, ALLOCATOR, typename ALLOCATOR::String>>::run(config, description);
+  }
+  return Driver<ADAPTER<HASH, ALLOCATOR, bool>,
+    ADAPTER<HASH, ALLOCATOR, typename ALLOCATOR::String>>::run(config, description);
+}
+
+template<typename ADAPTER, typename KV_ADAPTER>
+inline
+int Dispatch::plain(const Config& config, const std::string& description) {
+  return Driver<ADAPTER, KV_ADAPTER>::run(config, description);
+}
+
+} // namespace Benchmark
@@ -0,0 +1,158 @@
+#include <benchmark_eytzinger.h>
+#include <benchmark_adapter.h>
+#include <benchmark_driver.h>
+#include <benchmark_kvrecord.h>
+
+#include <eytzinger_index.h>
+
+#include <intel_skylake_pmu.h>
+
+#include <vector>
+
+#include <assert.h>
+
+namespace {
+
+class EytzingerAdapter: public Benchmark::AdapterBase<EytzingerAdapter> {
+  // Read-only sorted array of the keys themselves in Eytzinger order: what a trie costs over an ideal static index
+
+  // DATA
+  Eytzinger::Index d_index;
+
+public:
+  // TYPES
+  typedef unsigned char KeyType;
+
+  // ENUMS
+  enum {
+    k_CAN_SCAN    = 1,
+    k_FIND_BATCH  = 1,    // descend lookups in lock step prefetching each one's next levels
+    k_STATIC      = 1,
+  };
+
+  // CREATORS
+  explicit EytzingerAdapter(const Benchmark::Config&) {
+  }
+
+  // ACCESSORS
+  size_t size() const {
+    return d_index.size();
+  }
+
+  size_t memory() const {
+    return d_index.memory();
+  }
+
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<unsigned char>& key) {
+    // Staged until 'seal' which drops duplicates
+    d_index.add(key);
+    return true;
+  }
+
+  bool find(Benchmark::Slice<unsigned char>& key) {
+    return d_index.find(key)==Eytzinger::e_EXISTS;
+  }
+
+  bool update(Benchmark::Slice<unsigned char>& key) {
+    // Keys only: a key held is unchanged by update and one not held is staged
+    if (d_index.find(key)!=Eytzinger::e_EXISTS) {
+      d_index.add(key);
+    }
+    return true;
+  }
+
+  unsigned scan(Benchmark::Slice<unsigned char>& key, unsigned length) {
+    auto visitor = [](const u_int8_t *word, u_int16_t size) {
+      Intel::DoNotOptimize(word);
+      Intel::DoNotOptimize(size);
+    };
+    return static_cast<unsigned>(d_index.scan(key, length, visitor));
+  }
+
+  void findBatch(Benchmark::Slice<unsigned char> *keys, bool *results, unsigned count) {
+    int rc[Benchmark::Config::k_MAX_FIND_BATCH];
+    assert(count<=Benchmark::Config::k_MAX_FIND_BATCH);
+    d_index.findBatch(keys, rc, count);
+    for (unsigned i=0; i<count; ++i) {
+      results[i] = rc[i]==Eytzinger::e_EXISTS;
+    }
+  }
+
+  bool seal() {
+    d_index.build();
+    return true;
+  }
+};
+
+class EytzingerKVAdapter: public Benchmark::AdapterBase<EytzingerKVAdapter> {
+  // Read-only sorted array in Eytzinger order of the keys inside heap copies of their pairs
+
+  // DATA
+  Eytzinger::Index d_index;
+
+public:
+  // TYPES
+  typedef unsigned char KeyType;
+
+  // ENUMS
+  enum {
+    k_VALUES = 1,
+    k_STATIC = 1,
+  };
+
+  // CREATORS
+  explicit EytzingerKVAdapter(const Benchmark::Config&) {
+  }
+
+  ~EytzingerKVAdapter() {
+    std::vector<Benchmark::UKey> keys;
+    d_index.allKeys(keys);
+    for (auto key: keys) {
+      Benchmark::KVRecord::destroy(Benchmark::KVRecord::fromKey(key));
+    }
+  }
+
+  // ACCESSORS
+  size_t size() const {
+    return d_index.size();
+  }
+
+  size_t memory() const {
+    return d_index.memory();
+  }
+
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<unsigned char>& key, Benchmark::Slice<unsigned char>& value) {
+    d_index.add(Benchmark::KVRecord::key<unsigned char>(Benchmark::KVRecord::create(key, value)));
+    return true;
+  }
+
+  bool find(Benchmark::Slice<unsigned char>& key, Benchmark::Slice<unsigned char>& value) {
+    Benchmark::Slice<unsigned char> held;
+    return d_index.find(key, &held)==Eytzinger::e_EXISTS &&
+           Benchmark::KVRecord::equal(Benchmark::KVRecord::fromKey(held), value);
+  }
+
+  bool update(Benchmark::Slice<unsigned char>& key, Benchmark::Slice<unsigned char>& value) {
+    Benchmark::Slice<unsigned char> held;
+    return d_index.find(key, &held)==Eytzinger::e_EXISTS &&
+           Benchmark::KVRecord::assign(Benchmark::KVRecord::fromKey(held), value);
+  }
+
+  bool seal() {
+    // The first pair inserted for a key is kept as if later ones failed to insert
+    std::vector<Benchmark::UKey> dropped;
+    d_index.build(&dropped);
+    for (auto key: dropped) {
+      Benchmark::KVRecord::destroy(Benchmark::KVRecord::fromKey(key));
+    }
+    return true;
+  }
+};
+
+} // anonymous namespace
+
+int Benchmark::eytzinger::run(const Config& config, const std::string& description) {
+  return Dispatch::plain<EytzingerAdapter, EytzingerKVAdapter>(config, description);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <benchmark_config.h>
+
+#include <string>
+
+namespace Benchmark {
+
+struct eytzinger {
+  // STATIC FUNCTIONS
+  static int run(const Config& config, const std::string& description);
+    // Return 0 if all benchmarks per specified 'config' were run then reported under specified 'description' and
+    // non-zero otherwise. Note a non-zero code usually indicates bad configuration.
+};
+
+} // namespace Benchmark
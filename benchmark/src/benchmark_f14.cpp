@@ -1,195 +1,108 @@
 #include <benchmark_f14.h>
+#include <benchmark_adapter.h>
+#include <benchmark_driver.h>
 #include <benchmark_hashable_keys.h>
-#include <benchmark_textscan.h>
 
-#include <intel_skylake_pmu.h>
+#include <F14Map.h>
 
-#include <mimalloc.h>
+#include <type_traits>
 
-#include <F14Map.h>
+#include <assert.h>
+#include <string.h>
+
+namespace {
+
+template<typename HASH, typename ALLOCATOR, typename VALUE>
+class FacebookF14Adapter: public Benchmark::AdapterBase<FacebookF14Adapter<HASH, ALLOCATOR, VALUE>> {
+  // FacebookF14 hash map Key=Slice<char> hashed by 'HASH' on 'ALLOCATOR'. 'VALUE' is 'bool' for 'bin-text' where
+  // every key holds a constant, and 'ALLOCATOR::String' for 'bin-text-kv' where every key holds a copy of its value.
+
+  // TYPES
+  typedef folly::F14ValueMap<Benchmark::Slice<char>, VALUE, HASH, Benchmark::SliceEqual<Benchmark::Slice<char>>,
+    typename ALLOCATOR::template Type<std::pair<const Benchmark::Slice<char>, VALUE>>> Map;
+
+  // DATA
+  Map d_map;
 
-// +--------------------------------------------+----------------------------------------------------------------------------+
-// | Typedef                                    | Comment                                                                    |
-// +--------------------------------------------+----------------------------------------------------------------------------+
-// | FacebookF14XXhash_SliceBool_XX3_64BITS     | FacebookF14 hash map Key=Slice<char>, Value=bool on std::allocator         |
-// |                                            | using xxhash variant XX3_64BITS                                            |
-// +--------------------------------------------+----------------------------------------------------------------------------+
-// | FacebookF14XXhash_MIM_SliceBool_XX3_64BITS | FacebookF14 hash map Key=Slice<char>, Value=bool on Microsoft MIM allocator|
-// |                                            | using xxhash variant XX3_64BITS                                            |
-// +--------------------------------------------+----------------------------------------------------------------------------+
-// | FacebookF14T1ha_SliceBool                  | FacebookF14 hash map Key=Slice<char>, Value=bool on std::allocator         |
-// |                                            | using hash t1ha variant t1ha()                                             |
-// +--------------------------------------------+----------------------------------------------------------------------------+
-// | FacebookF14T1ha_MIM_SliceBool              | FacebookF14 hash map Key=Slice<char>, Value=bool on Microsoft MIM allocator|
-// |                                            | using hash t1ha variant t1ha()                                             |
-// +--------------------------------------------+----------------------------------------------------------------------------+
-// | FacebookF14City_SliceBool_CityHash64       | FacebookF14 hash map Key=Slice<char>, Value=bool on std::allocator         |
-// |                                            | using hash city variant CityHash64()                                       |
-// +--------------------------------------------+----------------------------------------------------------------------------+
-// | FacebookF14City_MIM_SliceBool_CityHash64   | FacebookF14 hash map Key=Slice<char>, Value=bool on Microsoft MIM allocator|
-// |                                            | using hash city variant CityHash64()                                       |
-// +--------------------------------------------+----------------------------------------------------------------------------+
-
-typedef folly::F14ValueMap<Benchmark::Slice<char>, bool, Benchmark::char_slice_xxhash_xx3_64bits,
-  Benchmark::SliceEqual<Benchmark::Slice<char>>> FacebookF14XXhash_SliceBool_XX3_64BITS;
-typedef folly::F14ValueMap<Benchmark::Slice<char>, bool, Benchmark::char_slice_xxhash_xx3_64bits,
-  Benchmark::SliceEqual<Benchmark::Slice<char>>, mi_stl_allocator<std::pair<const Benchmark::Slice<char>,bool>>> FacebookF14XXhash_MIM_SliceBool_XX3_64BITS;
-
-typedef folly::F14ValueMap<Benchmark::Slice<char>, bool, Benchmark::char_slice_t1ha,
-  Benchmark::SliceEqual<Benchmark::Slice<char>>> FacebookF14T1ha_SliceBool;
-typedef folly::F14ValueMap<Benchmark::Slice<char>, bool, Benchmark::char_slice_t1ha,
-  Benchmark::SliceEqual<Benchmark::Slice<char>>, mi_stl_allocator<std::pair<const Benchmark::Slice<char>,bool>>> FacebookF14T1ha_MIM_SliceBool;
-
-typedef folly::F14ValueMap<Benchmark::Slice<char>, bool, Benchmark::char_slice_city_cityhash64,
-  Benchmark::SliceEqual<Benchmark::Slice<char>>> FacebookF14City_SliceBool_CityHash64;
-typedef folly::F14ValueMap<Benchmark::Slice<char>, bool, Benchmark::char_slice_city_cityhash64,
-  Benchmark::SliceEqual<Benchmark::Slice<char>>, mi_stl_allocator<std::pair<const Benchmark::Slice<char>,bool>>> FacebookF14City_MIM_SliceBool_CityHash64;
-
-template<typename T>
-static int f14_test_text_insert(unsigned runNumber, T& map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  char label[128];
-  snprintf(label, sizeof(label), "insert run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-
-  // Benchmark running: do insert
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    map.insert(std::pair(word, false));
+public:
+  // TYPES
+  typedef char KeyType;
+
+  // ENUMS
+  enum {
+    k_VALUES     = !std::is_same<VALUE, bool>::value,
+    k_CAN_ERASE  = 1,
+    k_FIND_BATCH = 1,   // prehash then prefetch every key's chunk before probing
+    k_ALLOCATOR  = 1,
+  };
+
+  // CREATORS
+  explicit FacebookF14Adapter(const Benchmark::Config&) {
   }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  // ACCESSORS
+  size_t size() const {
+    return d_map.size();
+  }
 
-  return 0;
-}
+  size_t memory() const {
+    return d_map.getAllocatedMemorySize();
+  }
 
-template<typename T>
-static int f14_test_text_find(unsigned runNumber, T& map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  char label[128];
-  snprintf(label, sizeof(label), "find run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-
-  // Benchmark running: do find
-  u_int32_t errors(0);
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    if (map.find(word)==map.end()) {
-      ++errors;
-    }
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<char>& key) {
+    return d_map.insert(std::pair(key, false)).second;
   }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  bool find(Benchmark::Slice<char>& key) {
+    return d_map.find(key)!=d_map.end();
+  }
 
-  if (errors) {
-      printf("search errors: %u\n", errors);
+  bool update(Benchmark::Slice<char>& key) {
+    d_map.insert_or_assign(key, true);
+    return true;
   }
 
-  return 0;
-}
+  void findBatch(Benchmark::Slice<char> *keys, bool *results, unsigned count) {
+    // 'prehash' runs 'HASH' and prefetches the first cache line of the key's chunk. 'prefetch' adds the chunk's
+    // other lines. Every line is requested before the first probe waits on one
+    folly::F14HashToken tokens[Benchmark::Config::k_MAX_FIND_BATCH];
+    assert(count<=Benchmark::Config::k_MAX_FIND_BATCH);
+    for (unsigned i=0; i<count; ++i) {
+      tokens[i] = d_map.prehash(keys[i]);
+      d_map.prefetch(tokens[i]);
+    }
+    for (unsigned i=0; i<count; ++i) {
+      results[i] = d_map.find(tokens[i], keys[i])!=d_map.end();
+    }
+  }
 
-int Benchmark::FacebookF14::start() {
-  // Default start is to load file                                                                                      
-  int rc = Benchmark::Report::start();                                                                                  
-  if (rc!=0) {                                                                                                          
-    return rc;                                                                                                          
+  bool erase(Benchmark::Slice<char>& key) {
+    return d_map.erase(key)>0;
   }
 
-  if (d_config.d_format == "bin-text-kv") {
-    // We have KV pairs to play with
-    // Not implemented yet
-    return rc;
-  } else if (d_config.d_format=="bin-text") {
-    // We have a text file therefore we can only benchamrk key ins/upd/fnd/del on keys.
-    // Make a cuckoo map with the smallest possible value type (bool) and set it to a 
-    // constant value throughout all tests.
-    if (d_config.d_customAllocator) {
-      if (d_config.d_hashAlgo=="xxhash:XX3_64bits") {
-        // MIM alloc + xxhash
-        for (unsigned i=0; i<d_config.d_runs; ++i) {
-          if (d_config.d_verbosity>0) {
-            printf("execute run set %u...\n", i);
-          }
-          FacebookF14XXhash_MIM_SliceBool_XX3_64BITS map;
-          f14_test_text_insert(i, map, d_insertStats, d_file);
-          f14_test_text_find(i, map, d_findStats, d_file);
-          rusage(std::cout);
-        }
-      } else if (d_config.d_hashAlgo=="t1ha::t1ha") {
-        // MIM alloc + t1ha
-        for (unsigned i=0; i<d_config.d_runs; ++i) {
-          if (d_config.d_verbosity>0) {
-            printf("execute run set %u...\n", i);
-          }
-          FacebookF14T1ha_MIM_SliceBool map;
-          f14_test_text_insert(i, map, d_insertStats, d_file);
-          f14_test_text_find(i, map, d_findStats, d_file);
-          rusage(std::cout);
-        }
-      } else if (d_config.d_hashAlgo=="city::cityhash64") {
-        // MIM alloc + cityhash64
-        for (unsigned i=0; i<d_config.d_runs; ++i) {
-          if (d_config.d_verbosity>0) {
-            printf("execute run set %u...\n", i);
-          }
-          FacebookF14City_MIM_SliceBool_CityHash64 map;
-          f14_test_text_insert(i, map, d_insertStats, d_file);
-          f14_test_text_find(i, map, d_findStats, d_file);
-          rusage(std::cout);
-        }
-      }
-    } else {
-      if (d_config.d_hashAlgo=="xxhash:XX3_64bits") {
-        // std alloc + xxhash
-        for (unsigned i=0; i<d_config.d_runs; ++i) {
-          if (d_config.d_verbosity>0) {
-            printf("execute run set %u...\n", i);
-          }
-          FacebookF14XXhash_SliceBool_XX3_64BITS map;
-          f14_test_text_insert(i, map, d_insertStats, d_file);
-          f14_test_text_find(i, map, d_findStats, d_file);
-          rusage(std::cout);
-        }
-      } else if (d_config.d_hashAlgo=="t1ha::t1ha") {
-        // std alloc + t1ha
-        for (unsigned i=0; i<d_config.d_runs; ++i) {
-          if (d_config.d_verbosity>0) {
-            printf("execute run set %u...\n", i);
-          }
-          FacebookF14T1ha_SliceBool map;
-          f14_test_text_insert(i, map, d_insertStats, d_file);
-          f14_test_text_find(i, map, d_findStats, d_file);
-          rusage(std::cout);
-        }
-      } else if (d_config.d_hashAlgo=="city::cityhash64") {
-        // std alloc + cityhash64
-        for (unsigned i=0; i<d_config.d_runs; ++i) {
-          if (d_config.d_verbosity>0) {
-            printf("execute run set %u...\n", i);
-          }
-          FacebookF14City_SliceBool_CityHash64 map;
-          f14_test_text_insert(i, map, d_insertStats, d_file);
-          f14_test_text_find(i, map, d_findStats, d_file);
-          rusage(std::cout);
-        }
-      }
+  bool insert(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    return d_map.try_emplace(key, value.data(), value.size()).second;
+  }
+
+  bool find(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    auto iter = d_map.find(key);
+    return iter!=d_map.end() && iter->second.size()==value.size() &&
+           0==memcmp(iter->second.data(), value.data(), value.size());
+  }
+
+  bool update(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    auto iter = d_map.find(key);
+    if (iter==d_map.end()) {
+      return false;
     }
+    iter->second.assign(value.data(), value.size());
+    return true;
   }
-  return rc;
+};
+
+} // anonymous namespace
+
+int Benchmark::FacebookF14::run(const Config& config, const std::string& description) {
+  return Dispatch::hashed<FacebookF14Adapter>(config, description);
 }
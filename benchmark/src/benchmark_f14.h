@@ -7,25 +7,17 @@
 //                          https://github.com/facebook/folly/blob/main/folly/container/F14.md
 //                          https://news.ycombinator.com/item?id=19759630
 
-#include <benchmark_report.h>
+#include <benchmark_config.h>
 
-namespace Benchmark {
+#include <string>
 
-class FacebookF14: public Report {
-public:
-  // CREATORS                                                                                                           
-  FacebookF14(const Config& config, const std::string& description)                                     
-  : Report(config, description)                                                                                   
-  {                                                                                                                     
-  }                                                                                                                     
-                                                                                                                        
-  virtual ~FacebookF14() = default;                                                                                                   
-    // Destory this object 
+namespace Benchmark {
 
-  // MANIPULATORS
-  int start();
-    // Return 0 if all benchmarks were run and non-zero otherwise. Note a non-zero code usually indicates
-    // bad configuration.
+struct FacebookF14 {
+  // STATIC FUNCTIONS
+  static int run(const Config& config, const std::string& description);
+    // Return 0 if all benchmarks per specified 'config' were run then reported under specified 'description' and
+    // non-zero otherwise. Note a non-zero code usually indicates bad configuration.
 };
 
 } // namespace Benchmark
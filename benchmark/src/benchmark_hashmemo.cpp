@@ -0,0 +1,37 @@
+#include <benchmark_hashmemo.h>
+#include <benchmark_numa.h>
+
+const Benchmark::HashMemo *Benchmark::HashMemo::d_installed = 0;
+
+int Benchmark::HashMemo::allocate(const LoadFile& file, u_int64_t minSize, int node) {
+  assert(d_hashes==0);
+
+  d_shift = 0;
+  while ((2UL<<d_shift)<=sizeof(unsigned int)+minSize) {
+    ++d_shift;
+  }
+
+  const u_int64_t count = (file.fileSize()>>d_shift)+1;
+  void *data(0);
+  int rc = Numa::allocateHuge(count*sizeof(u_int64_t), node, &data, &d_mapped);
+  if (rc!=0) {
+    return rc;
+  }
+  d_hashes = static_cast<u_int64_t*>(data);
+  d_begin = file.data();
+  d_end = file.data()+file.fileSize();
+
+  return 0;
+}
+
+void Benchmark::HashMemo::free() {
+  if (d_hashes) {
+    Numa::freeHuge(d_hashes, d_mapped);
+  }
+  d_hashes = 0;
+  d_mapped = 0;
+  d_size = 0;
+  d_begin = 0;
+  d_end = 0;
+  d_shift = 0;
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+// PURPOSE: Hashes of every loaded key computed once before any phase is timed
+//
+// CLASSES:
+//  Benchmark::HashMemo:        Huge-page array holding the hash of each key of a loaded 'bin-text' file found by the
+//                              key's address in the file
+//  Benchmark::char_slice_memo: Hash functor returning the installed 'HashMemo' hash of a key, or 'HASH' of it if the
+//                              key is not in the memoized file
+
+#include <benchmark_loadfile.h>
+#include <benchmark_slice.h>
+#include <benchmark_textscan.h>
+
+#include <assert.h>
+#include <sys/types.h>
+
+namespace Benchmark {
+
+class HashMemo {
+  // A key's data starts 4 size bytes after the end of the key before it, so the data of two keys are at least 4
+  // plus the smallest key size bytes apart. Dividing a key's file offset by the largest power of two not above that
+  // gives each key its own slot without any per key lookup structure.
+
+  // STATIC DATA
+  static const HashMemo *d_installed;   // memo 'char_slice_memo' reads from or 0
+
+  // DATA
+  u_int64_t   *d_hashes;                // hash of the key whose data starts at file offset 'o' at 'o>>d_shift'
+  u_int64_t    d_mapped;                // bytes mapped at 'd_hashes'
+  u_int64_t    d_size;                  // number of keys hashed
+  const char  *d_begin;                 // start of the memoized file's data
+  const char  *d_end;                   // one past the end of the memoized file's data
+  unsigned     d_shift;                 // log2 of the slot stride in bytes
+
+public:
+  // CREATORS
+  HashMemo();
+    // Create an empty HashMemo. Call 'build' before use.
+
+  HashMemo(const HashMemo& other) = delete;
+    // Copy constructor not provided
+
+  ~HashMemo();
+    // Destroy this object freeing the array. If this memo is installed 'installed()' becomes 0.
+
+  // ACCESSORS
+  bool empty() const;
+    // Return true if no key was hashed and false otherwise
+
+  u_int64_t size() const;
+    // Return the number of keys hashed
+
+  u_int64_t stride() const;
+    // Return the bytes of file one slot of the array covers
+
+  u_int64_t memory() const;
+    // Return the bytes mapped for the array
+
+  bool lookup(const Slice<char>& key, std::size_t *hash) const;
+    // Return true assigning to specified 'hash' the memoized hash of specified 'key' if 'key' points into the
+    // memoized file, and false otherwise. The behavior is defined provided 'key' is a key of that file if it points
+    // into it.
+
+  // MANIPULATORS
+  template<typename HASH>
+  int build(const LoadFile& file, int node=-1);
+    // Return 0 if the array holds 'HASH()(key)' for every key of specified 'bin-text' 'file' and non-zero otherwise.
+    // Keys are those visited by the 'TextScan' loops every other phase uses. The array is huge-page backed where the
+    // kernel has huge pages free, otherwise 4K pages with transparent huge pages advised. If specified 'node>=0' it
+    // is bound to that NUMA node. Any earlier memo is freed first. 'file' must stay loaded while the memo is used.
+
+  void install();
+    // Make this memo the one 'char_slice_memo' reads from
+
+  void free();
+    // Free the array leaving the memo empty
+
+  HashMemo& operator=(const HashMemo& rhs) = delete;
+    // Assignment operator not provided
+
+  // STATIC FUNCTIONS
+  static const HashMemo *installed();
+    // Return the memo last installed and not since destroyed, or 0 if there is none
+
+private:
+  // PRIVATE MANIPULATORS
+  int allocate(const LoadFile& file, u_int64_t minSize, int node);
+    // Return 0 if 'd_hashes' has a slot for every key of specified 'file' whose smallest key is specified 'minSize'
+    // bytes, bound to specified 'node' if 'node>=0', setting 'd_begin, d_end, d_shift', and an 'errno' value otherwise
+};
+
+template<typename HASH>
+struct char_slice_memo {
+  // Passthrough hasher: hashed data structures built on it pay a load of the memoized hash instead of running 'HASH'
+  // on keys of the file given to the installed 'HashMemo'. Other keys, e.g. miss probes or NUMA replicas, are hashed.
+  std::size_t operator()(const Slice<char>& key) const;
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+inline
+HashMemo::HashMemo()
+: d_hashes(0)
+, d_mapped(0)
+, d_size(0)
+, d_begin(0)
+, d_end(0)
+, d_shift(0)
+{
+}
+
+inline
+HashMemo::~HashMemo() {
+  free();
+  if (d_installed==this) {
+    d_installed = 0;
+  }
+}
+
+// ACCESSORS
+inline
+bool HashMemo::empty() const {
+  return d_size==0;
+}
+
+inline
+u_int64_t HashMemo::size() const {
+  return d_size;
+}
+
+inline
+u_int64_t HashMemo::stride() const {
+  return 1UL<<d_shift;
+}
+
+inline
+u_int64_t HashMemo::memory() const {
+  return d_mapped;
+}
+
+inline
+bool HashMemo::lookup(const Slice<char>& key, std::size_t *hash) const {
+  assert(hash);
+  // An empty last key points one past the end: its slot is the extra one 'allocate' maps
+  const char *data = key.data();
+  if (data<d_begin || data>d_end) {
+    return false;
+  }
+  *hash = d_hashes[static_cast<u_int64_t>(data-d_begin)>>d_shift];
+  return true;
+}
+
+// MANIPULATORS
+template<typename HASH>
+int HashMemo::build(const LoadFile& file, int node) {
+  free();
+
+  TextScan<char> scanner(file);
+  if (scanner.available()==0) {
+    return 1;
+  }
+
+  // First pass finds the smallest key which fixes the stride
+  Slice<char> word;
+  u_int64_t minSize(0xFFFF);
+  while (!scanner.eof()) {
+    scanner.next(word);
+    if (static_cast<u_int64_t>(word.size())<minSize) {
+      minSize = word.size();
+    }
+  }
+
+  int rc = allocate(file, minSize, node);
+  if (rc!=0) {
+    return rc;
+  }
+
+  HASH hasher;
+  scanner.reset();
+  while (!scanner.eof()) {
+    scanner.next(word);
+    d_hashes[static_cast<u_int64_t>(word.data()-d_begin)>>d_shift] = hasher(word);
+    ++d_size;
+  }
+  if (d_size==0) {
+    free();
+    return 1;
+  }
+
+  return 0;
+}
+
+inline
+void HashMemo::install() {
+  d_installed = this;
+}
+
+// STATIC FUNCTIONS
+inline
+const HashMemo *HashMemo::installed() {
+  return d_installed;
+}
+
+template<typename HASH>
+inline
+std::size_t char_slice_memo<HASH>::operator()(const Slice<char>& key) const {
+  std::size_t hash;
+  const HashMemo *memo = HashMemo::installed();
+  if (memo && memo->lookup(key, &hash)) {
+    return hash;
+  }
+  return HASH()(key);
+}
+
+} // namespace Benchmark
@@ -1,99 +1,105 @@
 #include <benchmark_hattrie.h>
-#include <benchmark_hashable_keys.h>
-#include <benchmark_textscan.h>
+#include <benchmark_adapter.h>
+#include <benchmark_driver.h>
 
 #include <htrie_map.h>
 
-#include <intel_skylake_pmu.h>
-
-template<typename T>
-static int hattrie_test_text_insert(unsigned runNumber, T& map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  char label[128];
-  snprintf(label, sizeof(label), "insert run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-  
-  // Benchmark running: do insert
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    map.insert_ks(word.const_data(), word.size(), scanner.index());
+#include <string>
+
+#include <string.h>
+
+namespace {
+
+class HatTrieAdapter: public Benchmark::AdapterBase<HatTrieAdapter> {
+  // HAT-trie holding an 'int' for each key
+
+  // DATA
+  tsl::htrie_map<char, int> d_map;
+
+public:
+  // TYPES
+  typedef char KeyType;
+
+  // ENUMS
+  enum {
+    k_CAN_ERASE = 1,
+  };
+
+  // CREATORS
+  explicit HatTrieAdapter(const Benchmark::Config&) {
   }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  // ACCESSORS
+  size_t size() const {
+    return d_map.size();
+  }
 
-  return 0;
-}
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<char>& key) {
+    return d_map.insert_ks(key.const_data(), key.size(), 0).second;
+  }
 
-template<typename T>
-static int hattrie_test_text_find(unsigned runNumber, T& map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  unsigned int errors(0);
-  char label[128];
-  snprintf(label, sizeof(label), "find run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-
-  // Benchmark running: do find
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    auto iter = map.find_ks(word.const_data(), word.size());
-    if (iter==map.end()) {
-      ++errors;
-    }
+  bool find(Benchmark::Slice<char>& key) {
+    return d_map.find_ks(key.const_data(), key.size())!=d_map.end();
+  }
+
+  bool update(Benchmark::Slice<char>& key) {
+    d_map.insert_ks(key.const_data(), key.size(), 0).first.value() = 1;
+    return true;
+  }
+
+  bool erase(Benchmark::Slice<char>& key) {
+    return d_map.erase_ks(key.const_data(), key.size())>0;
   }
+};
+
+class HatTrieKVAdapter: public Benchmark::AdapterBase<HatTrieKVAdapter> {
+  // HAT-trie holding a copy of each value
+
+  // DATA
+  tsl::htrie_map<char, std::string> d_map;
+
+public:
+  // TYPES
+  typedef char KeyType;
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  // ENUMS
+  enum {
+    k_VALUES = 1,
+  };
 
-  if (errors) {
-    printf("searchErrors: %u\n", errors);
+  // CREATORS
+  explicit HatTrieKVAdapter(const Benchmark::Config&) {
   }
 
-  return 0;
-}
+  // ACCESSORS
+  size_t size() const {
+    return d_map.size();
+  }
+
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    return d_map.emplace_ks(key.const_data(), key.size(), value.const_data(), value.size()).second;
+  }
 
-int Benchmark::HatTrie::start() {
-  // Default start is to load file                                                                                      
-  int rc = Benchmark::Report::start();                                                                                  
-  if (rc!=0) {                                                                                                          
-    return rc;                                                                                                          
+  bool find(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    auto iter = d_map.find_ks(key.const_data(), key.size());
+    return iter!=d_map.end() && iter.value().size()==value.size() &&
+           0==memcmp(iter.value().data(), value.data(), value.size());
   }
 
-  if (d_config.d_format == "bin-text-kv") {
-    // We have KV pairs to play with
-    // Not implemented yet
-    return rc;
-  } else if (d_config.d_format=="bin-text") {
-    // We have a text file therefore we can only benchamrk key ins/upd/fnd/del on keys.
-    // Make a cuckoo map with the smallest possible value type (bool) and set it to a 
-    // constant value throughout all tests.
-    if (d_config.d_customAllocator) {
-      return rc;
-    } else {
-      for (unsigned i=0; i<d_config.d_runs; ++i) {
-        if (d_config.d_verbosity>0) {
-          printf("execute run set %u...\n", i);
-        }
-        tsl::htrie_map<char, int> map;
-        hattrie_test_text_insert(i, map, d_insertStats, d_file);
-        hattrie_test_text_find(i, map, d_findStats, d_file);
-        rusage(std::cout);
-      }
+  bool update(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    auto iter = d_map.find_ks(key.const_data(), key.size());
+    if (iter==d_map.end()) {
+      return false;
     }
+    iter.value().assign(value.data(), value.size());
+    return true;
   }
-  return rc;
+};
+
+} // anonymous namespace
+
+int Benchmark::HatTrie::run(const Config& config, const std::string& description) {
+  return Dispatch::plain<HatTrieAdapter, HatTrieKVAdapter>(config, description);
 }
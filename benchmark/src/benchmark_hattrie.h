@@ -2,24 +2,17 @@
 
 // PURPOSE: Benchmark HatTrie
 
-#include <benchmark_report.h>
+#include <benchmark_config.h>
 
-namespace Benchmark {
-
-class HatTrie: public Report {
-public:
-  // CREATORS
-  HatTrie(const Config& config, const std::string& description)
-  : Report(config, description)
-  {
-  }
+#include <string>
 
-  virtual ~HatTrie() = default;
+namespace Benchmark {
 
-  // MANIPULATORS
-  virtual int start();
-    // Return 0 if all benchmarks were run and non-zero otherwise. Note a non-zero code usually indicates
-    // bad configuration.
+struct HatTrie {
+  // STATIC FUNCTIONS
+  static int run(const Config& config, const std::string& description);
+    // Return 0 if all benchmarks per specified 'config' were run then reported under specified 'description' and
+    // non-zero otherwise. Note a non-zero code usually indicates bad configuration.
 };
 
 } // namespace Benchmark
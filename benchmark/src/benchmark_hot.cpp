@@ -1,30 +1,30 @@
 #include <benchmark_hot.h>
-#include <benchmark_hashable_keys.h>
-#include <benchmark_textscan.h>
+#include <benchmark_adapter.h>
+#include <benchmark_driver.h>
+#include <benchmark_kvrecord.h>
 
-#include <intel_skylake_pmu.h>
-
-#include <mimalloc.h>
-
-#pragma GCC diagnostic push                                                                                             
+#pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wclass-memaccess"
 #pragma GCC diagnostic ignored "-Wall"
 #pragma GCC diagnostic ignored "-Wextra"
 #pragma GCC diagnostic ignored "-Wpedantic"
 #include <HOTSingleThreaded.hpp>
 #include <IdentityKeyExtractor.hpp>
-#pragma GCC diagnostic pop 
+#pragma GCC diagnostic pop
 
 // +--------------------------------------------+----------------------------------------------------------------------------+
 // | Typedef                                    | Comment                                                                    |
 // +--------------------------------------------+----------------------------------------------------------------------------+
 // | HOTTrie                                    | trie key=Slice<char> std::allocator                                        |
 // +--------------------------------------------+----------------------------------------------------------------------------+
+// | HOTTrieKV                                  | trie value=KVRecord pointer whose key is the record's C-string key         |
+// +--------------------------------------------+----------------------------------------------------------------------------+
 
 /*
 template<typename ValueType>
 struct SliceExtractor {
   typedef ValueType KeyType;
+
   inline KeyType operator()(ValueType const &value) const {
     return value;
   }
@@ -32,98 +32,127 @@ struct SliceExtractor {
 
 namespace idx {
 namespace contenthelpers {
-
 template<> inline size_t getKeyLength<const Word *>(const Word* const & key) {
   return std::min<size_t>(key->d_size, MAX_STRING_KEY_LENGTH);
 }
-
 } // contenthelpers
 } // idx
 */
 
 typedef hot::singlethreaded::HOTSingleThreaded<const char*, idx::contenthelpers::IdentityKeyExtractor> HOTTrie;
 
-template<typename T>
-static int hot_test_text_insert(unsigned runNumber, T& map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+template<typename ValueType>
+struct KVRecordKeyExtractor {
+  // HOT stores one 'ValueType' per key and recovers the key from it. For 'bin-text-kv' the stored value is a
+  // 'Benchmark::KVRecord' so the key is the C-string held in the record.
+  typedef const char* KeyType;
 
-  char label[128];
-  snprintf(label, sizeof(label), "insert run %u", runNumber);
+  inline KeyType operator()(ValueType const &value) const {
+    return value + sizeof(unsigned int);
+  }
+};
 
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
+typedef hot::singlethreaded::HOTSingleThreaded<const char*, KVRecordKeyExtractor> HOTTrieKV;
 
-  // Benchmark running: do insert
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    map.insert(word.data());
+namespace {
+
+class HOTAdapter: public Benchmark::AdapterBase<HOTAdapter> {
+  // HOT holding C-string keys in place. Keys must be C-strings so generate the file with 'generator -t'.
+
+  // DATA
+  HOTTrie d_map;
+
+public:
+  // TYPES
+  typedef char KeyType;
+
+  // ENUMS
+  enum {
+    k_CAN_ERASE = 1,
+    k_CAN_SCAN  = 1,    // seek to a lower bound then iterate in key order
+  };
+
+  // CREATORS
+  explicit HOTAdapter(const Benchmark::Config&) {
   }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<char>& key) {
+    return d_map.insert(key.data());
+  }
 
-  return 0;
-}
+  bool find(Benchmark::Slice<char>& key) {
+    return d_map.lookup(key.data()).mIsValid;
+  }
 
-template<typename T>
-static int hot_test_text_find(unsigned runNumber, T& map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  char label[128];
-  snprintf(label, sizeof(label), "find run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-
-  // Benchmark running: do find
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    auto iter = map.find(word.data());
-    Intel::DoNotOptimize(iter);
+  bool update(Benchmark::Slice<char>& key) {
+    d_map.upsert(key.data());
+    return true;
   }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  bool erase(Benchmark::Slice<char>& key) {
+    return d_map.remove(key.data());
+  }
 
-  return 0;
-}
+  unsigned scan(Benchmark::Slice<char>& key, unsigned length) {
+    unsigned i(0);
+    for (auto iter = d_map.lower_bound(key.data()); i<length && iter!=d_map.end(); ++i, ++iter) {
+      const char *word = *iter;
+      Intel::DoNotOptimize(word);
+    }
+    return i;
+  }
+};
+
+class HOTKVAdapter: public Benchmark::AdapterBase<HOTKVAdapter> {
+  // HOT holding one pointer per key so it points to a copied record. Keys must be C-strings so generate the file
+  // with 'generator -t'.
+
+  // DATA
+  HOTTrieKV d_map;
+
+public:
+  // TYPES
+  typedef char KeyType;
+
+  // ENUMS
+  enum {
+    k_VALUES = 1,
+  };
+
+  // CREATORS
+  explicit HOTKVAdapter(const Benchmark::Config&) {
+  }
 
-int Benchmark::HOT::start() {
-  // Default start is to load file                                                                                      
-  int rc = Benchmark::Report::start();                                                                                  
-  if (rc!=0) {                                                                                                          
-    return rc;                                                                                                          
+  ~HOTKVAdapter() {
+    for (auto iter = d_map.begin(); iter!=d_map.end(); ++iter) {
+      Benchmark::KVRecord::destroy(const_cast<char*>(*iter));
+    }
   }
 
-  if (d_config.d_format == "bin-text-kv") {
-    // We have KV pairs to play with
-    // Not implemented yet
-    return rc;
-  } else if (d_config.d_format=="bin-text") {
-    // We have a text file therefore we can only benchamrk key ins/upd/fnd/del on keys.
-    // Make a cuckoo map with the smallest possible value type (bool) and set it to a 
-    // constant value throughout all tests.
-    if (d_config.d_customAllocator) {
-      return rc;
-    } else {
-      for (unsigned i=0; i<d_config.d_runs; ++i) {
-        if (d_config.d_verbosity>0) {
-          printf("execute run set %u...\n", i);
-        }
-        HOTTrie hotTrie;
-        hot_test_text_insert(i, hotTrie, d_insertStats, d_file);
-        hot_test_text_find(i, hotTrie, d_findStats, d_file);
-        rusage(std::cout);
-      }
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    char *record = Benchmark::KVRecord::create(key, value);
+    if (!d_map.insert(record)) {
+      Benchmark::KVRecord::destroy(record);
+      return false;
     }
+    return true;
   }
-  return rc;
+
+  bool find(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    auto result = d_map.lookup(key.data());
+    return result.mIsValid && Benchmark::KVRecord::equal(result.mValue, value);
+  }
+
+  bool update(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    auto result = d_map.lookup(key.data());
+    return result.mIsValid && Benchmark::KVRecord::assign(const_cast<char*>(result.mValue), value);
+  }
+};
+
+} // anonymous namespace
+
+int Benchmark::HOT::run(const Config& config, const std::string& description) {
+  return Dispatch::plain<HOTAdapter, HOTKVAdapter>(config, description);
 }
@@ -7,25 +7,17 @@
 //  Benchmark::Hot:        Benchmark HOT (height optimized trie)
 //                         https://github.com/speedskater/hot
 
-#include <benchmark_report.h>
+#include <benchmark_config.h>
 
-namespace Benchmark {
+#include <string>
 
-class HOT: public Report {
-public:
-  // CREATORS                                                                                                           
-  HOT(const Config& config, const std::string& description)                                     
-  : Report(config, description)                                                                                   
-  {                                                                                                                     
-  }                                                                                                                     
-                                                                                                                        
-  virtual ~HOT() = default;                                                                                                   
-    // Destory this object 
+namespace Benchmark {
 
-  // MANIPULATORS
-  int start();
-    // Return 0 if all benchmarks were run and non-zero otherwise. Note a non-zero code usually indicates
-    // bad configuration.
+struct HOT {
+  // STATIC FUNCTIONS
+  static int run(const Config& config, const std::string& description);
+    // Return 0 if all benchmarks per specified 'config' were run then reported under specified 'description' and
+    // non-zero otherwise. Note a non-zero code usually indicates bad configuration.
 };
 
 } // namespace Benchmark
@@ -0,0 +1,127 @@
+#include <benchmark_keyindex.h>
+#include <benchmark_numa.h>
+#include <benchmark_textscan.h>
+#include <benchmark_zipfian.h>
+
+#include <random>
+#include <vector>
+
+#include <string.h>
+
+int Benchmark::KeyIndex::allocate(u_int64_t count, int node) {
+  assert(d_keys==0);
+
+  void *data(0);
+  int rc = Numa::allocateHuge(count*sizeof(u_int64_t), node, &data, &d_mapped);
+  if (rc!=0) {
+    return rc;
+  }
+  d_keys = static_cast<u_int64_t*>(data);
+
+  return 0;
+}
+
+void Benchmark::KeyIndex::free() {
+  if (d_keys) {
+    Numa::freeHuge(d_keys, d_mapped);
+  }
+  d_keys = 0;
+  d_size = 0;
+  d_mapped = 0;
+  d_order = e_FILE;
+}
+
+int Benchmark::KeyIndex::build(const LoadFile& file, Order order, u_int64_t seed, int node) {
+  free();
+
+  TextScan<char> scanner(file);
+  if (scanner.available()==0) {
+    return 1;
+  }
+
+  int rc = allocate(scanner.available(), node);
+  if (rc!=0) {
+    return rc;
+  }
+
+  // Same words in the same order as every other phase
+  Slice<char> word;
+  while (!scanner.eof()) {
+    scanner.next(word);
+    d_keys[d_size++] = word.rawValue();
+  }
+  if (d_size==0) {
+    free();
+    return 1;
+  }
+  d_order = order;
+
+  std::mt19937_64 rng(seed);
+
+  switch (order) {
+    case e_FILE:
+      break;
+
+    case e_SHUFFLED:
+      {
+        // Fisher-Yates
+        for (u_int64_t i=d_size-1; i>0; --i) {
+          std::uniform_int_distribution<u_int64_t> pick(0, i);
+          const u_int64_t j = pick(rng);
+          const u_int64_t tmp = d_keys[i];
+          d_keys[i] = d_keys[j];
+          d_keys[j] = tmp;
+        }
+      }
+      break;
+
+    case e_UNIFORM:
+    case e_ZIPFIAN:
+      {
+        // Draws come from the keys in file order which the draws overwrite, so copy those first
+        const std::vector<u_int64_t> keys(d_keys, d_keys+d_size);
+        std::uniform_int_distribution<u_int64_t> pick(0, d_size-1);
+        std::uniform_real_distribution<double> unitDist(0.0, 1.0);
+        Zipfian zipfian(0.99);
+        for (u_int64_t i=0; i<d_size; ++i) {
+          if (order==e_UNIFORM) {
+            d_keys[i] = keys[pick(rng)];
+          } else {
+            d_keys[i] = keys[Zipfian::scatter(zipfian.next(d_size, unitDist(rng))) % d_size];
+          }
+        }
+      }
+      break;
+  }
+
+  return 0;
+}
+
+int Benchmark::KeyIndex::parseOrder(const char *name, Order *order) {
+  assert(name);
+  assert(order);
+
+  if (!strcmp(name, "file")) {
+    *order = e_FILE;
+  } else if (!strcmp(name, "shuffled")) {
+    *order = e_SHUFFLED;
+  } else if (!strcmp(name, "uniform")) {
+    *order = e_UNIFORM;
+  } else if (!strcmp(name, "zipfian")) {
+    *order = e_ZIPFIAN;
+  } else {
+    return 1;
+  }
+  return 0;
+}
+
+const char *Benchmark::KeyIndex::orderName(Order order) {
+  switch (order) {
+    case e_FILE:     return "file";
+    case e_SHUFFLED: return "shuffled";
+    case e_UNIFORM:  return "uniform";
+    case e_ZIPFIAN:  return "zipfian";
+    default:         break;
+  }
+  return "unknown";
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+// PURPOSE: Random-access array of the keys in a loaded 'bin-text' file
+//
+// CLASSES:
+//  Benchmark::KeyIndex: One pass over a loaded file builds a huge-page array of packed 'Slice' values, one per key,
+//                       in file order, shuffled, or drawn from a distribution
+
+#include <benchmark_loadfile.h>
+#include <benchmark_slice.h>
+
+#include <assert.h>
+#include <sys/types.h>
+
+namespace Benchmark {
+
+class KeyIndex {
+public:
+  // ENUMS
+  enum Order {
+    e_FILE     = 0,           // each key once in file order
+    e_SHUFFLED = 1,           // each key once in a random order
+    e_UNIFORM  = 2,           // as many keys as the file has, each drawn uniformly with replacement
+    e_ZIPFIAN  = 3,           // as many keys as the file has, few hot keys scattered across the file
+  };
+
+private:
+  // DATA
+  u_int64_t  *d_keys;         // 'Slice::rawValue' of each key; pointers into the indexed file
+  u_int64_t   d_size;         // number of entries in 'd_keys'
+  u_int64_t   d_mapped;       // bytes mapped at 'd_keys'
+  Order       d_order;        // order given to 'build'
+
+public:
+  // CREATORS
+  KeyIndex();
+    // Create an empty KeyIndex. Call 'build' before use.
+
+  KeyIndex(const KeyIndex& other) = delete;
+    // Copy constructor not provided
+
+  ~KeyIndex();
+    // Destroy this object freeing the array
+
+  // ACCESSORS
+  bool empty() const;
+    // Return true if there are no entries and false otherwise
+
+  u_int64_t size() const;
+    // Return the number of entries
+
+  Order order() const;
+    // Return the order given to 'build'
+
+  u_int64_t operator[](u_int64_t i) const;
+    // Return the 'Slice::rawValue' of specified entry 'i'. The behavior is defined provided 'i<size()'.
+
+  template<typename T>
+  Slice<T> key(u_int64_t i) const;
+    // Return specified entry 'i' as a 'Slice<T>'. The behavior is defined provided 'i<size()'.
+
+  // MANIPULATORS
+  int build(const LoadFile& file, Order order, u_int64_t seed, int node=-1);
+    // Return 0 if the index holds the keys of specified 'bin-text' 'file' in specified 'order' and non-zero
+    // otherwise. Keys are those visited by the 'TextScan' loops every other phase uses. Random orders use a
+    // generator seeded with specified 'seed' so the same 'seed' and 'file' always give the same index. The array is
+    // huge-page backed where the kernel has huge pages free, otherwise 4K pages with transparent huge pages advised.
+    // If specified 'node>=0' it is bound to that NUMA node. Any earlier index is freed first. Entries point into
+    // 'file' so it must stay loaded while the index is used.
+
+  void free();
+    // Free the array leaving the index empty
+
+  KeyIndex& operator=(const KeyIndex& rhs) = delete;
+    // Assignment operator not provided
+
+  // STATIC FUNCTIONS
+  static int parseOrder(const char *name, Order *order);
+    // Return 0 if specified 'name' is one of 'file', 'shuffled', 'uniform', 'zipfian' writing its value to specified
+    // 'order' and non-zero otherwise
+
+  static const char *orderName(Order order);
+    // Return the name of specified 'order' as accepted by 'parseOrder'
+
+private:
+  // PRIVATE MANIPULATORS
+  int allocate(u_int64_t count, int node);
+    // Return 0 if 'd_keys' has room for specified 'count' entries, bound to specified 'node' if 'node>=0', and an
+    // 'errno' value otherwise
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+inline
+KeyIndex::KeyIndex()
+: d_keys(0)
+, d_size(0)
+, d_mapped(0)
+, d_order(e_FILE)
+{
+}
+
+inline
+KeyIndex::~KeyIndex() {
+  free();
+}
+
+// ACCESSORS
+inline
+bool KeyIndex::empty() const {
+  return d_size==0;
+}
+
+inline
+u_int64_t KeyIndex::size() const {
+  return d_size;
+}
+
+inline
+KeyIndex::Order KeyIndex::order() const {
+  return d_order;
+}
+
+inline
+u_int64_t KeyIndex::operator[](u_int64_t i) const {
+  assert(i<d_size);
+  return d_keys[i];
+}
+
+template<typename T>
+inline
+Slice<T> KeyIndex::key(u_int64_t i) const {
+  assert(i<d_size);
+  return Slice<T>(d_keys[i]);
+}
+
+} // namespace Benchmark
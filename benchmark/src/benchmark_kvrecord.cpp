@@ -0,0 +1 @@
+#include <benchmark_kvrecord.h>
@@ -0,0 +1,130 @@
+#pragma once
+
+// PURPOSE: Own a copy of one key-value pair for structures which only hold a pointer
+//
+// CLASSES:
+//  Benchmark::KVRecord: Create, read, update, and free heap copies of 'bin-text-kv' pairs
+
+#include <benchmark_slice.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+namespace Benchmark {
+
+class KVRecord {
+  // A record has the same layout as a pair in a 'bin-text-kv' file:
+  //
+  //   [u32 keySize][key bytes][u32 valueSize][value bytes]
+  //
+  // Structures such as tries which store one pointer per key hold a pointer to a record. The key is recovered
+  // from the record without a second allocation, and the value follows the key in the same cache line(s) as it
+  // would if the structure embedded the value. Sizes are held in the lower 16 bits as per 'bin-text-kv'.
+
+public:
+  // STATIC FUNCTIONS
+  template<typename T>
+  static char *create(const Slice<T>& key, const Slice<T>& value);
+    // Return a pointer to a new heap allocated record holding a copy of specified 'key, value'. The caller must free
+    // the record with 'destroy'. The behavior is defined provided 'key, value' are non-empty.
+
+  static void destroy(char *record);
+    // Free memory for specified 'record' previously returned by 'create'
+
+  template<typename T>
+  static Slice<T> key(const char *record);
+    // Return the key held by specified 'record'
+
+  template<typename T>
+  static Slice<T> value(const char *record);
+    // Return the value held by specified 'record'
+
+  template<typename T>
+  static char *fromKey(const Slice<T>& key);
+    // Return the record holding specified 'key'. The behavior is defined provided 'key' was returned by 'key()' or
+    // is an unmodified copy of it.
+
+  template<typename T>
+  static bool equal(const char *record, const Slice<T>& value);
+    // Return true if the value held by specified 'record' is byte equal to specified 'value' and false otherwise
+
+  template<typename T>
+  static bool assign(char *record, const Slice<T>& value);
+    // Return true if specified 'value' was copied over the value held in specified 'record' and false otherwise.
+    // The copy is made in place; false is returned without change when the sizes differ.
+};
+
+// INLINE DEFINITIONS
+// STATIC FUNCTIONS
+template<typename T>
+inline
+char *KVRecord::create(const Slice<T>& key, const Slice<T>& value) {
+  assert(key.size()>0);
+  assert(value.size()>0);
+
+  const unsigned int keySize = key.size();
+  const unsigned int valueSize = value.size();
+  char *record = static_cast<char*>(malloc(2*sizeof(unsigned int) + (keySize+valueSize)*sizeof(T)));
+  assert(record);
+
+  char *ptr(record);
+  memcpy(ptr, &keySize, sizeof(unsigned int));
+  ptr += sizeof(unsigned int);
+  memcpy(ptr, key.data(), keySize*sizeof(T));
+  ptr += keySize*sizeof(T);
+  memcpy(ptr, &valueSize, sizeof(unsigned int));
+  ptr += sizeof(unsigned int);
+  memcpy(ptr, value.data(), valueSize*sizeof(T));
+
+  return record;
+}
+
+inline
+void KVRecord::destroy(char *record) {
+  free(record);
+}
+
+template<typename T>
+inline
+Slice<T> KVRecord::key(const char *record) {
+  assert(record);
+  const unsigned int *i = reinterpret_cast<const unsigned int*>(record);
+  return Slice<T>(reinterpret_cast<const T*>(record+sizeof(unsigned int)), (*i)&0xffff);
+}
+
+template<typename T>
+inline
+Slice<T> KVRecord::value(const char *record) {
+  assert(record);
+  const unsigned int *i = reinterpret_cast<const unsigned int*>(record);
+  const char *ptr = record + sizeof(unsigned int) + ((*i)&0xffff)*sizeof(T);
+  i = reinterpret_cast<const unsigned int*>(ptr);
+  return Slice<T>(reinterpret_cast<const T*>(ptr+sizeof(unsigned int)), (*i)&0xffff);
+}
+
+template<typename T>
+inline
+char *KVRecord::fromKey(const Slice<T>& key) {
+  return const_cast<char*>(reinterpret_cast<const char*>(key.data())) - sizeof(unsigned int);
+}
+
+template<typename T>
+inline
+bool KVRecord::equal(const char *record, const Slice<T>& value) {
+  const Slice<T> held = KVRecord::value<T>(record);
+  return held.size()==value.size() && 0==memcmp(held.data(), value.data(), value.size()*sizeof(T));
+}
+
+template<typename T>
+inline
+bool KVRecord::assign(char *record, const Slice<T>& value) {
+  const Slice<T> held = KVRecord::value<T>(record);
+  if (held.size()!=value.size()) {
+    return false;
+  }
+  memcpy(const_cast<T*>(held.data()), value.data(), value.size()*sizeof(T));
+  return true;
+}
+
+} // namespace Benchmark
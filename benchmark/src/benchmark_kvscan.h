@@ -0,0 +1,134 @@
+#pragma once
+
+// PURPOSE: Key-value scanner/iterator
+//
+// CLASSES:
+//  Benchmark::KVScan: Given a file pre-loaded in memory in 'bin-text-kv' format iterate through key-value pairs
+
+#include <benchmark_loadfile.h>
+#include <benchmark_slice.h>
+
+#include <ctype.h>
+#include <assert.h>
+
+namespace Benchmark {
+
+template<typename T>
+class KVScan {
+  // DATA
+  const LoadFile& d_file;       // holds pointer to memory array
+  char *          d_ptr;        // current memory position in memory array
+  char *          d_end;        // end of memory array
+  unsigned int    d_available;  // key-value pair count in loaded file
+  unsigned int    d_index;      // current pair in [0, d_available)
+
+public:
+  // CREATORS
+  explicit KVScan(const LoadFile& file);
+    // Create a KVScan object which will scan over the key-value pairs in specified 'file'. The behavior is defined
+    // provided 'file.load()' was error-free.
+
+  KVScan(const KVScan& other) = delete;
+    // Copy constructor not provided
+
+  ~KVScan() = default;
+    // Destroy this object.
+
+  // ACCESSORS
+  bool eof() const;
+    // Return true if EOF reached.
+
+  unsigned int index() const;
+    // Return number of scanned pairs found so far
+
+  unsigned int available() const;
+    // Return number of key-value pairs available in file loaded in memory
+
+  // MANIPULATORS
+  void next(Slice<T>& key, Slice<T>& value);
+    // Assign to 'key, value' the next key-value pair in file provided at construction time. The behavior is
+    // defined provided '!eof()'.
+
+  void reset();
+    // Reset internal state to point to the beginning of file.
+
+  KVScan& operator=(const KVScan& rhs) = delete;
+    // Assignment operator not provided
+
+  // STATIC FUNCTIONS
+  static void valueOf(const Slice<T>& key, Slice<T>& value);
+    // Assign to specified 'value' the value stored immediately after specified 'key' in loaded memory. The
+    // behavior is defined provided 'key' was produced by 'next' (or is an unmodified copy of one) so that structures
+    // holding only a pointer to the key can recover its value without storing a copy.
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+template<class T>
+inline
+KVScan<T>::KVScan(const LoadFile& file)
+: d_file(file)
+{
+  reset();
+}
+
+// ACCESSORS
+template<class T>
+inline
+bool KVScan<T>::eof() const {
+  return (d_index>=d_available);
+}
+
+template<class T>
+inline
+unsigned int KVScan<T>::index() const {
+  return d_index;
+}
+
+template<class T>
+inline
+unsigned int KVScan<T>::available() const {
+  return d_available;
+}
+
+// MANIPULATORS
+template<class T>
+inline
+void KVScan<T>::next(Slice<T>& key, Slice<T>& value) {
+  assert(!eof());
+
+  ++d_index;
+
+  unsigned int *i = reinterpret_cast<unsigned int*>(d_ptr);
+  key.reset((const T*)(d_ptr+sizeof(unsigned int)), (*i)&0xffff);
+  d_ptr += sizeof(unsigned int) + ((*i)&0xffff)*sizeof(T);
+
+  i = reinterpret_cast<unsigned int*>(d_ptr);
+  value.reset((const T*)(d_ptr+sizeof(unsigned int)), (*i)&0xffff);
+  d_ptr += sizeof(unsigned int) + ((*i)&0xffff)*sizeof(T);
+}
+
+template<class T>
+inline
+void KVScan<T>::reset() {
+  d_ptr = d_file.data();
+  d_end = d_file.data()+d_file.fileSize();
+  d_index = 0;
+  d_available = 0;
+  if (static_cast<unsigned long>(d_end-d_ptr)>=sizeof(unsigned int)) {
+    unsigned int *i = reinterpret_cast<unsigned int*>(d_ptr);
+    d_available = *i;
+    d_ptr += sizeof(unsigned int);
+  }
+}
+
+// STATIC FUNCTIONS
+template<class T>
+inline
+void KVScan<T>::valueOf(const Slice<T>& key, Slice<T>& value) {
+  const char *ptr = reinterpret_cast<const char*>(key.data()+key.size());
+  const unsigned int *i = reinterpret_cast<const unsigned int*>(ptr);
+  value.reset((const T*)(ptr+sizeof(unsigned int)), (*i)&0xffff);
+}
+
+} // namespace Benchmark
@@ -1,4 +1,5 @@
 #include <benchmark_loadfile.h>
+#include <benchmark_numa.h>
 
 #include <assert.h>
 
@@ -8,17 +9,96 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include <sys/shm.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <sys/types.h>
 
-Benchmark::LoadFile::LoadFile()
+#include <thread>
+#include <vector>
+
+// Each read asks for this many bytes. Large reads cut the system call count of a multi-GB load to a few thousand
+static const u_int64_t k_READ_BLOCK_SIZE = 8UL*1024UL*1024UL;
+
+// Default upper bound on reader threads. A few threads saturate page cache copies or an NVMe device
+static const unsigned k_MAX_READ_THREADS = 8;
+
+// First 8 bytes of every persistent segment's stamp. Identifies segments made by 'load'
+static const u_int64_t k_STAMP_MAGIC = 0x6b7662656e636831ULL;    // 'kvbench1'
+
+// Persistent segment keys have this top byte so 'removePersistent' can pick out candidates without attaching to other
+// programs' segments. Touching an unpopulated huge-page segment may allocate memory or raise SIGBUS
+static const key_t k_KEY_TAG = 0x6b000000;                      // 'k'
+static const key_t k_KEY_TAG_MASK = 0x7f000000;
+
+struct Stamp {
+  // Written after the file's bytes in a persistent segment before the file is read then again, with 'd_complete'
+  // set, once the whole file is read. A process dying mid-load leaves a segment later loads replace and
+  // 'removePersistent' still recognizes.
+
+  // DATA
+  u_int64_t d_magic;              // 'k_STAMP_MAGIC'
+  u_int64_t d_fileSize;           // size of file in bytes
+  int64_t   d_mtimeSec;           // modification time of file when read
+  int64_t   d_mtimeNsec;
+  int       d_pageSize;           // 'LoadFile::ONE_GB' or 'LoadFile::TWO_MB'
+  int       d_node;               // NUMA node memory is bound to or -1
+  u_int32_t d_complete;           // 1 if whole file was read
+  char      d_path[PATH_MAX];     // real path of file
+};
+
+static u_int64_t stampOffset(u_int64_t fileSize) {
+  // Return the offset of the stamp in a segment holding a file of specified 'fileSize' bytes
+  return (fileSize+63)&~63ULL;
+}
+
+static key_t persistentKey(const char *realPath, int pageSize, int node) {
+  // Return the key of the segment holding the file at specified 'realPath' loaded with specified 'pageSize, node'.
+  // FNV-1a hash of the three folded to 24 bits under 'k_KEY_TAG'. File size and time are checked in the stamp
+  // instead so a changed file replaces its segment rather than adding another.
+  u_int64_t hash = 0xcbf29ce484222325ULL;
+  for (const char *ptr = realPath; *ptr; ++ptr) {
+    hash = (hash ^ static_cast<unsigned char>(*ptr)) * 0x100000001b3ULL;
+  }
+  hash = (hash ^ static_cast<u_int64_t>(pageSize)) * 0x100000001b3ULL;
+  hash = (hash ^ static_cast<u_int64_t>(node+1)) * 0x100000001b3ULL;
+  hash ^= hash>>32;
+  return k_KEY_TAG | static_cast<key_t>((hash ^ (hash>>24)) & 0xffffff);
+}
+
+static int readRange(int fid, char *data, u_int64_t begin, u_int64_t end) {
+  // Return 0 if bytes '[begin, end)' of the file open on specified 'fid' were read to the same offsets of specified
+  // 'data' and a non-zero 'errno' value otherwise. 'EINVAL' is returned on unexpected EOF.
+  while (begin<end) {
+    const u_int64_t want = end-begin<k_READ_BLOCK_SIZE ? end-begin : k_READ_BLOCK_SIZE;
+    const ssize_t rc = pread(fid, data+begin, want, static_cast<off_t>(begin));
+    if (rc==-1) {
+      if (errno==EINTR) {
+        continue;
+      }
+      return errno;
+    } else if (rc==0) {
+      // unexpected EOF
+      return EINVAL;
+    }
+    // A short read is not an error; the next pread continues from where it stopped
+    begin += static_cast<u_int64_t>(rc);
+  }
+  return 0;
+}
+
+Benchmark::LoadFile::LoadFile(bool persistent)
 : d_fid(-1)
 , d_fileSize(0)
 , d_data(0)
 , d_shmId(-1)
+, d_node(-1)
+, d_mtime{0, 0}
+, d_persistent(persistent)
+, d_attached(false)
+, d_retain(false)
 {
 }
 
@@ -26,7 +106,7 @@ Benchmark::LoadFile::~LoadFile() {
   free();
 }
 
-int Benchmark::LoadFile::load(const char *path, int pageSize) {
+int Benchmark::LoadFile::load(const char *path, int pageSize, int node, unsigned readThreads) {
   assert(path);
   assert(strlen(path)>0);
 
@@ -37,15 +117,42 @@ int Benchmark::LoadFile::load(const char *path, int pageSize) {
   if ((rc = fileSize(path)) != 0) {
     return rc;
   }
+
+  char realPath[PATH_MAX];
+  key_t key(IPC_PRIVATE);
+  if (d_persistent) {
+    if (realpath(path, realPath)==0) {
+      return errno;
+    }
+    key = persistentKey(realPath, pageSize, node);
+    if (attachPersistent(realPath, key)==0) {
+      d_node = node;
+      d_attached = true;
+      d_retain = true;
+      return 0;
+    }
+  }
+
   if ((rc = openFile(path)) != 0) {
     return rc;
   }
-  if ((rc = mapFile(pageSize)) != 0) {
+  if ((rc = mapFile(pageSize, node, key)) != 0) {
     return rc;
   }
-  if ((rc = readFile()) != 0) {
+  if (d_persistent) {
+    stamp(realPath, pageSize, node, false);
+  }
+  if (readThreads==0) {
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    readThreads = cores>0 && cores<k_MAX_READ_THREADS ? static_cast<unsigned>(cores) : k_MAX_READ_THREADS;
+  }
+  if ((rc = readFile(readThreads)) != 0) {
     return rc;
   }
+  if (d_persistent) {
+    stamp(realPath, pageSize, node, true);
+    d_retain = true;
+  }
 
   return 0;
 }
@@ -55,7 +162,7 @@ void Benchmark::LoadFile::free() {
     shmdt(d_data);
   }
  
-  if (d_shmId!=-1) {
+  if (d_shmId!=-1 && !d_retain) {
     struct shmid_ds data;
     shmctl(d_shmId, IPC_RMID, &data);
   }
@@ -68,32 +175,42 @@ void Benchmark::LoadFile::free() {
   d_data = 0;
   d_fileSize = 0;
   d_shmId = -1;
+  d_node = -1;
+  d_attached = false;
+  d_retain = false;
 }
 
-int Benchmark::LoadFile::mapFile(int pageSize) {
+int Benchmark::LoadFile::mapFile(int pageSize, int node, key_t key) {
   assert(d_fid>0);
   assert(d_data==0);
   assert(d_fileSize>0);
   assert(d_shmId==-1);
 
   int flags = IPC_CREAT | IPC_EXCL | 0666 | SHM_HUGETLB | SHM_NORESERVE;
+  u_int64_t hugePageSize;
   if (pageSize == ONE_GB) {
     flags |= (30 << MAP_HUGE_SHIFT); // log_2(1024^3) = 30
+    hugePageSize = 1UL<<30;
   } else {
     flags |= (21 << MAP_HUGE_SHIFT); // log_2(2*1024^2) = 21
+    hugePageSize = 1UL<<21;
   }
     
+  // Persistent segments keep a stamp after the file
+  const u_int64_t size = key==IPC_PRIVATE ? d_fileSize : stampOffset(d_fileSize)+sizeof(Stamp);
+
   while (1) {
-    int shmKey = rand();
-    if (shmKey <= 0) {
+    int shmKey = key==IPC_PRIVATE ? rand() : key;
+    if (shmKey <= 0 || (key==IPC_PRIVATE && (shmKey & k_KEY_TAG_MASK)==k_KEY_TAG)) {
+      // Random keys stay clear of persistent ones
       continue;
     }
 
     // Request memory
-    d_shmId = shmget(shmKey, d_fileSize, flags);
+    d_shmId = shmget(shmKey, size, flags);
 
     if (d_shmId == -1) {
-      if (errno == EEXIST) {
+      if (errno == EEXIST && key==IPC_PRIVATE) {
         // key in use
         continue;
       }
@@ -112,6 +229,16 @@ int Benchmark::LoadFile::mapFile(int pageSize) {
   // Retain pointer to memory
   d_data = static_cast<char*>(data);
 
+  // SHM_NORESERVE means no page is allocated until 'readFile' touches it so binding now places every page. The
+  // range must cover whole huge pages
+  if (node>=0) {
+    int rc = Numa::bind(d_data, (size+hugePageSize-1)/hugePageSize*hugePageSize, node);
+    if (rc!=0) {
+      return rc;
+    }
+    d_node = node;
+  }
+
   return 0;
 }
 
@@ -130,6 +257,106 @@ int Benchmark::LoadFile::fileSize(const char *path) {
   }
 
   d_fileSize = fstat.st_size;
+  d_mtime = fstat.st_mtim;
+
+  return 0;
+}
+
+int Benchmark::LoadFile::attachPersistent(const char *realPath, key_t key) {
+  assert(realPath);
+  assert(d_data==0);
+  assert(d_shmId==-1);
+
+  int shmId = shmget(key, 0, 0);
+  if (shmId==-1) {
+    return errno;
+  }
+
+  struct shmid_ds info;
+  if (shmctl(shmId, IPC_STAT, &info)!=0) {
+    return errno;
+  }
+
+  bool match(false);
+  void *data(reinterpret_cast<void*>(-1));
+  if (info.shm_segsz==stampOffset(d_fileSize)+sizeof(Stamp)) {
+    data = shmat(shmId, 0, 0);
+    if (data!=reinterpret_cast<void*>(-1)) {
+      const Stamp *stamp = reinterpret_cast<const Stamp*>(static_cast<char*>(data)+stampOffset(d_fileSize));
+      match = stamp->d_magic==k_STAMP_MAGIC && stamp->d_complete==1 && stamp->d_fileSize==d_fileSize &&
+              stamp->d_mtimeSec==d_mtime.tv_sec && stamp->d_mtimeNsec==d_mtime.tv_nsec &&
+              0==strncmp(stamp->d_path, realPath, sizeof(stamp->d_path));
+    }
+  }
+
+  if (!match) {
+    // Stale or partial segment. Remove it so 'mapFile' can make a new one with the same key
+    if (data!=reinterpret_cast<void*>(-1)) {
+      shmdt(data);
+    }
+    shmctl(shmId, IPC_RMID, &info);
+    return EINVAL;
+  }
+
+  d_shmId = shmId;
+  d_data = static_cast<char*>(data);
+
+  return 0;
+}
+
+void Benchmark::LoadFile::stamp(const char *realPath, int pageSize, int node, bool complete) {
+  assert(realPath);
+  assert(d_data!=0);
+
+  Stamp *stamp = reinterpret_cast<Stamp*>(d_data+stampOffset(d_fileSize));
+  memset(stamp, 0, sizeof(Stamp));
+  stamp->d_magic = k_STAMP_MAGIC;
+  stamp->d_fileSize = d_fileSize;
+  stamp->d_mtimeSec = d_mtime.tv_sec;
+  stamp->d_mtimeNsec = d_mtime.tv_nsec;
+  stamp->d_pageSize = pageSize;
+  stamp->d_node = node;
+  snprintf(stamp->d_path, sizeof(stamp->d_path), "%s", realPath);
+  stamp->d_complete = complete ? 1 : 0;
+}
+
+int Benchmark::LoadFile::removePersistent(const char *path, unsigned *removed) {
+  assert(removed);
+
+  *removed = 0;
+
+  char realPath[PATH_MAX];
+  if (path && realpath(path, realPath)==0) {
+    return errno;
+  }
+
+  // Walk the kernel's segment table. SHM_STAT takes a table index rather than a segment id
+  struct shm_info info;
+  const int highest = shmctl(0, SHM_INFO, reinterpret_cast<struct shmid_ds*>(&info));
+  if (highest<0) {
+    return errno;
+  }
+
+  for (int index=0; index<=highest; ++index) {
+    struct shmid_ds segment;
+    const int shmId = shmctl(index, SHM_STAT, &segment);
+    if (shmId<0 || (segment.shm_perm.__key & k_KEY_TAG_MASK)!=k_KEY_TAG || segment.shm_segsz<sizeof(Stamp) ||
+        (segment.shm_segsz-sizeof(Stamp))%64!=0) {
+      continue;
+    }
+    void *data = shmat(shmId, 0, SHM_RDONLY);
+    if (data==reinterpret_cast<void*>(-1)) {
+      continue;
+    }
+    const Stamp *stamp = reinterpret_cast<const Stamp*>(static_cast<char*>(data)+segment.shm_segsz-sizeof(Stamp));
+    const bool ours = stamp->d_magic==k_STAMP_MAGIC &&
+                      segment.shm_segsz==stampOffset(stamp->d_fileSize)+sizeof(Stamp) &&
+                      (path==0 || 0==strncmp(stamp->d_path, realPath, sizeof(stamp->d_path)));
+    shmdt(data);
+    if (ours && shmctl(shmId, IPC_RMID, &segment)==0) {
+      ++*removed;
+    }
+  }
 
   return 0;
 }
@@ -143,42 +370,43 @@ int Benchmark::LoadFile::openFile(const char *path) {
   return 0;
 }
 
-int Benchmark::LoadFile::readFile() {
+int Benchmark::LoadFile::readFile(unsigned threads) {
   assert(d_fid>0);
   assert(d_data!=0);
   assert(d_fileSize>0);
   assert(d_shmId!=-1);
+  assert(threads>0);
 
-  char *ptr = d_data;
-  unsigned int left(d_fileSize);
-  const unsigned int blockSize = 4096;
+  // Parts start on block boundaries so no read straddles two threads' parts
+  const u_int64_t blocks = (d_fileSize+k_READ_BLOCK_SIZE-1)/k_READ_BLOCK_SIZE;
+  if (threads>blocks) {
+    threads = static_cast<unsigned>(blocks);
+  }
 
-  while (left>=blockSize) {
-    int rc = read(d_fid, ptr, blockSize);
-    if (rc == 0) {
-      // unexpected EOF
-      return EINVAL;
-    } else if (static_cast<unsigned int>(rc)!=blockSize) {
-      // unexpected number of bytes read
-      return EINVAL;
-    } else if (rc==-1) {
-      return errno;
+  std::vector<int> rcs(threads, 0);
+  std::vector<std::thread> readers;
+  for (unsigned i=0; i<threads; ++i) {
+    const u_int64_t begin = blocks*i/threads*k_READ_BLOCK_SIZE;
+    const u_int64_t end = i+1==threads ? d_fileSize : blocks*(i+1)/threads*k_READ_BLOCK_SIZE;
+    if (i+1==threads) {
+      // Calling thread reads the last part
+      rcs[i] = readRange(d_fid, d_data, begin, end);
+    } else {
+      readers.emplace_back([this, &rcs, i, begin, end]() {
+        rcs[i] = readRange(d_fid, d_data, begin, end);
+      });
     }
-    ptr += blockSize;
-    left -= blockSize;
   }
 
-  // Read remaining bytes
-  int rc = read(d_fid, ptr, left);
-  if (rc == 0) {
-    // unexpected EOF
-    return EINVAL;
-  } else if (static_cast<unsigned int>(rc)!=left) {
-    // unexpected number of bytes read
-    return EINVAL;
-  } else if (rc==-1) {
-    return errno;
+  for (auto& reader: readers) {
+    reader.join();
+  }
+
+  for (auto rc: rcs) {
+    if (rc!=0) {
+      return rc;
+    }
   }
 
   return 0;
-}                                                                                                      
+}
@@ -4,9 +4,12 @@
 //
 // CLASSES:
 //  Benchmark::LoadFile: Given an absolute path to a disk file, allocate sufficient huge-page memory to hold the file
-//                       then load the file into that memory.
+//                       then load the file into that memory. The memory may be bound to one NUMA node. The memory
+//                       may persist after the process exits, keyed by file, so later runs attach instead of reading.
 
+#include <time.h>
 #include <sys/types.h>
+#include <sys/ipc.h>
 
 namespace Benchmark {
 
@@ -23,10 +26,21 @@ public:
   u_int64_t    d_fileSize;
   char        *d_data;
   int          d_shmId;
+  int          d_node;
+  timespec     d_mtime;       // modification time of the file being loaded
+  bool         d_persistent;  // true if loads use, and leave behind, a segment keyed by file
+  bool         d_attached;    // true if last load attached to an existing persistent segment
+  bool         d_retain;      // true if 'free' detaches without removing the segment
 
   // CREATORS
-  LoadFile();
-    // Create a LoadFile object.
+  explicit LoadFile(bool persistent=false);
+    // Create a LoadFile object. If specified 'persistent' is true, 'load' places files into a shared memory segment
+    // whose key is derived from the file's real path, the page size and the NUMA node requested. The segment is
+    // stamped with the file's path, size and modification time and is not removed when this object is freed or
+    // destroyed. A later 'load' of the same file with the same page size and node, from this or another process,
+    // attaches to the segment without reading the file provided the stamp still matches. Otherwise the segment is
+    // replaced. Use 'removePersistent' to free such segments. Do not load the same file persistently from two
+    // processes at the same time.
 
   ~LoadFile();
     // Destory this object deallocating memory if any
@@ -38,38 +52,72 @@ public:
   u_int64_t fileSize() const;
     // Return the size of the loaded file or 0 if no file is loaded.
 
+  int node() const;
+    // Return the NUMA node the loaded file's memory was bound to or -1 if no file is loaded or no node was requested.
+
+  bool persistent() const;
+    // Return the 'persistent' value given at construction
+
+  bool attached() const;
+    // Return true if the last 'load' attached to an existing persistent segment instead of reading the file and
+    // false otherwise
+
   // MANIPULATORS
-  int load(const char *path, int pageSize=ONE_GB);
+  int load(const char *path, int pageSize=ONE_GB, int node=-1, unsigned readThreads=0);
     // Return 0 if the disk file at specified 'path' was loaded into into huge-page backed shared memory with read,
     // write permissions or a non-zero 'errno' as set by the underlying C-API otherwise. The behavior is defined 
     // provided 'path' is a non-zero pointer of length at least 1. If a file is already loaded, it is first freed.
     // Optionally, request the pagesize to be used for the allocation with specified 'pageSize'. On success 'data()'
     // provides a pointer to the initialized memory. Note that the extent of valid memory is only guaranteed to be
     // '[data(), data() + fileSize())'. Also note, 'EINVAL' may be returned if file size is zero (and file exists)
-    // or upon unexpected EOF during read.
+    // or upon unexpected EOF during read. If specified 'node>=0' the memory is bound to that NUMA node before it is
+    // first touched so every huge page comes from 'node' or the load fails with 'ENOMEM'. Otherwise the kernel's
+    // default policy applies: pages come from the node of the core which first writes them. The file is read in
+    // multi-MB blocks by specified 'readThreads' threads each reading its own contiguous part. Zero picks the
+    // smaller of 8 and the number of online cores.
 
   void free();
-    // Unconditionally free all resources from an earlier 'load()', if any. You must re-load following free.
+    // Unconditionally free all resources from an earlier 'load()', if any. You must re-load following free. A
+    // completely loaded persistent segment is detached but not removed.
+
+  // STATIC FUNCTIONS
+  static int removePersistent(const char *path, unsigned *removed);
+    // Return 0 after removing every persistent segment left behind by 'load' or a non-zero 'errno' value otherwise.
+    // If specified 'path' is non-zero only segments holding that file are removed. The number of segments removed is
+    // written to specified 'removed'. Segments still attached by a running process are freed when it detaches.
 
 private:
   // PRIVATE MANIPULATORS
-  int mapFile(int pageSize);
-    // Return 0 if huge-page backed shared memory of size 'd_fileSize' was allocated for read, write or a non-zero
-    // 'errno' value as set by the underlying C-API otherwise. The behavior is valid provided 'fileSize' was run
-    // earlier without error.
+  int mapFile(int pageSize, int node, key_t key);
+    // Return 0 if huge-page backed shared memory of size 'd_fileSize' was allocated for read, write and, if specified
+    // 'node>=0', bound to that NUMA node or a non-zero 'errno' value as set by the underlying C-API otherwise. A
+    // specified 'key' of 'IPC_PRIVATE' picks an unused random key. Otherwise the segment is made with 'key' and has
+    // room for a stamp after the file's bytes. The behavior is valid provided 'fileSize' was run earlier without
+    // error.
+
+  int attachPersistent(const char *realPath, key_t key);
+    // Return 0 if the segment with specified 'key' was attached and its stamp shows a complete load of the file at
+    // specified 'realPath' with the current 'd_fileSize, d_mtime' and non-zero otherwise. A segment which exists but
+    // does not match is removed.
+
+  void stamp(const char *realPath, int pageSize, int node, bool complete);
+    // Write after the file's bytes the stamp of a load of the file at specified 'realPath' marked complete if
+    // specified 'complete' is true. The behavior is defined provided 'mapFile' was given a key other than
+    // 'IPC_PRIVATE' and, if 'complete', 'readFile' returned without error.
 
   int fileSize(const char *path);
-    // Return 0 if 'd_fileSize' (bytes) was set for the file at specified 'path' or a non-zero 'errno' value as set
-    // by the underlying C-API otherwise. 'EINVAL' is returned if file size is zero, and the file exists.
+    // Return 0 if 'd_fileSize' (bytes) and 'd_mtime' were set for the file at specified 'path' or a non-zero 'errno'
+    // value as set by the underlying C-API otherwise. 'EINVAL' is returned if file size is zero, and the file exists.
 
   int openFile(const char *path);
     // Return 0 if the specified file at 'path' was opened for read or a non-zero 'errno' value as set by the
     // underlying C-API otherwise.
 
-  int readFile();
+  int readFile(unsigned threads);
     // Return 0 if the contents of the file with descriptor 'd_fid' was read into memory starting at 'd_data' or a
-    // non-zero 'errno' value as set by the underlying C-API otherwise. The behavior is defined provided both
-    // 'mapFile(), openFile()' previously returned without error. Note 'EINVAL' is returned when unexpected EOF
+    // non-zero 'errno' value as set by the underlying C-API otherwise. The file is split by offset into specified
+    // 'threads>0' similarly sized parts each read with 'pread' from its own thread. The behavior is defined provided
+    // both 'mapFile(), openFile()' previously returned without error. Note 'EINVAL' is returned when unexpected EOF
     // occurs.
 };
 
@@ -84,4 +132,19 @@ u_int64_t LoadFile::fileSize() const {
   return d_fileSize;
 }
 
+inline
+int LoadFile::node() const {
+  return d_node;
+}
+
+inline
+bool LoadFile::persistent() const {
+  return d_persistent;
+}
+
+inline
+bool LoadFile::attached() const {
+  return d_attached;
+}
+
 } // namespace Benchmark
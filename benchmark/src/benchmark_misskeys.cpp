@@ -0,0 +1,56 @@
+#include <benchmark_misskeys.h>
+#include <benchmark_textscan.h>
+
+#include <string.h>
+
+int Benchmark::MissKeys::load(const char *path, int node) {
+  assert(path);
+
+  d_keys.clear();
+  d_storage.clear();
+
+  int rc = d_file.load(path, LoadFile::ONE_GB, node);
+  if (rc!=0) {
+    return rc;
+  }
+
+  Slice<char> word;
+  TextScan<char> scanner(d_file);
+  d_keys.reserve(scanner.available());
+  while (!scanner.eof()) {
+    scanner.next(word);
+    d_keys.push_back(word.rawValue());
+  }
+
+  return d_keys.empty() ? 1 : 0;
+}
+
+int Benchmark::MissKeys::mutate(const LoadFile& file) {
+  d_keys.clear();
+  d_storage.clear();
+  d_file.free();
+
+  // Keys never outgrow the file they came from. Reserve now so slices into 'd_storage' stay valid
+  d_storage.reserve(file.fileSize());
+
+  Slice<char> word;
+  TextScan<char> scanner(file);
+  d_keys.reserve(scanner.available());
+  while (!scanner.eof()) {
+    scanner.next(word);
+    char *copy = d_storage.data()+d_storage.size();
+    if (word.size()==0) {
+      // No byte to flip. The key's length word in 'file' leaves room for a 1 byte probe
+      d_storage.push_back(static_cast<char>(0x80));
+      d_keys.push_back(Slice<char>(copy, 1).rawValue());
+      continue;
+    }
+    d_storage.insert(d_storage.end(), word.data(), word.data()+word.size());
+    // Files made with 'generator -t' end keys with a 0 terminator some adapters drop. Flip the byte before it
+    const ssize last = word.size()>1 && copy[word.size()-1]==0 ? word.size()-2 : word.size()-1;
+    copy[last] ^= static_cast<char>(0x80);
+    d_keys.push_back(Slice<char>(copy, word.size()).rawValue());
+  }
+
+  return d_keys.empty() ? 1 : 0;
+}
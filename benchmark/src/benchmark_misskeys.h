@@ -0,0 +1,89 @@
+#pragma once
+
+// PURPOSE: Keys expected to be absent from the benchmarked data structure
+//
+// CLASSES:
+//  Benchmark::MissKeys: Probe keys for negative lookups taken from a second file or made by mutating loaded keys
+
+#include <benchmark_loadfile.h>
+#include <benchmark_slice.h>
+
+#include <vector>
+
+#include <assert.h>
+#include <sys/types.h>
+
+namespace Benchmark {
+
+class MissKeys {
+  // DATA
+  LoadFile                d_file;       // probe file for 'load'
+  std::vector<char>       d_storage;    // mutated keys back to back for 'mutate'
+  std::vector<u_int64_t>  d_keys;       // 'Slice::rawValue' of each probe key
+
+public:
+  // CREATORS
+  explicit MissKeys(bool persistent=false);
+    // Create an empty MissKeys object. Specified 'persistent' is given to the 'LoadFile' used by 'load'.
+
+  MissKeys(const MissKeys& other) = delete;
+    // Copy constructor not provided
+
+  ~MissKeys() = default;
+    // Destroy this object
+
+  // ACCESSORS
+  bool empty() const;
+    // Return true if there are no probe keys and false otherwise
+
+  u_int64_t size() const;
+    // Return the number of probe keys
+
+  template<typename T>
+  Slice<T> key(u_int64_t i) const;
+    // Return probe key specified 'i'. The behavior is defined provided 'i<size()'.
+
+  // MANIPULATORS
+  int load(const char *path, int node);
+    // Return 0 if the probe keys are the keys of the 'bin-text' file at specified 'path' loaded into huge-page memory
+    // bound to specified 'node' if 'node>=0' and non-zero otherwise. The file should share no keys with the file
+    // whose keys were inserted.
+
+  int mutate(const LoadFile& file);
+    // Return 0 if the probe keys are copies of the keys of specified loaded 'bin-text' 'file' each with its last
+    // byte's top bit flipped and non-zero otherwise. A trailing 0 terminator is left alone and the byte before it is
+    // flipped instead. An empty key is probed by the 1 byte key '0x80'. For ASCII keys every probe misses, and does
+    // so only at its last byte, which is the longest miss path for tries. Keys are those visited by the 'TextScan'
+    // loops every other phase uses.
+
+  MissKeys& operator=(const MissKeys& rhs) = delete;
+    // Assignment operator not provided
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+inline
+MissKeys::MissKeys(bool persistent)
+: d_file(persistent)
+{
+}
+
+// ACCESSORS
+inline
+bool MissKeys::empty() const {
+  return d_keys.empty();
+}
+
+inline
+u_int64_t MissKeys::size() const {
+  return d_keys.size();
+}
+
+template<typename T>
+inline
+Slice<T> MissKeys::key(u_int64_t i) const {
+  assert(i<d_keys.size());
+  return Slice<T>(d_keys[i]);
+}
+
+} // namespace Benchmark
@@ -0,0 +1,174 @@
+#include <benchmark_numa.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include <linux/mempolicy.h>
+
+// The memory policy system calls are used directly so the benchmark does not need libnuma. Node masks passed to the
+// kernel cover this many nodes.
+static const unsigned k_MAX_NODES = 1024;
+
+// Huge page size 'allocateHuge' requests
+static const u_int64_t k_HUGE_PAGE_SIZE = 2UL*1024UL*1024UL;
+
+int Benchmark::Numa::nodes() {
+  // '/sys/devices/system/node/online' is a list of ranges e.g. '0-1' or '0,2-3'. Highest node is the last number
+  FILE *file = fopen("/sys/devices/system/node/online", "r");
+  if (file==0) {
+    return 1;
+  }
+  char buffer[256];
+  int highest = 0;
+  if (fgets(buffer, sizeof(buffer), file)) {
+    for (char *ptr = buffer; *ptr; ) {
+      if (*ptr>='0' && *ptr<='9') {
+        highest = static_cast<int>(strtol(ptr, &ptr, 10));
+      } else {
+        ++ptr;
+      }
+    }
+  }
+  fclose(file);
+  return highest+1;
+}
+
+int Benchmark::Numa::nodeOfCore(int core) {
+  // The kernel lists a core's node as a directory 'node<N>' under the core's sysfs directory
+  char path[128];
+  struct stat info;
+  const int count = nodes();
+  for (int node=0; node<count; ++node) {
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d", core, node);
+    if (stat(path, &info)==0) {
+      return node;
+    }
+  }
+  return 0;
+}
+
+int Benchmark::Numa::bind(void *addr, u_int64_t size, int node) {
+  assert(addr);
+  assert(node>=0);
+
+  if (static_cast<unsigned>(node)>=k_MAX_NODES) {
+    return EINVAL;
+  }
+
+  unsigned long mask[k_MAX_NODES/(8*sizeof(unsigned long))];
+  memset(mask, 0, sizeof(mask));
+  mask[node/(8*sizeof(unsigned long))] = 1UL << (node%(8*sizeof(unsigned long)));
+
+  if (syscall(SYS_mbind, addr, size, MPOL_BIND, mask, k_MAX_NODES, 0)!=0) {
+    return errno;
+  }
+  return 0;
+}
+
+int Benchmark::Numa::nodeOf(const void *addr) {
+  assert(addr);
+
+  int node(-1);
+  if (syscall(SYS_get_mempolicy, &node, 0, 0, addr, MPOL_F_NODE|MPOL_F_ADDR)!=0) {
+    return -1;
+  }
+  return node;
+}
+
+const Benchmark::LoadFile& Benchmark::NumaReplicas::forCore(int core) const {
+  const unsigned node = static_cast<unsigned>(Numa::nodeOfCore(core));
+  if (node<d_replicas.size() && d_replicas[node]) {
+    return *d_replicas[node];
+  }
+  return d_primary;
+}
+
+int Benchmark::NumaReplicas::replicate(const char *path, int node) {
+  assert(path);
+  assert(node>=0);
+
+  if (node==d_primary.node()) {
+    return 0;
+  }
+  if (static_cast<unsigned>(node)>=d_replicas.size()) {
+    d_replicas.resize(node+1);
+  }
+  if (d_replicas[node]) {
+    return 0;
+  }
+
+  std::unique_ptr<LoadFile> replica(new LoadFile(d_primary.persistent()));
+  int rc = replica->load(path, LoadFile::ONE_GB, node);
+  if (rc!=0) {
+    return rc;
+  }
+  d_replicas[node] = std::move(replica);
+
+  return 0;
+}
+
+void Benchmark::NumaReplicas::print(const Config& config) const {
+  if (d_primary.data()==0) {
+    return;
+  }
+  printf("placement: {\n");
+  printf("  file         : node %d %s\n", Numa::nodeOf(d_primary.data()),
+    d_primary.node()>=0 ? "bound" : "first touch");
+  for (unsigned node=0; node<d_replicas.size(); ++node) {
+    if (d_replicas[node]) {
+      printf("  replica      : node %d bound\n", Numa::nodeOf(d_replicas[node]->data()));
+    }
+  }
+  const unsigned threads = config.d_threads ? config.d_threads : 1;
+  for (unsigned i=0; i<threads; ++i) {
+    const int core = config.threadCore(i);
+    const LoadFile& file = forCore(core);
+    printf("  thread %-6u: core %d node %d reads %s on node %d\n", i, core, Numa::nodeOfCore(core),
+      &file==&d_primary ? "file" : "replica", Numa::nodeOf(file.data()));
+  }
+  printf("}\n");
+}
+
+int Benchmark::Numa::allocateHuge(u_int64_t size, int node, void **addr, u_int64_t *mapped) {
+  assert(addr);
+  assert(mapped);
+
+  const u_int64_t bytes = (size+k_HUGE_PAGE_SIZE-1)/k_HUGE_PAGE_SIZE*k_HUGE_PAGE_SIZE;
+
+  // Explicit huge pages first. Without MAP_NORESERVE the kernel reserves them now so a shortage fails here rather
+  // than with SIGBUS on first touch
+  void *data = mmap(0, bytes, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB|(21<<MAP_HUGE_SHIFT), -1,
+    0);
+  if (data==MAP_FAILED) {
+    data = mmap(0, bytes, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (data==MAP_FAILED) {
+      return errno;
+    }
+    madvise(data, bytes, MADV_HUGEPAGE);
+  }
+
+  if (node>=0) {
+    int rc = bind(data, bytes, node);
+    if (rc!=0) {
+      munmap(data, bytes);
+      return rc;
+    }
+  }
+
+  *addr = data;
+  *mapped = bytes;
+  return 0;
+}
+
+void Benchmark::Numa::freeHuge(void *addr, u_int64_t mapped) {
+  assert(addr);
+  munmap(addr, mapped);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+// PURPOSE: Place the benchmark file on NUMA nodes
+//
+// CLASSES:
+//  Benchmark::Numa:         Node topology plus binding, locating and allocating memory through the kernel's memory
+//                           policy calls
+//  Benchmark::NumaReplicas: The loaded file plus optional copies on other nodes so pinned threads read node-local keys
+
+#include <benchmark_config.h>
+#include <benchmark_loadfile.h>
+
+#include <memory>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace Benchmark {
+
+class Numa {
+public:
+  // STATIC FUNCTIONS
+  static int nodes();
+    // Return one more than the highest online NUMA node. A box without NUMA support has 1 node.
+
+  static int nodeOfCore(int core);
+    // Return the NUMA node holding specified cpu 'core' or 0 if it cannot be determined
+
+  static int bind(void *addr, u_int64_t size, int node);
+    // Return 0 if memory '[addr, addr+size)' was bound to specified 'node' so its pages, when first touched, come
+    // from 'node' only, or a non-zero 'errno' value otherwise. The behavior is defined provided 'addr' is aligned to
+    // the page size of its mapping and 'size' is a multiple of it. Pages already allocated are not moved.
+
+  static int nodeOf(const void *addr);
+    // Return the NUMA node the page holding specified 'addr' resides on or -1 if the kernel cannot say
+
+  static int allocateHuge(u_int64_t size, int node, void **addr, u_int64_t *mapped);
+    // Return 0 setting specified 'addr' to zeroed memory of at least specified 'size' bytes and specified 'mapped' to
+    // the bytes mapped there, a multiple of the 2MB huge page size, and a non-zero 'errno' value otherwise. Explicit
+    // huge pages are tried first, then transparent huge pages. Memory is bound to specified 'node' if 'node>=0'.
+
+  static void freeHuge(void *addr, u_int64_t mapped);
+    // Release specified 'mapped' bytes at specified 'addr' returned by 'allocateHuge'
+};
+
+class NumaReplicas {
+  // Holds copies of a loaded file, at most one per node, each bound to its node. Threads ask for the copy local to
+  // their core and fall back to the primary file when there is none.
+
+  // DATA
+  const LoadFile&                         d_primary;      // file the copies are made from; not owned
+  std::vector<std::unique_ptr<LoadFile>>  d_replicas;     // indexed by node: copy bound there or null
+
+public:
+  // CREATORS
+  explicit NumaReplicas(const LoadFile& primary);
+    // Create a NumaReplicas object without copies of specified 'primary' which must outlive this object
+
+  NumaReplicas(const NumaReplicas& other) = delete;
+    // Copy constructor not provided
+
+  ~NumaReplicas() = default;
+    // Destroy this object freeing all copies
+
+  // ACCESSORS
+  const LoadFile& primary() const;
+    // Return the file copies are made from
+
+  const LoadFile& forCore(int core) const;
+    // Return the copy bound to the node of specified cpu 'core' if any and the primary file otherwise
+
+  bool empty() const;
+    // Return true if there are no copies and false otherwise
+
+  // MANIPULATORS
+  int replicate(const char *path, int node);
+    // Return 0 if a copy of the file at specified 'path' was loaded bound to specified 'node', or if no copy is
+    // needed because the primary or an earlier copy is bound there, and a non-zero 'errno' value otherwise. The
+    // behavior is defined provided 'path' is the file the primary was loaded from. Copies of a persistent primary
+    // are persistent too.
+
+  void clear();
+    // Free all copies
+
+  NumaReplicas& operator=(const NumaReplicas& rhs) = delete;
+    // Assignment operator not provided
+
+  // ASPECTS
+  void print(const Config& config) const;
+    // Pretty-print to stdout where the primary file and each copy reside, and which copy each of 'config.d_threads'
+    // threads reads. Single threaded runs show thread 0 only. Nothing is printed if the primary is not loaded.
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+inline
+NumaReplicas::NumaReplicas(const LoadFile& primary)
+: d_primary(primary)
+{
+}
+
+// ACCESSORS
+inline
+const LoadFile& NumaReplicas::primary() const {
+  return d_primary;
+}
+
+inline
+bool NumaReplicas::empty() const {
+  for (const auto& replica: d_replicas) {
+    if (replica) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// MANIPULATORS
+inline
+void NumaReplicas::clear() {
+  d_replicas.clear();
+}
+
+} // namespace Benchmark
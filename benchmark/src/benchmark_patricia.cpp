@@ -1,105 +1,129 @@
 #include <benchmark_patricia.h>
-#include <benchmark_textscan.h>
+#include <benchmark_adapter.h>
+#include <benchmark_driver.h>
+#include <benchmark_kvrecord.h>
 
 #include <patricia_tree.h>
 
-#include <intel_skylake_pmu.h>
+#include <vector>
 
-#pragma GCC diagnostic push                                                                                             
-#pragma GCC diagnostic ignored "-Wpedantic"                                                                             
-#include <art.h>
-#pragma GCC diagnostic pop 
+#include <assert.h>
 
 extern Patricia::MemoryManager memManager;
 
-template<typename T>
-static int patricia_test_text_insert(unsigned runNumber, T* map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<unsigned char> word;
-  Benchmark::TextScan<unsigned char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  char label[128];
-  snprintf(label, sizeof(label), "insert run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-  
-  // Benchmark running: do insert
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    Patricia::insertKey(map, word);
+namespace {
+
+class PatriciaAdapter: public Benchmark::AdapterBase<PatriciaAdapter> {
+  // Patricia tree whose leaves are the keys themselves
+
+  // DATA
+  Patricia::Tree *d_tree;
+
+public:
+  // TYPES
+  typedef unsigned char KeyType;
+
+  // ENUMS
+  enum {
+    k_CAN_ERASE  = 1,
+    k_FIND_BATCH = 1,   // interleave lookups prefetching each one's next node or leaf
+  };
+
+  // CREATORS
+  explicit PatriciaAdapter(const Benchmark::Config&)
+  : d_tree(memManager.allocTree())
+  {
   }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  ~PatriciaAdapter() {
+    Patricia::destroyTree(d_tree);
+    memManager.freeTree(d_tree);
+  }
 
-  return 0;
-}
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<unsigned char>& key) {
+    return Patricia::insertKey(d_tree, key)==Patricia::Errno::e_OK;
+  }
 
-template<typename T>
-static int patricia_test_text_find(unsigned runNumber, T* map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<unsigned char> word;
-  Benchmark::TextScan<unsigned char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  unsigned int errors(0);
-  char label[128];
-  snprintf(label, sizeof(label), "find run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-
-  // Benchmark running: do find
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    auto val = Patricia::findKey(map, word);
-    if (val!=0) {
-      ++errors;
-    }
+  bool find(Benchmark::Slice<unsigned char>& key) {
+    return Patricia::findKey(d_tree, key)==Patricia::Errno::e_OK;
   }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  bool update(Benchmark::Slice<unsigned char>& key) {
+    Patricia::insertKey(d_tree, key);
+    return true;
+  }
 
-  if (errors) {
-    printf("searchErrors: %u\n", errors);
+  void findBatch(Benchmark::Slice<unsigned char> *keys, bool *results, unsigned count) {
+    int rc[Benchmark::Config::k_MAX_FIND_BATCH];
+    assert(count<=Benchmark::Config::k_MAX_FIND_BATCH);
+    Patricia::findKeys(d_tree, keys, rc, count);
+    for (unsigned i=0; i<count; ++i) {
+      results[i] = rc[i]==Patricia::Errno::e_OK;
+    }
   }
 
-  return 0;
-}
+  bool erase(Benchmark::Slice<unsigned char>& key) {
+    return Patricia::deleteKey(d_tree, key)==Patricia::Errno::e_OK;
+  }
+};
 
-int Benchmark::patricia::start() {
-  // Default start is to load file                                                                                      
-  int rc = Benchmark::Report::start();                                                                                  
-  if (rc!=0) {                                                                                                          
-    return rc;                                                                                                          
+class PatriciaKVAdapter: public Benchmark::AdapterBase<PatriciaKVAdapter> {
+  // Patricia tree whose leaves are the key inside a heap copy of its pair
+
+  // DATA
+  Patricia::Tree *d_tree;
+
+public:
+  // TYPES
+  typedef unsigned char KeyType;
+
+  // ENUMS
+  enum {
+    k_VALUES = 1,
+  };
+
+  // CREATORS
+  explicit PatriciaKVAdapter(const Benchmark::Config&)
+  : d_tree(memManager.allocTree())
+  {
+  }
+
+  ~PatriciaKVAdapter() {
+    std::vector<Benchmark::UKey> leaves;
+    Patricia::allKeysSorted(d_tree, leaves);
+    for (auto leaf: leaves) {
+      Benchmark::KVRecord::destroy(Benchmark::KVRecord::fromKey(leaf));
+    }
+    Patricia::destroyTree(d_tree);
+    memManager.freeTree(d_tree);
   }
 
-  if (d_config.d_format == "bin-text-kv") {
-    // We have KV pairs to play with
-    // Not implemented yet
-    return rc;
-  } else if (d_config.d_format=="bin-text") {
-    // We have a text file therefore we can only benchamrk key ins/upd/fnd/del on keys.
-    // Make a cuckoo map with the smallest possible value type (bool) and set it to a 
-    // constant value throughout all tests.
-    if (d_config.d_customAllocator) {
-      return rc;
-    } else {
-      for (unsigned i=0; i<d_config.d_runs; ++i) {
-        if (d_config.d_verbosity>0) {
-          printf("execute run set %u...\n", i);
-        }
-        Patricia::Tree *patriciaTree = memManager.allocTree();
-        patricia_test_text_insert(i, patriciaTree, d_insertStats, d_file);
-        patricia_test_text_find(i, patriciaTree, d_findStats, d_file);
-        rusage(std::cout);
-      }
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<unsigned char>& key, Benchmark::Slice<unsigned char>& value) {
+    char *record = Benchmark::KVRecord::create(key, value);
+    if (Patricia::insertKey(d_tree, Benchmark::KVRecord::key<unsigned char>(record))!=Patricia::Errno::e_OK) {
+      Benchmark::KVRecord::destroy(record);
+      return false;
     }
+    return true;
   }
-  return rc;
+
+  bool find(Benchmark::Slice<unsigned char>& key, Benchmark::Slice<unsigned char>& value) {
+    Benchmark::Slice<unsigned char> leaf;
+    return Patricia::findKey(d_tree, key, &leaf)==Patricia::Errno::e_OK &&
+           Benchmark::KVRecord::equal(Benchmark::KVRecord::fromKey(leaf), value);
+  }
+
+  bool update(Benchmark::Slice<unsigned char>& key, Benchmark::Slice<unsigned char>& value) {
+    Benchmark::Slice<unsigned char> leaf;
+    return Patricia::findKey(d_tree, key, &leaf)==Patricia::Errno::e_OK &&
+           Benchmark::KVRecord::assign(Benchmark::KVRecord::fromKey(leaf), value);
+  }
+};
+
+} // anonymous namespace
+
+int Benchmark::patricia::run(const Config& config, const std::string& description) {
+  return Dispatch::plain<PatriciaAdapter, PatriciaKVAdapter>(config, description);
 }
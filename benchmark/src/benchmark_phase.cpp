@@ -0,0 +1 @@
+#include <benchmark_phase.h>
@@ -0,0 +1,844 @@
+#pragma once
+
+// PURPOSE: Timed benchmark loops written once for every data structure
+//
+// CLASSES:
+//  Benchmark::Phase: Time one pass of insert, find, update, erase or a workload over a loaded file through an adapter
+//
+// Each function is a template on the adapter type (see 'benchmark_adapter.h') so the loop is compiled, with the
+// adapter's operations inlined, once per data structure. All structures therefore pay for exactly the same scan,
+// error counting, latency sampling and PMU bracketing.
+
+#include <benchmark_config.h>
+#include <benchmark_delegation.h>
+#include <benchmark_keyindex.h>
+#include <benchmark_kvscan.h>
+#include <benchmark_loadfile.h>
+#include <benchmark_misskeys.h>
+#include <benchmark_numa.h>
+#include <benchmark_scaling.h>
+#include <benchmark_slice.h>
+#include <benchmark_textscan.h>
+#include <benchmark_workload.h>
+
+#include <intel_latency_recorder.h>
+#include <intel_pmu_stats.h>
+#include <intel_skylake_pmu.h>
+
+#include <stdio.h>
+#include <time.h>
+
+namespace Benchmark {
+
+class Phase {
+public:
+  // STATIC FUNCTIONS
+  template<typename ADAPTER>
+  static int insert(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file);
+    // Return 0 after timing 'adapter.insert' on each key in specified 'file' recording results in specified 'stats'
+    // labeled by specified 'runNumber'
+
+  template<typename ADAPTER>
+  static int find(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file);
+    // Return 0 after timing 'adapter.find' on each key in specified 'file' recording results in specified 'stats'
+    // labeled by specified 'runNumber'. Keys not found are counted and printed.
+
+  template<typename ADAPTER>
+  static int find(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const KeyIndex& index);
+    // Return 0 after timing 'adapter.find' on each entry of specified 'index' in index order recording results in
+    // specified 'stats' labeled by specified 'runNumber'. Keys not found are counted and printed.
+
+  template<typename ADAPTER>
+  static int findBatch(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file,
+    unsigned batch);
+  template<typename ADAPTER>
+  static int findBatch(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const KeyIndex& index,
+    unsigned batch);
+    // Return 0 after timing 'adapter.findBatch' on each key in specified 'file', or each entry of specified 'index'
+    // in index order, specified 'batch' keys per call recording results in specified 'stats' labeled by specified
+    // 'runNumber'. Keys not found are counted and printed. No latency is sampled: a batch overlaps its keys' lookups
+    // so none is timed alone. Behavior is defined provided '0<batch<=Config::k_MAX_FIND_BATCH'.
+
+  template<typename ADAPTER>
+  static int miss(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const MissKeys& keys);
+    // Return 0 after timing 'adapter.find' on each of specified probe 'keys' recording results in specified 'stats'
+    // labeled by specified 'runNumber'. Probes are expected to miss; any found are counted and printed.
+
+  template<typename ADAPTER>
+  static int erase(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const KeyIndex& index,
+    u_int64_t count);
+    // Return 0 after timing 'adapter.erase' on the first specified 'count' entries of specified 'index' recording
+    // results in specified 'stats' labeled by specified 'runNumber'. Keys not erased are counted and printed.
+    // Behavior is defined provided 'ADAPTER::k_CAN_ERASE' is non-zero and 'count<=index.size()'.
+
+  template<typename ADAPTER>
+  static int reinsert(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const KeyIndex& index,
+    u_int64_t count);
+    // Return 0 after timing 'adapter.insert' on the first specified 'count' entries of specified 'index' recording
+    // results in specified 'stats' labeled by specified 'runNumber'. Run after 'erase' with the same 'index, count'
+    // to put back the keys it erased. Keys not inserted are counted and printed. Behavior is defined provided
+    // 'count<=index.size()'.
+
+  template<typename ADAPTER>
+  static int scan(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const KeyIndex& index, u_int64_t count,
+    unsigned length);
+    // Return 0 after timing 'adapter.scan(key, length)' from each of the first specified 'count' entries of specified
+    // 'index' recording results, one operation per scan, in specified 'stats' labeled by specified 'runNumber' and
+    // 'length'. Prints the keys visited, time per scan and keys per second. Scans visiting no keys are counted and
+    // printed. Behavior is defined provided 'ADAPTER::k_CAN_SCAN' is non-zero and 'count<=index.size()'.
+
+  template<typename ADAPTER>
+  static int compact(unsigned runNumber, ADAPTER& adapter);
+    // Return 0 after timing one 'adapter.compact' printing the time taken and 'adapter.memory' before and after
+    // labeled by specified 'runNumber', and non-zero if the adapter failed to compact. Behavior is defined provided
+    // 'ADAPTER::k_CAN_COMPACT' is non-zero.
+
+  template<typename ADAPTER>
+  static int seal(unsigned runNumber, ADAPTER& adapter);
+    // Return 0 after timing one 'adapter.seal' printing the time taken, 'adapter.size' and 'adapter.memory' labeled
+    // by specified 'runNumber', and non-zero if the adapter failed to seal. Behavior is defined provided
+    // 'ADAPTER::k_STATIC' is non-zero.
+
+  template<typename HASH>
+  static int hash(unsigned runNumber, Intel::Stats& stats, const LoadFile& file, const char *name);
+    // Return 0 after timing 'HASH' alone on each key in specified 'file' recording results in specified 'stats'
+    // labeled by specified 'name' and 'runNumber'. No data structure is touched so the time is the hash's own cost.
+
+  template<typename ADAPTER>
+  static int insertMT(unsigned runNumber, ADAPTER& adapter, ScalingStats& stats, const Config& config,
+    const NumaReplicas& files);
+    // Return 0 after running 'adapter.insertMT' over 'config.d_threads' threads per 'Scaling::run'. Behavior is
+    // defined provided 'ADAPTER::k_MT_INSERT' is non-zero and 'adapter.threads(config.d_threads)' was called.
+
+  template<typename ADAPTER>
+  static int findMT(unsigned runNumber, ADAPTER& adapter, ScalingStats& stats, const Config& config,
+    const NumaReplicas& files);
+    // Return 0 after running 'adapter.findMT' over 'config.d_threads' threads per 'Scaling::run'. Behavior is
+    // defined provided 'adapter.threads(config.d_threads)' was called.
+
+  template<typename ADAPTER>
+  static int mixedMT(unsigned runNumber, ADAPTER& adapter, ScalingStats& insertStats, ScalingStats& findStats,
+    const Config& config, const NumaReplicas& files);
+    // Return 0 after running 'adapter.insertMT' over 'config.d_writers' threads while 'adapter.findMT' runs over the
+    // rest of 'config.d_threads' per 'Scaling::runMixed'. Finds race the inserts so they hit only keys inserted so
+    // far. Behavior is defined provided 'ADAPTER::k_MT_INSERT' is non-zero, 'adapter.threads(config.d_threads)' was
+    // called and '0<config.d_writers<config.d_threads'.
+
+  template<typename ADAPTER>
+  static int delegate(unsigned runNumber, Delegation<ADAPTER>& delegation, ScalingStats& insertStats,
+    ScalingStats& findStats, ScalingStats& roundTripStats);
+    // Return 0 after running 'delegation.insert' then 'delegation.find' recording owners' results in specified
+    // 'insertStats' and 'findStats' respectively, then if 'delegation.spec().reply()' 'delegation.roundTrip'
+    // recording clients' results and latency in specified 'roundTripStats'. Shards are those of 'delegation' so finds
+    // hit the keys inserted.
+
+  template<typename ADAPTER>
+  static int kvInsert(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file);
+    // Return 0 after timing 'adapter.insert(key, value)' on each pair in specified 'bin-text-kv' 'file'
+
+  template<typename ADAPTER>
+  static int kvFind(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file);
+    // Return 0 after timing 'adapter.find(key, value)' on each pair in specified 'bin-text-kv' 'file'. Pairs not
+    // found, or found with a different value, are counted and printed.
+
+  template<typename ADAPTER>
+  static int kvUpdate(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file);
+    // Return 0 after timing 'adapter.update(key, value)' on each pair in specified 'bin-text-kv' 'file'. Keys not
+    // found are counted and printed.
+
+  template<typename ADAPTER>
+  static int workload(unsigned runNumber, ADAPTER& adapter, const Workload& workload, Intel::Stats& stats);
+    // Return 0 after preloading then timing specified 'workload' through 'adapter' recording results in specified
+    // 'stats'. 'e_RMW' is 'find' then 'update' of the same key. Behavior is defined provided 'ADAPTER::k_CAN_SCAN'
+    // is non-zero if 'workload' has scans.
+};
+
+// INLINE DEFINITIONS
+// STATIC FUNCTIONS
+template<typename ADAPTER>
+int Phase::insert(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file) {
+  typedef typename ADAPTER::KeyType T;
+
+  Slice<T> word;
+  TextScan<T> scanner(file);
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  char label[128];
+  snprintf(label, sizeof(label), "insert run %u", runNumber);
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do insert
+  while (!scanner.eof()) {
+    scanner.next(word);
+    latency.begin();
+    adapter.insert(word);
+    latency.end();
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, scanner.index(), startTime, endTime, pmu, latency);
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::find(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file) {
+  typedef typename ADAPTER::KeyType T;
+
+  Slice<T> word;
+  TextScan<T> scanner(file);
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  char label[128];
+  snprintf(label, sizeof(label), "find run %u", runNumber);
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do find
+  unsigned int errors(0);
+  while (!scanner.eof()) {
+    scanner.next(word);
+    latency.begin();
+    if (!adapter.find(word)) {
+      ++errors;
+    }
+    latency.end();
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, scanner.index(), startTime, endTime, pmu, latency);
+
+  if (errors) {
+    printf("searchErrors: %u\n", errors);
+  }
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::find(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const KeyIndex& index) {
+  typedef typename ADAPTER::KeyType T;
+
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  char label[128];
+  snprintf(label, sizeof(label), "find run %u", runNumber);
+
+  const u_int64_t size = index.size();
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do find in index order
+  unsigned int errors(0);
+  for (u_int64_t i=0; i<size; ++i) {
+    Slice<T> word(index.key<T>(i));
+    latency.begin();
+    if (!adapter.find(word)) {
+      ++errors;
+    }
+    latency.end();
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, size, startTime, endTime, pmu, latency);
+
+  if (errors) {
+    printf("searchErrors: %u\n", errors);
+  }
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::findBatch(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file,
+  unsigned batch) {
+  typedef typename ADAPTER::KeyType T;
+  assert(batch>0 && batch<=Config::k_MAX_FIND_BATCH);
+
+  Slice<T> words[Config::k_MAX_FIND_BATCH];
+  bool found[Config::k_MAX_FIND_BATCH];
+  TextScan<T> scanner(file);
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+
+  char label[128];
+  snprintf(label, sizeof(label), "find batch%u run %u", batch, runNumber);
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do find 'batch' keys at a time
+  unsigned int errors(0);
+  unsigned count(0);
+  while (!scanner.eof()) {
+    scanner.next(words[count]);
+    if (++count<batch) {
+      continue;
+    }
+    adapter.findBatch(words, found, count);
+    for (unsigned i=0; i<count; ++i) {
+      errors += !found[i];
+    }
+    count = 0;
+  }
+  if (count) {
+    adapter.findBatch(words, found, count);
+    for (unsigned i=0; i<count; ++i) {
+      errors += !found[i];
+    }
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, scanner.index(), startTime, endTime, pmu);
+
+  if (errors) {
+    printf("searchErrors: %u\n", errors);
+  }
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::findBatch(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const KeyIndex& index,
+  unsigned batch) {
+  typedef typename ADAPTER::KeyType T;
+  assert(batch>0 && batch<=Config::k_MAX_FIND_BATCH);
+
+  Slice<T> words[Config::k_MAX_FIND_BATCH];
+  bool found[Config::k_MAX_FIND_BATCH];
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+
+  char label[128];
+  snprintf(label, sizeof(label), "find batch%u run %u", batch, runNumber);
+
+  const u_int64_t size = index.size();
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do find in index order 'batch' keys at a time
+  unsigned int errors(0);
+  for (u_int64_t i=0; i<size; i+=batch) {
+    const unsigned count = size-i<batch ? static_cast<unsigned>(size-i) : batch;
+    for (unsigned j=0; j<count; ++j) {
+      words[j] = index.key<T>(i+j);
+    }
+    adapter.findBatch(words, found, count);
+    for (unsigned j=0; j<count; ++j) {
+      errors += !found[j];
+    }
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, size, startTime, endTime, pmu);
+
+  if (errors) {
+    printf("searchErrors: %u\n", errors);
+  }
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::miss(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const MissKeys& keys) {
+  typedef typename ADAPTER::KeyType T;
+
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  char label[128];
+  snprintf(label, sizeof(label), "miss run %u", runNumber);
+
+  const u_int64_t size = keys.size();
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do find of absent keys
+  unsigned int hits(0);
+  for (u_int64_t i=0; i<size; ++i) {
+    Slice<T> word(keys.key<T>(i));
+    latency.begin();
+    if (adapter.find(word)) {
+      ++hits;
+    }
+    latency.end();
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, size, startTime, endTime, pmu, latency);
+
+  if (hits) {
+    printf("missProbesFound: %u\n", hits);
+  }
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::erase(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const KeyIndex& index,
+  u_int64_t count) {
+  typedef typename ADAPTER::KeyType T;
+  static_assert(ADAPTER::k_CAN_ERASE, "adapter cannot erase");
+  assert(count<=index.size());
+
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  char label[128];
+  snprintf(label, sizeof(label), "erase run %u", runNumber);
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do erase in index order
+  unsigned int errors(0);
+  for (u_int64_t i=0; i<count; ++i) {
+    Slice<T> word(index.key<T>(i));
+    latency.begin();
+    if (!adapter.erase(word)) {
+      ++errors;
+    }
+    latency.end();
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, count, startTime, endTime, pmu, latency);
+
+  if (errors) {
+    printf("eraseErrors: %u\n", errors);
+  }
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::reinsert(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const KeyIndex& index,
+  u_int64_t count) {
+  typedef typename ADAPTER::KeyType T;
+  assert(count<=index.size());
+
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  char label[128];
+  snprintf(label, sizeof(label), "reinsert run %u", runNumber);
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do insert of erased keys into space erase freed
+  unsigned int errors(0);
+  for (u_int64_t i=0; i<count; ++i) {
+    Slice<T> word(index.key<T>(i));
+    latency.begin();
+    if (!adapter.insert(word)) {
+      ++errors;
+    }
+    latency.end();
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, count, startTime, endTime, pmu, latency);
+
+  if (errors) {
+    printf("reinsertErrors: %u\n", errors);
+  }
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::scan(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const KeyIndex& index, u_int64_t count,
+  unsigned length) {
+  typedef typename ADAPTER::KeyType T;
+  static_assert(ADAPTER::k_CAN_SCAN, "adapter cannot scan");
+  assert(count<=index.size());
+
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  char label[128];
+  snprintf(label, sizeof(label), "scan%u run %u", length, runNumber);
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do one seek then up to 'length' keys in order from each start key
+  unsigned int errors(0);
+  u_int64_t visited(0);
+  for (u_int64_t i=0; i<count; ++i) {
+    Slice<T> word(index.key<T>(i));
+    latency.begin();
+    const unsigned keys = adapter.scan(word, length);
+    latency.end();
+    if (keys==0) {
+      ++errors;
+    }
+    visited += keys;
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, count, startTime, endTime, pmu, latency);
+
+  // Stats count scans. Scans of the same length visit fewer keys near the end of the key space so give keys too
+  const double elapsedNs = (double)(endTime.tv_sec-startTime.tv_sec)*1000000000.0 +
+    (double)(endTime.tv_nsec-startTime.tv_nsec);
+  printf("%s: scans: %lu keys: %lu nsPerScan: %.1lf keysPerSecond: %.0lf\n", label, count, visited,
+    elapsedNs/(double)count, elapsedNs>0 ? (double)visited*1000000000.0/elapsedNs : 0.0);
+
+  if (errors) {
+    printf("scanErrors: %u\n", errors);
+  }
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::compact(unsigned runNumber, ADAPTER& adapter) {
+  static_assert(ADAPTER::k_CAN_COMPACT, "adapter cannot compact");
+
+  const size_t before = adapter.memory();
+
+  timespec startTime;
+  timespec endTime;
+  timespec_get(&startTime, TIME_UTC);
+
+  // Benchmark running: do compaction. One call so no per-operation stats
+  const bool ok = adapter.compact();
+
+  timespec_get(&endTime, TIME_UTC);
+
+  const double elapsedMs = (double)(endTime.tv_sec-startTime.tv_sec)*1000.0 +
+    (double)(endTime.tv_nsec-startTime.tv_nsec)/1000000.0;
+  printf("compact run %u: %s elapsedMs: %.3lf memoryBytes before: %lu after: %lu\n", runNumber,
+    ok ? "ok" : "failed", elapsedMs, before, adapter.memory());
+
+  return ok ? 0 : 1;
+}
+
+template<typename ADAPTER>
+int Phase::seal(unsigned runNumber, ADAPTER& adapter) {
+  static_assert(ADAPTER::k_STATIC, "adapter is not static");
+
+  timespec startTime;
+  timespec endTime;
+  timespec_get(&startTime, TIME_UTC);
+
+  // Benchmark running: build the read-only structure from the keys inserted. One call so no per-operation stats
+  const bool ok = adapter.seal();
+
+  timespec_get(&endTime, TIME_UTC);
+
+  const double elapsedMs = (double)(endTime.tv_sec-startTime.tv_sec)*1000.0 +
+    (double)(endTime.tv_nsec-startTime.tv_nsec)/1000000.0;
+  printf("seal run %u: %s elapsedMs: %.3lf keys: %lu memoryBytes: %lu\n", runNumber, ok ? "ok" : "failed", elapsedMs,
+    adapter.size(), adapter.memory());
+
+  return ok ? 0 : 1;
+}
+
+template<typename HASH>
+int Phase::hash(unsigned runNumber, Intel::Stats& stats, const LoadFile& file, const char *name) {
+  assert(name);
+
+  HASH hasher;
+  Slice<char> word;
+  TextScan<char> scanner(file);
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  char label[128];
+  snprintf(label, sizeof(label), "hash %s run %u", name, runNumber);
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do hash. Folding every hash into one value keeps each call live
+  std::size_t sum(0);
+  while (!scanner.eof()) {
+    scanner.next(word);
+    latency.begin();
+    sum += hasher(word);
+    latency.end();
+  }
+  Intel::DoNotOptimize(sum);
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, scanner.index(), startTime, endTime, pmu, latency);
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::insertMT(unsigned runNumber, ADAPTER& adapter, ScalingStats& stats, const Config& config,
+  const NumaReplicas& files) {
+  typedef typename ADAPTER::KeyType T;
+  static_assert(ADAPTER::k_MT_INSERT, "adapter does not allow concurrent insert");
+
+  char label[128];
+  snprintf(label, sizeof(label), "insert run %u", runNumber);
+
+  // Benchmark running: do insert from all threads
+  Scaling::run<T>(label, config, files, stats, [&adapter](unsigned thread, Slice<T>& word) {
+    adapter.insertMT(thread, word);
+  });
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::findMT(unsigned runNumber, ADAPTER& adapter, ScalingStats& stats, const Config& config,
+  const NumaReplicas& files) {
+  typedef typename ADAPTER::KeyType T;
+
+  char label[128];
+  snprintf(label, sizeof(label), "find run %u", runNumber);
+
+  // Benchmark running: do find from all threads. Finds do not modify the structure
+  Scaling::run<T>(label, config, files, stats, [&adapter](unsigned thread, Slice<T>& word) {
+    bool found = adapter.findMT(thread, word);
+    Intel::DoNotOptimize(found);
+  });
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::mixedMT(unsigned runNumber, ADAPTER& adapter, ScalingStats& insertStats, ScalingStats& findStats,
+  const Config& config, const NumaReplicas& files) {
+  typedef typename ADAPTER::KeyType T;
+  static_assert(ADAPTER::k_MT_INSERT, "adapter does not allow concurrent insert");
+
+  char label[128];
+  snprintf(label, sizeof(label), "mixed run %u", runNumber);
+
+  // Benchmark running: writers insert while readers find
+  Scaling::runMixed<T>(label, config, files, insertStats, findStats, [&adapter](unsigned thread, Slice<T>& word) {
+    adapter.insertMT(thread, word);
+  }, [&adapter](unsigned thread, Slice<T>& word) {
+    bool found = adapter.findMT(thread, word);
+    Intel::DoNotOptimize(found);
+  });
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::delegate(unsigned runNumber, Delegation<ADAPTER>& delegation, ScalingStats& insertStats,
+  ScalingStats& findStats, ScalingStats& roundTripStats) {
+  char label[128];
+
+  // Benchmark running: clients send inserts then finds to the owners of their keys' shards
+  snprintf(label, sizeof(label), "insert run %u", runNumber);
+  delegation.insert(label, insertStats);
+  snprintf(label, sizeof(label), "find run %u", runNumber);
+  delegation.find(label, findStats);
+  if (delegation.spec().reply()) {
+    snprintf(label, sizeof(label), "round trip run %u", runNumber);
+    delegation.roundTrip(label, roundTripStats);
+  }
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::kvInsert(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file) {
+  typedef typename ADAPTER::KeyType T;
+
+  Slice<T> key;
+  Slice<T> value;
+  KVScan<T> scanner(file);
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  char label[128];
+  snprintf(label, sizeof(label), "insert run %u", runNumber);
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do insert copying value into structure
+  while (!scanner.eof()) {
+    scanner.next(key, value);
+    latency.begin();
+    adapter.insert(key, value);
+    latency.end();
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, scanner.index(), startTime, endTime, pmu, latency);
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::kvFind(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file) {
+  typedef typename ADAPTER::KeyType T;
+
+  Slice<T> key;
+  Slice<T> value;
+  KVScan<T> scanner(file);
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  char label[128];
+  snprintf(label, sizeof(label), "find run %u", runNumber);
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do find reading every value byte
+  unsigned int errors(0);
+  while (!scanner.eof()) {
+    scanner.next(key, value);
+    latency.begin();
+    if (!adapter.find(key, value)) {
+      ++errors;
+    }
+    latency.end();
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, scanner.index(), startTime, endTime, pmu, latency);
+
+  if (errors) {
+    printf("searchErrors: %u\n", errors);
+  }
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::kvUpdate(unsigned runNumber, ADAPTER& adapter, Intel::Stats& stats, const LoadFile& file) {
+  typedef typename ADAPTER::KeyType T;
+
+  Slice<T> key;
+  Slice<T> value;
+  KVScan<T> scanner(file);
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  char label[128];
+  snprintf(label, sizeof(label), "update run %u", runNumber);
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do update overwriting value in place
+  unsigned int errors(0);
+  while (!scanner.eof()) {
+    scanner.next(key, value);
+    latency.begin();
+    if (!adapter.update(key, value)) {
+      ++errors;
+    }
+    latency.end();
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(label, scanner.index(), startTime, endTime, pmu, latency);
+
+  if (errors) {
+    printf("updateErrors: %u\n", errors);
+  }
+
+  return 0;
+}
+
+template<typename ADAPTER>
+int Phase::workload(unsigned runNumber, ADAPTER& adapter, const Workload& workload, Intel::Stats& stats) {
+  typedef typename ADAPTER::KeyType T;
+
+  char label[128];
+  snprintf(label, sizeof(label), "workload run %u", runNumber);
+
+  auto op = [&adapter](unsigned type, Slice<T>& key, unsigned length) {
+    switch (type) {
+      case Workload::e_READ:
+        {
+          bool found = adapter.find(key);
+          Intel::DoNotOptimize(found);
+        }
+        break;
+      case Workload::e_UPDATE:
+        {
+          adapter.update(key);
+        }
+        break;
+      case Workload::e_INSERT:
+        {
+          adapter.insert(key);
+        }
+        break;
+      case Workload::e_SCAN:
+        {
+          unsigned visited = adapter.scan(key, length);
+          Intel::DoNotOptimize(visited);
+        }
+        break;
+      case Workload::e_RMW:
+        {
+          if (adapter.find(key)) {
+            adapter.update(key);
+          }
+        }
+        break;
+    }
+  };
+
+  // Insert the keys operations start from. This is not timed
+  workload.preload<T>(op);
+
+  // Benchmark running: do interleaved operations
+  workload.run<T>(label, stats, op);
+
+  return 0;
+}
+
+} // namespace Benchmark
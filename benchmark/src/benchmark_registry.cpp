@@ -0,0 +1,53 @@
+#include <benchmark_registry.h>
+
+#include <benchmark_art.h>
+#include <benchmark_cedar.h>
+#include <benchmark_cradix.h>
+#include <benchmark_cuckoo.h>
+#include <benchmark_eytzinger.h>
+#include <benchmark_f14.h>
+#include <benchmark_hattrie.h>
+#include <benchmark_hot.h>
+#include <benchmark_patricia.h>
+#include <benchmark_wormhole.h>
+
+#include <string.h>
+#include <assert.h>
+
+namespace {
+
+// Adding a data structure means writing its adapter(s) and adding one line here
+const Benchmark::RegistryEntry registry[] = {
+  { "cuckoo",   "Cuckoo Hashmap", "hashmap  https://github.com/efficient/libcuckoo",                              true,  Benchmark::Cuckoo::run      },
+  { "f14",      "F14 Hashmap",    "hashmap  https://github.com/facebook/folly",                                   true,  Benchmark::FacebookF14::run },
+  { "hot",      "HOT Trie",       "HOT trie https://github.com/speedskater/hot",                                  false, Benchmark::HOT::run         },
+  { "art",      "ART Trie",       "ART trie https://github.com/armon/libart.git",                                 false, Benchmark::ART::run         },
+  { "patricia", "Patricia Trie",  "own trie based on https://cr.yp.to/critbit.html, https://github.com/agl/critbit", false, Benchmark::patricia::run    },
+  { "cradix",   "CRadix Trie",    "own m-ary trie",                                                               false, Benchmark::cradix::run      },
+  { "cradix-olc", "CRadix OLC Trie", "own m-ary trie, lock-free finds and per node version locked inserts",       false, Benchmark::cradixOLC::run   },
+  { "cedar",    "Cedar Trie",     "double array trie http://www.tkl.iis.u-tokyo.ac.jp/~ynaga/cedar/",             false, Benchmark::Cedar::run       },
+  { "wormhole", "Wormhole Trie",  "Wormhole trie https://github.com/wuxb45/wormhole",                             false, Benchmark::WormHole::run    },
+  { "hattrie",  "HAT-Trie",       "Hat-Trie trie https://github.com/Tessil/hat-trie",                             false, Benchmark::HatTrie::run     },
+  { "eytzinger", "Eytzinger Array", "own read-only sorted array in Eytzinger order, static baseline for tries",  false, Benchmark::eytzinger::run   },
+};
+
+} // anonymous namespace
+
+const Benchmark::RegistryEntry *Benchmark::Registry::find(const char *name) {
+  assert(name);
+  for (const auto& item: registry) {
+    if (!strcmp(item.d_name, name)) {
+      return &item;
+    }
+  }
+  return 0;
+}
+
+unsigned Benchmark::Registry::size() {
+  return sizeof(registry)/sizeof(registry[0]);
+}
+
+const Benchmark::RegistryEntry& Benchmark::Registry::entry(unsigned index) {
+  assert(index<size());
+  return registry[index];
+}
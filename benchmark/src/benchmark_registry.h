@@ -0,0 +1,38 @@
+#pragma once
+
+// PURPOSE: Name to data structure lookup for the command line
+//
+// CLASSES:
+//  Benchmark::RegistryEntry: One benchmarkable data structure: its '-d' name, title, reference, and entry point
+//  Benchmark::Registry:      Table of all benchmarkable data structures
+
+#include <benchmark_config.h>
+
+#include <string>
+
+namespace Benchmark {
+
+struct RegistryEntry {
+  // DATA
+  const char *d_name;           // '-d' argument e.g. 'cuckoo'
+  const char *d_description;    // title used in reports e.g. 'Cuckoo Hashmap'
+  const char *d_usage;          // one line description with reference for usage
+  bool        d_needHashAlgo;   // true if '-h' is mandatory
+  int       (*d_run)(const Config& config, const std::string& description);
+                                // run then report benchmarks per 'config' returning 0 on success
+};
+
+class Registry {
+public:
+  // STATIC FUNCTIONS
+  static const RegistryEntry *find(const char *name);
+    // Return the entry whose 'd_name' is specified 'name' or 0 if there is none
+
+  static unsigned size();
+    // Return the number of entries
+
+  static const RegistryEntry& entry(unsigned index);
+    // Return the entry at specified 'index'. Behavior is defined provided 'index<size()'.
+};
+
+} // namespace Benchmark
@@ -1,12 +1,172 @@
 #include <benchmark_report.h>
+#include <benchmark_hashable_keys.h>
 
 #include <intel_skylake_pmu.h>
 
+#include <stdlib.h>
+
 #include <sys/time.h>
 #include <sys/resource.h>
 
 int Benchmark::Report::start() {
-  return loadFile(d_config.d_filename.c_str());
+  int rc = loadFile(d_config.d_filename.c_str());
+  if (rc!=0) {
+    return rc;
+  }
+
+  if (!d_config.d_keyOrder.empty()) {
+    KeyIndex::Order order(KeyIndex::e_FILE);
+    if (d_config.d_format!="bin-text" || KeyIndex::parseOrder(d_config.d_keyOrder.c_str(), &order)!=0) {
+      printf("error: key order '%s' requires format 'bin-text'\n", d_config.d_keyOrder.c_str());
+      return 1;
+    }
+    timespec startTime;
+    timespec endTime;
+    timespec_get(&startTime, TIME_UTC);
+    // Fixed seed: every run and every data structure looks keys up in the same order
+    if ((rc = d_keyIndex.build(d_file, order, 0x5EEDULL, d_file.node()))!=0) {
+      printf("error: cannot build '%s' key index (rc=%d)\n", d_config.d_keyOrder.c_str(), rc);
+      return 1;
+    }
+    timespec_get(&endTime, TIME_UTC);
+    printf("key index: order '%s' entries %lu built in %.1f ms\n", KeyIndex::orderName(order), d_keyIndex.size(),
+      (double)(endTime.tv_sec-startTime.tv_sec)*1000.0 + (double)(endTime.tv_nsec-startTime.tv_nsec)/1000000.0);
+  }
+
+  if (!d_config.d_missFile.empty()) {
+    if (d_config.d_format!="bin-text") {
+      printf("error: miss keys '%s' require format 'bin-text'\n", d_config.d_missFile.c_str());
+      return 1;
+    }
+    if (d_config.d_missFile=="mutate") {
+      rc = d_missKeys.mutate(d_file);
+    } else {
+      printf("loading miss keys '%s'\n", d_config.d_missFile.c_str());
+      rc = d_missKeys.load(d_config.d_missFile.c_str(), d_file.node());
+    }
+    if (rc!=0) {
+      printf("error: cannot make miss keys from '%s' (rc=%d)\n", d_config.d_missFile.c_str(), rc);
+      return 1;
+    }
+    printf("miss keys: %lu\n", d_missKeys.size());
+  }
+
+  if (!d_config.d_erase.empty()) {
+    if (d_config.d_format!="bin-text") {
+      printf("error: erase '%s' requires format 'bin-text'\n", d_config.d_erase.c_str());
+      return 1;
+    }
+    // Drain erases every key in file order. A percent erases that share of keys picked at random with a fixed
+    // seed so every run and every data structure erases the same keys in the same order
+    const bool drain = d_config.d_erase=="drain";
+    const unsigned percent = drain ? 100 : atoi(d_config.d_erase.c_str());
+    if (percent<1 || percent>100) {
+      printf("error: bad erase '%s'\n", d_config.d_erase.c_str());
+      return 1;
+    }
+    const KeyIndex::Order order = drain ? KeyIndex::e_FILE : KeyIndex::e_SHUFFLED;
+    if ((rc = d_eraseIndex.build(d_file, order, 0x5EEDULL, d_file.node()))!=0) {
+      printf("error: cannot build erase key index (rc=%d)\n", rc);
+      return 1;
+    }
+    d_eraseCount = d_eraseIndex.size()*percent/100;
+    if (d_eraseCount==0) {
+      d_eraseCount = 1;
+    }
+    printf("erase keys: %lu of %lu in '%s' order\n", d_eraseCount, d_eraseIndex.size(), KeyIndex::orderName(order));
+  }
+
+  if (d_config.d_findBatch && d_config.d_format!="bin-text") {
+    printf("error: find batch %u requires format 'bin-text'\n", d_config.d_findBatch);
+    return 1;
+  }
+
+  if (d_config.d_writers && (d_config.d_writers>=d_config.d_threads || d_config.d_format!="bin-text")) {
+    printf("error: %u writers require more -t threads and format 'bin-text'\n", d_config.d_writers);
+    return 1;
+  }
+
+  if (!d_config.d_delegate.empty()) {
+    if (d_config.d_threads==0 || d_config.d_format!="bin-text" || d_delegation.configure(d_config.d_delegate)!=0) {
+      printf("error: delegation '%s' requires -t threads and format 'bin-text'\n", d_config.d_delegate.c_str());
+      return 1;
+    }
+    d_delegation.print();
+  }
+
+  if (!d_config.d_scanLengths.empty()) {
+    if (d_config.d_format!="bin-text" || parseScanLengths(d_config.d_scanLengths.c_str(), &d_scanLengths)!=0) {
+      printf("error: scan lengths '%s' require format 'bin-text'\n", d_config.d_scanLengths.c_str());
+      return 1;
+    }
+    // Scans start at keys picked at random with a fixed seed so every run and every data structure scans the same
+    // ranges. Each length scans about as many keys in total as there are keys
+    if ((rc = d_scanIndex.build(d_file, KeyIndex::e_SHUFFLED, 0x5EEDULL, d_file.node()))!=0) {
+      printf("error: cannot build scan key index (rc=%d)\n", rc);
+      return 1;
+    }
+    for (unsigned length: d_scanLengths) {
+      const u_int64_t count = d_scanIndex.size()/length;
+      d_scanCounts.push_back(count ? count : 1);
+      d_scanStats.emplace_back();
+      d_scanStats.back().setLatencySampling(d_config.d_latencySampling);
+      printf("scan keys: %lu scans of up to %u keys\n", d_scanCounts.back(), length);
+    }
+  }
+
+  if (d_config.d_hashMemo) {
+    if (d_config.d_format!="bin-text" || !d_config.d_needHashAlgo) {
+      printf("error: hash memo requires format 'bin-text' and a data structure taking '-h'\n");
+      return 1;
+    }
+    timespec startTime;
+    timespec endTime;
+    timespec_get(&startTime, TIME_UTC);
+    if (d_config.d_hashAlgo=="xxhash:XX3_64bits") {
+      rc = d_hashMemo.build<char_slice_xxhash_xx3_64bits>(d_file, d_file.node());
+    } else if (d_config.d_hashAlgo=="t1ha::t1ha") {
+      rc = d_hashMemo.build<char_slice_t1ha>(d_file, d_file.node());
+    } else if (d_config.d_hashAlgo=="city::cityhash64") {
+      rc = d_hashMemo.build<char_slice_city_cityhash64>(d_file, d_file.node());
+    } else {
+      rc = 1;
+    }
+    if (rc!=0) {
+      printf("error: cannot build '%s' hash memo (rc=%d)\n", d_config.d_hashAlgo.c_str(), rc);
+      return 1;
+    }
+    timespec_get(&endTime, TIME_UTC);
+    d_hashMemo.install();
+    printf("hash memo: '%s' entries %lu stride %lu memoryBytes %lu built in %.1f ms\n", d_config.d_hashAlgo.c_str(),
+      d_hashMemo.size(), d_hashMemo.stride(), d_hashMemo.memory(),
+      (double)(endTime.tv_sec-startTime.tv_sec)*1000.0 + (double)(endTime.tv_nsec-startTime.tv_nsec)/1000000.0);
+  }
+
+  if (d_config.d_workload.empty()) {
+    return 0;
+  }
+
+  if (d_config.d_format!="bin-text") {
+    printf("error: workload '%s' requires format 'bin-text'\n", d_config.d_workload.c_str());
+    return 1;
+  }
+  if (d_workload.configure(d_config.d_workload, d_config.d_keyDistribution)!=0) {
+    printf("error: bad workload '%s'\n", d_config.d_workload.c_str());
+    return 1;
+  }
+  if (d_workload.has(Workload::e_SCAN) && !supportsScan()) {
+    printf("error: workload '%s' has scans but %s cannot scan\n", d_config.d_workload.c_str(),
+      d_description.c_str());
+    return 1;
+  }
+  // Fixed seed: every run and every data structure sees the same operation stream
+  if (d_workload.generate(d_file, 0x5EEDULL)!=0) {
+    printf("error: cannot generate workload '%s'\n", d_config.d_workload.c_str());
+    return 1;
+  }
+  d_workload.print();
+
+  return 0;
 }
 
 std::ostream& Benchmark::Report::rusage(std::ostream& stream, const char *label) {
@@ -30,26 +190,181 @@ std::ostream& Benchmark::Report::rusage(std::ostream& stream, const char *label)
   return stream;
 }
 
+int Benchmark::Report::parseScanLengths(const char *spec, std::vector<unsigned> *lengths) {
+  assert(spec);
+  assert(lengths);
+
+  lengths->clear();
+  while (*spec) {
+    char *end(0);
+    const unsigned long length = strtoul(spec, &end, 10);
+    if (end==spec || length==0 || length>0xFFFFFFFFUL || (*end!=',' && *end!=0)) {
+      lengths->clear();
+      return 1;
+    }
+    lengths->push_back(static_cast<unsigned>(length));
+    spec = *end ? end+1 : end;
+    if (*end==',' && *spec==0) {
+      // Trailing ','
+      lengths->clear();
+      return 1;
+    }
+  }
+
+  return lengths->empty() ? 1 : 0;
+}
+
 void Benchmark::Report::report() {
   Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
   d_config.print();
-  std::string desc = d_description;
-  desc.append(" Insert");
-  d_insertStats.summary(desc.c_str(), pmu);
-  desc = d_description;
-  desc.append(" ExactSearch");
-  d_findStats.summary(desc.c_str(), pmu);
+  d_replicas.print(d_config);
+  std::string desc;
+  if (!d_xxhashStats.empty()) {
+    desc = d_description;
+    desc.append(" Hash xxhash:XX3_64bits");
+    d_xxhashStats.summary(desc.c_str(), pmu);
+  }
+  if (!d_t1haStats.empty()) {
+    desc = d_description;
+    desc.append(" Hash t1ha::t1ha");
+    d_t1haStats.summary(desc.c_str(), pmu);
+  }
+  if (!d_cityStats.empty()) {
+    desc = d_description;
+    desc.append(" Hash city::cityhash64");
+    d_cityStats.summary(desc.c_str(), pmu);
+  }
+  if (!d_insertStats.empty()) {
+    desc = d_description;
+    desc.append(" Insert");
+    d_insertStats.summary(desc.c_str(), pmu);
+  }
+  if (!d_findStats.empty()) {
+    desc = d_description;
+    desc.append(" ExactSearch");
+    if (d_config.d_findBatch && d_config.d_threads==0 && d_config.d_workload.empty()) {
+      desc.append(" Batch");
+      desc.append(std::to_string(d_config.d_findBatch));
+    }
+    d_findStats.summary(desc.c_str(), pmu);
+  }
+  if (!d_updateStats.empty()) {
+    desc = d_description;
+    desc.append(" Update");
+    d_updateStats.summary(desc.c_str(), pmu);
+  }
+  if (!d_missStats.empty()) {
+    desc = d_description;
+    desc.append(" MissSearch");
+    d_missStats.summary(desc.c_str(), pmu);
+  }
+  if (!d_eraseStats.empty()) {
+    desc = d_description;
+    desc.append(" Erase");
+    d_eraseStats.summary(desc.c_str(), pmu);
+  }
+  if (!d_reinsertStats.empty()) {
+    desc = d_description;
+    desc.append(" Reinsert");
+    d_reinsertStats.summary(desc.c_str(), pmu);
+  }
+  if (!d_findBeforeCompactStats.empty()) {
+    desc = d_description;
+    desc.append(" ExactSearch BeforeCompact");
+    d_findBeforeCompactStats.summary(desc.c_str(), pmu);
+  }
+  if (!d_findAfterCompactStats.empty()) {
+    desc = d_description;
+    desc.append(" ExactSearch AfterCompact");
+    d_findAfterCompactStats.summary(desc.c_str(), pmu);
+  }
+  for (unsigned i=0; i<d_scanStats.size(); ++i) {
+    if (!d_scanStats[i].empty()) {
+      desc = d_description;
+      desc.append(" Scan");
+      desc.append(std::to_string(d_scanLengths[i]));
+      d_scanStats[i].summary(desc.c_str(), pmu);
+    }
+  }
+  if (!d_workloadStats.empty()) {
+    desc = d_description;
+    desc.append(" Workload ");
+    desc.append(d_workload.spec());
+    d_workloadStats.summary(desc.c_str(), pmu);
+  }
+  if (!d_insertScaling.empty()) {
+    desc = d_description;
+    desc.append(" Insert");
+    d_insertScaling.summary(desc.c_str());
+  }
+  if (!d_findScaling.empty()) {
+    desc = d_description;
+    desc.append(" ExactSearch");
+    d_findScaling.summary(desc.c_str());
+  }
+  if (!d_mixedInsertScaling.empty()) {
+    desc = d_description;
+    desc.append(" Mixed Insert");
+    d_mixedInsertScaling.summary(desc.c_str());
+  }
+  if (!d_mixedFindScaling.empty()) {
+    desc = d_description;
+    desc.append(" Mixed ExactSearch");
+    d_mixedFindScaling.summary(desc.c_str());
+  }
+  if (!d_delegatedInsertScaling.empty()) {
+    desc = d_description;
+    desc.append(" Delegated Insert ");
+    desc.append(d_delegation.spec());
+    d_delegatedInsertScaling.summary(desc.c_str());
+  }
+  if (!d_delegatedFindScaling.empty()) {
+    desc = d_description;
+    desc.append(" Delegated ExactSearch ");
+    desc.append(d_delegation.spec());
+    d_delegatedFindScaling.summary(desc.c_str());
+  }
+  if (!d_delegatedRoundTripScaling.empty()) {
+    desc = d_description;
+    desc.append(" Delegated RoundTrip ExactSearch ");
+    desc.append(d_delegation.spec());
+    d_delegatedRoundTripScaling.summary(desc.c_str());
+  }
   rusage(std::cout);
 }
 
 int Benchmark::Report::loadFile(const char *path) {
   assert(path);                                                                              
   printf("loading '%s'\n", path);
-  int rc = d_file.load(path);
+
+  int node(-1);
+  if (d_config.d_numa=="local" || d_config.d_numa=="replicate") {
+    node = Numa::nodeOfCore(d_config.d_cpu0);
+  } else if (!d_config.d_numa.empty()) {
+    node = atoi(d_config.d_numa.c_str());
+  }
+
+  int rc = d_file.load(path, LoadFile::ONE_GB, node);
   if (rc!=0) {                                                                                                          
     printf("error: cannot load '%s': %s (errno=%d)\n", path, strerror(rc), rc);                           
     exit(1);                                                                                                            
   }                                                                                                                     
+
+  if (d_file.attached()) {
+    printf("attached persistent segment %d holding '%s'\n", d_file.d_shmId, path);
+  }
+
+  if (d_config.d_numa=="replicate") {
+    for (unsigned i=0; i<d_config.d_threads; ++i) {
+      node = Numa::nodeOfCore(d_config.threadCore(i));
+      if ((rc = d_replicas.replicate(path, node))!=0) {
+        printf("error: cannot replicate '%s' on node %d: %s (errno=%d)\n", path, node, strerror(rc), rc);
+        exit(1);
+      }
+    }
+  }
+  d_replicas.print(d_config);
+
   char buffer[1024];
   snprintf(buffer, sizeof(buffer), "After Loading '%s'", path);
   rusage(std::cout, buffer);
@@ -3,9 +3,19 @@
 // PURPOSE: Base class for collecting stats
 
 #include <benchmark_config.h>
+#include <benchmark_delegation.h>
+#include <benchmark_hashmemo.h>
+#include <benchmark_keyindex.h>
 #include <benchmark_loadfile.h>
+#include <benchmark_misskeys.h>
+#include <benchmark_numa.h>
+#include <benchmark_scaling.h>
+#include <benchmark_workload.h>
 #include <intel_pmu_stats.h>
 
+#include <deque>
+#include <vector>
+
 namespace Benchmark {
 
 class Report {
@@ -14,8 +24,37 @@ public:
   const Config&       d_config;                                                                                             
   const std::string   d_description;
   LoadFile            d_file;
+  NumaReplicas        d_replicas;
+  KeyIndex            d_keyIndex;
+  MissKeys            d_missKeys;
+  KeyIndex            d_eraseIndex;
+  u_int64_t           d_eraseCount;
   Intel::Stats        d_findStats;
   Intel::Stats        d_insertStats;
+  Intel::Stats        d_updateStats;
+  Intel::Stats        d_missStats;
+  Intel::Stats        d_eraseStats;
+  Intel::Stats        d_reinsertStats;
+  Intel::Stats        d_findBeforeCompactStats;
+  Intel::Stats        d_findAfterCompactStats;
+  KeyIndex            d_scanIndex;
+  std::vector<unsigned> d_scanLengths;
+  std::vector<u_int64_t> d_scanCounts;
+  std::deque<Intel::Stats> d_scanStats;
+  HashMemo            d_hashMemo;
+  Intel::Stats        d_xxhashStats;
+  Intel::Stats        d_t1haStats;
+  Intel::Stats        d_cityStats;
+  ScalingStats        d_insertScaling;
+  ScalingStats        d_findScaling;
+  ScalingStats        d_mixedInsertScaling;
+  ScalingStats        d_mixedFindScaling;
+  DelegationSpec      d_delegation;
+  ScalingStats        d_delegatedInsertScaling;
+  ScalingStats        d_delegatedFindScaling;
+  ScalingStats        d_delegatedRoundTripScaling;
+  Workload            d_workload;
+  Intel::Stats        d_workloadStats;
 
   // CREATORS
   explicit Report(const Config& config, const std::string& description);
@@ -27,13 +66,24 @@ public:
   virtual ~Report() = default;
     // Destory this object
 
+  // ACCESSORS
+  virtual bool supportsScan() const;
+    // Return true if the benchmarked data structure can visit keys in order from a lower bound so that workloads
+    // with scans can run and false otherwise. The default is false.
+
   // MANIPULATORS
   virtual int loadFile(const char *path);
-    // Return 0 if specified file in 'path' was loaded into 'd_file' and non-zero otherwise
+    // Return 0 if specified file in 'path' was loaded into 'd_file' and non-zero otherwise. 'd_config.d_numa' binds
+    // the file to a node: 'local' the node of 'd_cpu0', or the given node number. 'replicate' binds like 'local'
+    // then loads into 'd_replicas' a copy bound to every other node a multi-threaded run's threads are pinned to.
+    // With 'd_config.d_persistent' set, the file and its copies are attached from earlier runs' segments if possible.
 
   virtual int start();
     // Return 0 if all benchmarks were run and non-zero otherwise. Note a non-zero code usually indicates
-    // bad configuration.
+    // bad configuration. The base implementation loads the file and, if configured, builds 'd_keyIndex',
+    // 'd_missKeys', 'd_eraseIndex' with 'd_eraseCount', 'd_scanIndex' with 'd_scanLengths, d_scanCounts' and one
+    // 'd_scanStats' per length, builds and installs 'd_hashMemo', configures 'd_delegation', and generates
+    // 'd_workload'.
 
   virtual void report();
     // Emit to stdout collected benchmark statistics
@@ -45,13 +95,38 @@ public:
   static std::ostream& rusage(std::ostream& stream, const char *label=0);
     // Print to specified 'stream' selected rusage stats take at time of call returning stream
     // If 'label' is non-zero it's emitted to 'stream' before dumping rusage
+
+  static int parseScanLengths(const char *spec, std::vector<unsigned> *lengths);
+    // Return 0 if specified 'spec' is one or more ',' separated key counts 'length>0', e.g. '10,100,1000', assigning
+    // them in order to specified 'lengths' and non-zero otherwise.
 };
 
 inline
 Report::Report(const Config& config, const std::string& description)
 : d_config(config)
 , d_description(description)
+, d_file(config.d_persistent)
+, d_replicas(d_file)
+, d_missKeys(config.d_persistent)
+, d_eraseCount(0)
 {
+  d_findStats.setLatencySampling(config.d_latencySampling);
+  d_insertStats.setLatencySampling(config.d_latencySampling);
+  d_updateStats.setLatencySampling(config.d_latencySampling);
+  d_missStats.setLatencySampling(config.d_latencySampling);
+  d_eraseStats.setLatencySampling(config.d_latencySampling);
+  d_reinsertStats.setLatencySampling(config.d_latencySampling);
+  d_findBeforeCompactStats.setLatencySampling(config.d_latencySampling);
+  d_findAfterCompactStats.setLatencySampling(config.d_latencySampling);
+  d_xxhashStats.setLatencySampling(config.d_latencySampling);
+  d_t1haStats.setLatencySampling(config.d_latencySampling);
+  d_cityStats.setLatencySampling(config.d_latencySampling);
+  d_workloadStats.setLatencySampling(config.d_latencySampling);
+}
+
+inline
+bool Report::supportsScan() const {
+  return false;
 }
 
 } // namespace Benchmark
@@ -0,0 +1,178 @@
+#include <benchmark_scaling.h>
+
+#include <stdio.h>
+
+static double elapsedNs(const timespec& start, const timespec& end) {
+  return (double)(end.tv_sec-start.tv_sec)*1000000000.0 + (double)(end.tv_nsec-start.tv_nsec);
+}
+
+static bool before(const timespec& lhs, const timespec& rhs) {
+  return lhs.tv_sec<rhs.tv_sec || (lhs.tv_sec==rhs.tv_sec && lhs.tv_nsec<rhs.tv_nsec);
+}
+
+static void calcMinMaxAvgOps(const std::vector<double>& elapsedNs, const std::vector<u_int64_t>& iterations,
+  double ops[3]) {
+  // Calculate the minimum, maximum, and average operations per second using specified 'elapsedNs, iterations'
+  // writing results into specified 'ops' (min at index 0, max index 1, avg at index 2). 'avg' is defined as the
+  // total of all entries in 'iterations' divided by the total of all entries in 'elapsedNs'.
+  ops[0] = ops[1] = ops[2] = 0.0;
+
+  double totalNs = 0.0;
+  double totalIterations = 0.0;
+
+  for (unsigned i=0; i<elapsedNs.size(); ++i) {
+    totalNs += elapsedNs[i];
+    totalIterations += (double)iterations[i];
+
+    const double datum = (double)iterations[i]*1000000000.0/elapsedNs[i];
+    if (i==0) {
+      ops[0] = ops[1] = datum;
+    } else if (datum<ops[0]) {
+      ops[0] = datum;
+    } else if (datum>ops[1]) {
+      ops[1] = datum;
+    }
+  }
+
+  if (totalNs>0.0) {
+    ops[2] = totalIterations*1000000000.0/totalNs;
+  }
+}
+
+static void calcMinMaxAvgLatency(const std::vector<u_int64_t>& samples, const std::vector<double>& latency,
+  double& min, double& max, double& avg) {
+  // Calculate the minimum, maximum, and average of specified 'latency' over runs with non-zero specified 'samples'.
+  // 'avg' is the mean over those runs.
+  min = max = avg = 0.0;
+  unsigned runs = 0;
+
+  for (unsigned i=0; i<latency.size(); ++i) {
+    if (samples[i]==0) {
+      continue;
+    }
+    if (runs==0) {
+      min = max = latency[i];
+    } else if (latency[i]<min) {
+      min = latency[i];
+    } else if (latency[i]>max) {
+      max = latency[i];
+    }
+    avg += latency[i];
+    ++runs;
+  }
+
+  if (runs) {
+    avg /= (double)runs;
+  }
+}
+
+void Benchmark::ScalingStats::record(const char *desc, const std::vector<ScalingResult>& results) {
+  assert(!results.empty());
+  assert(d_cores.empty() || d_cores.size()==results.size());
+
+  if (d_cores.empty()) {
+    d_threadIterations.resize(results.size());
+    d_threadElapsedNs.resize(results.size());
+    for (auto& result: results) {
+      d_cores.push_back(result.d_core);
+    }
+  }
+
+  timespec start = results[0].d_start;
+  timespec end = results[0].d_end;
+  u_int64_t iterations(0);
+
+  for (unsigned i=0; i<results.size(); ++i) {
+    iterations += results[i].d_iterations;
+    if (before(results[i].d_start, start)) {
+      start = results[i].d_start;
+    }
+    if (before(end, results[i].d_end)) {
+      end = results[i].d_end;
+    }
+    d_threadIterations[i].push_back(results[i].d_iterations);
+    d_threadElapsedNs[i].push_back(elapsedNs(results[i].d_start, results[i].d_end));
+  }
+
+  d_description.push_back(desc);
+  d_iterations.push_back(iterations);
+  d_elapsedNs.push_back(elapsedNs(start, end));
+  d_latencyN.push_back(0);
+  d_latencyP50.push_back(0.0);
+  d_latencyP99.push_back(0.0);
+  d_latencyP999.push_back(0.0);
+  d_latencyMax.push_back(0.0);
+}
+
+void Benchmark::ScalingStats::record(const char *desc, const std::vector<ScalingResult>& results,
+  const Intel::LatencyRecorder& latency, double nsPerCycle) {
+  record(desc, results);
+  if (latency.samples()==0) {
+    return;
+  }
+  d_latencyN.back() = latency.samples();
+  d_latencyP50.back() = (double)latency.percentile(50.0)*nsPerCycle;
+  d_latencyP99.back() = (double)latency.percentile(99.0)*nsPerCycle;
+  d_latencyP999.back() = (double)latency.percentile(99.9)*nsPerCycle;
+  d_latencyMax.back() = (double)latency.max()*nsPerCycle;
+}
+
+void Benchmark::ScalingStats::summary(const char *label) const {
+  printf("Scaling Summary Statistics: %lu runs %lu threads: %s\n", d_description.size(), d_cores.size(), label);
+
+  double ops[3];
+  calcMinMaxAvgOps(d_elapsedNs, d_iterations, ops);
+
+  printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
+    "MPS",
+    "aggregate millions of operations per second over all threads",
+    ops[0]/1000000.0, ops[1]/1000000.0, ops[2]/1000000.0);
+
+  printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
+    "OPS",
+    "aggregate operations per second over all threads",
+    ops[0], ops[1], ops[2]);
+
+  bool sampled = false;
+  for (auto n: d_latencyN) {
+    sampled |= n>0;
+  }
+
+  if (sampled) {
+    double min, max, avg;
+    calcMinMaxAvgLatency(d_latencyN, d_latencyP50, min, max, avg);
+    printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
+      "P50",
+      "median nanoseconds per sampled operation",
+      min, max, avg);
+
+    calcMinMaxAvgLatency(d_latencyN, d_latencyP99, min, max, avg);
+    printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
+      "P99",
+      "99th percentile nanoseconds per sampled operation",
+      min, max, avg);
+
+    calcMinMaxAvgLatency(d_latencyN, d_latencyP999, min, max, avg);
+    printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
+      "P3N",
+      "99.9th percentile nanoseconds per sampled operation",
+      min, max, avg);
+
+    calcMinMaxAvgLatency(d_latencyN, d_latencyMax, min, max, avg);
+    printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
+      "PMX",
+      "maximum nanoseconds per sampled operation",
+      min, max, avg);
+  }
+
+  for (unsigned i=0; i<d_cores.size(); ++i) {
+    char mnemonic[16];
+    char description[128];
+    snprintf(mnemonic, sizeof(mnemonic), "T%u", i);
+    snprintf(description, sizeof(description), "thread %u on core %d millions of operations per second", i,
+      d_cores[i]);
+    calcMinMaxAvgOps(d_threadElapsedNs[i], d_threadIterations[i], ops);
+    printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
+      mnemonic, description, ops[0]/1000000.0, ops[1]/1000000.0, ops[2]/1000000.0);
+  }
+}
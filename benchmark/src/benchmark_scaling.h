@@ -0,0 +1,262 @@
+#pragma once
+
+// PURPOSE: Run one benchmark phase over many pinned threads
+//
+// CLASSES:
+//  Benchmark::ScalingResult: What one thread did in one multi-threaded run
+//  Benchmark::ScalingStats:  Per-thread and aggregate throughput, and optionally per-operation latency, collected
+//                            over multi-threaded runs
+//  Benchmark::Scaling:       Partition a loaded file's keys across pinned threads running one operation per key, or
+//                            two operations each on its own threads
+
+#include <benchmark_config.h>
+#include <benchmark_loadfile.h>
+#include <benchmark_numa.h>
+#include <benchmark_slice.h>
+#include <benchmark_textscan.h>
+
+#include <intel_latency_recorder.h>
+#include <intel_skylake_pmu.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+#include <assert.h>
+#include <sys/types.h>
+
+namespace Benchmark {
+
+struct ScalingResult {
+  // DATA
+  int         d_core;         // cpu coreId thread ran on
+  u_int64_t   d_iterations;   // number of operations thread ran
+  timespec    d_start;        // time thread started its first operation
+  timespec    d_end;          // time thread finished its last operation
+};
+
+class ScalingStats {
+  // DATA
+  std::vector<std::string>          d_description;        // per run: description e.g. 'find run 0'
+  std::vector<u_int64_t>            d_iterations;         // per run: operations over all threads
+  std::vector<double>               d_elapsedNs;          // per run: first thread start to last thread end
+  std::vector<int>                  d_cores;              // per thread: coreId
+  std::vector<std::vector<u_int64_t>> d_threadIterations; // per thread per run: operations
+  std::vector<std::vector<double>>  d_threadElapsedNs;    // per thread per run: elapsed time
+  std::vector<u_int64_t>            d_latencyN;           // per run: number of latency samples over all threads
+  std::vector<double>               d_latencyP50;         // per run: median sampled latency in nanoseconds
+  std::vector<double>               d_latencyP99;         // per run: 99th percentile sampled latency in nanoseconds
+  std::vector<double>               d_latencyP999;        // per run: 99.9th percentile sampled latency in nanoseconds
+  std::vector<double>               d_latencyMax;         // per run: largest sampled latency in nanoseconds
+
+public:
+  // CREATORS
+  ScalingStats() = default;
+    // Create a ScalingStats object containing no data
+
+  ScalingStats(const ScalingStats& other) = delete;
+    // Copy constructor not provided
+
+  ~ScalingStats() = default;
+    // Destroy this object
+
+  // ACCESSORS
+  bool empty() const;
+    // Return true if no results were recorded and false otherwise
+
+  // MANIPULATORS
+  void record(const char *desc, const std::vector<ScalingResult>& results);
+    // Record specified 'results' of one run described by specified 'desc'. A thread which ran no operations, e.g. a
+    // delegation owner whose shard no key maps to, counts 0 operations per second. Behavior is defined provided
+    // every run recorded has the same number of threads.
+
+  void record(const char *desc, const std::vector<ScalingResult>& results, const Intel::LatencyRecorder& latency,
+    double nsPerCycle);
+    // Record the same data as above plus the p50, p99, p99.9 and max per-operation latency over all threads sampled
+    // by specified 'latency' converted from 'rdtsc' cycles to nanoseconds by multiplying by specified 'nsPerCycle'
+
+  void reset();
+    // Discard all collected results
+
+  ScalingStats& operator=(const ScalingStats& rhs) = delete;
+    // Assignment operator not provided
+
+  // ASPECTS
+  void summary(const char *label) const;
+    // Print to stdout a human readable summary of all results collected with 'record'. The aggregate throughput
+    // over all threads is given first followed by sampled latency if any and each thread's throughput. Specified
+    // 'label' gives context.
+};
+
+class Scaling {
+public:
+  // STATIC FUNCTIONS
+  template<typename T, typename OP>
+  static void run(const char *desc, const Config& config, const NumaReplicas& files, ScalingStats& stats, OP op);
+    // Run 'config.d_threads' threads each pinned to 'config.threadCore(thread)'. Thread 'i' of 'n' calls
+    // 'op(i, word)' for each word in the i-th of n contiguous, similarly sized parts of the words in specified
+    // 'files'. Each thread reads the copy of the file local to its core's NUMA node if there is one. Threads position their scanners before a common start signal so only 'op' is timed. Results are
+    // recorded in specified 'stats' under specified 'desc' after all threads finish. 'op' must be safe to call
+    // concurrently from different threads.
+
+  template<typename T, typename WRITE, typename READ>
+  static void runMixed(const char *desc, const Config& config, const NumaReplicas& files, ScalingStats& writeStats,
+    ScalingStats& readStats, WRITE write, READ read);
+    // Run 'config.d_threads' pinned threads as 'run' does except the first 'config.d_writers' call 'write(i, word)'
+    // and the rest call 'read(i, word)'. Writers split all the words among themselves as 'run' splits them among
+    // all threads, and so do readers, so each word is written once and read once at the same time. Writers' results
+    // are recorded in specified 'writeStats' and readers' in specified 'readStats' under specified 'desc'. Behavior
+    // is defined provided '0<config.d_writers<config.d_threads'.
+};
+
+// INLINE DEFINITIONS
+// ACCESSORS
+inline
+bool ScalingStats::empty() const {
+  return d_description.empty();
+}
+
+// MANIPULATORS
+inline
+void ScalingStats::reset() {
+  d_description.clear();
+  d_iterations.clear();
+  d_elapsedNs.clear();
+  d_cores.clear();
+  d_threadIterations.clear();
+  d_threadElapsedNs.clear();
+  d_latencyN.clear();
+  d_latencyP50.clear();
+  d_latencyP99.clear();
+  d_latencyP999.clear();
+  d_latencyMax.clear();
+}
+
+// STATIC FUNCTIONS
+template<typename T, typename OP>
+void Scaling::run(const char *desc, const Config& config, const NumaReplicas& files, ScalingStats& stats, OP op) {
+  assert(config.d_threads>0);
+
+  const unsigned threads = config.d_threads;
+  const unsigned available = TextScan<T>(files.primary()).available();
+
+  std::atomic<unsigned> ready(0);
+  std::atomic<bool> go(false);
+  std::vector<ScalingResult> results(threads);
+  std::vector<std::thread> workers;
+
+  for (unsigned i=0; i<threads; ++i) {
+    workers.emplace_back([&, i]() {
+      ScalingResult& result = results[i];
+      result.d_core = config.threadCore(i);
+      Intel::SkyLake::PMU::pinToHWCore(result.d_core);
+
+      // Position scanner on first word of this thread's part
+      const unsigned begin = static_cast<unsigned>((u_int64_t)available*i/threads);
+      const unsigned end = static_cast<unsigned>((u_int64_t)available*(i+1)/threads);
+      Slice<T> word;
+      TextScan<T> scanner(files.forCore(result.d_core));
+      for (unsigned j=0; j<begin; ++j) {
+        scanner.next(word);
+      }
+
+      ++ready;
+      while (!go.load(std::memory_order_acquire)) {
+      }
+
+      timespec_get(&result.d_start, TIME_UTC);
+
+      // Benchmark running: do op over this thread's part
+      for (unsigned j=begin; j<end; ++j) {
+        scanner.next(word);
+        op(i, word);
+      }
+
+      timespec_get(&result.d_end, TIME_UTC);
+      result.d_iterations = end-begin;
+    });
+  }
+
+  while (ready.load()!=threads) {
+  }
+  go.store(true, std::memory_order_release);
+
+  for (auto& worker: workers) {
+    worker.join();
+  }
+
+  stats.record(desc, results);
+}
+
+template<typename T, typename WRITE, typename READ>
+void Scaling::runMixed(const char *desc, const Config& config, const NumaReplicas& files, ScalingStats& writeStats,
+  ScalingStats& readStats, WRITE write, READ read) {
+  assert(config.d_writers>0);
+  assert(config.d_writers<config.d_threads);
+
+  const unsigned threads = config.d_threads;
+  const unsigned writers = config.d_writers;
+  const unsigned available = TextScan<T>(files.primary()).available();
+
+  std::atomic<unsigned> ready(0);
+  std::atomic<bool> go(false);
+  std::vector<ScalingResult> results(threads);
+  std::vector<std::thread> workers;
+
+  for (unsigned i=0; i<threads; ++i) {
+    workers.emplace_back([&, i]() {
+      ScalingResult& result = results[i];
+      result.d_core = config.threadCore(i);
+      Intel::SkyLake::PMU::pinToHWCore(result.d_core);
+
+      // Position scanner on first word of this thread's part of its role's words
+      const bool writer = i<writers;
+      const unsigned part = writer ? i : i-writers;
+      const unsigned parts = writer ? writers : threads-writers;
+      const unsigned begin = static_cast<unsigned>((u_int64_t)available*part/parts);
+      const unsigned end = static_cast<unsigned>((u_int64_t)available*(part+1)/parts);
+      Slice<T> word;
+      TextScan<T> scanner(files.forCore(result.d_core));
+      for (unsigned j=0; j<begin; ++j) {
+        scanner.next(word);
+      }
+
+      ++ready;
+      while (!go.load(std::memory_order_acquire)) {
+      }
+
+      timespec_get(&result.d_start, TIME_UTC);
+
+      // Benchmark running: do this thread's role over its part
+      if (writer) {
+        for (unsigned j=begin; j<end; ++j) {
+          scanner.next(word);
+          write(i, word);
+        }
+      } else {
+        for (unsigned j=begin; j<end; ++j) {
+          scanner.next(word);
+          read(i, word);
+        }
+      }
+
+      timespec_get(&result.d_end, TIME_UTC);
+      result.d_iterations = end-begin;
+    });
+  }
+
+  while (ready.load()!=threads) {
+  }
+  go.store(true, std::memory_order_release);
+
+  for (auto& worker: workers) {
+    worker.join();
+  }
+
+  writeStats.record(desc, std::vector<ScalingResult>(results.begin(), results.begin()+writers));
+  readStats.record(desc, std::vector<ScalingResult>(results.begin()+writers, results.end()));
+}
+
+} // namespace Benchmark
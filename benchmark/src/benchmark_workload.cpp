@@ -0,0 +1,186 @@
+#include <benchmark_workload.h>
+#include <benchmark_zipfian.h>
+
+#include <random>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+Benchmark::Workload::Workload()
+: d_distribution(e_UNIFORM)
+, d_preloaded(0)
+{
+  for (unsigned i=0; i<e_OP_TYPES; ++i) {
+    d_percent[i] = 0;
+    d_count[i] = 0;
+  }
+}
+
+const char *Benchmark::Workload::opName(unsigned type) {
+  switch (type) {
+    case e_READ:   return "read";
+    case e_UPDATE: return "update";
+    case e_INSERT: return "insert";
+    case e_SCAN:   return "scan";
+    case e_RMW:    return "read-modify-write";
+    default:       break;
+  }
+  return "unknown";
+}
+
+int Benchmark::Workload::configure(const std::string& spec, const std::string& distribution) {
+  unsigned percent[e_OP_TYPES] = {0, 0, 0, 0, 0};
+  Distribution dist = e_UNIFORM;
+
+  if (spec.size()==1) {
+    // YCSB core workloads
+    switch (tolower(spec[0])) {
+      case 'a': percent[e_READ] = 50; percent[e_UPDATE] = 50; dist = e_ZIPFIAN; break;
+      case 'b': percent[e_READ] = 95; percent[e_UPDATE] = 5;  dist = e_ZIPFIAN; break;
+      case 'c': percent[e_READ] = 100;                        dist = e_ZIPFIAN; break;
+      case 'd': percent[e_READ] = 95; percent[e_INSERT] = 5;  dist = e_LATEST;  break;
+      case 'e': percent[e_SCAN] = 95; percent[e_INSERT] = 5;  dist = e_ZIPFIAN; break;
+      case 'f': percent[e_READ] = 50; percent[e_RMW] = 50;    dist = e_ZIPFIAN; break;
+      default:  return 1;
+    }
+  } else {
+    // '<percent><type>[:<percent><type>]*'
+    unsigned total = 0;
+    const char *ptr = spec.c_str();
+    while (*ptr) {
+      char *end = 0;
+      const long value = strtol(ptr, &end, 10);
+      if (end==ptr || value<=0 || value>100) {
+        return 1;
+      }
+      int type = -1;
+      switch (*end) {
+        case 'r': type = e_READ;   break;
+        case 'u': type = e_UPDATE; break;
+        case 'i': type = e_INSERT; break;
+        case 's': type = e_SCAN;   break;
+        case 'm': type = e_RMW;    break;
+        default:  return 1;
+      }
+      percent[type] += (unsigned)value;
+      total += (unsigned)value;
+      ptr = end+1;
+      if (*ptr==':') {
+        ++ptr;
+      } else if (*ptr) {
+        return 1;
+      }
+    }
+    if (total!=100) {
+      return 1;
+    }
+  }
+
+  if (distribution=="uniform") {
+    dist = e_UNIFORM;
+  } else if (distribution=="zipfian") {
+    dist = e_ZIPFIAN;
+  } else if (distribution=="latest") {
+    dist = e_LATEST;
+  } else if (!distribution.empty()) {
+    return 1;
+  }
+
+  d_spec = spec;
+  d_distribution = dist;
+  for (unsigned i=0; i<e_OP_TYPES; ++i) {
+    d_percent[i] = percent[i];
+  }
+
+  return 0;
+}
+
+int Benchmark::Workload::generate(const LoadFile& file, u_int64_t seed) {
+  d_keys.free();
+  d_ops.clear();
+  d_preloaded = 0;
+  for (unsigned i=0; i<e_OP_TYPES; ++i) {
+    d_count[i] = 0;
+  }
+
+  // Same words in the same order as every other phase
+  if (d_keys.build(file, KeyIndex::e_FILE, 0)!=0) {
+    return 1;
+  }
+
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<unsigned> percentDist(0, 99);
+  std::uniform_int_distribution<unsigned> scanDist(1, k_MAX_SCAN_LENGTH);
+  std::uniform_real_distribution<double> unitDist(0.0, 1.0);
+
+  // First choose every operation's type so the number of inserts, and hence which keys must be held back from
+  // preload, is known before keys are chosen
+  d_ops.resize(d_keys.size());
+  for (auto& item: d_ops) {
+    unsigned pick = percentDist(rng);
+    unsigned type = 0;
+    while (pick>=d_percent[type]) {
+      pick -= d_percent[type];
+      ++type;
+    }
+    assert(type<e_OP_TYPES);
+    item.d_type = static_cast<u_int16_t>(type);
+    item.d_length = 0;
+    ++d_count[type];
+  }
+
+  d_preloaded = static_cast<unsigned>(d_keys.size()-d_count[e_INSERT]);
+
+  // Then choose keys. 'inserted' grows as inserts are issued so later operations may pick newer keys.
+  Zipfian zipfian(0.99);
+  u_int64_t inserted = d_preloaded;
+  for (auto& item: d_ops) {
+    if (item.d_type==e_INSERT) {
+      item.d_key = static_cast<u_int32_t>(inserted++);
+      continue;
+    }
+
+    // Operations before the first insert into an empty structure have no key to use; only possible for a mix
+    // of 100% inserts which never gets here
+    assert(inserted>0);
+
+    switch (d_distribution) {
+      case e_UNIFORM:
+        item.d_key = static_cast<u_int32_t>(unitDist(rng)*(double)inserted);
+        break;
+      case e_ZIPFIAN:
+        item.d_key = static_cast<u_int32_t>(Zipfian::scatter(zipfian.next(inserted, unitDist(rng))) % inserted);
+        break;
+      case e_LATEST:
+        item.d_key = static_cast<u_int32_t>(inserted-1-zipfian.next(inserted, unitDist(rng)));
+        break;
+    }
+    if (item.d_key>=inserted) {
+      item.d_key = static_cast<u_int32_t>(inserted-1);
+    }
+
+    if (item.d_type==e_SCAN) {
+      item.d_length = static_cast<u_int16_t>(scanDist(rng));
+    }
+  }
+
+  return 0;
+}
+
+void Benchmark::Workload::print() const {
+  static const char *distName[] = { "uniform", "zipfian", "latest" };
+
+  printf("workload: {\n");
+  printf("  mix          : \"%s\"\n", d_spec.c_str());
+  printf("  distribution : \"%s\"\n", distName[d_distribution]);
+  printf("  keys         : %lu,\n", d_keys.size());
+  printf("  preloaded    : %u,\n", d_preloaded);
+  for (unsigned i=0; i<e_OP_TYPES; ++i) {
+    if (d_count[i]) {
+      printf("  %-13s: %lu (%u%%),\n", opName(i), d_count[i], d_percent[i]);
+    }
+  }
+  printf("}\n");
+}
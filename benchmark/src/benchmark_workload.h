@@ -0,0 +1,185 @@
+#pragma once
+
+// PURPOSE: YCSB-style mixed workloads over the keys of a loaded file
+//
+// CLASSES:
+//  Benchmark::WorkloadOp: One precomputed operation: what to do and on which key
+//  Benchmark::Workload:   Parse a mix spec, precompute an interleaved operation stream, and time it
+
+#include <benchmark_keyindex.h>
+#include <benchmark_loadfile.h>
+#include <benchmark_slice.h>
+
+#include <intel_pmu_stats.h>
+#include <intel_latency_recorder.h>
+#include <intel_skylake_pmu.h>
+
+#include <string>
+#include <vector>
+
+#include <time.h>
+#include <assert.h>
+#include <sys/types.h>
+
+namespace Benchmark {
+
+struct WorkloadOp {
+  // DATA
+  u_int32_t   d_key;          // index of key in 'Workload::key'
+  u_int16_t   d_type;         // one of 'Workload::OpType'
+  u_int16_t   d_length;       // number of keys to visit for 'e_SCAN' and 0 otherwise
+};
+
+class Workload {
+public:
+  // ENUMS
+  enum OpType {
+    e_READ    = 0,            // exact match find of an existing key
+    e_UPDATE  = 1,            // overwrite an existing key
+    e_INSERT  = 2,            // insert the next key not yet inserted
+    e_SCAN    = 3,            // visit 'd_length' keys in order starting at the first key >= an existing key
+    e_RMW     = 4,            // read then update the same existing key
+    e_OP_TYPES= 5,
+  };
+
+  enum Distribution {
+    e_UNIFORM = 0,            // every existing key equally likely
+    e_ZIPFIAN = 1,            // few hot keys scattered across the file
+    e_LATEST  = 2,            // most recently inserted keys hottest
+  };
+
+  enum {
+    k_MAX_SCAN_LENGTH = 100,  // scan lengths are uniform in [1, k_MAX_SCAN_LENGTH]
+  };
+
+private:
+  // DATA
+  std::string             d_spec;                   // mix as given e.g. '95r:5u' or 'a'
+  unsigned                d_percent[e_OP_TYPES];    // percent of operations of each type summing to 100
+  Distribution            d_distribution;           // how existing keys are chosen
+  KeyIndex                d_keys;                   // each key in file order
+  std::vector<WorkloadOp> d_ops;                    // interleaved operation stream run each time
+  unsigned                d_preloaded;              // keys '[0, d_preloaded)' are inserted before timing
+  u_int64_t               d_count[e_OP_TYPES];      // number of operations of each type in 'd_ops'
+
+public:
+  // CREATORS
+  Workload();
+    // Create an empty Workload. Call 'configure, generate' before use.
+
+  Workload(const Workload& other) = delete;
+    // Copy constructor not provided
+
+  ~Workload() = default;
+    // Destroy this object
+
+  // ACCESSORS
+  bool empty() const;
+    // Return true if there are no operations to run and false otherwise
+
+  const std::string& spec() const;
+    // Return the mix spec given to 'configure'
+
+  Distribution distribution() const;
+    // Return the key choice distribution
+
+  bool has(OpType type) const;
+    // Return true if the mix contains operations of specified 'type' and false otherwise
+
+  unsigned preloaded() const;
+    // Return the number of keys inserted by 'preload' before 'run'
+
+  template<typename T, typename OP>
+  void preload(OP op) const;
+    // Call 'op(e_INSERT, key, 0)' for each of the first 'preloaded()' keys in file order. This is not timed.
+
+  template<typename T, typename OP>
+  void run(const char *desc, Intel::Stats& stats, OP op) const;
+    // Time 'op(type, key, length)' for each operation in order recording results in specified 'stats' under
+    // specified 'desc'. 'type' is an 'OpType' and 'length' is the scan length for 'e_SCAN' and 0 otherwise. Behavior
+    // is defined provided 'preload' was called on the same data structure first.
+
+  void print() const;
+    // Pretty-print the mix, distribution and per-type operation counts to stdout
+
+  // MANIPULATORS
+  int configure(const std::string& spec, const std::string& distribution);
+    // Return 0 if specified 'spec' and 'distribution' are valid and non-zero otherwise. 'spec' is either one of the
+    // YCSB core workloads 'a'..'f' or a ':' separated list of '<percent><type>' where 'type' is 'r' (read), 'u'
+    // (update), 'i' (insert), 's' (scan) or 'm' (read-modify-write) and percents sum to 100 e.g. '95r:5u'.
+    // 'distribution' is 'uniform', 'zipfian', 'latest', or empty for the core workload's (else uniform).
+
+  int generate(const LoadFile& file, u_int64_t seed);
+    // Return 0 if an operation stream with one operation per key in specified 'file' was generated using a random
+    // number generator seeded with specified 'seed' and non-zero otherwise. Keys needed by inserts are held back
+    // from 'preload'. The same 'seed' and 'file' always give the same stream.
+
+  Workload& operator=(const Workload& rhs) = delete;
+    // Assignment operator not provided
+
+  // STATIC FUNCTIONS
+  static const char *opName(unsigned type);
+    // Return a human readable name of specified 'type'
+};
+
+// INLINE DEFINITIONS
+// ACCESSORS
+inline
+bool Workload::empty() const {
+  return d_ops.empty();
+}
+
+inline
+const std::string& Workload::spec() const {
+  return d_spec;
+}
+
+inline
+Workload::Distribution Workload::distribution() const {
+  return d_distribution;
+}
+
+inline
+bool Workload::has(OpType type) const {
+  return d_percent[type]>0;
+}
+
+inline
+unsigned Workload::preloaded() const {
+  return d_preloaded;
+}
+
+template<typename T, typename OP>
+void Workload::preload(OP op) const {
+  for (unsigned i=0; i<d_preloaded; ++i) {
+    Slice<T> key(d_keys[i]);
+    op(e_INSERT, key, 0);
+  }
+}
+
+template<typename T, typename OP>
+void Workload::run(const char *desc, Intel::Stats& stats, OP op) const {
+  assert(!d_ops.empty());
+
+  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
+  Intel::LatencyRecorder latency(stats.latencySampling());
+
+  timespec startTime;
+  timespec endTime;
+  pmu.reset();
+  timespec_get(&startTime, TIME_UTC);
+  pmu.start();
+
+  // Benchmark running: do interleaved operations
+  for (const auto& item: d_ops) {
+    Slice<T> key(d_keys[item.d_key]);
+    latency.begin();
+    op(item.d_type, key, item.d_length);
+    latency.end();
+  }
+
+  timespec_get(&endTime, TIME_UTC);
+  stats.record(desc, d_ops.size(), startTime, endTime, pmu, latency);
+}
+
+} // namespace Benchmark
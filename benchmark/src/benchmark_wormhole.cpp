@@ -1,104 +1,157 @@
 #include <benchmark_wormhole.h>
-#include <benchmark_hashable_keys.h>
-#include <benchmark_textscan.h>
+#include <benchmark_adapter.h>
+#include <benchmark_driver.h>
 
 #include "lib.h"
 #include "kv.h"
 #include <wh.h>
 
-#include <intel_skylake_pmu.h>
-
-template<typename T>
-static int wormhole_test_text_insert(unsigned runNumber, T* map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  char label[128];
-  snprintf(label, sizeof(label), "insert run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-  
-  // Benchmark running: do insert
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    wh_put(map, word.data(), word.size(), 0, 0); 
-  }
+#include <vector>
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+#include <string.h>
 
-  return 0;
-}
+namespace {
+
+class WormHoleAdapter: public Benchmark::AdapterBase<WormHoleAdapter> {
+  // Wormhole holding keys with empty values. wh_* is the thread-safe wormhole API provided each thread has its own
+  // reference so 'threads' makes one per thread.
+
+  // DATA
+  struct wormhole                *d_wh;
+  struct wormref                 *d_ref;      // reference used from the calling thread
+  struct wormhole_iter           *d_iter;     // made on first scan; parked between scans so it holds no lock
+  std::vector<struct wormref*>    d_refs;     // one reference per thread
+
+public:
+  // TYPES
+  typedef char KeyType;
 
-template<typename T>
-static int wormhole_test_text_find(unsigned runNumber, T* map, Intel::Stats& stats, const Benchmark::LoadFile& file) {
-  Benchmark::Slice<char> word;
-  Benchmark::TextScan<char> scanner(file);
-  Intel::SkyLake::PMU pmu(false, Intel::SkyLake::PMU::ProgCounterSetConfig::k_DEFAULT_SKYLAKE_CONFIG_0);
-
-  unsigned int errors(0);
-  char label[128];
-  snprintf(label, sizeof(label), "find run %u", runNumber);
-
-  timespec startTime;
-  timespec endTime;
-  pmu.reset();
-  timespec_get(&startTime, TIME_UTC);
-  pmu.start();
-
-  // Benchmark running: do find
-  for (scanner.next(word); !scanner.eof(); scanner.next(word)) {
-    auto val = wh_probe(map, word.data(), word.size());
-    if (val==0) {
-      ++errors;
+  // ENUMS
+  enum {
+    k_CAN_ERASE = 1,
+    k_CAN_SCAN  = 1,
+    k_MT_INSERT = 1,
+  };
+
+  // CREATORS
+  explicit WormHoleAdapter(const Benchmark::Config&)
+  : d_wh(wh_create())
+  , d_ref(wh_ref(d_wh))
+  , d_iter(0)
+  {
+  }
+
+  ~WormHoleAdapter() {
+    if (d_iter) {
+      wh_iter_destroy(d_iter);
+    }
+    for (auto ref: d_refs) {
+      wh_unref(ref);
     }
+    wh_unref(d_ref);
+    wh_clean(d_wh);
+    wh_destroy(d_wh);
   }
 
-  timespec_get(&endTime, TIME_UTC);
-  stats.record(label, scanner.index(), startTime, endTime, pmu);
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<char>& key) {
+    return wh_put(d_ref, key.data(), key.size(), 0, 0);
+  }
 
-  if (errors) {
-    printf("searchErrors: %u\n", errors);
+  bool find(Benchmark::Slice<char>& key) {
+    return wh_probe(d_ref, key.data(), key.size());
   }
 
-  return 0;
-}
+  bool update(Benchmark::Slice<char>& key) {
+    return wh_put(d_ref, key.data(), key.size(), 0, 0);
+  }
 
-int Benchmark::WormHole::start() {
-  // Default start is to load file                                                                                      
-  int rc = Benchmark::Report::start();                                                                                  
-  if (rc!=0) {                                                                                                          
-    return rc;                                                                                                          
+  bool erase(Benchmark::Slice<char>& key) {
+    return wh_del(d_ref, key.data(), key.size());
   }
 
-  if (d_config.d_format == "bin-text-kv") {
-    // We have KV pairs to play with
-    // Not implemented yet
-    return rc;
-  } else if (d_config.d_format=="bin-text") {
-    // We have a text file therefore we can only benchamrk key ins/upd/fnd/del on keys.
-    // Make a cuckoo map with the smallest possible value type (bool) and set it to a 
-    // constant value throughout all tests.
-    if (d_config.d_customAllocator) {
-      return rc;
-    } else {
-      for (unsigned i=0; i<d_config.d_runs; ++i) {
-        if (d_config.d_verbosity>0) {
-          printf("execute run set %u...\n", i);
-        }
-        struct wormhole * const wh = wh_create();
-        struct wormref * const ref = wh_ref(wh);
-        wormhole_test_text_insert(i, ref, d_insertStats, d_file);
-        wormhole_test_text_find(i, ref, d_findStats, d_file);
-        rusage(std::cout);
-        wh_clean(wh);
-        wh_destroy(wh);
-      }
+  unsigned scan(Benchmark::Slice<char>& key, unsigned length) {
+    if (!d_iter) {
+      d_iter = wh_iter_create(d_ref);
     }
+    char buffer[256];
+    u32 klen(0);
+    unsigned i(0);
+    wh_iter_seek(d_iter, key.data(), key.size());
+    for (; i<length && wh_iter_valid(d_iter); ++i) {
+      wh_iter_peek(d_iter, buffer, sizeof(buffer), &klen, 0, 0, 0);
+      Intel::DoNotOptimize(klen);
+      wh_iter_skip1(d_iter);
+    }
+    wh_iter_park(d_iter);
+    return i;
+  }
+
+  void threads(unsigned count) {
+    while (d_refs.size()<count) {
+      d_refs.push_back(wh_ref(d_wh));
+    }
+  }
+
+  bool findMT(unsigned thread, Benchmark::Slice<char>& key) {
+    return wh_probe(d_refs[thread], key.data(), key.size());
   }
-  return rc;
+
+  bool insertMT(unsigned thread, Benchmark::Slice<char>& key) {
+    return wh_put(d_refs[thread], key.data(), key.size(), 0, 0);
+  }
+};
+
+class WormHoleKVAdapter: public Benchmark::AdapterBase<WormHoleKVAdapter> {
+  // Wormhole natively stores a copy of each value
+
+  // DATA
+  struct wormhole  *d_wh;
+  struct wormref   *d_ref;
+
+public:
+  // TYPES
+  typedef char KeyType;
+
+  // ENUMS
+  enum {
+    k_VALUES = 1,
+  };
+
+  // CREATORS
+  explicit WormHoleKVAdapter(const Benchmark::Config&)
+  : d_wh(wh_create())
+  , d_ref(wh_ref(d_wh))
+  {
+  }
+
+  ~WormHoleKVAdapter() {
+    wh_unref(d_ref);
+    wh_clean(d_wh);
+    wh_destroy(d_wh);
+  }
+
+  // MANIPULATORS
+  bool insert(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    return wh_put(d_ref, key.data(), key.size(), value.data(), value.size());
+  }
+
+  bool find(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    // Values are at most 0xffff bytes. wh_get copies the value out
+    static char buffer[0x10000];
+    u32 size(0);
+    return wh_get(d_ref, key.data(), key.size(), buffer, sizeof(buffer), &size) && size==value.size() &&
+           0==memcmp(buffer, value.data(), size);
+  }
+
+  bool update(Benchmark::Slice<char>& key, Benchmark::Slice<char>& value) {
+    // wh_put replaces the existing kv object
+    return wh_put(d_ref, key.data(), key.size(), value.data(), value.size());
+  }
+};
+
+} // anonymous namespace
+
+int Benchmark::WormHole::run(const Config& config, const std::string& description) {
+  return Dispatch::plain<WormHoleAdapter, WormHoleKVAdapter>(config, description);
 }
@@ -2,24 +2,17 @@
 
 // PURPOSE: Benchmark Wormhole
 
-#include <benchmark_report.h>
+#include <benchmark_config.h>
 
-namespace Benchmark {
-
-class WormHole: public Report {
-public:
-  // CREATORS
-  WormHole(const Config& config, const std::string& description)
-  : Report(config, description)
-  {
-  }
+#include <string>
 
-  virtual ~WormHole() = default;
+namespace Benchmark {
 
-  // MANIPULATORS
-  virtual int start();
-    // Return 0 if all benchmarks were run and non-zero otherwise. Note a non-zero code usually indicates
-    // bad configuration.
+struct WormHole {
+  // STATIC FUNCTIONS
+  static int run(const Config& config, const std::string& description);
+    // Return 0 if all benchmarks per specified 'config' were run then reported under specified 'description' and
+    // non-zero otherwise. Note a non-zero code usually indicates bad configuration.
 };
 
 } // namespace Benchmark
@@ -0,0 +1,90 @@
+#pragma once
+
+// PURPOSE: Zipfian rank generator shared by workloads and key orders
+//
+// CLASSES:
+//  Benchmark::Zipfian: Gray et al. 'Quickly Generating Billion-Record Synthetic Databases' as used by YCSB
+
+#include <assert.h>
+#include <math.h>
+#include <sys/types.h>
+
+namespace Benchmark {
+
+class Zipfian {
+  // Item count may grow one at a time; zeta is extended incrementally so growth costs O(1) per new item.
+
+  // DATA
+  double      d_theta;
+  double      d_alpha;
+  double      d_zeta2;
+  double      d_zetan;
+  double      d_eta;
+  u_int64_t   d_items;
+
+public:
+  // CREATORS
+  explicit Zipfian(double theta);
+    // Create a Zipfian generator with skew specified 'theta' in '(0, 1)'. YCSB uses 0.99.
+
+  // MANIPULATORS
+  u_int64_t next(u_int64_t items, double u);
+    // Return a rank in '[0, items)' where rank 0 is the most popular using specified uniform 'u' in '[0, 1)'. The
+    // behavior is defined provided 'items>0' and 'items' is at least the value given in the previous call.
+
+  // STATIC FUNCTIONS
+  static u_int64_t scatter(u_int64_t rank);
+    // Return FNV-1a hash of specified 'rank'. Taken modulo the item count it spreads hot ranks across the items
+    // instead of crowding them at the front.
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+inline
+Zipfian::Zipfian(double theta)
+: d_theta(theta)
+, d_alpha(1.0/(1.0-theta))
+, d_zeta2(1.0+pow(0.5, theta))
+, d_zetan(0.0)
+, d_eta(0.0)
+, d_items(0)
+{
+}
+
+// MANIPULATORS
+inline
+u_int64_t Zipfian::next(u_int64_t items, double u) {
+  assert(items>0);
+  assert(items>=d_items);
+  if (items!=d_items) {
+    for (u_int64_t i=d_items; i<items; ++i) {
+      d_zetan += 1.0/pow((double)(i+1), d_theta);
+    }
+    d_items = items;
+    d_eta = (1.0-pow(2.0/(double)items, 1.0-d_theta))/(1.0-d_zeta2/d_zetan);
+  }
+
+  const double uz = u*d_zetan;
+  if (uz<1.0) {
+    return 0;
+  }
+  if (uz<d_zeta2) {
+    return items>1 ? 1 : 0;
+  }
+  const u_int64_t rank = (u_int64_t)((double)items*pow(d_eta*u-d_eta+1.0, d_alpha));
+  return rank<items ? rank : items-1;
+}
+
+// STATIC FUNCTIONS
+inline
+u_int64_t Zipfian::scatter(u_int64_t rank) {
+  u_int64_t hash = 0xCBF29CE484222325ULL;
+  for (unsigned i=0; i<8; ++i) {
+    hash ^= rank & 0xff;
+    hash *= 0x100000001B3ULL;
+    rank >>= 8;
+  }
+  return hash;
+}
+
+} // namespace Benchmark
@@ -0,0 +1,28 @@
+#include <intel_latency_recorder.h>
+
+u_int64_t Intel::LatencyRecorder::percentile(double pct) const {
+  assert(pct>0.0 && pct<=100.0);
+
+  if (d_samples==0) {
+    return 0;
+  }
+
+  u_int64_t target = static_cast<u_int64_t>(pct/100.0*(double)d_samples + 0.5);
+  if (target==0) {
+    target = 1;
+  } else if (target>d_samples) {
+    target = d_samples;
+  }
+
+  u_int64_t seen(0);
+  for (unsigned i=0; i<k_BUCKETS; ++i) {
+    seen += d_count[i];
+    if (seen>=target) {
+      // Never report more than the exact max: the last bucket's upper bound may exceed it
+      const u_int64_t value = highestEquivalentValue(i);
+      return value<d_max ? value : d_max;
+    }
+  }
+
+  return d_max;
+}
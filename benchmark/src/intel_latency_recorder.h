@@ -0,0 +1,185 @@
+#pragma once
+
+// PURPOSE: Low overhead per-operation latency histogram
+//
+// CLASSES:
+//  Intel::LatencyRecorder: Time every Nth operation with 'rdtsc' into HDR-style log-linear buckets
+
+#include <x86intrin.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/types.h>
+
+namespace Intel {
+
+class LatencyRecorder {
+public:
+  // ENUMS
+  enum {
+    k_SUB_BUCKET_BITS = 5,                              // each power of 2 is split into 2^5 linear buckets
+    k_SUB_BUCKETS     = 1<<k_SUB_BUCKET_BITS,           // so any value is bucketed within ~3% of its true value
+    k_BUCKETS         = (64-k_SUB_BUCKET_BITS+1)*k_SUB_BUCKETS,
+  };
+
+private:
+  // DATA
+  u_int64_t   d_count[k_BUCKETS];   // number of samples per bucket
+  u_int64_t   d_samples;            // total number of samples
+  u_int64_t   d_max;                // largest sample exactly
+  u_int64_t   d_start;              // 'rdtsc' at 'begin' of the operation being sampled
+  unsigned    d_every;              // sample 1 in 'd_every' operations; 0 disables sampling
+  unsigned    d_countdown;          // operations until next sample
+  bool        d_active;             // true if the current operation is being sampled
+
+public:
+  // CREATORS
+  explicit LatencyRecorder(unsigned every);
+    // Create a LatencyRecorder sampling one in specified 'every' operations. 'every=1' samples all operations and
+    // 'every=0' disables recording so that 'begin, end' cost one predictable branch each.
+
+  LatencyRecorder(const LatencyRecorder& other) = delete;
+    // Copy constructor not provided
+
+  ~LatencyRecorder() = default;
+    // Destroy this object
+
+  // ACCESSORS
+  unsigned every() const;
+    // Return the sampling interval given at construction
+
+  u_int64_t samples() const;
+    // Return the number of samples recorded
+
+  u_int64_t max() const;
+    // Return the largest sample recorded in 'rdtsc' cycles or 0 if there are no samples
+
+  u_int64_t percentile(double pct) const;
+    // Return the smallest value in 'rdtsc' cycles such that at least specified 'pct' percent of samples are less
+    // than or equal to it up to bucket precision, or 0 if there are no samples. Behavior is defined provided
+    // '0<pct<=100'.
+
+  // MANIPULATORS
+  void begin();
+    // Mark the start of one operation. Call immediately before the operation.
+
+  void end();
+    // Mark the end of the operation started by 'begin' recording its latency if it was sampled.
+
+  void record(u_int64_t cycles);
+    // Record specified 'cycles' as one sample
+
+  void merge(const LatencyRecorder& other);
+    // Add the samples of specified 'other' to this object's as if each had been recorded here
+
+  void reset();
+    // Discard all samples
+
+  LatencyRecorder& operator=(const LatencyRecorder& rhs) = delete;
+    // Assignment operator not provided
+
+  // STATIC FUNCTIONS
+  static unsigned bucket(u_int64_t value);
+    // Return the index of the bucket holding specified 'value'
+
+  static u_int64_t highestEquivalentValue(unsigned bucket);
+    // Return the largest value mapped to specified 'bucket'
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+inline
+LatencyRecorder::LatencyRecorder(unsigned every)
+: d_every(every)
+{
+  reset();
+}
+
+// ACCESSORS
+inline
+unsigned LatencyRecorder::every() const {
+  return d_every;
+}
+
+inline
+u_int64_t LatencyRecorder::samples() const {
+  return d_samples;
+}
+
+inline
+u_int64_t LatencyRecorder::max() const {
+  return d_max;
+}
+
+// MANIPULATORS
+inline
+void LatencyRecorder::begin() {
+  // 'rdtsc' is not serialized here: a fence per operation would cost more than most operations being measured
+  if (d_every && --d_countdown==0) {
+    d_countdown = d_every;
+    d_active = true;
+    d_start = __rdtsc();
+  }
+}
+
+inline
+void LatencyRecorder::end() {
+  if (d_active) {
+    record(__rdtsc()-d_start);
+    d_active = false;
+  }
+}
+
+inline
+void LatencyRecorder::record(u_int64_t cycles) {
+  ++d_count[bucket(cycles)];
+  ++d_samples;
+  if (cycles>d_max) {
+    d_max = cycles;
+  }
+}
+
+inline
+void LatencyRecorder::merge(const LatencyRecorder& other) {
+  for (unsigned i=0; i<k_BUCKETS; ++i) {
+    d_count[i] += other.d_count[i];
+  }
+  d_samples += other.d_samples;
+  if (other.d_max>d_max) {
+    d_max = other.d_max;
+  }
+}
+
+inline
+void LatencyRecorder::reset() {
+  memset(d_count, 0, sizeof(d_count));
+  d_samples = 0;
+  d_max = 0;
+  d_start = 0;
+  d_countdown = d_every;
+  d_active = false;
+}
+
+// STATIC FUNCTIONS
+inline
+unsigned LatencyRecorder::bucket(u_int64_t value) {
+  // Values below 2*k_SUB_BUCKETS have their own bucket. Above that each power of 2 gets 'k_SUB_BUCKETS' buckets
+  if (value < 2*k_SUB_BUCKETS) {
+    return static_cast<unsigned>(value);
+  }
+  const unsigned msb = 63 - __builtin_clzll(value);
+  const unsigned shift = msb - k_SUB_BUCKET_BITS;
+  return shift*k_SUB_BUCKETS + static_cast<unsigned>(value>>shift);
+}
+
+inline
+u_int64_t LatencyRecorder::highestEquivalentValue(unsigned bucket) {
+  assert(bucket<k_BUCKETS);
+  if (bucket < 2*k_SUB_BUCKETS) {
+    return bucket;
+  }
+  const unsigned shift = bucket/k_SUB_BUCKETS - 1;
+  const u_int64_t sub = bucket%k_SUB_BUCKETS + k_SUB_BUCKETS;
+  return (sub<<shift) + ((1ULL<<shift)-1);
+}
+
+} // namespace Intel
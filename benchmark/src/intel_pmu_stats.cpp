@@ -86,6 +86,36 @@ void Intel::Stats::calcMinMaxAvgData(const std::vector<u_int64_t>& data, const s
   avg = totalData / totalIterations;
 }
 
+void Intel::Stats::calcMinMaxAvgLatency(const std::vector<u_int64_t>& cycles, double& min, double& max,
+  double& avg) const {
+
+  assert(cycles.size()==d_latencyN.size());
+
+  min = max = avg = 0.0;
+  unsigned runs = 0;
+
+  for (unsigned i=0; i<cycles.size(); ++i) {
+    if (d_latencyN[i]==0 || d_rdstc[i]==0) {
+      continue;
+    }
+
+    const double datum = (double)cycles[i]*d_elapsedNs[i]/(double)d_rdstc[i];
+    if (runs==0) {
+      min = max = datum;
+    } else if (datum<min) {
+      min = datum;
+    } else if (datum>max) {
+      max = datum;
+    }
+    avg += datum;
+    ++runs;
+  }
+
+  if (runs) {
+    avg /= (double)runs;
+  }
+}
+
 void Intel::Stats::legend(const Intel::SkyLake::PMU& pmu) const {
   printf("%-3s [%-60s]\n", "C0", "rdtsc cycles: use with F2");
 
@@ -113,6 +143,20 @@ void Intel::Stats::legend(const Intel::SkyLake::PMU& pmu) const {
 
   sprintf(buffer, "iterations");
   printf("%-3s [%-60s]\n", "N", buffer);
+
+  if (d_latencySampling) {
+    sprintf(buffer, "median nanoseconds per sampled operation");
+    printf("%-3s [%-60s]\n", "P50", buffer);
+
+    sprintf(buffer, "99th percentile nanoseconds per sampled operation");
+    printf("%-3s [%-60s]\n", "P99", buffer);
+
+    sprintf(buffer, "99.9th percentile nanoseconds per sampled operation");
+    printf("%-3s [%-60s]\n", "P3N", buffer);
+
+    sprintf(buffer, "maximum nanoseconds per sampled operation");
+    printf("%-3s [%-60s]\n", "PMX", buffer);
+  }
 }
 
 void Intel::Stats::dump(const Intel::SkyLake::PMU& pmu) const {
@@ -155,6 +199,15 @@ void Intel::Stats::dump(const Intel::SkyLake::PMU& pmu) const {
     printf(  "%-3s: [%-60s] value: %-11.5lf\n", "MPS", "millions of operations per second", (double)1000/((double)d_elapsedNs[i]/(double)d_itertions[i]));
     printf(  "%-3s: [%-60s] value: %-11.5lf\n", "OPS", "operations per second", (double)1000000000/((double)d_elapsedNs[i]/(double)d_itertions[i]));
     printf(  "%-3s: [%-60s] value: %lu\n",  "N", "iterations", d_itertions[i]);
+
+    if (d_latencyN[i] && d_rdstc[i]) {
+      const double nsPerCycle = d_elapsedNs[i]/(double)d_rdstc[i];
+      printf(  "%-3s: [%-60s] value: %-11.5lf\n", "P50", "median nanoseconds per sampled operation", (double)d_latencyP50[i]*nsPerCycle);
+      printf(  "%-3s: [%-60s] value: %-11.5lf\n", "P99", "99th percentile nanoseconds per sampled operation", (double)d_latencyP99[i]*nsPerCycle);
+      printf(  "%-3s: [%-60s] value: %-11.5lf\n", "P3N", "99.9th percentile nanoseconds per sampled operation", (double)d_latencyP999[i]*nsPerCycle);
+      printf(  "%-3s: [%-60s] value: %-11.5lf\n", "PMX", "maximum nanoseconds per sampled operation", (double)d_latencyMax[i]*nsPerCycle);
+      printf(  "%-3s: [%-60s] value: %lu\n",  "PN", "latency samples", d_latencyN[i]);
+    }
   }
 }
 
@@ -313,6 +366,37 @@ void Intel::Stats::summary(const char *label, const Intel::SkyLake::PMU& pmu) co
     "operations per second",
     ops[0], ops[1], ops[2]);
 
+  bool sampled = false;
+  for (auto n: d_latencyN) {
+    sampled |= n>0;
+  }
+
+  if (sampled) {
+    calcMinMaxAvgLatency(d_latencyP50, min, max, avg);
+    printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
+      "P50",
+      "median nanoseconds per sampled operation",
+      min, max, avg);
+
+    calcMinMaxAvgLatency(d_latencyP99, min, max, avg);
+    printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
+      "P99",
+      "99th percentile nanoseconds per sampled operation",
+      min, max, avg);
+
+    calcMinMaxAvgLatency(d_latencyP999, min, max, avg);
+    printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
+      "P3N",
+      "99.9th percentile nanoseconds per sampled operation",
+      min, max, avg);
+
+    calcMinMaxAvgLatency(d_latencyMax, min, max, avg);
+    printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
+      "PMX",
+      "maximum nanoseconds per sampled operation",
+      min, max, avg);
+  }
+
   printf(  "%-3s: [%-60s] minValue: %-16.5lf maxValue: %-16.5lf avgValue: %-16.5f\n",
     "N",
     "iterations",
@@ -404,4 +488,28 @@ void Intel::Stats::record(
   double elapsedNs = (double)end.tv_sec*1000000000.0+(double)end.tv_nsec -
                      ((double)start.tv_sec*1000000000.0+(double)start.tv_nsec);
   d_elapsedNs.push_back(elapsedNs);
+
+  d_latencyN.push_back(0);
+  d_latencyP50.push_back(0);
+  d_latencyP99.push_back(0);
+  d_latencyP999.push_back(0);
+  d_latencyMax.push_back(0);
+}
+
+void Intel::Stats::record(
+    const char *description,
+    unsigned long iterations,
+    timespec start,
+    timespec end,
+    const Intel::SkyLake::PMU& pmu,
+    const LatencyRecorder& latency)
+{
+  record(description, iterations, start, end, pmu);
+
+  // Percentiles are walked after the PMU is read above so the histogram scan is not counted
+  d_latencyN.back() = latency.samples();
+  d_latencyP50.back() = latency.percentile(50.0);
+  d_latencyP99.back() = latency.percentile(99.0);
+  d_latencyP999.back() = latency.percentile(99.9);
+  d_latencyMax.back() = latency.max();
 }
@@ -5,6 +5,8 @@
 // CLASSES:
 //  Intel::Stats: Holds raw statistics from each test run reporting them to standard out.
 
+#include <intel_latency_recorder.h>
+
 #include <string>
 #include <vector>
 #include <iostream>
@@ -35,11 +37,17 @@ class Stats {
   std::vector<u_int64_t>      d_progmCntr6;   // per result set: elapsed value of programmable counter 6 at test end
   std::vector<u_int64_t>      d_progmCntr7;   // per result set: elapsed value of programmable counter 7 at test end
   std::vector<double>         d_elapsedNs;    // per result set: elapsed time in nanoseconds
+  std::vector<u_int64_t>      d_latencyN;     // per result set: number of per-operation latency samples
+  std::vector<u_int64_t>      d_latencyP50;   // per result set: median sampled latency in rdtsc cycles
+  std::vector<u_int64_t>      d_latencyP99;   // per result set: 99th percentile sampled latency in rdtsc cycles
+  std::vector<u_int64_t>      d_latencyP999;  // per result set: 99.9th percentile sampled latency in rdtsc cycles
+  std::vector<u_int64_t>      d_latencyMax;   // per result set: largest sampled latency in rdtsc cycles
+  unsigned                    d_latencySampling; // sample 1 in this many operations; 0 disables latency sampling
 
   // CREATORS
 public:
-  Stats() = default;
-    // Create a Stats object containing no data
+  Stats();
+    // Create a Stats object containing no data with latency sampling disabled
 
   Stats(const Stats& other) = delete;
     // Copy constructor not defined
@@ -47,6 +55,13 @@ public:
   ~Stats() = default;
     // Destroy this object
 
+  // ACCESSORS
+  bool empty() const;
+    // Return true if no results were recorded and false otherwise
+
+  unsigned latencySampling() const;
+    // Return the latency sampling interval tests should construct their 'LatencyRecorder' with
+
   // MANIPULATORS
   void record(const char *desc,
               u_int64_t iterations,
@@ -58,6 +73,19 @@ public:
     // describing how many operations were run e.g. inserts, loops, finds, adds etc., and the elapsed time specified as
     // 'end - start'. Behavior is defined provided 'iterations>0', and 'pmu' was successfully started.
 
+  void record(const char *desc,
+              u_int64_t iterations,
+              timespec start,
+              timespec end,
+              const Intel::SkyLake::PMU& pmu,
+              const LatencyRecorder& latency);
+    // Record the same data as above plus the p50, p99, p99.9 and max per-operation latency sampled by specified
+    // 'latency'. Runs whose 'latency' has no samples are recorded as if 'latency' were not given.
+
+  void setLatencySampling(unsigned every);
+    // Make 'latencySampling' return specified 'every'. Use 0 to disable, 1 to time every operation, and N to time
+    // every Nth operation.
+
   void reset();
     // Discard all collected results
 
@@ -73,6 +101,12 @@ private:
     // in that same run. 'max' is defined similarly. 'avg' is defined as the total of all entries in 'data' divided
     // by the total of all entries in 'iterations'.
 
+  void calcMinMaxAvgLatency(const std::vector<u_int64_t>& cycles, double& min, double& max, double& avg) const;
+    // Calculate the minimum, maximum, and average latency in nanoseconds over runs with latency samples using
+    // specified 'cycles' writing results into specified 'min, max, avg'. Each run's cycles are converted to
+    // nanoseconds with that run's ratio of elapsed nanoseconds to elapsed 'rdtsc' cycles. 'avg' is the mean over
+    // those runs.
+
   void calcMinMaxAvgTime(const std::vector<double>& elapsedNs, const std::vector<u_int64_t>& iterations,
     double ns[3], double nsPerIter[3], double ops[3], double iters[3]) const;
     // Calculate the minimum, maximum, and average statistics using specified 'elapsedNs, iterations' writing results
@@ -100,6 +134,24 @@ public:
 };
 
 // INLINE DEFINITIONS
+// CREATORS
+inline
+Stats::Stats()
+: d_latencySampling(0)
+{
+}
+
+// ACCESSORS
+inline
+bool Stats::empty() const {
+  return d_description.empty();
+}
+
+inline
+unsigned Stats::latencySampling() const {
+  return d_latencySampling;
+}
+
 // MANIPULATORS
 inline
 void Stats::reset() {
@@ -118,6 +170,16 @@ void Stats::reset() {
   d_progmCntr6.clear();
   d_progmCntr7.clear();
   d_elapsedNs.clear();
+  d_latencyN.clear();
+  d_latencyP50.clear();
+  d_latencyP99.clear();
+  d_latencyP999.clear();
+  d_latencyMax.clear();
+}
+
+inline
+void Stats::setLatencySampling(unsigned every) {
+  d_latencySampling = every;
 }
 
 } // namespace Benchmark
@@ -3,18 +3,15 @@
 #include <string.h>
 
 #include <benchmark_config.h>
+#include <benchmark_delegation.h>
+#include <benchmark_keyindex.h>
 #include <benchmark_loadfile.h>
-#include <benchmark_cuckoo.h>
-#include <benchmark_f14.h>
-#include <benchmark_hot.h>
-#include <benchmark_art.h>
-#include <benchmark_patricia.h>
-#include <benchmark_cradix.h>
-#include <benchmark_cedar.h>
-#include <benchmark_wormhole.h>
-#include <benchmark_hattrie.h>
+#include <benchmark_numa.h>
+#include <benchmark_registry.h>
+#include <benchmark_report.h>
 
 #include <benchmark_textscan.h>
+#include <benchmark_workload.h>
 
 Benchmark::Config config;
 
@@ -25,17 +22,13 @@ void usageAndExit() {
   printf("\n");
   printf("       -F <format>              mandatory: format is one of the following:\n");
   printf("                                'bin-text'    : <filename> contains (probably mostly ASCII) keys in binary format\n");
+  printf("                                'bin-text-kv' : <filename> contains (probably mostly ASCII) key-value pairs in binary format\n");
   printf("\n");
   printf("       -d <data-structure>      mandatory: data structure to benchmark for which code included in this repository\n");
-  printf("                                'cuckoo'     : hashmap  https://github.com/efficient/libcuckoo\n");
-  printf("                                'f14'        : hashmap  https://github.com/facebook/folly\n");
-  printf("                                'hot'        : HOT trie https://github.com/speedskater/hot\n");
-  printf("                                'art'        : ART trie https://github.com/armon/libart.git\n");
-  printf("                                'patricia'   : own trie based on https://cr.yp.to/critbit.html, https://github.com/agl/critbit\n");
-  printf("                                'cradix'     : own m-ary trie\n");
-  printf("                                'cedar'      : double array trie http://www.tkl.iis.u-tokyo.ac.jp/~ynaga/cedar/\n");
-  printf("                                'wormhole'   : Wormhole trie https://github.com/wuxb45/wormhole\n");
-  printf("                                'hattrie'    : Hat-Trie trie https://github.com/Tessil/hat-trie\n");
+  for (unsigned i=0; i<Benchmark::Registry::size(); ++i) {
+    const Benchmark::RegistryEntry& entry = Benchmark::Registry::entry(i);
+    printf("                                %-13s: %s\n", (std::string("'")+entry.d_name+"'").c_str(), entry.d_usage);
+  }
   printf("\n");
   printf("       -h <hash-algo>           optional : hashmap algorithms require a hashing function. Specify it here\n");
   printf("                                'xxhash:XX3_64bits': xxhash    variant 'XXH3_64bits()' https://github.com/Cyan4973/xxHash.git\n");
@@ -50,8 +43,95 @@ void usageAndExit() {
   printf("       -r <#runs>               optional  : number of runs to execute before collecting stats\n");
   printf("\n");
   printf("                                optional  : CPU cores for pinning threads\n");
-  printf("       -0 <coreId0>             run thread 0 pinned to 'coreId0>=0'. 'cradix uses thread 0 to run radix operations\n");
-  printf("       -1 <coreId1>             run thread 1 pinned to 'coreId1>=0'. 'cradix delegates work from coreId0 to a thread running on coreId1\n");
+  printf("       -0 <coreId0>             run thread 0 pinned to 'coreId0>=0'. Single threaded phases run here\n");
+  printf("       -1 <coreId1>             run thread 1 pinned to 'coreId1>=0'\n");
+  printf("       -2 <coreId2>             run thread 2 pinned to 'coreId2>=0'\n");
+  printf("       -3 <coreId3>             run thread 3 pinned to 'coreId3>=0'\n");
+  printf("\n");
+  printf("       -t <threads>             optional  : run find (and insert where the data structure is thread-safe) over 'threads>0'\n");
+  printf("                                            pinned threads each working on a contiguous part of <filename>'s keys. Threads\n");
+  printf("                                            0-3 run on -0..-3. Higher threads continue with the stride of -2, -3. Reports\n");
+  printf("                                            aggregate and per-thread throughput. Format 'bin-text' only\n");
+  printf("\n");
+  printf("       -W <writers>             optional  : with -t, each run also times a mixed phase on an empty structure: 'writers'\n");
+  printf("                                            of the -t threads insert every key while the rest find every key. Finds\n");
+  printf("                                            hit keys inserted so far. Insert and find throughput are reported apart.\n");
+  printf("                                            Needs '0<writers<threads' and a thread-safe insert\n");
+  printf("\n");
+  printf("       -D <owners>[,<ring>][,<shard>][,<batch>][,reply]\n");
+  printf("                                optional  : with -t, each run also delegates insert then find to 'owners' in [1,256]\n");
+  printf("                                            owner threads each holding its own single threaded instance of one shard\n");
+  printf("                                            of the keys. The -t threads become clients sending each key to its\n");
+  printf("                                            shard's owner. Owners run on the cores after the -t threads'. Works with\n");
+  printf("                                            every data structure. Reports per-owner and aggregate throughput\n");
+  printf("                                'spsc'      : one SPSC ring per client, owner pair (default)\n");
+  printf("                                'mpsc'      : one MPSC ring per owner shared by all clients\n");
+  printf("                                'hash'      : owner is the key's xxhash modulo 'owners' (default)\n");
+  printf("                                'range'     : owners split first key byte values into contiguous ranges\n");
+  printf("                                '<batch>'   : send keys as 8 byte words 'batch' in [1,256] per append. Without\n");
+  printf("                                              it each key is sent alone as one 64 byte op\n");
+  printf("                                'reply'     : owners answer finds over rings back to clients. Adds a round trip find\n");
+  printf("                                              phase reporting clients' throughput and per-key p50, p99, p99.9\n");
+  printf("                                              and max latency with one batch, or key, in flight per owner\n");
+  printf("\n");
+  printf("       -l <every>               optional  : time every 'every>0' operation with rdtsc reporting p50, p99, p99.9 and max\n");
+  printf("                                            latency next to throughput. 1 times every operation. Sampling adds\n");
+  printf("                                            two rdtsc plus a histogram update per sampled operation\n");
+  printf("\n");
+  printf("       -w <mix>                 optional  : replace the insert then find phases with one interleaved YCSB-style stream of\n");
+  printf("                                            one operation per key. <mix> is a YCSB core workload 'a'..'f' or ':' separated\n");
+  printf("                                            '<percent><op>' summing to 100 e.g. '95r:5u'. <op> is 'r' read, 'u' update,\n");
+  printf("                                            'i' insert, 's' scan, 'm' read-modify-write. Format 'bin-text' only\n");
+  printf("       -k <distribution>        optional  : how -w picks existing keys. One of 'uniform', 'zipfian', 'latest'. Default is\n");
+  printf("                                            the core workload's or 'uniform' for an explicit mix\n");
+  printf("\n");
+  printf("       -n <placement>           optional  : NUMA node holding <filename>'s huge pages. Omitting it leaves the kernel default\n");
+  printf("                                'local'     : bind to the node of -0\n");
+  printf("                                '<node>'    : bind to node number 'node>=0'\n");
+  printf("                                'replicate' : bind to the node of -0 plus one copy bound to each other node -t threads\n");
+  printf("                                              are pinned to. Each thread reads its node's copy\n");
+  printf("\n");
+  printf("       -o <order>               optional  : look keys up in this order in the single threaded find phase. Keys are indexed\n");
+  printf("                                            once after loading so lookups pay no scan cost. Format 'bin-text' only\n");
+  printf("                                'file'      : each key once in file order\n");
+  printf("                                'shuffled'  : each key once in a random order\n");
+  printf("                                'uniform'   : as many lookups as keys, each key drawn uniformly\n");
+  printf("                                'zipfian'   : as many lookups as keys, few hot keys (YCSB zipfian 0.99)\n");
+  printf("\n");
+  printf("       -m <missfile>            optional  : after find, time a miss phase looking up keys absent from <filename>. Reported\n");
+  printf("                                            separately from find so hit and miss paths each get throughput and latency\n");
+  printf("                                '<path>'    : probe the keys of this 'bin-text' file, which should share no keys with -f\n");
+  printf("                                'mutate'    : probe each key of <filename> with the top bit of its last byte flipped\n");
+  printf("\n");
+  printf("       -e <erase>               optional  : after find, time erasing keys then time reinserting the same keys into the\n");
+  printf("                                            emptied space. Format 'bin-text' only\n");
+  printf("                                'drain'     : erase every key in file order\n");
+  printf("                                '<percent>' : erase 1-100 percent of keys picked at random\n");
+  printf("\n");
+  printf("       -c                       optional  : last in each run, time find again, compact the structure, then time find\n");
+  printf("                                            once more. Structures which cannot compact say so and skip it. Format\n");
+  printf("                                            'bin-text' without -t or -w only\n");
+  printf("\n");
+  printf("       -s <lengths>             optional  : after find, time range scans of each ',' separated key count e.g. '10,100,1000'.\n");
+  printf("                                            Each scan seeks to a random existing key then visits up to that many keys\n");
+  printf("                                            in order. Structures which cannot scan say so and skip it. Format 'bin-text'\n");
+  printf("                                            without -w only\n");
+  printf("\n");
+  printf("       -B <batch>               optional  : single threaded find looks up 1-%d keys per call. Hashmaps with batched\n",
+    Benchmark::Config::k_MAX_FIND_BATCH);
+  printf("                                            find hash every key and prefetch its buckets before probing any,\n");
+  printf("                                            others find one key after another. No latency with -l. Format\n");
+  printf("                                            'bin-text' without -t or -w only\n");
+  printf("\n");
+  printf("       -H                       optional  : hashmaps only. Hash every key of <filename> with -h once before timing and\n");
+  printf("                                            have the hashmap load that hash instead of computing it. Each run first\n");
+  printf("                                            times every -h hash alone over the keys so hash and table cost separate.\n");
+  printf("                                            Format 'bin-text' only\n");
+  printf("\n");
+  printf("       -P                       optional  : keep <filename> in a huge-page shared memory segment after exit. Later runs with\n");
+  printf("                                            -P and the same -n attach to it instead of reading the file. A segment whose\n");
+  printf("                                            file has since changed size or mtime is reloaded\n");
+  printf("       -C                       remove segments left by -P then exit. With -f only that file's segments are removed\n");
   printf("\n");
   printf("File format descriptions provided in 'README.md' at https://github.com/rodgarrison/kvbench\n");
   exit(2);
@@ -59,8 +139,9 @@ void usageAndExit() {
 
 void parseCommandLine(int argc, char **argv) {
   int opt;
+  bool cleanup(false);
 
-  const char *switches = "f:F:d:h:a:0:1:2:3:r:";
+  const char *switches = "f:F:d:h:a:0:1:2:3:r:t:W:D:l:w:k:n:o:m:e:cs:B:HPC";
 
   while ((opt = getopt(argc, argv, switches)) != -1) {
     switch (opt) {
@@ -90,26 +171,10 @@ void parseCommandLine(int argc, char **argv) {
 
       case 'd':
         {
-          if (!strcmp("cuckoo", optarg)) {
-            config.d_dataStructure = optarg;
-            config.d_needHashAlgo = true;
-          } else if (!strcmp("f14", optarg)) {
-            config.d_dataStructure = optarg;
-            config.d_needHashAlgo = true;
-          } else if (!strcmp("hot", optarg)) {
-            config.d_dataStructure = optarg;
-          } else if (!strcmp("art", optarg)) {
-            config.d_dataStructure = optarg;
-          } else if (!strcmp("patricia", optarg)) {
-            config.d_dataStructure = optarg;
-          } else if (!strcmp("cradix", optarg)) {
-            config.d_dataStructure = optarg;
-          } else if (!strcmp("cedar", optarg)) {
-            config.d_dataStructure = optarg;
-          } else if (!strcmp("wormhole", optarg)) {
-            config.d_dataStructure = optarg;
-          } else if (!strcmp("hattrie", optarg)) {
+          const Benchmark::RegistryEntry *entry = Benchmark::Registry::find(optarg);
+          if (entry) {
             config.d_dataStructure = optarg;
+            config.d_needHashAlgo = entry->d_needHashAlgo;
           } else {
             usageAndExit();
           }
@@ -185,6 +250,140 @@ void parseCommandLine(int argc, char **argv) {
           }
         }
         break;
+      case 't':
+        {
+          if (atoi(optarg)>0) {
+            config.d_threads = atoi(optarg);
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'W':
+        {
+          if (atoi(optarg)>0) {
+            config.d_writers = atoi(optarg);
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'D':
+        {
+          Benchmark::DelegationSpec delegation;
+          if (delegation.configure(optarg)==0) {
+            config.d_delegate = optarg;
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'l':
+        {
+          if (atoi(optarg)>0) {
+            config.d_latencySampling = atoi(optarg);
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'w':
+        {
+          Benchmark::Workload workload;
+          if (workload.configure(optarg, "")==0) {
+            config.d_workload = optarg;
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'k':
+        {
+          if (!strcmp("uniform", optarg) || !strcmp("zipfian", optarg) || !strcmp("latest", optarg)) {
+            config.d_keyDistribution = optarg;
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'n':
+        {
+          if (!strcmp("local", optarg) || !strcmp("replicate", optarg)) {
+            config.d_numa = optarg;
+          } else if (optarg[0]>='0' && optarg[0]<='9' && atoi(optarg)<Benchmark::Numa::nodes()) {
+            config.d_numa = optarg;
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'o':
+        {
+          Benchmark::KeyIndex::Order order;
+          if (Benchmark::KeyIndex::parseOrder(optarg, &order)==0) {
+            config.d_keyOrder = optarg;
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'm':
+        {
+          if (strlen(optarg)>0) {
+            config.d_missFile = optarg;
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'e':
+        {
+          if (!strcmp(optarg, "drain") || (atoi(optarg)>=1 && atoi(optarg)<=100)) {
+            config.d_erase = optarg;
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'c':
+        {
+          config.d_compact = true;
+        }
+        break;
+      case 's':
+        {
+          std::vector<unsigned> lengths;
+          if (Benchmark::Report::parseScanLengths(optarg, &lengths)==0) {
+            config.d_scanLengths = optarg;
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'B':
+        {
+          if (atoi(optarg)>0 && atoi(optarg)<=Benchmark::Config::k_MAX_FIND_BATCH) {
+            config.d_findBatch = atoi(optarg);
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+      case 'H':
+        {
+          config.d_hashMemo = true;
+        }
+        break;
+      case 'P':
+        {
+          config.d_persistent = true;
+        }
+        break;
+      case 'C':
+        {
+          cleanup = true;
+        }
+        break;
       
       default:
         {
@@ -194,6 +393,18 @@ void parseCommandLine(int argc, char **argv) {
     }
   }
 
+  if (cleanup) {
+    unsigned removed(0);
+    const char *path = config.d_filename.empty() ? 0 : config.d_filename.c_str();
+    int rc = Benchmark::LoadFile::removePersistent(path, &removed);
+    if (rc!=0) {
+      printf("error: cannot remove persistent segments: %s (errno=%d)\n", strerror(rc), rc);
+      exit(1);
+    }
+    printf("removed %u persistent segment(s)\n", removed);
+    exit(0);
+  }
+
   if (config.d_filename.empty()) {
     usageAndExit();
   }
@@ -214,46 +425,11 @@ int main(int argc, char **argv) {
   parseCommandLine(argc, argv);
 
   // Now do what command line requested
-  if (config.d_dataStructure=="cuckoo") {
-    Benchmark::Cuckoo test(config, "Cuckoo Hashmap");
-    test.start();
-    test.report();
-  } else if (config.d_dataStructure=="f14") {
-    Benchmark::FacebookF14 test(config, "F14 Hashmap");
-    test.start();
-    test.report();
-  } else if (config.d_dataStructure=="hot") {
-    Benchmark::HOT test(config, "HOT Trie");
-    test.start();
-    test.report();
-  } else if (config.d_dataStructure=="art") {
-    Benchmark::ART test(config, "ART Trie");
-    test.start();
-    test.report();
-  } else if (config.d_dataStructure=="patricia") {
-    Benchmark::patricia test(config, "Patricia Trie");
-    test.start();
-    test.report();
-  } else if (config.d_dataStructure=="cradix") {
-    Benchmark::cradix test(config, "CRadix Trie");
-    test.start();
-    test.report();
-  } else if (config.d_dataStructure=="cedar") {
-    Benchmark::Cedar test(config, "Cedar Trie");
-    test.start();
-    test.report();
-  } else if (config.d_dataStructure=="wormhole") {
-    Benchmark::WormHole test(config, "Wormhole Trie");
-    test.start();
-    test.report();
-  } else if (config.d_dataStructure=="hattrie") {
-    Benchmark::HatTrie test(config, "HAT-Trie");
-    test.start();
-    test.report();
-  } else {
+  const Benchmark::RegistryEntry *entry = Benchmark::Registry::find(config.d_dataStructure.c_str());
+  if (!entry) {
     printf("error: unknown data structure\n");
     exit(2);
   }
-  
-  return 0;
+
+  return entry->d_run(config, entry->d_description);
 }
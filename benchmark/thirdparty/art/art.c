@@ -973,3 +973,106 @@ int art_iter_prefix(art_tree *t, const unsigned char *key, int key_len, art_call
     }
     return 0;
 }
+
+/**
+ * Compares a leaf's key with a key
+ * @return negative, 0 or positive if the leaf's key is
+ * less than, equal to or greater than the key.
+ */
+static int leaf_compare(const art_leaf *n, const unsigned char *key, int key_len) {
+    int cmp = memcmp(n->key, key, min(n->key_len, key_len));
+    if (cmp) return cmp;
+    return (int)n->key_len - key_len;
+}
+
+static int recursive_iter_from(art_node *n, const unsigned char *key, int key_len, int depth, art_callback cb, void *data);
+
+// Iterates over one child with key byte b given the key's byte c at this depth
+static int iter_child_from(art_node *child, unsigned char b, unsigned char c, const unsigned char *key, int key_len, int depth, art_callback cb, void *data) {
+    if (b < c) return 0;
+    if (b > c) return recursive_iter(child, cb, data);
+    return recursive_iter_from(child, key, key_len, depth + 1, cb, data);
+}
+
+// Recursively iterates over the leaves not less than the key
+static int recursive_iter_from(art_node *n, const unsigned char *key, int key_len, int depth, art_callback cb, void *data) {
+    // Handle base cases
+    if (!n) return 0;
+    if (IS_LEAF(n)) {
+        art_leaf *l = LEAF_RAW(n);
+        if (leaf_compare(l, key, key_len) < 0) return 0;
+        return cb(data, (const unsigned char*)l->key, l->key_len, l->value);
+    }
+
+    // Order the whole subtree against the key by its prefix. Only
+    // MAX_PREFIX_LEN bytes are stored, the minimum leaf has the rest
+    if (n->partial_len) {
+        const unsigned char *partial = n->partial;
+        if (n->partial_len > MAX_PREFIX_LEN) {
+            partial = minimum(n)->key + depth;
+        }
+        int cmp = memcmp(partial, key + depth, min(n->partial_len, key_len - depth));
+        if (cmp < 0) return 0;
+        if (cmp > 0) return recursive_iter(n, cb, data);
+        depth = depth + n->partial_len;
+    }
+
+    // The key ends here or in the prefix: every leaf extends it
+    if (depth >= key_len) return recursive_iter(n, cb, data);
+
+    int idx, res;
+    unsigned char c = key[depth];
+    switch (n->type) {
+        case NODE4:
+            for (int i=0; i < n->num_children; i++) {
+                res = iter_child_from(((art_node4*)n)->children[i], ((art_node4*)n)->keys[i], c, key, key_len, depth, cb, data);
+                if (res) return res;
+            }
+            break;
+
+        case NODE16:
+            for (int i=0; i < n->num_children; i++) {
+                res = iter_child_from(((art_node16*)n)->children[i], ((art_node16*)n)->keys[i], c, key, key_len, depth, cb, data);
+                if (res) return res;
+            }
+            break;
+
+        case NODE48:
+            for (int i=c; i < 256; i++) {
+                idx = ((art_node48*)n)->keys[i];
+                if (!idx) continue;
+
+                res = iter_child_from(((art_node48*)n)->children[idx-1], i, c, key, key_len, depth, cb, data);
+                if (res) return res;
+            }
+            break;
+
+        case NODE256:
+            for (int i=c; i < 256; i++) {
+                if (!((art_node256*)n)->children[i]) continue;
+                res = iter_child_from(((art_node256*)n)->children[i], i, c, key, key_len, depth, cb, data);
+                if (res) return res;
+            }
+            break;
+
+        default:
+            abort();
+    }
+    return 0;
+}
+
+/**
+ * Iterates through the entries pairs in the map in key order,
+ * invoking a callback for each not less than a given key.
+ * The call back gets a key, value for each and returns an integer stop value.
+ * If the callback returns non-zero, then the iteration stops.
+ * @arg t The tree to iterate over
+ * @arg key The smallest key to read, which need not be in the map
+ * @arg key_len The length of the key
+ * @arg cb The callback function to invoke
+ * @arg data Opaque handle passed to the callback
+ * @return 0 on success, or the return of the callback.
+ */
+int art_iter_from(art_tree *t, const unsigned char *key, int key_len, art_callback cb, void *data) {
+    return recursive_iter_from(t->root, key, key_len, 0, cb, data);
+}
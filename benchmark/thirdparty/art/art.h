@@ -208,6 +208,20 @@ int art_iter(art_tree *t, art_callback cb, void *data);
  */
 int art_iter_prefix(art_tree *t, const unsigned char *prefix, int prefix_len, art_callback cb, void *data);
 
+/**
+ * Iterates through the entries pairs in the map in key order,
+ * invoking a callback for each not less than a given key.
+ * The call back gets a key, value for each and returns an integer stop value.
+ * If the callback returns non-zero, then the iteration stops.
+ * @arg t The tree to iterate over
+ * @arg key The smallest key to read, which need not be in the map
+ * @arg key_len The length of the key
+ * @arg cb The callback function to invoke
+ * @arg data Opaque handle passed to the callback
+ * @return 0 on success, or the return of the callback.
+ */
+int art_iter_from(art_tree *t, const unsigned char *key, int key_len, art_callback cb, void *data);
+
 #ifdef __cplusplus
 }
 #endif
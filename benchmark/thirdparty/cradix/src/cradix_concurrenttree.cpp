@@ -0,0 +1,226 @@
+#include <cradix_concurrenttree.h>
+#include <cradix_memmanager.h>
+#include <cradix_node256.h>
+
+static inline u_int32_t loadOffset(const CRadix::Node256 *node, u_int32_t index) {
+  // Return the offset at 'index' of 'node' or 0 if 'index' is outside its
+  // span. The span is read once: a writer changes it with one store and never
+  // past the node's capacity so a torn read stays inside the node. What's
+  // returned is trusted only once the node's version validates.
+  const u_int32_t data = __atomic_load_n(&node->d_udata, __ATOMIC_RELAXED);
+  const u_int32_t min = data & 0xff;
+  if (index<min || index>((data & 0xff00)>>8)) {
+    return 0;
+  }
+  return __atomic_load_n(node->d_offset+(index-min), __ATOMIC_ACQUIRE);
+}
+
+static inline void publishOffset(CRadix::Node256 *node, u_int32_t index, u_int32_t offset) {
+  // Set 'index' of locked 'node' to 'offset' after every write made before
+  // so a reader loading 'offset' sees the nodes it links to built
+  assert(index>=node->minIndex() && index<=node->maxIndex());
+  __atomic_store_n(node->d_offset+(index-node->minIndex()), offset, __ATOMIC_RELEASE);
+}
+
+int CRadix::ConcurrentTree::findOnce(const u_int8_t *key, const u_int16_t size) const {
+  assert(key!=0);
+  assert(size>0);
+
+  const u_int8_t *basePtr = d_tree.d_memManager->basePtr();
+  u_int32_t node = d_tree.d_root;
+  u_int64_t version = d_locks.readVersion(node);
+
+  for (u_int32_t i=0; i<size; ++i) {
+    const u_int32_t link = loadOffset((const Node256*)(basePtr+node), key[i]);
+    if (!d_locks.validate(node, version)) {
+      return k_RESTART;
+    }
+    if (link & k_NODE256_IS_LEAF) {
+      return ((i+1U)==size) ? e_EXISTS : e_NOT_FOUND;
+    } else if (link==0) {
+      return e_NOT_FOUND;
+    } else if ((i+1U)==size) {
+      return (link & k_NODE256_IS_TERMINAL) ? e_EXISTS : e_NOT_FOUND;
+    }
+
+    // Child's version first then recheck node: 'link' was live when child reached
+    const u_int32_t child = link & k_NODE256_NO_TAG_MASK;
+    const u_int64_t childVersion = d_locks.readVersion(child);
+    if (!d_locks.validate(node, version)) {
+      return k_RESTART;
+    }
+    node = child;
+    version = childVersion;
+  }
+
+  assert(false);
+  return e_NOT_FOUND;
+}
+
+int CRadix::ConcurrentTree::insert(const Benchmark::Slice<u_int8_t> key) {
+  assert(key.size()>0);
+  int rc;
+  while ((rc = insertOnce(key.data(), key.size()))==k_RESTART) {
+  }
+
+  if (rc==e_OK) {
+    // Iterators size their key buffer from the deepest key
+    const u_int16_t size = key.size();
+    u_int16_t depth = __atomic_load_n(&d_tree.d_currentMaxDepth, __ATOMIC_RELAXED);
+    while (size>depth && !__atomic_compare_exchange_n(&d_tree.d_currentMaxDepth, &depth, size, true,
+      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+  }
+
+  return rc;
+}
+
+int CRadix::ConcurrentTree::insertOnce(const u_int8_t *key, const u_int16_t size) {
+  assert(key!=0);
+  assert(size>0);
+
+  // Walk as 'findOnce' tracking 3 nodes connected by two edges: parent -> node -> link
+  MemManager *memManager = d_tree.d_memManager;
+  u_int8_t *basePtr = const_cast<u_int8_t *>(memManager->basePtr());
+  u_int32_t parent(0);
+  u_int64_t parentVersion(0);
+  u_int32_t node = d_tree.d_root;
+  u_int64_t version = d_locks.readVersion(node);
+
+  for (u_int32_t i=0; i<size; ++i) {
+    Node256 *nodePtr = (Node256*)(basePtr+node);
+    const u_int32_t link = loadOffset(nodePtr, key[i]);
+    if (!d_locks.validate(node, version)) {
+      return k_RESTART;
+    }
+
+    if (link & k_NODE256_IS_LEAF) {
+      if ((i+1U)==size) {
+        return e_EXISTS;
+      }
+      // Key continues past a leaf: the leaf becomes a terminal node holding
+      // the rest of the key. 'key[i]' is in span so no reallocation
+      const u_int32_t chain = newChain(key, i+1, size);
+      if (chain==0) {
+        return e_MEMORY_ERROR;
+      }
+      if (!d_locks.tryLock(node, version)) {
+        freeChain(chain);
+        return k_RESTART;
+      }
+      publishOffset(nodePtr, key[i], chain|k_NODE256_IS_TERMINAL);
+      d_locks.unlock(node);
+      return e_OK;
+    }
+
+    if (link==0) {
+      // Key leaves the tree at node: link in a chain holding the rest of it.
+      // The chain is built before 'tryLock' whose fence orders it before the
+      // store 'trySetOffset' makes
+      const u_int32_t chain = newChain(key, i+1, size);
+      if (chain==0) {
+        return e_MEMORY_ERROR;
+      }
+      if (!d_locks.tryLock(node, version)) {
+        freeChain(chain);
+        return k_RESTART;
+      }
+      int32_t newMin, newMax;
+      if (nodePtr->trySetOffset(key[i], chain, newMin, newMax)) {
+        d_locks.unlock(node);
+        return e_OK;
+      }
+
+      // Node is full. Copy it into a bigger node holding the chain too then
+      // swing parent to the copy. Root spans every byte so node has a parent
+      assert(i>0);
+      assert(parent!=0);
+      const bool shared = d_locks.stripe(parent)==d_locks.stripe(node);
+      if (shared ? parentVersion!=version : !d_locks.tryLock(parent, parentVersion)) {
+        d_locks.unlock(node);
+        freeChain(chain);
+        return k_RESTART;
+      }
+      lockMemory();
+      const u_int32_t copy = memManager->copyAllocateNode256(newMin, newMax, parent, node);
+      unlockMemory();
+      if (copy==0) {
+        d_locks.unlock(node);
+        if (!shared) {
+          d_locks.unlock(parent);
+        }
+        freeChain(chain);
+        return e_MEMORY_ERROR;
+      }
+      ((Node256*)(basePtr+copy))->setOffset(key[i], chain);
+      Node256 *parentPtr = (Node256*)(basePtr+parent);
+      const u_int32_t parentLink = parentPtr->offset(key[i-1]);
+      assert((parentLink&k_NODE256_NO_TAG_MASK)==node);
+      publishOffset(parentPtr, key[i-1], copy|(parentLink&k_NODE256_ANY_TAG));
+      // Node is dead and may already be reused: the new version fails readers still on it
+      d_locks.unlock(node);
+      if (!shared) {
+        d_locks.unlock(parent);
+      }
+      return e_OK;
+    }
+
+    if ((i+1U)==size) {
+      // Key ends on an inner node: tag the link to it terminal
+      if (link & k_NODE256_IS_TERMINAL) {
+        return e_EXISTS;
+      }
+      if (!d_locks.tryLock(node, version)) {
+        return k_RESTART;
+      }
+      publishOffset(nodePtr, key[i], link|k_NODE256_IS_TERMINAL);
+      d_locks.unlock(node);
+      return e_OK;
+    }
+
+    const u_int32_t child = link & k_NODE256_NO_TAG_MASK;
+    const u_int64_t childVersion = d_locks.readVersion(child);
+    if (!d_locks.validate(node, version)) {
+      return k_RESTART;
+    }
+    parent = node;
+    parentVersion = version;
+    node = child;
+    version = childVersion;
+  }
+
+  assert(false);
+  return e_NOT_FOUND;
+}
+
+u_int32_t CRadix::ConcurrentTree::newChain(const u_int8_t *key, const u_int16_t begin, const u_int16_t size) {
+  assert(begin<=size);
+
+  // Built bottom up so each node is complete when the one above links to it
+  u_int32_t link = k_NODE256_IS_LEAF;
+  lockMemory();
+  for (u_int32_t i=size; i>begin; --i) {
+    const u_int32_t offset = d_tree.d_memManager->newNode256(k_MEMMANAGER_DEFAULT_CAPACITY, key[i-1], link);
+    if (offset==0) {
+      unlockMemory();
+      freeChain(link);
+      return 0;
+    }
+    link = offset;
+  }
+  unlockMemory();
+
+  return link;
+}
+
+void CRadix::ConcurrentTree::freeChain(u_int32_t link) {
+  MemManager *memManager = d_tree.d_memManager;
+  lockMemory();
+  while ((link & k_NODE256_IS_LEAF)==0) {
+    assert(link>=k_MEMMANAGER_MIN_OFFSET);
+    const u_int32_t next = memManager->ptr(link)->d_offset[0];
+    memManager->freeNode256(link);
+    link = next;
+  }
+  unlockMemory();
+}
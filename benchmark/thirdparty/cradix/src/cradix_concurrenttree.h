@@ -0,0 +1,144 @@
+#pragma once
+
+#include <assert.h>
+#include <sys/types.h>
+
+#include <cradix_constants.h>
+#include <cradix_tree.h>
+#include <cradix_versionlocks.h>
+
+#include <benchmark_slice.h>
+
+#include <atomic>
+
+namespace CRadix {
+
+struct MemManager;
+struct Node256;
+
+// Class ConcurrentTree: CRadix tree many threads may insert into and search at once
+//
+// Finds take no lock: they walk 'Node256's remembering each one's version in
+// 'VersionLocks' and restart from the root if a node they read changed. A
+// child's version is taken before its parent's is rechecked so the link
+// followed was live when the child was reached (optimistic lock coupling).
+//
+// Inserts walk the same way. The new part of a key is built off tree as a
+// chain of nodes then published with one store into the last node matched,
+// which is the only node locked. If that node is full it is copied into a
+// bigger node (copy-on-write) and its parent, now locked too, is swung to
+// the copy. The old node goes back to the memory manager under its lock so
+// any reader still on it fails validation before trusting what it read.
+//
+// Keys only: values, 'remove' and 'compact' are single threaded and only
+// run through 'tree()' while no insert or find is running.
+class ConcurrentTree {
+  // DATA
+  Tree                d_tree;           // nodes, root and memory manager
+  VersionLocks        d_locks;          // node versions
+  std::atomic_flag    d_memLock;        // held while calling 'd_tree.d_memManager'
+
+public:
+  // CREATORS
+  ConcurrentTree() = delete;
+    // Default constructor not provided
+
+  explicit ConcurrentTree(MemManager *memManager);
+    // Create empty concurrent tree using specified 'memManager' for memory
+    // management
+
+  ConcurrentTree(const ConcurrentTree& other) = delete;
+    // Copy constructor not provided
+
+  ~ConcurrentTree() = default;
+    // Destroy this tree deallocating all its memory
+
+  // ACCESSORS
+  int find(const Benchmark::Slice<u_int8_t> key) const;
+    // Return 'e_EXISTS' if specified key was found in tree, and 'e_NOT_FOUND'
+    // otherwise. Safe to call while other threads call 'find' or 'insert'.
+
+  // MANIPULATORS
+  int insert(const Benchmark::Slice<u_int8_t> key);
+    // Return 'e_OK' if specified key was inserted into tree or 'e_EXISTS' if
+    // key already exists, and otherwise return 'e_MEMORY_ERROR' if there's
+    // insufficient memory. Safe to call while other threads call 'find' or
+    // 'insert'. Behavior is defined provided 'key.size()>0' and no key was
+    // inserted with a value.
+
+  Tree& tree();
+    // Return the underlying tree. Behavior is defined provided no thread
+    // runs 'find' or 'insert' while it's used.
+
+  ConcurrentTree& operator=(const ConcurrentTree& rhs) = delete;
+    // Assignment operator not provided
+
+private:
+  // PRIVATE ACCESSORS
+  int findOnce(const u_int8_t *key, const u_int16_t size) const;
+    // Return 'e_EXISTS' or 'e_NOT_FOUND' per 'find' for specified 'key' of
+    // specified 'size', or 'k_RESTART' if a node changed under the search
+
+  // PRIVATE MANIPULATORS
+  int insertOnce(const u_int8_t *key, const u_int16_t size);
+    // Return 'e_OK', 'e_EXISTS' or 'e_MEMORY_ERROR' per 'insert' for
+    // specified 'key' of specified 'size', or 'k_RESTART' with the tree
+    // unchanged if a node changed under the insert or could not be locked
+
+  u_int32_t newChain(const u_int8_t *key, const u_int16_t begin, const u_int16_t size);
+    // Return the link to a new off tree chain of nodes holding specified
+    // 'key[begin, size)' ending on a leaf, 'k_NODE256_IS_LEAF' if
+    // 'begin==size', or 0 if there's insufficient memory
+
+  void freeChain(u_int32_t link);
+    // Free the nodes of specified 'link' returned by 'newChain' and never
+    // published
+
+  void lockMemory();
+    // Wait until caller is the only thread calling the memory manager
+
+  void unlockMemory();
+    // Let other threads call the memory manager
+
+  // PRIVATE CLASS DATA
+  static const int k_RESTART = -1;      // 'findOnce/insertOnce' must run again
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+inline
+ConcurrentTree::ConcurrentTree(MemManager *memManager)
+: d_tree(memManager)
+{
+  d_memLock.clear();
+}
+
+// ACCESSORS
+inline
+int ConcurrentTree::find(const Benchmark::Slice<u_int8_t> key) const {
+  assert(key.size()>0);
+  int rc;
+  while ((rc = findOnce(key.data(), key.size()))==k_RESTART) {
+  }
+  return rc;
+}
+
+// MANIPULATORS
+inline
+Tree& ConcurrentTree::tree() {
+  return d_tree;
+}
+
+inline
+void ConcurrentTree::lockMemory() {
+  while (d_memLock.test_and_set(std::memory_order_acquire)) {
+    __builtin_ia32_pause();
+  }
+}
+
+inline
+void ConcurrentTree::unlockMemory() {
+  d_memLock.clear(std::memory_order_release);
+}
+
+} // namespace CRadix
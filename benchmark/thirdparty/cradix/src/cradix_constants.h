@@ -24,7 +24,6 @@ const u_int64_t k_MEMMANAGER_MIN_OFFSET = 8;
 const u_int64_t k_MEMMANAGER_MIN_MEMORY = 1024;
 const u_int32_t k_MEMMANAGER_DEFAULT_CAPACITY = 4;
 const u_int64_t k_MEMMANAGER_MAX_MEMORY = 0x100000000UL;
-const u_int64_t k_MEMMANAGER_DEADMEMORY_RESERVE = 65536;
 
 const u_int32_t k_NODE256_IS_LEAF = 0x01;
 const u_int32_t k_NODE256_IS_TERMINAL = 0x02;
@@ -33,4 +32,8 @@ const u_int32_t k_NODE256_NO_TAG_MASK = 0xFFFFFFFC;
 const u_int32_t k_NODE256_CLR_LEAF_MASK = 0xFFFFFFFE;
 const u_int32_t k_NODE256_CLR_TERMINAL_MASK = 0xFFFFFFFD;
 
+// Leaf links hold '(valueId<<k_NODE256_VALUE_SHIFT)|k_NODE256_IS_LEAF'. Id 0 means no value
+const u_int32_t k_NODE256_VALUE_SHIFT = 2;
+const u_int32_t k_TREE_MAX_VALUE_ID = 0x3FFFFFFF;
+
 } // namespace CRadix
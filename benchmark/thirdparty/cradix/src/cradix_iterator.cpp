@@ -12,8 +12,8 @@ begin:
     assert((d_node&k_NODE256_IS_LEAF)==0);
     d_childNode = d_nodePtr->offset(d_index);
 
-    if (d_childNode<k_MEMMANAGER_MIN_OFFSET) {
-      if (d_childNode==k_NODE256_IS_LEAF) {
+    if (d_childNode<k_MEMMANAGER_MIN_OFFSET || (d_childNode&k_NODE256_IS_LEAF)) {
+      if (d_childNode & k_NODE256_IS_LEAF) {
         d_attributes = k_NODE256_IS_LEAF;
         d_key[d_depth] = (u_int8_t)(d_index);
         ++d_index;
@@ -41,7 +41,7 @@ jump:
     assert(d_depth<d_maxDepth);
     assert((d_childNode&k_NODE256_IS_LEAF)==0);
     d_key[d_depth] = (u_int8_t)(d_index);
-    d_stack.push(CRadix::IterState(d_node, d_index, d_depth));
+    push();
     // following d_childNode: reset
     d_node = d_childNode;
     d_nodePtr = (Node256*)(d_basePtr+(d_childNode&k_NODE256_NO_TAG_MASK));
@@ -51,15 +51,95 @@ jump:
     goto begin;
   }
 
-  if (!d_stack.empty()) {
-    d_index = d_stack.top().d_index+1;
-    d_depth = d_stack.top().d_depth;
-    d_node = d_stack.top().d_node;
+  if (d_stackSize>0) {
+    const IterState& top = d_stack[--d_stackSize];
+    d_index = top.d_index+1;
+    d_depth = top.d_depth;
+    d_node = top.d_node;
     d_nodePtr = (Node256*)(d_basePtr+(d_node&k_NODE256_NO_TAG_MASK));
     d_maxIndex = d_nodePtr->maxIndex();
-    d_stack.pop();
     goto begin;
   }
 
   d_end = true;
 }
+
+void CRadix::Iterator::seek(const Benchmark::Slice<u_int8_t> key) {
+  const u_int8_t *keyPtr = key.data();
+  const u_int16_t size = key.size();
+
+  d_stackSize = 0;
+  d_jump = false;
+  d_end = false;
+  d_depth = 0;
+  d_node = d_root;
+  d_nodePtr = (Node256*)(d_basePtr+d_root);
+  d_maxIndex = d_nodePtr->maxIndex();
+
+  if (d_maxDepth==0) {
+    d_end = true;
+    return;
+  }
+
+  // Follow 'key' down the tree. Where it leaves the tree pick the index at which 'next' finds the first greater
+  // key: the first index in span, the one after the byte, or past the span so 'next' climbs back to the parent
+  for (;;) {
+    if (d_depth>=size) {
+      // Every key below is longer than 'key' it extends
+      d_index = d_nodePtr->minIndex();
+      break;
+    }
+
+    const u_int16_t byte = keyPtr[d_depth];
+    if (byte<d_nodePtr->minIndex()) {
+      d_index = d_nodePtr->minIndex();
+      break;
+    }
+    if (byte>d_maxIndex) {
+      d_index = d_maxIndex+1;
+      break;
+    }
+
+    const u_int32_t link = d_nodePtr->offset(byte);
+    if (link==0) {
+      d_index = byte+1;
+      break;
+    }
+
+    const bool last = (d_depth+1U)==size;
+    if (link & k_NODE256_IS_LEAF) {
+      if (last) {
+        // Exact match: position as 'next' leaves a leaf
+        d_childNode = link;
+        d_attributes = k_NODE256_IS_LEAF;
+        d_key[d_depth] = (u_int8_t)byte;
+        d_index = byte+1;
+        return;
+      }
+      // Leaf is a proper prefix of 'key' so less
+      d_index = byte+1;
+      break;
+    }
+
+    if (last && (link & k_NODE256_IS_TERMINAL)) {
+      // Exact match: position as 'next' leaves a terminal inner node
+      d_childNode = link;
+      d_attributes = k_NODE256_IS_TERMINAL;
+      d_key[d_depth] = (u_int8_t)byte;
+      d_index = byte;
+      d_jump = true;
+      return;
+    }
+
+    // Either 'key' continues below or every key below is greater
+    d_index = byte;
+    d_key[d_depth] = (u_int8_t)byte;
+    push();
+    d_node = link;
+    d_nodePtr = (Node256*)(d_basePtr+(link&k_NODE256_NO_TAG_MASK));
+    d_maxIndex = d_nodePtr->maxIndex();
+    ++d_depth;
+  }
+
+  next();
+}
@@ -4,19 +4,29 @@
 #include <cradix_node256.h>
 #include <cradix_iterstate.h>
 
+#include <benchmark_slice.h>
+
 #include <iostream>
+#include <new>
 
 #include <assert.h>
-
-#include <stack>
+#include <stdlib.h>
+#include <string.h>
 
 namespace CRadix {
 
 class Iterator {
+public:
+  // ENUMS
+  enum {
+    k_INLINE_DEPTH = 64,                // keys up to this size need no heap memory
+  };
+
+private:
   // DATA
-  std::stack<IterState> d_stack;        // stack to revisit parents
+  IterState            *d_stack;        // parents to revisit: 'd_stackSpace' or heap memory shared with 'd_key'
+  u_int8_t             *d_key;          // current key: 'd_keySpace' or heap memory
   u_int8_t             *d_basePtr;      // point to start of memory containing root
-  u_int8_t             *d_key;          // current key (owned)
   Node256              *d_nodePtr;      // d_node as valid pointer
   u_int32_t             d_root;         // offset to tree's root
   u_int32_t             d_node;         // offset to current node
@@ -25,18 +35,23 @@ class Iterator {
   u_int16_t             d_index;        // current index on current node's children offset array
   u_int16_t             d_maxIndex;     // the maximum valid index on current node's children offet array
   u_int16_t             d_depth;        // current tree depth & size of current key minus 1 in bytes
+  u_int16_t             d_stackSize;    // number of entries in 'd_stack'
   const u_int16_t       d_maxDepth;     // maximum length of key
   bool                  d_end;          // true when no more keys
   bool                  d_jump;         // true when resuming from terminal inner node
+  alignas(IterState) u_int8_t d_stackSpace[k_INLINE_DEPTH*sizeof(IterState)];
+  u_int8_t              d_keySpace[k_INLINE_DEPTH];
 
 public:
   // CREATORS
-  Iterator(u_int32_t root, u_int64_t maxDepth, const u_int8_t *basePtr, u_int8_t *keySpace);
-    // Create a Iterator on specified 'root' holding keys of at most 'maxDepth' bytes where specified 'keySpace' is 
-    // memory sufficient to hold the current key. 'keySpace' becomes owned by this object and freed in its destructor.
-    // Specified 'basePtr' points to the start of the memory managed by the root's memory manager when it was 
-    // constructed. Behavior is defined provided there's at least 'maxDepth' bytes of valid, contiguous writeable bytes
-    // in range '[keySpace, keySpace+maxDepth)'.
+  Iterator(u_int32_t root, u_int64_t maxDepth, const u_int8_t *basePtr);
+    // Create a Iterator on specified 'root' holding keys of at most 'maxDepth' bytes positioned on the first key.
+    // Specified 'basePtr' points to the start of the memory managed by the root's memory manager when it was
+    // constructed. The stack of parents and the current key live in this object when 'maxDepth<=k_INLINE_DEPTH'
+    // and otherwise in one heap allocation made here, so neither iteration nor 'seek' allocates memory.
+
+  Iterator(u_int32_t root, u_int64_t maxDepth, const u_int8_t *basePtr, const Benchmark::Slice<u_int8_t> key);
+    // Create a Iterator as above but positioned per 'seek(key)' on the first key not less than specified 'key'
 
   Iterator(const Iterator& other) = delete;
     // Copy constructor not provided
@@ -51,6 +66,14 @@ public:
   u_int16_t keySize() const;
     // Return the size of the current key in bytes. Behavior is defined provided 'end()==false'
 
+  int compare(const Benchmark::Slice<u_int8_t> key) const;
+    // Return a negative value, 0 or a positive value if the current key is respectively less than, equal to or
+    // greater than specified 'key' comparing bytes unsigned then sizes. Behavior is defined provided 'end()==false'
+
+  bool hasPrefix(const Benchmark::Slice<u_int8_t> prefix) const;
+    // Return 'true' if the current key starts with specified 'prefix' or equals it. Behavior is defined provided
+    // 'end()==false'
+
   bool isTerminal() const;
     // Return 'true' if current node is a terminal node or leaf node. Behavior is defined provided 'end()==false'
 
@@ -65,6 +88,11 @@ public:
     // Advance to the next key or set 'end()==true' if no more keys. Caller must ensure 'end()==false' after
     // call returns before invoking accessors
 
+  void seek(const Benchmark::Slice<u_int8_t> key);
+    // Position this iterator on the first key not less than specified 'key', or set 'end()==true' if there is
+    // none. One descent of the tree finds it; 'next' then continues in order from there. 'key' may be empty
+    // which is the same as the first key.
+
   Iterator& operator=(const Iterator& rhs) = delete;
     // Assignment operator not provided
 
@@ -72,15 +100,27 @@ public:
   std::ostream& print(std::ostream& stream) const;
     // Print into specified 'stream' a human readable representation of the current key returning 'stream'.
     // Behavior is defined provided 'end()==false'
+
+private:
+  // PRIVATE MANIPULATORS
+  void push();
+    // Save 'd_node, d_index, d_depth' to revisit after the child at 'd_index' is done
 };
 
 // INLINE DEFINITIONS
 // CREATORS
 
 inline
-Iterator::Iterator(u_int32_t root, u_int64_t maxDepth, const u_int8_t *basePtr, u_int8_t *keySpace)
-: d_basePtr(const_cast<u_int8_t*>(basePtr))
-, d_key(keySpace)
+Iterator::Iterator(u_int32_t root, u_int64_t maxDepth, const u_int8_t *basePtr)
+: Iterator(root, maxDepth, basePtr, Benchmark::Slice<u_int8_t>())
+{
+}
+
+inline
+Iterator::Iterator(u_int32_t root, u_int64_t maxDepth, const u_int8_t *basePtr, const Benchmark::Slice<u_int8_t> key)
+: d_stack(reinterpret_cast<IterState*>(d_stackSpace))
+, d_key(d_keySpace)
+, d_basePtr(const_cast<u_int8_t*>(basePtr))
 , d_nodePtr(0)
 , d_root(root)
 , d_node(root)
@@ -89,37 +129,37 @@ Iterator::Iterator(u_int32_t root, u_int64_t maxDepth, const u_int8_t *basePtr,
 , d_index(0)
 , d_maxIndex(0)
 , d_depth(0)
+, d_stackSize(0)
 , d_maxDepth((u_int16_t)maxDepth)
 , d_end(false)
 , d_jump(false)
-{                                                                                                                       
+{
   assert(d_basePtr);
-  assert(d_key);
   assert(d_root);
   // Root cannot be a leaf
   assert((d_root & k_NODE256_IS_LEAF) == 0);
   // Root cannot be a terminal node
   assert((d_root & k_NODE256_IS_TERMINAL) == 0);
-  // Set up a valid Node256 pointer from root offset
-  d_nodePtr = (Node256*)(d_basePtr+d_root); 
-  assert(d_nodePtr);
-
-  if (maxDepth>0) {
-    d_index = d_nodePtr->minIndex();
-    d_maxIndex = d_nodePtr->maxIndex();
-    next();
-  } else {
-    d_end = true;
+
+  if (maxDepth>k_INLINE_DEPTH) {
+    // Stack first so it's aligned then key
+    d_stack = static_cast<IterState*>(malloc(maxDepth*(sizeof(IterState)+1)));
+    assert(d_stack);
+    d_key = reinterpret_cast<u_int8_t*>(d_stack+maxDepth);
   }
+
+  // An empty key positions on the first key
+  seek(key);
 }
 
 inline
-Iterator::~Iterator() {                                                                                         
-  if (d_key) {                                                                                                          
-    free(d_key);                                                                                  
-    d_key = 0;                                                                                                          
-  }                                                                                                                     
-}     
+Iterator::~Iterator() {
+  if (d_key!=d_keySpace) {
+    free(d_stack);
+  }
+  d_stack = 0;
+  d_key = 0;
+}
 
 inline
 std::ostream& Iterator::print(std::ostream& stream) const {
@@ -157,6 +197,24 @@ u_int16_t Iterator::keySize() const {
   return d_depth+1;
 }
 
+inline
+int Iterator::compare(const Benchmark::Slice<u_int8_t> key) const {
+  assert(!d_end);
+  const u_int32_t size = keySize();
+  const u_int32_t otherSize = key.size();
+  const int rc = memcmp(d_key, key.data(), size<otherSize ? size : otherSize);
+  if (rc!=0) {
+    return rc;
+  }
+  return static_cast<int>(size)-static_cast<int>(otherSize);
+}
+
+inline
+bool Iterator::hasPrefix(const Benchmark::Slice<u_int8_t> prefix) const {
+  assert(!d_end);
+  return keySize()>=prefix.size() && memcmp(d_key, prefix.data(), prefix.size())==0;
+}
+
 inline
 bool Iterator::isTerminal() const {
   assert(!d_end);
@@ -174,4 +232,12 @@ bool Iterator::end() const {
   return d_end;
 }
 
+// PRIVATE MANIPULATORS
+inline
+void Iterator::push() {
+  assert(d_stackSize<d_maxDepth);
+  new(d_stack+d_stackSize) IterState(d_node, d_index, d_depth);
+  ++d_stackSize;
+}
+
 } // namespace CRadix
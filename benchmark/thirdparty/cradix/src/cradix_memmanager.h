@@ -2,7 +2,7 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <iostream>
-#include <vector>
+#include <string.h>
 
 #include <cradix_constants.h>
 #include <cradix_memstats.h>
@@ -23,8 +23,8 @@ struct MemManager {
 #ifdef CRADIX_MEMMANAGER_RUNTIME_STATISTICS
   MemStats    d_stats;                    // runtime memory statistics
 #endif
-  std::vector<u_int32_t>  d_deadOffsets;
-  bool                    d_owned;        // true if memory freed in destructor
+  u_int32_t   d_freeList[k_MAX_CHILDREN+1]; // per capacity, offset of first dead Node256 of that capacity or 0
+  bool        d_owned;                    // true if memory freed in destructor
 
   // CREATORS
   MemManager() = delete;
@@ -67,7 +67,8 @@ struct MemManager {
   u_int32_t newNode256(u_int32_t capacity, u_int32_t index, u_int32_t offset);
     // Allocate memory and construct a Node256 object with specified 'capacity'
     // s.t. on return specified 'offset' is assigned to specified 'index'. The
-    // offset to this new object is returned. Behavior is defined provided
+    // offset to this new object is returned. A dead node of the same capacity
+    // is reused before new memory is taken. Behavior is defined provided
     // '1<=capacity<=k_MAX_CHILDREN'. The rest of the arguments are passed to
     // Node256's constructor and must satisfy its contract. If there's not
     // enough free memory 0 is returned.
@@ -75,15 +76,40 @@ struct MemManager {
   u_int32_t copyAllocateNode256(u_int32_t newMin, u_int32_t newMax, u_int32_t oldParentOffset, u_int32_t oldOffset);
     // Allocate memory with capacity of 'newMax-newMin-1' offsets then copy-construct
     // 'oldOffset' into it where 'oldParentOffset' is 'oldOffset's parent offset.
-    // The memory at 'oldOffset' is marked dead. The offset to the new object is
+    // A dead node of that capacity is reused before new memory is taken. The
+    // memory at 'oldOffset' is marked dead and becomes reusable. The offset to the new object is
     // returned. Behavior is defined provided 'newMin, newMax' and implied new
     // capacity satisfiy the contract for Node256's copy-creator. If there's not
     // enough free memory 0 is returned.
 
+  u_int32_t cloneNode256(const Node256 *node);
+    // Allocate memory for exactly 'node->size()' offsets and copy-construct
+    // specified 'node' into it returning its offset, or 0 if there's not
+    // enough free memory. 'node' may live in another MemManager. Behavior is
+    // defined provided '!node->isDead()'.
+
   u_int32_t newRoot();
     // Allocate memory and construct the root of a CRadix tree object holding
     // zero offset values for all children in the range '[0, k_MAX_CHILDREN)'.
     // If there's no enough free memory 0 is returned.
+
+  void freeNode256(u_int32_t offset);
+    // Mark the Node256 at specified 'offset' dead putting it on the free list
+    // for its capacity for reuse. Behavior is defined provided 'offset' was
+    // returned by 'newNode256' or 'copyAllocateNode256', is not dead, and is
+    // no longer linked from any live node.
+
+private:
+  // PRIVATE MANIPULATORS
+  u_int32_t allocate(u_int32_t capacity);
+    // Return the offset of memory for a Node256 of specified 'capacity' taken
+    // from the free list for 'capacity' if not empty and from unused memory
+    // otherwise, or 0 if there's not enough free memory. Behavior is defined
+    // provided '1<=capacity<=k_MAX_CHILDREN'.
+
+  void release(u_int32_t offset);
+    // Mark the Node256 at specified 'offset' dead and push it onto the free
+    // list for its capacity. Its first offset slot links to the next dead node.
 };
 
 // INLINE DEFINITONS
@@ -119,7 +145,7 @@ MemManager::MemManager(u_int8_t *ptr, u_int64_t size, u_int64_t alignment)
   assert(((d_baseVal+d_offset) & k_NODE256_IS_TERMINAL)==0);
   assert(d_offset<=d_size);
 
-  d_deadOffsets.reserve(CRadix::k_MEMMANAGER_DEADMEMORY_RESERVE);
+  memset(d_freeList, 0, sizeof(d_freeList));
 }
 
 inline
@@ -153,6 +179,8 @@ MemManager::MemManager(u_int64_t size, u_int64_t alignment)
   assert(((d_baseVal+d_offset) & k_NODE256_IS_LEAF)==0);
   assert(((d_baseVal+d_offset) & k_NODE256_IS_TERMINAL)==0);
   assert(d_offset<=d_size);
+
+  memset(d_freeList, 0, sizeof(d_freeList));
 }
 
 inline
@@ -189,44 +217,14 @@ u_int32_t MemManager::newNode256(u_int32_t capacity, u_int32_t index, u_int32_t
   assert(index<k_MAX_CHILDREN);
   assert(capacity>0 && capacity<=k_MAX_CHILDREN);
 
-  // Memory request in bytes
-  u_int64_t sz = sizeof(Node256)+(capacity<<2);
-
-  // Make sure we have memory
-  if ((d_offset+sz)>d_size) {
+  const u_int32_t ret = allocate(capacity);
+  if (ret==0) {
     assert(false);
     return 0;
   }
 
-#ifdef CRADIX_MEMMANAGER_RUNTIME_STATISTICS
-  ++d_stats.d_allocCount;
-  d_stats.d_currentSizeBytes += sz;
-  d_stats.d_requestedBytes += sz;
-  if (d_stats.d_currentSizeBytes>d_stats.d_maximumSizeBytes) {
-    d_stats.d_maximumSizeBytes = d_stats.d_currentSizeBytes;
-  } 
-#endif
-
   // Construct the memory
-  const u_int32_t ret = d_offset;
-  new(d_basePtr+d_offset) Node256(index, offset, capacity);
-
-  // Adjust d_offset to next 'alignment' boundary
-  d_offset += sz;
-  u_int64_t rem = d_offset & d_alignMask;
-  if (rem) {
-    d_offset += (d_alignment - rem);
-    if (d_offset>d_size) {
-      d_offset = d_size;
-    }
-  }  
-
-  assert((d_offset&d_alignMask)==0);
-  assert((d_offset&k_NODE256_IS_LEAF)==0);
-  assert((d_offset&k_NODE256_IS_TERMINAL)==0);
-  assert(((d_baseVal+d_offset) & k_NODE256_IS_LEAF)==0);
-  assert(((d_baseVal+d_offset) & k_NODE256_IS_TERMINAL)==0);
-  assert(d_offset<=d_size);
+  new(d_basePtr+ret) Node256(index, offset, capacity);
 
   return ret;
 }
@@ -235,69 +233,83 @@ inline
 u_int32_t MemManager::copyAllocateNode256(u_int32_t newMin, u_int32_t newMax, u_int32_t oldParentOffset, u_int32_t oldOffset) {
   assert(oldOffset>=k_MEMMANAGER_MIN_OFFSET);
   assert(newMax>newMin);
+  (void)oldParentOffset;
 
   Node256 *oldNode = ptr(oldOffset);
 
-  // Memory request in bytes
-  u_int64_t sz = sizeof(Node256)+((newMax-newMin+1)<<2);
-
-  // Make sure we have memory
-  if ((d_offset+sz)>d_size) {
+  const u_int32_t ret = allocate(newMax-newMin+1);
+  if (ret==0) {
     assert(false);
     return 0;
   }
 
-  d_deadOffsets.push_back(oldParentOffset);
-  d_deadOffsets.push_back(oldOffset);
+  // Copy-construct the memory then retire the old node
+  new(d_basePtr+ret) Node256(newMin, newMax, oldNode);
+  release(oldOffset);
 
-#ifdef CRADIX_MEMMANAGER_RUNTIME_STATISTICS
-  ++d_stats.d_allocCount;
-  d_stats.d_currentSizeBytes += sz;
-  d_stats.d_requestedBytes += sz;
-  if (d_stats.d_currentSizeBytes>d_stats.d_maximumSizeBytes) {
-    d_stats.d_maximumSizeBytes = d_stats.d_currentSizeBytes;
-  } 
-#endif
+  return ret;
+}
+
+inline
+u_int32_t MemManager::cloneNode256(const Node256 *node) {
+  assert(node);
+
+  const u_int32_t ret = allocate(node->size());
+  if (ret==0) {
+    return 0;
+  }
 
   // Copy-construct the memory
-  const u_int32_t ret = d_offset;
-  new(d_basePtr+d_offset) Node256(newMin, newMax, oldNode);
+  new(d_basePtr+ret) Node256(node);
 
-  // Mark old memory dead
-  oldNode->markDead();
-#ifdef CRADIX_MEMMANAGER_RUNTIME_STATISTICS
-  ++d_stats.d_deadCount;
-  d_stats.d_deadBytes += sizeof(Node256)+(oldNode->capacity()<<2);
-#endif
+  return ret;
+}
 
-  // Adjust d_offset to next 'alignment' boundary
-  d_offset += sz;
-  u_int64_t rem = d_offset & d_alignMask;
-  if (rem) {
-    d_offset += (d_alignment - rem);
-    if (d_offset>d_size) {
-      d_offset = d_size;
-    }
-  }  
+inline
+u_int32_t MemManager::newRoot() {
+  const u_int32_t ret = allocate(k_MAX_CHILDREN);
+  if (ret==0) {
+    assert(false);
+    return 0;
+  }
 
-  assert((d_offset&d_alignMask)==0);
-  assert((d_offset&k_NODE256_IS_LEAF)==0);
-  assert((d_offset&k_NODE256_IS_TERMINAL)==0);
-  assert(((d_baseVal+d_offset) & k_NODE256_IS_LEAF)==0);
-  assert(((d_baseVal+d_offset) & k_NODE256_IS_TERMINAL)==0);
-  assert(d_offset<=d_size);
+  // Construct the memory
+  new(d_basePtr+ret) Node256;
 
   return ret;
 }
 
 inline
-u_int32_t MemManager::newRoot() {
+void MemManager::freeNode256(u_int32_t offset) {
+  assert(offset>=k_MEMMANAGER_MIN_OFFSET);
+  assert((offset&k_NODE256_ANY_TAG)==0);
+  release(offset);
+}
+
+// PRIVATE MANIPULATORS
+inline
+u_int32_t MemManager::allocate(u_int32_t capacity) {
+  assert(capacity>0 && capacity<=k_MAX_CHILDREN);
+
   // Memory request in bytes
-  u_int64_t sz = sizeof(Node256)+(k_MAX_CHILDREN<<2);
+  const u_int64_t sz = sizeof(Node256)+(capacity<<2);
+
+  // Reuse a dead node of the same capacity first
+  const u_int32_t dead = d_freeList[capacity];
+  if (dead) {
+    d_freeList[capacity] = ptr(dead)->d_offset[0];
+#ifdef CRADIX_MEMMANAGER_RUNTIME_STATISTICS
+    ++d_stats.d_allocCount;
+    ++d_stats.d_freeCount;
+    d_stats.d_requestedBytes += sz;
+    d_stats.d_freedBytes += sz;
+    d_stats.d_deadBytes -= sz;
+#endif
+    return dead;
+  }
 
   // Make sure we have memory
   if ((d_offset+sz)>d_size) {
-    assert(false);
     return 0;
   }
 
@@ -310,9 +322,7 @@ u_int32_t MemManager::newRoot() {
   } 
 #endif
 
-  // Construct the memory
   const u_int32_t ret = d_offset;
-  new(d_basePtr+d_offset) Node256;
 
   // Adjust d_offset to next 'alignment' boundary
   d_offset += sz;
@@ -334,4 +344,22 @@ u_int32_t MemManager::newRoot() {
   return ret;
 }
 
+inline
+void MemManager::release(u_int32_t offset) {
+  Node256 *node = ptr(offset);
+  assert(!node->isDead());
+
+  // Capacity survives 'markDead' so the node goes back on its own size class
+  const u_int32_t capacity = node->capacity();
+  assert(capacity>0 && capacity<=k_MAX_CHILDREN);
+  node->markDead();
+  node->d_offset[0] = d_freeList[capacity];
+  d_freeList[capacity] = offset;
+
+#ifdef CRADIX_MEMMANAGER_RUNTIME_STATISTICS
+  ++d_stats.d_deadCount;
+  d_stats.d_deadBytes += sizeof(Node256)+(capacity<<2);
+#endif
+}
+
 } // namespace CRadix
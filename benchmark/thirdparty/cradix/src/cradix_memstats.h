@@ -8,11 +8,11 @@ struct MemStats {
   // DATA
   u_int64_t d_allocCount;           // number of Node256s allocated
   u_int64_t d_deadCount;            // number of Node255s marked dead
-  u_int64_t d_freeCount;            // number of Node256s reclaimed after marked dead
-  u_int64_t d_currentSizeBytes;     // current amount of allocated memory
+  u_int64_t d_freeCount;            // number of Node256s reclaimed after marked dead i.e. allocations reusing them
+  u_int64_t d_currentSizeBytes;     // current amount of memory taken from the managed region
   u_int64_t d_maximumSizeBytes;     // max 'currentSizeBytes' seen so far
   u_int64_t d_requestedBytes;       // sum of sizes to all malloc calls
-  u_int64_t d_freedBytes;           // sum of sizes to all free calls
+  u_int64_t d_freedBytes;           // sum of sizes of dead Node256s reclaimed
   u_int64_t d_deadBytes;            // total freed memory not reclaimed
   u_int64_t d_sizeBytes;            // size in bytes of memory under management
 
@@ -26,6 +26,10 @@ struct MemStats {
   ~MemStats() = default;
     // Destory this object
 
+  // ACCESSORS
+  double reuseRate() const;
+    // Return the fraction of allocations satisfied by reclaiming dead memory or 0 if there were none
+
   // MANIPULATORS
   void reset();
     // Reset all attributes to zero
@@ -55,6 +59,12 @@ MemStats::MemStats()
 {
 }
 
+// ACCESSORS
+inline
+double MemStats::reuseRate() const {
+  return d_allocCount ? static_cast<double>(d_freeCount)/static_cast<double>(d_allocCount) : 0.0;
+}
+
 // MANIPULATORS
 inline
 void MemStats::reset() {
@@ -81,6 +91,7 @@ std::ostream& MemStats::print(std::ostream& stream) const {
          << " freedBytes: "       << d_freedBytes
          << " deadBytes: "        << d_deadBytes
          << " sizeBytes: "        << d_sizeBytes
+         << " reuseRate: "        << reuseRate()
          << std::endl;
   return stream;
 }
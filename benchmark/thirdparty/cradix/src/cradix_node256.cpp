@@ -61,10 +61,9 @@ bool CRadix::Node256::trySetOffset(const u_int32_t index, const u_int32_t offset
       memset(d_offset, 0, delta<<2);
       // set/update offset
       d_offset[0] = offset;
-      // clear old min
-      d_udata &= 0xFFFFFF00;
-      // set new min
-      d_udata |= index;
+      // replace old min. One store per header change so lock-free readers
+      // never see a span wider than this node (see 'ConcurrentTree')
+      d_udata = (d_udata & 0xFFFFFF00) | index;
 #ifdef CRADIX_NODE_RUNTIME_STATISTICS                                                                                   
       ++d_nodeStats.d_trySetOffsetCase1Count;
       d_nodeStats.d_bytesCleared += (delta<<2);
@@ -86,10 +85,8 @@ bool CRadix::Node256::trySetOffset(const u_int32_t index, const u_int32_t offset
       memset(d_offset+size(), 0, delta<<2);
       // set/update offset
       d_offset[index-minIndex()] = offset;
-      // clear old max
-      d_udata &= 0xFFFF00FF;
-      // set new max
-      d_udata |= (index<<8);
+      // replace old max
+      d_udata = (d_udata & 0xFFFF00FF) | (index<<8);
 #ifdef CRADIX_NODE_RUNTIME_STATISTICS                                                                                   
       ++d_nodeStats.d_trySetOffsetCase2Count;
       d_nodeStats.d_bytesCleared += (delta<<2);
@@ -112,10 +109,8 @@ bool CRadix::Node256::trySetOffset(const u_int32_t index, const u_int32_t offset
   // at object creation time. Using the definition of size(), capacity()
   // we can work out the new spare capacity. In this code 'size()'
   // reflects the new size since those updates happened above:
-  d_udata &= 0xFF00FFFF;
-  // Set new spare capacity
   assert(oldCapacity>=usize());
-  d_udata |= ((oldCapacity-size()) << 16);
+  d_udata = (d_udata & 0xFF00FFFF) | ((oldCapacity-size()) << 16);
 
 #ifndef NDEBUG
   assert(capacity()==oldCapacity);
@@ -56,6 +56,10 @@ struct Node256 {
     // * '!oldNode->isDead()'
     // Offsets in the this' span not in oldNode are preset 0
 
+  explicit Node256(const Node256 *other);
+    // Copy-create a Node256 from specified 'other' with the same span and offsets but no spare capacity. Behavior is
+    // defined provided '!other->isDead()' and this object has room for 'other->size()' offsets
+
   Node256(const Node256& other) = delete;
     // Default-copy-constuctor not provided
 
@@ -129,6 +133,12 @@ struct Node256 {
     // all entries before call plus specified 'index'. 'newMin, newMax' can be used to copy allocate
     // space for 'index' if desired. See class 'MemManager'.
 
+  void clearOffset(const u_int32_t index);
+    // Set the value at specified 'index' to 0 then, if 'index' was 'minIndex()' or 'maxIndex()', shrink the span
+    // past any now leading or trailing 0 offsets returning the freed slots to spare capacity. Capacity does not
+    // change. If 'index' held the only non-zero offset the span is left as is. Behavior is defined provided
+    // 'minIndex()<=index<=maxIndex()' and 'isDead()==false'
+
   void markDead();
     // Mark this object dead and eligble for reclaimation
 
@@ -218,6 +228,19 @@ Node256::Node256(u_int32_t newMin, u_int32_t newMax, const Node256 *oldNode) {
 #endif
 }
 
+inline
+Node256::Node256(const Node256 *other) {
+  assert(other);
+  assert(!other->isDead());
+  d_udata = other->minIndex() | (other->maxIndex()<<8);
+  memcpy(d_offset, other->d_offset, other->size()<<2);
+
+#ifdef CRADIX_NODE_RUNTIME_STATISTICS
+  ++d_nodeStats.d_copyAllocationCount;
+  d_nodeStats.d_bytesCopied += other->size()<<2;
+#endif
+}
+
 // ACCESSORS
 inline
 u_int32_t Node256::tryOffset(const u_int32_t index) const {
@@ -342,6 +365,39 @@ void Node256::setOffset(const u_int32_t i, u_int32_t offset) {
   d_offset[i-minIndex()] = offset;
 }
 
+inline
+void Node256::clearOffset(const u_int32_t index) {
+  assert(!isDead());
+  assert(index>=minIndex()&&index<=maxIndex());
+#ifdef CRADIX_NODE_RUNTIME_STATISTICS
+  ++d_nodeStats.d_setOffsetCount;
+#endif
+  d_offset[index-minIndex()] = 0;
+
+  u_int32_t newMin = minIndex();
+  u_int32_t newMax = maxIndex();
+  while (newMax>newMin && d_offset[newMax-minIndex()]==0) {
+    --newMax;
+  }
+  while (newMin<newMax && d_offset[newMin-minIndex()]==0) {
+    ++newMin;
+  }
+  if (newMin==minIndex() && newMax==maxIndex()) {
+    return;
+  }
+
+  // Shift the remaining span down to 'd_offset[0]' then recompute spare capacity from the unchanged capacity
+  const u_int32_t oldCapacity = capacity();
+  if (newMin!=minIndex()) {
+    memmove(d_offset, d_offset+(newMin-minIndex()), (newMax-newMin+1)<<2);
+#ifdef CRADIX_NODE_RUNTIME_STATISTICS
+    d_nodeStats.d_bytesCopied += (newMax-newMin+1)<<2;
+#endif
+  }
+  d_udata = (d_udata & k_NODE256_IS_DEAD) | newMin | (newMax<<8) | ((oldCapacity-(newMax-newMin+1))<<16);
+  assert(capacity()==oldCapacity);
+}
+
 inline
 void Node256::markDead() {
   d_udata |= k_NODE256_IS_DEAD;
@@ -2,10 +2,13 @@
 #include <cradix_node256.h>
 #include <cradix_memmanager.h>
 
+#include <stack>
+
 CRadix::Tree::Tree(MemManager *memManager)
 : d_memManager(memManager)
 , d_root(0)
 , d_currentMaxDepth(0)
+, d_values(1, 0)
 {
   assert(d_memManager!=0);
   d_root = d_memManager->newRoot();
@@ -13,7 +16,11 @@ CRadix::Tree::Tree(MemManager *memManager)
 }
 
 CRadix::Iterator CRadix::Tree::begin() const {
-  return Iterator(d_root, currentMaxDepth(), d_memManager->basePtr(), (u_int8_t*)malloc(currentMaxDepth()));
+  return Iterator(d_root, currentMaxDepth(), d_memManager->basePtr());
+}
+
+CRadix::Iterator CRadix::Tree::lowerBound(const Benchmark::Slice<u_int8_t> key) const {
+  return Iterator(d_root, currentMaxDepth(), d_memManager->basePtr(), key);
 }
 
 int CRadix::Tree::findHelper(const u_int8_t *key, const u_int16_t size) const {
@@ -27,10 +34,10 @@ int CRadix::Tree::findHelper(const u_int8_t *key, const u_int16_t size) const {
 
   for (u_int32_t i=0; i<size; ++i) {
     childOffset = node->tryOffset(key[i]);
-    if (childOffset>=k_MEMMANAGER_MIN_OFFSET) {
+    if (childOffset>=k_MEMMANAGER_MIN_OFFSET && (childOffset&k_NODE256_IS_LEAF)==0) {
       childWasTerminal = childOffset & k_NODE256_IS_TERMINAL;
       node = (Node256*)(basePtr+(childOffset&k_NODE256_CLR_TERMINAL_MASK));
-    } else if (childOffset==k_NODE256_IS_LEAF) {
+    } else if (childOffset & k_NODE256_IS_LEAF) {
       return ((i+1U)==size) ? e_EXISTS : e_NOT_FOUND;
     } else {
       assert(childOffset==0);
@@ -38,10 +45,150 @@ int CRadix::Tree::findHelper(const u_int8_t *key, const u_int16_t size) const {
     }
   }
 
-  return (childOffset==k_NODE256_IS_LEAF || childWasTerminal) ? e_EXISTS : e_NOT_FOUND;
+  return childWasTerminal ? e_EXISTS : e_NOT_FOUND;
+}
+
+void CRadix::Tree::findBatch(const Benchmark::Slice<u_int8_t> *keys, int *results, u_int32_t count) const {
+  assert(keys!=0 || count==0);
+  assert(results!=0 || count==0);
+
+  // One lookup of 'findHelper' as a state machine. 'step' runs until the
+  // next read would be a cache miss, prefetches it and returns 'k_RUNNING'
+  struct Lookup {
+    const Node256   *d_node;            // node holding offset for next byte
+    const u_int32_t *d_slot;            // offset for next byte if known else 0
+    u_int32_t        d_key;             // index into 'keys'
+    u_int16_t        d_depth;           // next byte of key to match
+    bool             d_terminal;        // true if last offset was terminal
+  };
+  const int k_RUNNING = -1;
+
+  u_int8_t *basePtr = const_cast<u_int8_t *>(d_memManager->basePtr());
+  const Node256 *root = (const Node256*)(basePtr+d_root);
+
+  auto start = [root](Lookup& lookup, u_int32_t key) {
+    lookup.d_node = root;
+    lookup.d_slot = 0;
+    lookup.d_key = key;
+    lookup.d_depth = 0;
+    lookup.d_terminal = false;
+  };
+
+  auto step = [keys, basePtr](Lookup& lookup) -> int {
+    const Benchmark::Slice<u_int8_t>& key = keys[lookup.d_key];
+    assert(key.size()>0);
+
+    if (lookup.d_slot==0) {
+      // Node header arrived: find the offset for the next byte
+      const u_int32_t index = key.data()[lookup.d_depth];
+      if (index<lookup.d_node->minIndex() || index>lookup.d_node->maxIndex()) {
+        return e_NOT_FOUND;
+      }
+      lookup.d_slot = lookup.d_node->d_offset+(index-lookup.d_node->minIndex());
+      if ((reinterpret_cast<u_int64_t>(lookup.d_slot)>>6)!=(reinterpret_cast<u_int64_t>(lookup.d_node)>>6)) {
+        __builtin_prefetch(lookup.d_slot);
+        return k_RUNNING;
+      }
+    }
+
+    const u_int32_t childOffset = *lookup.d_slot;
+    lookup.d_slot = 0;
+    if (childOffset>=k_MEMMANAGER_MIN_OFFSET && (childOffset&k_NODE256_IS_LEAF)==0) {
+      lookup.d_terminal = childOffset & k_NODE256_IS_TERMINAL;
+      if (++lookup.d_depth==key.size()) {
+        return lookup.d_terminal ? e_EXISTS : e_NOT_FOUND;
+      }
+      lookup.d_node = (const Node256*)(basePtr+(childOffset&k_NODE256_CLR_TERMINAL_MASK));
+      __builtin_prefetch(lookup.d_node);
+      return k_RUNNING;
+    } else if (childOffset & k_NODE256_IS_LEAF) {
+      return ((lookup.d_depth+1U)==key.size()) ? e_EXISTS : e_NOT_FOUND;
+    }
+    assert(childOffset==0);
+    return e_NOT_FOUND;
+  };
+
+  Lookup lookup[k_FIND_BATCH_WIDTH];
+  u_int32_t active(0);
+  u_int32_t next(0);
+  for (; active<k_FIND_BATCH_WIDTH && next<count; ++active, ++next) {
+    start(lookup[active], next);
+  }
+
+  while (active>0) {
+    for (u_int32_t i=0; i<active; ) {
+      const int rc = step(lookup[i]);
+      if (rc==k_RUNNING) {
+        ++i;
+        continue;
+      }
+      results[lookup[i].d_key] = rc;
+      if (next<count) {
+        start(lookup[i], next++);
+        ++i;
+      } else {
+        lookup[i] = lookup[--active];
+      }
+    }
+  }
+}
+
+int CRadix::Tree::locate(const u_int8_t *key, const u_int16_t size, Node256 **node, u_int32_t *link) const {
+  assert(key!=0);
+  assert(size>0);
+  assert(node!=0);
+  assert(link!=0);
+
+  u_int8_t *basePtr = const_cast<u_int8_t *>(d_memManager->basePtr());
+  Node256 *nodePtr = (Node256*)(basePtr+d_root);
+
+  for (u_int32_t i=0; i<size; ++i) {
+    const u_int32_t childOffset = nodePtr->tryOffset(key[i]);
+    if (childOffset==0) {
+      return e_NOT_FOUND;
+    }
+    if ((i+1U)==size) {
+      // Last byte: a leaf or a terminal link to an inner node ends the key
+      if ((childOffset & (k_NODE256_IS_LEAF|k_NODE256_IS_TERMINAL))==0) {
+        return e_NOT_FOUND;
+      }
+      *node = nodePtr;
+      *link = childOffset;
+      return e_EXISTS;
+    }
+    if (childOffset & k_NODE256_IS_LEAF) {
+      return e_NOT_FOUND;
+    }
+    nodePtr = (Node256*)(basePtr+(childOffset&k_NODE256_NO_TAG_MASK));
+  }
+
+  return e_NOT_FOUND;
+}
+
+u_int32_t CRadix::Tree::valueId(u_int32_t link) const {
+  if (link & k_NODE256_IS_LEAF) {
+    return link>>k_NODE256_VALUE_SHIFT;
+  }
+  if (d_terminalValues.empty()) {
+    return 0;
+  }
+  const auto iter = d_terminalValues.find(link&k_NODE256_NO_TAG_MASK);
+  return iter==d_terminalValues.end() ? 0 : iter->second;
+}
+
+int CRadix::Tree::find(const Benchmark::Slice<u_int8_t> key, u_int64_t *value) const {
+  assert(value!=0);
+
+  Node256 *nodePtr(0);
+  u_int32_t link(0);
+  if (locate(key.data(), key.size(), &nodePtr, &link)!=e_EXISTS) {
+    return e_NOT_FOUND;
+  }
+  *value = d_values[valueId(link)];
+  return e_EXISTS;
 }
 
-int CRadix::Tree::insertHelper(const u_int8_t *key, const u_int16_t size,
+int CRadix::Tree::insertHelper(const u_int8_t *key, const u_int16_t size, const u_int32_t valueId,
   u_int16_t *lastMatchIndex, u_int32_t *lastMatch, u_int32_t *lastMatchParent) {
   assert(key!=0);
   assert(size>0);
@@ -59,7 +206,7 @@ int CRadix::Tree::insertHelper(const u_int8_t *key, const u_int16_t size,
 
   for (u_int32_t i=0; i<size; ++i) {
     childOffset = offsetPtr->tryOffset(key[i]);
-    if (childOffset>=k_MEMMANAGER_MIN_OFFSET) {
+    if (childOffset>=k_MEMMANAGER_MIN_OFFSET && (childOffset&k_NODE256_IS_LEAF)==0) {
       pOffset = offset;
       offset = childOffset;
       offsetPtr = (Node256*)(basePtr+(childOffset&k_NODE256_CLR_TERMINAL_MASK));
@@ -72,7 +219,7 @@ int CRadix::Tree::insertHelper(const u_int8_t *key, const u_int16_t size,
       *lastMatchParent = pOffset;
       return e_NOT_FOUND;
     } else {
-      assert(childOffset==k_NODE256_IS_LEAF);
+      assert(childOffset & k_NODE256_IS_LEAF);
       *lastMatchIndex = i+1;
       if (*lastMatchIndex!=size) {
         // Last byte matched ends on leaf node. However the whole key
@@ -87,6 +234,10 @@ int CRadix::Tree::insertHelper(const u_int8_t *key, const u_int16_t size,
         // set offset because we know key[i] valid on offsetPtr:
         *lastMatch = d_memManager->newNode256(k_MEMMANAGER_DEFAULT_CAPACITY, key[*lastMatchIndex], 0);
         offsetPtr->setOffset(key[i], (*lastMatch|k_NODE256_IS_TERMINAL));
+        // The leaf's value, if any, now belongs to the terminal node
+        if (childOffset>>k_NODE256_VALUE_SHIFT) {
+          d_terminalValues[*lastMatch] = childOffset>>k_NODE256_VALUE_SHIFT;
+        }
         *lastMatchParent = pOffset;
         return e_NOT_FOUND;
       } else {
@@ -106,12 +257,58 @@ int CRadix::Tree::insertHelper(const u_int8_t *key, const u_int16_t size,
   assert(pOffset>=k_MEMMANAGER_MIN_OFFSET);
   offsetPtr = (Node256*)(basePtr+(pOffset&k_NODE256_CLR_TERMINAL_MASK));
   offset = offsetPtr->offset(key[size-1]);
+  if (offset & k_NODE256_IS_TERMINAL) {
+    return e_EXISTS;
+  }
   offsetPtr->setOffset(key[size-1], (offset|k_NODE256_IS_TERMINAL));
+  if (valueId) {
+    d_terminalValues[offset] = valueId;
+  }
 
   return e_OK;
 }
 
-int CRadix::Tree::insert(const Benchmark::Slice<u_int8_t> key) {
+int CRadix::Tree::insert(const Benchmark::Slice<u_int8_t> key, u_int64_t value) {
+  const u_int32_t id = newValueId(value);
+  if (id==0) {
+    return e_MEMORY_ERROR;
+  }
+
+  const int rc = insertValueId(key, id);
+  if (rc!=e_OK) {
+    freeValueId(id);
+  }
+
+  return rc;
+}
+
+int CRadix::Tree::upsert(const Benchmark::Slice<u_int8_t> key, u_int64_t value) {
+  Node256 *nodePtr(0);
+  u_int32_t link(0);
+  if (locate(key.data(), key.size(), &nodePtr, &link)!=e_EXISTS) {
+    return insert(key, value);
+  }
+
+  u_int32_t id = valueId(link);
+  if (id) {
+    d_values[id] = value;
+    return e_EXISTS;
+  }
+
+  // Key was inserted without a value
+  if ((id = newValueId(value))==0) {
+    return e_MEMORY_ERROR;
+  }
+  if (link & k_NODE256_IS_LEAF) {
+    nodePtr->setOffset(key.data()[key.size()-1], (id<<k_NODE256_VALUE_SHIFT)|k_NODE256_IS_LEAF);
+  } else {
+    d_terminalValues[link&k_NODE256_NO_TAG_MASK] = id;
+  }
+
+  return e_EXISTS;
+}
+
+int CRadix::Tree::insertValueId(const Benchmark::Slice<u_int8_t> key, const u_int32_t valueId) {
   int rc;
   u_int32_t lastMatch(0);
   u_int32_t lastMatchParent(0);
@@ -120,7 +317,7 @@ int CRadix::Tree::insert(const Benchmark::Slice<u_int8_t> key) {
   const u_int8_t *keyPtr = key.data();
 
   // Find node with longest pre-existing prefix in key
-  if ((rc = insertHelper(keyPtr, size, &lastMatchIndex, &lastMatch, &lastMatchParent)) != e_NOT_FOUND) {
+  if ((rc = insertHelper(keyPtr, size, valueId, &lastMatchIndex, &lastMatch, &lastMatchParent)) != e_NOT_FOUND) {
     return rc;
   }
 
@@ -178,7 +375,8 @@ int CRadix::Tree::insert(const Benchmark::Slice<u_int8_t> key) {
   }
 
   // Termination of case 2 OR case 1
-  if (!lastMatchPtr->trySetOffset(byte, k_NODE256_IS_LEAF, newMin, newMax)) {
+  const u_int32_t leaf = (valueId<<k_NODE256_VALUE_SHIFT) | k_NODE256_IS_LEAF;
+  if (!lastMatchPtr->trySetOffset(byte, leaf, newMin, newMax)) {
     Node256 *parentPtr = (Node256*)(basePtr+(lastMatchParent&k_NODE256_NO_TAG_MASK));
     // Ok, now reallocate child and relink it
     u_int32_t copyOffset = reallocateAndLink(parentPtr, keyPtr[lastMatchIndex-1], newMin, newMax, lastMatchParent, lastMatch);
@@ -186,7 +384,7 @@ int CRadix::Tree::insert(const Benchmark::Slice<u_int8_t> key) {
     // update pointer to 'lastMatch' to reflect reallocation
     lastMatchPtr = (Node256*)(basePtr+copyOffset);
     // now complete assignment as intended
-    lastMatchPtr->setOffset(byte, k_NODE256_IS_LEAF);
+    lastMatchPtr->setOffset(byte, leaf);
   }
 
   if (size>d_currentMaxDepth) {
@@ -196,6 +394,176 @@ int CRadix::Tree::insert(const Benchmark::Slice<u_int8_t> key) {
   return CRadix::e_OK;
 }
 
+int CRadix::Tree::remove(const Benchmark::Slice<u_int8_t> key) {
+  const u_int16_t size = key.size();
+  const u_int8_t *keyPtr = key.data();
+  assert(keyPtr!=0);
+  assert(size>0);
+
+  u_int8_t *basePtr = const_cast<u_int8_t *>(d_memManager->basePtr());
+
+  // Walk the key remembering the deepest edge removal has to change. Below it every node on the key's path has
+  // exactly one child and is not the end of another key, so it exists only for this key and is freed. That edge
+  // is either cleared in a node which keeps other children (root included), or is the terminal link to a node
+  // with one child which becomes a leaf because a shorter key ends there.
+  u_int32_t cut = d_root;
+  u_int16_t cutIndex = 0;
+  bool makeLeaf = false;
+
+  u_int32_t node = d_root;
+  Node256  *nodePtr = (Node256*)(basePtr+d_root);
+  u_int32_t childOffset(0);
+  u_int32_t parent(0);
+  u_int32_t parentLink(0);
+
+  for (u_int16_t i=0; i<size; ++i) {
+    if (i>0) {
+      if (nodePtr->minIndex()!=nodePtr->maxIndex()) {
+        cut = node;
+        cutIndex = i;
+        makeLeaf = false;
+      } else if (parentLink & k_NODE256_IS_TERMINAL) {
+        cut = parent;
+        cutIndex = i-1;
+        makeLeaf = true;
+      }
+    }
+
+    childOffset = nodePtr->tryOffset(keyPtr[i]);
+    if (childOffset==0) {
+      return e_NOT_FOUND;
+    }
+
+    if (childOffset & k_NODE256_IS_LEAF) {
+      if ((i+1U)!=size) {
+        return e_NOT_FOUND;
+      }
+      break;
+    }
+
+    assert(childOffset>=k_MEMMANAGER_MIN_OFFSET);
+    if ((i+1U)==size) {
+      // Key ends on an inner node which still leads to longer keys
+      if ((childOffset & k_NODE256_IS_TERMINAL)==0) {
+        return e_NOT_FOUND;
+      }
+      nodePtr->setOffset(keyPtr[i], childOffset&k_NODE256_CLR_TERMINAL_MASK);
+      if (!d_terminalValues.empty()) {
+        const auto iter = d_terminalValues.find(childOffset&k_NODE256_NO_TAG_MASK);
+        if (iter!=d_terminalValues.end()) {
+          freeValueId(iter->second);
+          d_terminalValues.erase(iter);
+        }
+      }
+      return e_OK;
+    }
+
+    parent = node;
+    parentLink = childOffset;
+    node = childOffset&k_NODE256_NO_TAG_MASK;
+    nodePtr = (Node256*)(basePtr+node);
+  }
+
+  // Key ends on a leaf. Unlink the chain below 'cut' then free it
+  freeValueId(childOffset>>k_NODE256_VALUE_SHIFT);
+  Node256 *cutPtr = (Node256*)(basePtr+cut);
+  u_int32_t link = cutPtr->offset(keyPtr[cutIndex]);
+  if (makeLeaf) {
+    // The shorter key's value moves from its terminal node to the leaf replacing it
+    u_int32_t id(0);
+    if (!d_terminalValues.empty()) {
+      const auto iter = d_terminalValues.find(link&k_NODE256_NO_TAG_MASK);
+      if (iter!=d_terminalValues.end()) {
+        id = iter->second;
+        d_terminalValues.erase(iter);
+      }
+    }
+    cutPtr->setOffset(keyPtr[cutIndex], (id<<k_NODE256_VALUE_SHIFT)|k_NODE256_IS_LEAF);
+  } else if (cut==d_root) {
+    // Root always spans every byte
+    cutPtr->setOffset(keyPtr[cutIndex], 0);
+  } else {
+    cutPtr->clearOffset(keyPtr[cutIndex]);
+  }
+
+  for (u_int16_t i=cutIndex+1; (link&k_NODE256_IS_LEAF)==0; ++i) {
+    assert(i<size);
+    assert(link>=k_MEMMANAGER_MIN_OFFSET);
+    const u_int32_t chain = link&k_NODE256_NO_TAG_MASK;
+    link = ((Node256*)(basePtr+chain))->offset(keyPtr[i]);
+    d_memManager->freeNode256(chain);
+  }
+
+  return e_OK;
+}
+
+int CRadix::Tree::compact(MemManager *memManager) {
+  assert(memManager);
+  assert(memManager!=d_memManager);
+
+  // Walk the copy not the original: each copied node starts out holding its children's old offsets which are
+  // replaced one by one by offsets of their copies. The original is only read so failing part way is harmless
+  const u_int8_t *oldBasePtr = d_memManager->basePtr();
+  const u_int32_t root = memManager->cloneNode256((const Node256*)(oldBasePtr+d_root));
+  if (root==0) {
+    return e_MEMORY_ERROR;
+  }
+
+  std::unordered_map<u_int32_t, u_int32_t> terminalValues;
+  std::stack<IterState> stack;
+  u_int32_t node = root;
+  Node256  *nodePtr = memManager->ptr(root);
+  u_int16_t index = nodePtr->minIndex();
+  u_int16_t maxIndex = nodePtr->maxIndex();
+  u_int16_t depth(0);
+
+begin:
+  while (index<=maxIndex) {
+    const u_int32_t link = nodePtr->offset(index);
+    if (link<k_MEMMANAGER_MIN_OFFSET || (link&k_NODE256_IS_LEAF)) {
+      ++index;
+      continue;
+    }
+
+    const u_int32_t child = memManager->cloneNode256((const Node256*)(oldBasePtr+(link&k_NODE256_NO_TAG_MASK)));
+    if (child==0) {
+      return e_MEMORY_ERROR;
+    }
+    nodePtr->setOffset(index, child | (link&k_NODE256_ANY_TAG));
+    if ((link & k_NODE256_IS_TERMINAL) && !d_terminalValues.empty()) {
+      const auto iter = d_terminalValues.find(link&k_NODE256_NO_TAG_MASK);
+      if (iter!=d_terminalValues.end()) {
+        terminalValues[child] = iter->second;
+      }
+    }
+
+    // Copy child's subtree next so it lands right after child
+    stack.push(CRadix::IterState(node, index, depth));
+    node = child;
+    nodePtr = memManager->ptr(child);
+    index = nodePtr->minIndex();
+    maxIndex = nodePtr->maxIndex();
+    depth++;
+    goto begin;
+  }
+
+  if (!stack.empty()) {
+    index = stack.top().d_index+1;
+    depth = stack.top().d_depth;
+    node = stack.top().d_node;
+    nodePtr = memManager->ptr(node);
+    maxIndex = nodePtr->maxIndex();
+    stack.pop();
+    goto begin;
+  }
+
+  d_memManager = memManager;
+  d_root = root;
+  d_terminalValues.swap(terminalValues);
+
+  return e_OK;
+}
+
 void CRadix::Tree::statistics(TreeStats *stats) const {
   assert(stats);
   stats->reset();
@@ -218,8 +586,8 @@ begin:
     assert((node&k_NODE256_IS_LEAF)==0);
     childNode = nodePtr->offset(index);
 
-    if (childNode<k_MEMMANAGER_MIN_OFFSET) {
-      if (childNode==k_NODE256_IS_LEAF) {
+    if (childNode<k_MEMMANAGER_MIN_OFFSET || (childNode&k_NODE256_IS_LEAF)) {
+      if (childNode & k_NODE256_IS_LEAF) {
         ++stats->d_leafCount;
         ++stats->d_terminalCount;
         if ((depth+1U)>stats->d_maxDepth) {
@@ -293,8 +661,8 @@ begin:
     assert((node&k_NODE256_IS_LEAF)==0);
     childNode = nodePtr->offset(index);
 
-    if (childNode<k_MEMMANAGER_MIN_OFFSET) {
-      if (childNode==k_NODE256_IS_LEAF) {
+    if (childNode<k_MEMMANAGER_MIN_OFFSET || (childNode&k_NODE256_IS_LEAF)) {
+      if (childNode & k_NODE256_IS_LEAF) {
         if (isprint(index)) {
           buf[0] = char(index);
           buf[1] = 0;
@@ -401,9 +769,37 @@ u_int32_t CRadix::Tree::reallocateAndLink(Node256 *parentPtr, u_int8_t byte, int
   u_int32_t newOffset = d_memManager->copyAllocateNode256(min, max, parent&k_NODE256_NO_TAG_MASK, child&k_NODE256_NO_TAG_MASK);                 
   assert(newOffset!=0);                                                                                                 
   parentPtr->setOffset(byte, newOffset | (child&k_NODE256_ANY_TAG));                                                    
+  if ((child & k_NODE256_IS_TERMINAL) && !d_terminalValues.empty()) {
+    const auto iter = d_terminalValues.find(child&k_NODE256_NO_TAG_MASK);
+    if (iter!=d_terminalValues.end()) {
+      const u_int32_t id = iter->second;
+      d_terminalValues.erase(iter);
+      d_terminalValues[newOffset] = id;
+    }
+  }
   return newOffset;                                                                                                     
 }
 
+u_int32_t CRadix::Tree::newValueId(u_int64_t value) {
+  if (!d_freeValueIds.empty()) {
+    const u_int32_t id = d_freeValueIds.back();
+    d_freeValueIds.pop_back();
+    d_values[id] = value;
+    return id;
+  }
+  if (d_values.size()>k_TREE_MAX_VALUE_ID) {
+    return 0;
+  }
+  d_values.push_back(value);
+  return d_values.size()-1;
+}
+
+void CRadix::Tree::freeValueId(u_int32_t id) {
+  if (id) {
+    d_freeValueIds.push_back(id);
+  }
+}
+
 void CRadix::Tree::destroy() {
   // TBD by memory reclaimation
   return;
@@ -10,6 +10,9 @@
 
 #include <benchmark_slice.h>
 
+#include <unordered_map>
+#include <vector>
+
 namespace CRadix {
 
 struct MemManager;
@@ -19,8 +22,21 @@ class Tree {
   MemManager *d_memManager;             // to manage memory
   u_int32_t   d_root;                   // root node offset
   u_int16_t   d_currentMaxDepth;        // max depth of tree
+  std::vector<u_int64_t>  d_values;     // values by id; id 0 holds 0 for keys without a value
+  std::vector<u_int32_t>  d_freeValueIds;
+                                        // ids freed by 'remove' for reuse
+  std::unordered_map<u_int32_t, u_int32_t>
+              d_terminalValues;         // value id by node offset of keys ending on an inner node
+
+  // FRIENDS
+  friend class ConcurrentTree;          // walks and links nodes under its own locks
 
 public:
+  // ENUMS
+  enum {
+    k_FIND_BATCH_WIDTH = 16,            // lookups 'findBatch' interleaves
+  };
+
   // CREATORS
   Tree() = delete;
     // Default constructor not provided
@@ -39,6 +55,9 @@ public:
   u_int64_t currentMaxDepth() const;
     // Return the size in bytes of the maximum sized key in tree
 
+  MemManager *memManager() const;
+    // Return the memory manager holding this tree's nodes
+
   void statistics(TreeStats *stats) const;
     // Compute tree statistics setting result into specified 'stats'.
 
@@ -49,19 +68,77 @@ public:
     // Return 'e_EXISTS' if specified key was found in tree, and 'e_NOT_FOUND'
     // otherwise.
 
+  int find(const Benchmark::Slice<u_int8_t> key, u_int64_t *value) const;
+    // Return 'e_EXISTS' setting specified 'value' to the value held for
+    // specified 'key' if found, and 'e_NOT_FOUND' otherwise. Keys inserted
+    // without a value hold 0.
+
+  void findBatch(const Benchmark::Slice<u_int8_t> *keys, int *results, u_int32_t count) const;
+    // Set 'results[i]' to 'find(keys[i])' for each 'i<count'. Up to
+    // 'k_FIND_BATCH_WIDTH' lookups are in flight at once: each one prefetches
+    // the next memory it reads then yields to the next lookup so their cache
+    // misses overlap. A finished lookup's place is taken by the next key.
+
+  u_int64_t valueSizeBytes() const;
+    // Return the bytes of memory used to hold values outside the memory
+    // manager
+
   Iterator begin() const;
     // Return a in-order read-only key iterator on this tree. It's behavior is
     // defined provided 'insert/remove' not run while in scope.
 
+  Iterator lowerBound(const Benchmark::Slice<u_int8_t> key) const;
+    // Return a in-order read-only key iterator on this tree positioned on the
+    // first key not less than specified 'key'. It's behavior is defined
+    // provided 'insert/remove/compact' not run while in scope.
+
+  template<typename VISITOR>
+  u_int64_t scan(const Benchmark::Slice<u_int8_t> start, const Benchmark::Slice<u_int8_t> end, u_int64_t limit,
+    VISITOR& visitor) const;
+    // Call specified 'visitor(key, size)' in key order on at most specified
+    // 'limit' keys not less than specified 'start' and less than specified
+    // 'end' returning the number of keys visited. An empty 'end' is no bound.
+
+  template<typename VISITOR>
+  u_int64_t scanPrefix(const Benchmark::Slice<u_int8_t> prefix, u_int64_t limit, VISITOR& visitor) const;
+    // Call specified 'visitor(key, size)' in key order on at most specified
+    // 'limit' keys starting with specified 'prefix', 'prefix' itself
+    // included, returning the number of keys visited.
+
   // MANIUPLATORS
   int insert(const Benchmark::Slice<u_int8_t> key);
     // Return 'e_OK' if specified key was inserted into tree or 'e_EXISTS' if 
     // if key already exists, and otherwise return 'e_MEMORY_ERROR' if there's
     // insufficient memory to perform insertion.
 
+  int insert(const Benchmark::Slice<u_int8_t> key, u_int64_t value);
+    // Return 'e_OK' if specified key was inserted into tree holding specified
+    // 'value', 'e_EXISTS' leaving the held value unchanged if key already
+    // exists, and 'e_MEMORY_ERROR' if there's insufficient memory. A key
+    // ending on a leaf keeps its value's id in the leaf link itself so no
+    // memory is allocated per key. A key which is a prefix of other keys
+    // keeps it in a side table.
+
+  int upsert(const Benchmark::Slice<u_int8_t> key, u_int64_t value);
+    // Return 'e_OK' if specified key was inserted into tree holding specified
+    // 'value', 'e_EXISTS' if key already existed and now holds 'value', and
+    // 'e_MEMORY_ERROR' if there's insufficient memory.
+
   int remove(const Benchmark::Slice<u_int8_t> key);
     // Return 'e_OK' if specified key was removed from tree or 'e_NOT_FOUND'
-    // if key was not found.
+    // if key was not found. Inner nodes left holding no key are freed to the
+    // memory manager, and spans of nodes losing their first or last child
+    // shrink in place. A removed key which is a prefix of other keys only
+    // loses its terminal tag.
+
+  int compact(MemManager *memManager);
+    // Return 'e_OK' after copying every live node into specified empty
+    // 'memManager' in depth-first order, each with no spare capacity, then
+    // using 'memManager' from now on, and 'e_MEMORY_ERROR' if 'memManager'
+    // ran out of memory. On error the tree is unchanged. On success the
+    // previous memory manager holds no live node and may be destroyed.
+    // Lookups walk parents then children in adjacent memory. Behavior is
+    // defined provided 'memManager' is not this tree's memory manager.
 
   void destroy();
     // Destory this object and deallocate all memory leaving tree empty
@@ -76,12 +153,36 @@ private:
     // if found, and 'e_NOT_FOUND' otherwise. The behavior is defined provided
     // 'size>0'.
 
+  int locate(const u_int8_t *key, const u_int16_t size, Node256 **node, u_int32_t *link) const;
+    // Search for specified 'key' of specified 'size' returning 'e_EXISTS'
+    // if found, and 'e_NOT_FOUND' otherwise. If found specified 'node' is set
+    // to the node holding the key's last byte and specified 'link' to the
+    // offset held there. The behavior is defined provided 'size>0'.
+
+  u_int32_t valueId(u_int32_t link) const;
+    // Return the value id of the key ending at specified 'link', a leaf or a
+    // terminal link to an inner node, or 0 if the key has no value
+
   // PRIVATE MANIPULATORS
-  int insertHelper(const u_int8_t *key, const u_int16_t size,
+  int insertValueId(const Benchmark::Slice<u_int8_t> key, const u_int32_t valueId);
+    // Return 'e_OK' if specified key was inserted into tree holding value
+    // specified 'valueId', 'e_EXISTS' if key already exists, and
+    // 'e_MEMORY_ERROR' if there's insufficient memory.
+
+  u_int32_t newValueId(u_int64_t value);
+    // Return the id of a value slot holding specified 'value', or 0 if there
+    // are no more ids. Ids of freed slots are reused first.
+
+  void freeValueId(u_int32_t id);
+    // Make specified value 'id' available to 'newValueId'. Do nothing if
+    // 'id==0'.
+
+  int insertHelper(const u_int8_t *key, const u_int16_t size, const u_int32_t valueId,
     u_int16_t *lastMatchIndex, u_int32_t *lastMatch, u_int32_t *lastMatchParent);
     // Search for specified 'key' of specified 'size' returning 'e_EXISTS'
     // if found, and 'e_NOT_FOUND' otherwise. The behavior is defined provided
-    // 'size>0'. 'lastMatchIndex, lastMatch, lastMatchParent' are set and defined
+    // 'size>0'. If the key ends on an existing inner node that node is marked
+    // terminal holding specified 'valueId' and 'e_OK' is returned. 'lastMatchIndex, lastMatch, lastMatchParent' are set and defined
     // only when 'e_NOT_FOUND' is returned. In that case '0<=lastMatchIndex<size'
     // is set to the last byte matched in key, 'lastMatch' points to the node
     // offset in which 'key[*lastMatchIndex]' terminates. 'lastMatchParent' is
@@ -151,9 +252,52 @@ u_int64_t Tree::currentMaxDepth() const {
   return d_currentMaxDepth;
 }
 
+inline
+MemManager *Tree::memManager() const {
+  return d_memManager;
+}
+
 inline
 int Tree::find(const Benchmark::Slice<u_int8_t> key) const {
   return findHelper(key.data(), key.size());
 }
 
+inline
+u_int64_t Tree::valueSizeBytes() const {
+  return d_values.capacity()*sizeof(u_int64_t) + d_freeValueIds.capacity()*sizeof(u_int32_t) +
+    d_terminalValues.size()*2*sizeof(u_int32_t);
+}
+
+template<typename VISITOR>
+inline
+u_int64_t Tree::scan(const Benchmark::Slice<u_int8_t> start, const Benchmark::Slice<u_int8_t> end, u_int64_t limit,
+  VISITOR& visitor) const {
+  u_int64_t count(0);
+  const bool bounded = end.size()>0;
+  for (Iterator iter = lowerBound(start); count<limit && !iter.end(); iter.next(), ++count) {
+    if (bounded && iter.compare(end)>=0) {
+      break;
+    }
+    visitor(iter.key(), iter.keySize());
+  }
+  return count;
+}
+
+template<typename VISITOR>
+inline
+u_int64_t Tree::scanPrefix(const Benchmark::Slice<u_int8_t> prefix, u_int64_t limit, VISITOR& visitor) const {
+  u_int64_t count(0);
+  for (Iterator iter = lowerBound(prefix); count<limit && !iter.end() && iter.hasPrefix(prefix); iter.next(),
+    ++count) {
+    visitor(iter.key(), iter.keySize());
+  }
+  return count;
+}
+
+// MANIPULATORS
+inline
+int Tree::insert(const Benchmark::Slice<u_int8_t> key) {
+  return insertValueId(key, 0);
+}
+
 } // namespace Radix
@@ -0,0 +1 @@
+#include <cradix_versionlocks.h>
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+
+#include <assert.h>
+#include <sys/types.h>
+
+namespace CRadix {
+
+// Class VersionLocks: Optimistic lock coupling versions for Node256s
+//
+// A Node256 has no room for a version so each node offset hashes to one of
+// 'k_STRIPES' 64-bit versions here. An even version is unlocked. A writer
+// makes it odd while it changes any node hashing to it, then even again one
+// higher. A reader takes the version before reading a node and checks it is
+// unchanged after: if not the node may have changed under it and the reader
+// restarts. Nodes sharing a version only cost each other spurious restarts.
+class VersionLocks {
+public:
+  // ENUMS
+  enum {
+    k_STRIPES = 1<<16,                  // number of versions
+  };
+
+private:
+  // DATA
+  std::atomic<u_int64_t> *d_versions;   // 'k_STRIPES' versions
+
+public:
+  // CREATORS
+  VersionLocks();
+    // Create VersionLocks with every version 0 e.g. unlocked
+
+  VersionLocks(const VersionLocks& other) = delete;
+    // Copy constructor not provided
+
+  ~VersionLocks();
+    // Destroy this object
+
+  // ACCESSORS
+  u_int32_t stripe(u_int32_t offset) const;
+    // Return the index of the version specified node 'offset' hashes to
+
+  u_int64_t readVersion(u_int32_t offset) const;
+    // Return the version of the node at specified 'offset' waiting while a
+    // writer holds it. Reads of the node made after this call are ordered
+    // after it.
+
+  bool validate(u_int32_t offset, u_int64_t version) const;
+    // Return true if the version of the node at specified 'offset' is still
+    // specified 'version' returned by 'readVersion', and false otherwise.
+    // Reads of the node made before this call are ordered before it so
+    // 'true' means they saw no concurrent write.
+
+  // MANIPULATORS
+  bool tryLock(u_int32_t offset, u_int64_t version);
+    // Return true if the node at specified 'offset' is now locked by caller
+    // because its version was still specified 'version', and false
+    // otherwise. Never waits so writers holding locks cannot deadlock.
+
+  void unlock(u_int32_t offset);
+    // Unlock the node at specified 'offset' giving it a new version. Writes
+    // made while locked are ordered before it. Behavior is defined provided
+    // caller locked it.
+
+  VersionLocks& operator=(const VersionLocks& rhs) = delete;
+    // Assignment operator not provided
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+inline
+VersionLocks::VersionLocks()
+: d_versions(new std::atomic<u_int64_t>[k_STRIPES])
+{
+  for (u_int32_t i=0; i<k_STRIPES; ++i) {
+    d_versions[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+inline
+VersionLocks::~VersionLocks() {
+  delete [] d_versions;
+  d_versions = 0;
+}
+
+// ACCESSORS
+inline
+u_int32_t VersionLocks::stripe(u_int32_t offset) const {
+  // Fibonacci hashing: the top bits of the product mix every bit of 'offset'
+  static_assert(k_STRIPES==(1<<16));
+  return (offset*0x9E3779B1U)>>16;
+}
+
+inline
+u_int64_t VersionLocks::readVersion(u_int32_t offset) const {
+  const std::atomic<u_int64_t>& version = d_versions[stripe(offset)];
+  u_int64_t value;
+  while ((value = version.load(std::memory_order_acquire)) & 1) {
+    __builtin_ia32_pause();
+  }
+  return value;
+}
+
+inline
+bool VersionLocks::validate(u_int32_t offset, u_int64_t version) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return d_versions[stripe(offset)].load(std::memory_order_relaxed)==version;
+}
+
+// MANIPULATORS
+inline
+bool VersionLocks::tryLock(u_int32_t offset, u_int64_t version) {
+  assert((version & 1)==0);
+  if (!d_versions[stripe(offset)].compare_exchange_strong(version, version+1, std::memory_order_acquire)) {
+    return false;
+  }
+  // Readers must see the odd version before any write made while locked
+  std::atomic_thread_fence(std::memory_order_release);
+  return true;
+}
+
+inline
+void VersionLocks::unlock(u_int32_t offset) {
+  std::atomic<u_int64_t>& version = d_versions[stripe(offset)];
+  assert(version.load(std::memory_order_relaxed) & 1);
+  version.fetch_add(1, std::memory_order_release);
+}
+
+} // namespace CRadix
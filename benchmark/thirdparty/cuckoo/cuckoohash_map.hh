@@ -474,6 +474,48 @@ public:
     }
   }
 
+  /**
+   * Searches the table for each of the @p count keys at @p keys, and invokes
+   * @p fn with each key's index in @p keys and a pointer to its value, or
+   * nullptr if the key was not found. Keys are taken in groups of
+   * kFindBatchSize. Every key in a group is hashed and its two buckets and
+   * their locks are prefetched before any key in the group is searched, so the
+   * cache misses of different keys overlap instead of following one another.
+   * @p fn is not allowed to modify the contents of the value.
+   *
+   * @tparam K type of the key. This can be any type comparable with @c key_type
+   * @tparam F type of the functor. It should implement the method
+   * <tt>void operator()(size_type, const mapped_type*)</tt>.
+   * @param keys the keys to search for
+   * @param count the number of keys at @p keys
+   * @param fn the functor to invoke for each key
+   */
+  template <typename K, typename F>
+  void find_batch_fn(const K *keys, size_type count, F fn) const {
+    hash_value hv[kFindBatchSize];
+    for (size_type first = 0; first < count; first += kFindBatchSize) {
+      const size_type n = std::min(count - first, kFindBatchSize);
+      const size_type hp = hashpower();
+      const locks_t &locks = get_current_locks();
+      for (size_type i = 0; i < n; ++i) {
+        hv[i] = hashed_key(keys[first + i]);
+        const size_type i1 = index_hash(hp, hv[i].hash);
+        const size_type i2 = alt_index(hp, hv[i].partial, i1);
+        __builtin_prefetch(&locks[lock_ind(i1)]);
+        __builtin_prefetch(&locks[lock_ind(i2)]);
+        __builtin_prefetch(&buckets_[i1]);
+        __builtin_prefetch(&buckets_[i2]);
+      }
+      for (size_type i = 0; i < n; ++i) {
+        const auto b = snapshot_and_lock_two<normal_mode>(hv[i]);
+        const table_position pos =
+            cuckoo_find(keys[first + i], hv[i].partial, b.i1, b.i2);
+        fn(first + i,
+           pos.status == ok ? &buckets_[pos.index].mapped(pos.slot) : nullptr);
+      }
+    }
+  }
+
   /**
    * Searches the table for @p key, and invokes @p fn on the value. @p fn is
    * allow to modify the contents of the value if found.
@@ -2015,6 +2057,9 @@ private:
 
   static constexpr size_type kMaxNumLocks = 1UL << 16;
 
+  // The number of keys find_batch_fn hashes and prefetches before searching
+  static constexpr size_type kFindBatchSize = 16;
+
   locks_t &get_current_locks() const { return all_locks_.back(); }
 
   // Get/set/decrement num remaining lazy rehash locks. If we reach 0 remaining
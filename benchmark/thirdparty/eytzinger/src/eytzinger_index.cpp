@@ -0,0 +1,122 @@
+#include <eytzinger_index.h>
+
+#include <algorithm>
+#include <utility>
+
+#include <stdlib.h>
+
+static u_int64_t *allocSlots(u_int64_t count) {
+  // Return cache line aligned memory for 'count' slots so slots '8k' to '8k+7' share one line
+  const u_int64_t bytes = ((count*sizeof(u_int64_t)+63)/64)*64;
+  void *ptr = aligned_alloc(64, bytes);
+  assert(ptr);
+  return static_cast<u_int64_t*>(ptr);
+}
+
+Eytzinger::Index::~Index() {
+  free(d_prefix);
+  free(d_keys);
+  d_prefix = 0;
+  d_keys = 0;
+}
+
+u_int64_t Eytzinger::Index::memory() const {
+  return (d_prefix ? 2*(d_size+1)*sizeof(u_int64_t) : 0) + d_pending.capacity()*sizeof(Benchmark::UKey);
+}
+
+void Eytzinger::Index::findBatch(const Benchmark::UKey *keys, int *results, u_int32_t count) const {
+  assert(keys);
+  assert(results);
+
+  // Every descent takes one step per level, the last level excepted, so lookups advance in lock step
+  const unsigned levels = d_size ? 64-__builtin_clzll(d_size) : 0;
+  u_int64_t prefixes[k_FIND_BATCH_WIDTH];
+  u_int64_t slots[k_FIND_BATCH_WIDTH];
+
+  for (u_int32_t first=0; first<count; first+=k_FIND_BATCH_WIDTH) {
+    const u_int32_t width = std::min(count-first, static_cast<u_int32_t>(k_FIND_BATCH_WIDTH));
+    for (u_int32_t i=0; i<width; ++i) {
+      prefixes[i] = prefix(keys[first+i].data(), keys[first+i].size());
+      slots[i] = 1;
+    }
+    for (unsigned level=0; level<levels; ++level) {
+      for (u_int32_t i=0; i<width; ++i) {
+        if (slots[i]<=d_size) {
+          __builtin_prefetch(d_prefix + slots[i]*k_PREFETCH_SLOTS);
+          slots[i] = 2*slots[i] + less(slots[i], prefixes[i], keys[first+i]);
+        }
+      }
+    }
+    for (u_int32_t i=0; i<width; ++i) {
+      const u_int64_t slot = slots[i] >> __builtin_ffsll(~slots[i]);
+      results[first+i] = slot && equal(slot, prefixes[i], keys[first+i]) ? e_EXISTS : e_NOT_FOUND;
+    }
+  }
+}
+
+void Eytzinger::Index::allKeys(std::vector<Benchmark::UKey>& keys) const {
+  for (u_int64_t slot=1; slot<=d_size; ++slot) {
+    keys.push_back(Benchmark::UKey(d_keys[slot]));
+  }
+  keys.insert(keys.end(), d_pending.begin(), d_pending.end());
+}
+
+u_int64_t Eytzinger::Index::build(std::vector<Benchmark::UKey> *dropped) {
+  // Keys already searched come first so a stable sort keeps them over equal staged keys
+  std::vector<std::pair<u_int64_t, u_int64_t>> sorted;
+  sorted.reserve(d_size+d_pending.size());
+  for (u_int64_t slot=1; slot<=d_size; ++slot) {
+    sorted.emplace_back(d_prefix[slot], d_keys[slot]);
+  }
+  for (const auto& key: d_pending) {
+    sorted.emplace_back(prefix(key.data(), key.size()), key.rawValue());
+  }
+
+  std::stable_sort(sorted.begin(), sorted.end(),
+    [](const std::pair<u_int64_t, u_int64_t>& lhs, const std::pair<u_int64_t, u_int64_t>& rhs) {
+      if (lhs.first!=rhs.first) {
+        return lhs.first<rhs.first;
+      }
+      return compare(Benchmark::UKey(lhs.second), Benchmark::UKey(rhs.second))<0;
+    });
+
+  u_int64_t unique(0);
+  for (u_int64_t i=0; i<sorted.size(); ++i) {
+    if (unique>0 && sorted[i].first==sorted[unique-1].first &&
+      compare(Benchmark::UKey(sorted[i].second), Benchmark::UKey(sorted[unique-1].second))==0) {
+      if (dropped) {
+        dropped->push_back(Benchmark::UKey(sorted[i].second));
+      }
+      continue;
+    }
+    sorted[unique++] = sorted[i];
+  }
+  sorted.resize(unique);
+
+  free(d_prefix);
+  free(d_keys);
+  d_size = unique;
+  d_prefix = allocSlots(d_size+1);
+  d_keys = allocSlots(d_size+1);
+  d_prefix[0] = d_keys[0] = 0;
+
+  u_int64_t used(0);
+  layout(sorted, used, 1);
+  assert(used==d_size);
+
+  std::vector<Benchmark::UKey>().swap(d_pending);
+  return d_size;
+}
+
+void Eytzinger::Index::layout(const std::vector<std::pair<u_int64_t, u_int64_t>>& sorted, u_int64_t& used,
+  u_int64_t slot) {
+  // In-order walk of the implicit tree hands out keys in sorted order. Depth is about log2 of the key count
+  if (slot>d_size) {
+    return;
+  }
+  layout(sorted, used, 2*slot);
+  d_prefix[slot] = sorted[used].first;
+  d_keys[slot] = sorted[used].second;
+  ++used;
+  layout(sorted, used, 2*slot+1);
+}
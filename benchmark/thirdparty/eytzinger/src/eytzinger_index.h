@@ -0,0 +1,251 @@
+#pragma once
+
+// PURPOSE: Read-only sorted key set laid out in Eytzinger (BFS) order for branch-free, prefetched search
+//
+// CLASSES:
+//  Eytzinger::Index: Sorted, de-duplicated keys rebuilt in one go by 'build' from keys staged by 'add'
+//
+// A sorted array searched by binary search touches a new cache line on nearly every probe and mispredicts about
+// half its branches. Eytzinger order stores the implicit binary search tree level by level: the root in slot 1 and
+// the children of slot 'k' in slots '2k, 2k+1'. The descent then computes the next slot instead of branching, and
+// the 8 slots 3 levels below 'k', '8k' to '8k+7', sit in one cache line which can be prefetched 3 levels early.
+//
+// Each slot holds the first 8 key bytes big-endian, zero padded, so integer order is key order up to ties, and
+// the key's 'Slice::rawValue' in a second array of the same order. Descent compares prefixes only; the key itself
+// is read on a prefix tie, and once at the end to confirm a match. Keys are not copied: they must outlive the index.
+
+#include <benchmark_slice.h>
+
+#include <utility>
+#include <vector>
+
+#include <string.h>
+#include <assert.h>
+#include <sys/types.h>
+
+namespace Eytzinger {
+
+enum Errno {
+  e_OK        = 0,
+  e_NOT_FOUND = 1,
+  e_EXISTS    = 2,
+};
+
+class Index {
+  // DATA
+  u_int64_t                     *d_prefix;  // slot 'k' in '[1, d_size]': big-endian first 8 key bytes zero padded
+  u_int64_t                     *d_keys;    // slot 'k' in '[1, d_size]': key's 'Slice::rawValue'
+  u_int64_t                      d_size;    // number of keys 'find' searches
+  std::vector<Benchmark::UKey>   d_pending; // keys staged by 'add' since the last 'build'
+
+public:
+  // ENUMS
+  enum {
+    k_FIND_BATCH_WIDTH = 16,                // lookups 'findBatch' descends together
+    k_PREFETCH_SLOTS   = 8,                 // prefixes per cache line: 3 levels below a slot
+  };
+
+  // CREATORS
+  Index();
+    // Create an empty index
+
+  Index(const Index& other) = delete;
+    // Copy constructor not provided
+
+  ~Index();
+    // Destroy this index. Keys are not freed.
+
+  // ACCESSORS
+  u_int64_t size() const;
+    // Return the number of keys 'find' searches
+
+  u_int64_t pending() const;
+    // Return the number of keys staged by 'add' since the last 'build'
+
+  u_int64_t memory() const;
+    // Return the bytes of memory used by the searched slots and the staged keys
+
+  int find(const Benchmark::UKey key) const;
+    // Return 'e_EXISTS' if specified 'key' was found, and 'e_NOT_FOUND' otherwise. Keys staged since the last
+    // 'build' are not found.
+
+  int find(const Benchmark::UKey key, Benchmark::UKey *found) const;
+    // Return 'e_EXISTS' setting specified 'found' to the key held equal to specified 'key' if found, and
+    // 'e_NOT_FOUND' otherwise
+
+  void findBatch(const Benchmark::UKey *keys, int *results, u_int32_t count) const;
+    // Set 'results[i]' to 'find(keys[i])' for each 'i<count'. Up to 'k_FIND_BATCH_WIDTH' lookups descend one level
+    // each in turn, each prefetching the slots 3 levels below its next, so their cache misses overlap.
+
+  template<typename VISITOR>
+  u_int64_t scan(const Benchmark::UKey start, u_int64_t limit, VISITOR& visitor) const;
+    // Call specified 'visitor(key, size)' in key order on at most specified 'limit' keys not less than specified
+    // 'start' returning the number of keys visited
+
+  void allKeys(std::vector<Benchmark::UKey>& keys) const;
+    // Append to specified 'keys' every key searched and staged, in no particular order
+
+  // MANIPULATORS
+  void add(const Benchmark::UKey key);
+    // Stage specified 'key' for the next 'build'. Behavior is defined provided 'key' is not empty.
+
+  u_int64_t build(std::vector<Benchmark::UKey> *dropped = 0);
+    // Return the number of keys searched after rebuilding the index from the keys searched and those staged
+    // sorted with duplicates removed. A staged key equal to a key already searched, or to an earlier staged key, is
+    // dropped and appended to specified 'dropped' if given.
+
+  Index& operator=(const Index& rhs) = delete;
+    // Assignment operator not provided
+
+  // STATIC FUNCTIONS
+  static u_int64_t prefix(const u_int8_t *key, u_int16_t size);
+    // Return the first 8 bytes of specified 'key' of specified 'size' as a big-endian integer, zero padded when
+    // 'size<8', so 'prefix(a)<prefix(b)' implies 'a<b' in key order
+
+  static int compare(const Benchmark::UKey lhs, const Benchmark::UKey rhs);
+    // Return a negative value, 0, or a positive value if specified 'lhs' is less than, equal to, or greater than
+    // specified 'rhs' in key order: bytes compared unsigned, a proper prefix first
+
+private:
+  // PRIVATE ACCESSORS
+  bool less(u_int64_t slot, u_int64_t prefix, const Benchmark::UKey key) const;
+    // Return true if the key in specified 'slot' is less than specified 'key' with specified 'prefix'. Prefixes
+    // decide without a branch but for a tie which reads the slot's key.
+
+  u_int64_t lowerBound(u_int64_t prefix, const Benchmark::UKey key) const;
+    // Return the slot of the first key not less than specified 'key' with specified 'prefix', or 0 if there is none
+
+  u_int64_t next(u_int64_t slot) const;
+    // Return the slot of the key after the one in specified 'slot' in key order, or 0 if there is none
+
+  bool equal(u_int64_t slot, u_int64_t prefix, const Benchmark::UKey key) const;
+    // Return true if the key in specified 'slot' equals specified 'key' with specified 'prefix'. Behavior is
+    // defined provided '0<slot<=d_size'.
+
+  // PRIVATE MANIPULATORS
+  void layout(const std::vector<std::pair<u_int64_t, u_int64_t>>& sorted, u_int64_t& used, u_int64_t slot);
+    // Fill the subtree at specified 'slot' in order from specified 'sorted' prefix, 'Slice::rawValue' pairs
+    // starting after the specified 'used' first ones, adding to 'used' the number filled
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+inline
+Index::Index()
+: d_prefix(0)
+, d_keys(0)
+, d_size(0)
+{
+}
+
+// ACCESSORS
+inline
+u_int64_t Index::size() const {
+  return d_size;
+}
+
+inline
+u_int64_t Index::pending() const {
+  return d_pending.size();
+}
+
+inline
+int Index::find(const Benchmark::UKey key) const {
+  const u_int64_t keyPrefix = prefix(key.data(), key.size());
+  const u_int64_t slot = lowerBound(keyPrefix, key);
+  return slot && equal(slot, keyPrefix, key) ? e_EXISTS : e_NOT_FOUND;
+}
+
+inline
+int Index::find(const Benchmark::UKey key, Benchmark::UKey *found) const {
+  assert(found);
+  const u_int64_t keyPrefix = prefix(key.data(), key.size());
+  const u_int64_t slot = lowerBound(keyPrefix, key);
+  if (slot && equal(slot, keyPrefix, key)) {
+    *found = Benchmark::UKey(d_keys[slot]);
+    return e_EXISTS;
+  }
+  return e_NOT_FOUND;
+}
+
+template<typename VISITOR>
+inline
+u_int64_t Index::scan(const Benchmark::UKey start, u_int64_t limit, VISITOR& visitor) const {
+  u_int64_t visited(0);
+  for (u_int64_t slot = lowerBound(prefix(start.data(), start.size()), start); slot && visited<limit;
+    slot = next(slot)) {
+    const Benchmark::UKey key(d_keys[slot]);
+    visitor(key.data(), key.size());
+    ++visited;
+  }
+  return visited;
+}
+
+inline
+bool Index::less(u_int64_t slot, u_int64_t prefix, const Benchmark::UKey key) const {
+  const u_int64_t slotPrefix = d_prefix[slot];
+  if (__builtin_expect(slotPrefix==prefix, 0)) {
+    return compare(Benchmark::UKey(d_keys[slot]), key)<0;
+  }
+  return slotPrefix<prefix;
+}
+
+inline
+u_int64_t Index::lowerBound(u_int64_t prefix, const Benchmark::UKey key) const {
+  u_int64_t slot(1);
+  while (slot<=d_size) {
+    __builtin_prefetch(d_prefix + slot*k_PREFETCH_SLOTS);
+    slot = 2*slot + less(slot, prefix, key);
+  }
+  // Each trailing 1 bit is a right turn after the last left turn, whose parent is the lower bound
+  return slot >> __builtin_ffsll(~slot);
+}
+
+inline
+u_int64_t Index::next(u_int64_t slot) const {
+  if (2*slot+1<=d_size) {
+    // Leftmost slot of the right subtree
+    for (slot = 2*slot+1; 2*slot<=d_size; slot *= 2) {
+    }
+    return slot;
+  }
+  // Climb out of right subtrees then up once more
+  return slot >> __builtin_ffsll(~slot);
+}
+
+inline
+bool Index::equal(u_int64_t slot, u_int64_t prefix, const Benchmark::UKey key) const {
+  assert(slot>0 && slot<=d_size);
+  if (d_prefix[slot]!=prefix) {
+    return false;
+  }
+  const Benchmark::UKey held(d_keys[slot]);
+  return held.size()==key.size() && (key.size()<=8 || 0==memcmp(held.data()+8, key.data()+8, key.size()-8));
+}
+
+// MANIPULATORS
+inline
+void Index::add(const Benchmark::UKey key) {
+  assert(key.size()>0);
+  d_pending.push_back(key);
+}
+
+// STATIC FUNCTIONS
+inline
+u_int64_t Index::prefix(const u_int8_t *key, u_int16_t size) {
+  u_int64_t value(0);
+  memcpy(&value, key, size<8 ? size : 8);
+  return __builtin_bswap64(value);
+}
+
+inline
+int Index::compare(const Benchmark::UKey lhs, const Benchmark::UKey rhs) {
+  const u_int16_t size = lhs.size()<rhs.size() ? lhs.size() : rhs.size();
+  const int rc = memcmp(lhs.data(), rhs.data(), size);
+  if (rc) {
+    return rc;
+  }
+  return (int)lhs.size()-(int)rhs.size();
+}
+
+} // namespace Eytzinger
@@ -38,6 +38,103 @@ int Patricia::findKey(Patricia::Tree *t, Benchmark::UKey key) {
   return key.equal(reinterpret_cast<void*>(p)) ? Patricia::Errno::e_OK : Patricia::Errno::e_NOT_FOUND;
 }
 
+int Patricia::findKey(Patricia::Tree *t, Benchmark::UKey key, Benchmark::UKey *leaf) {
+  assert(t);
+  assert(leaf);
+  assert(key.data());
+  assert(key.size());
+
+  if (!t->root) {
+    return Patricia::Errno::e_NOT_FOUND;
+  }
+
+  const u_int8_t *const keyData      = key.data();
+  const u_int16_t       keyDataSize  = key.size() - 1;
+
+  intptr_t p = reinterpret_cast<intptr_t>(t->root);
+  while (1 & p) {
+    Patricia::InternalNode *q = reinterpret_cast<Patricia::InternalNode*>(p-1);
+
+    u_int8_t c = 0;
+    if (q->diffIndex < keyDataSize) {
+      c = keyData[q->diffIndex];
+    }
+    const int direction = (1 + (q->diffMask | c)) >> 8;
+
+    p = reinterpret_cast<intptr_t>(q->child[direction]);
+  }
+
+  if (!key.equal(reinterpret_cast<void*>(p))) {
+    return Patricia::Errno::e_NOT_FOUND;
+  }
+
+  // Leaf is the key as given to 'insertKey' which may differ in address from 'key'
+  *leaf = Benchmark::UKey(reinterpret_cast<void*>(p));
+  return Patricia::Errno::e_OK;
+}
+
+void Patricia::findKeys(Patricia::Tree *t, const Benchmark::UKey *keys, int *results, unsigned count) {
+  assert(t);
+  assert(keys || count==0);
+  assert(results || count==0);
+
+  if (!t->root) {
+    for (unsigned i=0; i<count; ++i) {
+      results[i] = Patricia::Errno::e_NOT_FOUND;
+    }
+    return;
+  }
+
+  // 'findKey' as a state machine: 'p' is the prefetched node or leaf to read next
+  struct Lookup {
+    intptr_t  p;
+    unsigned  key;
+  };
+
+  Lookup lookup[Patricia::k_FIND_BATCH_WIDTH];
+  unsigned active = 0;
+  unsigned next = 0;
+  for (; active<Patricia::k_FIND_BATCH_WIDTH && next<count; ++active, ++next) {
+    lookup[active].p = reinterpret_cast<intptr_t>(t->root);
+    lookup[active].key = next;
+  }
+
+  while (active>0) {
+    for (unsigned i=0; i<active; ) {
+      Lookup& l = lookup[i];
+      Benchmark::UKey key = keys[l.key];
+      assert(key.data());
+      assert(key.size());
+
+      if (1 & l.p) {
+        Patricia::InternalNode *q = reinterpret_cast<Patricia::InternalNode*>(l.p-1);
+
+        u_int8_t c = 0;
+        if (q->diffIndex < static_cast<u_int16_t>(key.size()-1)) {
+          c = key.data()[q->diffIndex];
+        }
+        const int direction = (1 + (q->diffMask | c)) >> 8;
+
+        // Next is another node or a leaf: a Slice whose top 16 bits hold its size
+        l.p = reinterpret_cast<intptr_t>(q->child[direction]);
+        __builtin_prefetch(reinterpret_cast<void*>((1 & l.p) ? l.p-1 : l.p & 0xFFFFFFFFFFFFLL));
+        ++i;
+        continue;
+      }
+
+      // Leaf arrived
+      results[l.key] = key.equal(reinterpret_cast<void*>(l.p)) ? Patricia::Errno::e_OK : Patricia::Errno::e_NOT_FOUND;
+      if (next<count) {
+        l.p = reinterpret_cast<intptr_t>(t->root);
+        l.key = next++;
+        ++i;
+      } else {
+        l = lookup[--active];
+      }
+    }
+  }
+}
+
 int Patricia::insertKey(Patricia::Tree *t, Benchmark::UKey key) {
   assert(t);
   assert(key.data());
@@ -125,6 +222,56 @@ different_byte_found:
   return Patricia::Errno::e_OK;
 }
 
+int Patricia::deleteKey(Patricia::Tree *t, Benchmark::UKey key) {
+  assert(t);
+  assert(key.data());
+  assert(key.size());
+
+  if (!t->root) {
+    return Patricia::Errno::e_NOT_FOUND;
+  }
+
+  const u_int8_t *const keyData      = key.data();
+  const u_int16_t       keyDataSize  = key.size() - 1;
+
+  // Walk as 'findKey' does remembering the link to the leaf and the link to its parent
+  void **wherep = reinterpret_cast<void**>(&t->root);
+  void **whereq = 0;
+  Patricia::InternalNode *q = 0;
+  int direction = 0;
+
+  intptr_t p = reinterpret_cast<intptr_t>(*wherep);
+  while (1 & p) {
+    whereq = wherep;
+    q = reinterpret_cast<Patricia::InternalNode*>(p-1);
+
+    u_int8_t c = 0;
+    if (q->diffIndex < keyDataSize) {
+      c = keyData[q->diffIndex];
+    }
+    direction = (1 + (q->diffMask | c)) >> 8;
+
+    wherep = q->child + direction;
+    p = reinterpret_cast<intptr_t>(*wherep);
+  }
+
+  if (!key.equal(reinterpret_cast<void*>(p))) {
+    return Patricia::Errno::e_NOT_FOUND;
+  }
+
+  // Only leaf?
+  if (!whereq) {
+    t->root = 0;
+    return Patricia::Errno::e_OK;
+  }
+
+  // Leaf's sibling replaces its parent
+  *whereq = q->child[1 - direction];
+  memManager.freeInternalNode(q);
+
+  return Patricia::Errno::e_OK;
+}
+
 void Patricia::allKeysSorted(Tree *t, std::vector<Benchmark::UKey>& leaf) {
   leaf.clear();
   
@@ -38,6 +38,10 @@ typedef struct {
   u_int8_t  diffMask;     // bit mask at byte location of difference
 } InternalNode;
 
+enum {
+  k_FIND_BATCH_WIDTH = 16,  // lookups 'findKeys' interleaves
+};
+
 enum Errno {
   e_OK        = 0,
   e_NOT_FOUND = 1,
@@ -54,6 +58,10 @@ extern void statsTree(Tree *t, TreeStats *stats);
 extern int  insertKey(Tree *t,   const Benchmark::UKey key);
 extern int  deleteKey(Tree *t,   const Benchmark::UKey key);
 extern int  findKey(Tree *t,     const Benchmark::UKey key);
+extern int  findKey(Tree *t,     const Benchmark::UKey key, Benchmark::UKey *leaf);
+extern void findKeys(Tree *t,    const Benchmark::UKey *keys, int *results, unsigned count);
+  // Set 'results[i]' to 'findKey(t, keys[i])' for each 'i<count' with up to 'k_FIND_BATCH_WIDTH' lookups in flight.
+  // Each prefetches the next node, or finally its leaf, then yields to the next lookup so their cache misses overlap.
 
 class MemoryManager {
   // DATA
@@ -0,0 +1,193 @@
+#pragma once
+
+// PURPOSE: Multi-threaded safe ring-buffer many writers 'append' to, and one reader 'read's from
+//
+// CLASSES: RingBuffer::BasicMPSC: Multiple producer (MP) single consumer (SC) buffer with power of 2 capacity fixed at
+//                                 construction, k_MPSC_CAPACITY by default, operating on objects of type 'VALUE'
+//          RingBuffer::MPSC:      'BasicMPSC' of 'RingBuffer::Op'
+//          RingBuffer::WordMPSC:  'BasicMPSC' of 8 byte 'RingBuffer::Word'
+//
+// Each slot carries a sequence number telling whose turn it is (Vyukov's bounded queue). Producers claim a slot with
+// one CAS on the shared write index then publish it by storing its sequence. The one consumer owns the read index so
+// it needs no CAS: it checks the slot's sequence then hands the slot back one lap ahead. A batch 'append' claims all
+// its slots with one CAS. Slots are still published one sequence store each because the consumer checks each one;
+// on x86 those are plain stores.
+
+#include <atomic>
+#include <thread>
+
+#include <ringbuffer_op.h>
+
+#include <assert.h>
+
+namespace RingBuffer {
+
+const u_int64_t k_MPSC_CAPACITY = 4096;
+
+template<typename VALUE>
+struct BasicMPSC {
+  // TYPES
+  struct Cell {
+    // DATA
+    std::atomic<u_int64_t>  d_sequence;   // 'pos' free for producer at 'pos', 'pos+1' full for consumer at 'pos'
+    VALUE                   d_value;
+  };
+
+  // DATA
+  alignas(64) std::atomic<u_int64_t>          d_writeIdx;
+  alignas(64) u_int64_t                       d_readIdx;
+  alignas(64) const u_int64_t                 d_mask;
+  Cell                                       *d_data;
+
+public:
+  // CREATORS
+  explicit BasicMPSC(u_int64_t capacity = k_MPSC_CAPACITY);
+    // Construct MPSC (multi-producer, single-consumer) queue operating on 'VALUE' objects with specified 'capacity'
+    // slots. Behavior is defined provided 'capacity>1' is a power of 2.
+
+  BasicMPSC(const BasicMPSC& other) = delete;
+    // Copy constructor not provided
+
+  ~BasicMPSC();
+    // Destroy this object
+
+  // MANIPULATORS
+  bool append(const VALUE& value);
+    // Return true if specified 'value' was appended to queue and false if queue full. Any number of producer
+    // threads may call 'append' at once.
+
+  u_int64_t append(const VALUE *values, u_int64_t count);
+    // Return the number of the first of specified 'count' 'values' appended to queue in order, which is less than
+    // 'count' only if the queue filled. Objects one call appends are contiguous in the queue. Any number of
+    // producer threads may call 'append' at once.
+
+  bool read(VALUE& value);
+    // Return true if next object for reader was copied into specified 'value' and false othewise. Note that false
+    // means queue empty or the next object is claimed but not yet published. Behavior is defined provided the
+    // consumer thread only calls 'read'.
+
+  u_int64_t read(VALUE *values, u_int64_t count);
+    // Return the number of objects, at most specified 'count', copied in order into specified 'values' stopping at
+    // the first not yet published. Behavior is defined provided the consumer thread only calls 'read'.
+
+  BasicMPSC& operator=(const BasicMPSC& rhs) = delete;
+    // Assignment operator not provided
+};
+
+typedef BasicMPSC<Op>   MPSC;
+typedef BasicMPSC<Word> WordMPSC;
+
+// INLINE DEFINITIONS
+// CREATORS
+template<typename VALUE>
+inline
+BasicMPSC<VALUE>::BasicMPSC(u_int64_t capacity)
+: d_writeIdx(0)
+, d_readIdx(0)
+, d_mask(capacity-1)
+, d_data(new Cell[capacity])
+{
+  assert(capacity>1);
+  assert((capacity & (capacity-1))==0);
+  for (u_int64_t i=0; i<capacity; ++i) {
+    d_data[i].d_sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+template<typename VALUE>
+inline
+BasicMPSC<VALUE>::~BasicMPSC() {
+  delete [] d_data;
+  d_data = 0;
+}
+
+// MANIPULATORS
+template<typename VALUE>
+inline
+bool BasicMPSC<VALUE>::append(const VALUE& value) {
+  Cell *cell;
+  u_int64_t writeIdx = d_writeIdx.load(std::memory_order_relaxed);
+  for (;;) {
+    cell = d_data + (writeIdx & d_mask);
+    const int64_t diff = (int64_t)cell->d_sequence.load(std::memory_order_acquire) - (int64_t)writeIdx;
+    if (diff==0) {
+      // Slot free: claim it unless another producer got there first
+      if (d_writeIdx.compare_exchange_weak(writeIdx, writeIdx+1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff<0) {
+      // Slot still holds what the consumer has not read one lap ago
+      return false;
+    } else {
+      writeIdx = d_writeIdx.load(std::memory_order_relaxed);
+    }
+  }
+  cell->d_value = value;
+  cell->d_sequence.store(writeIdx+1, std::memory_order_release);
+  return true;
+}
+
+template<typename VALUE>
+inline
+u_int64_t BasicMPSC<VALUE>::append(const VALUE *values, u_int64_t count) {
+  if (count>d_mask+1) {
+    count = d_mask+1;
+  }
+
+  u_int64_t writeIdx = d_writeIdx.load(std::memory_order_relaxed);
+  while (count>0) {
+    // The consumer frees slots in order so if the last slot wanted is free, so are the ones before it
+    const u_int64_t lastIdx = writeIdx+count-1;
+    const int64_t diff = (int64_t)d_data[writeIdx & d_mask].d_sequence.load(std::memory_order_acquire) -
+      (int64_t)writeIdx;
+    const int64_t lastDiff = (int64_t)d_data[lastIdx & d_mask].d_sequence.load(std::memory_order_acquire) -
+      (int64_t)lastIdx;
+    if (diff<0) {
+      return 0;
+    } else if (diff>0 || lastDiff>0) {
+      writeIdx = d_writeIdx.load(std::memory_order_relaxed);
+    } else if (lastDiff<0) {
+      // Queue fills part way: claim fewer
+      count = count/2;
+    } else if (d_writeIdx.compare_exchange_weak(writeIdx, writeIdx+count, std::memory_order_relaxed)) {
+      for (u_int64_t i=0; i<count; ++i) {
+        Cell *cell = d_data + ((writeIdx+i) & d_mask);
+        cell->d_value = values[i];
+        cell->d_sequence.store(writeIdx+i+1, std::memory_order_release);
+      }
+      return count;
+    }
+  }
+  return 0;
+}
+
+template<typename VALUE>
+inline
+bool BasicMPSC<VALUE>::read(VALUE& value) {
+  Cell *cell = d_data + (d_readIdx & d_mask);
+  if (cell->d_sequence.load(std::memory_order_acquire)!=d_readIdx+1) {
+    return false;
+  }
+  value = cell->d_value;
+  cell->d_sequence.store(d_readIdx+d_mask+1, std::memory_order_release);
+  ++d_readIdx;
+  return true;
+}
+
+template<typename VALUE>
+inline
+u_int64_t BasicMPSC<VALUE>::read(VALUE *values, u_int64_t count) {
+  u_int64_t i(0);
+  for (; i<count; ++i) {
+    Cell *cell = d_data + ((d_readIdx+i) & d_mask);
+    if (cell->d_sequence.load(std::memory_order_acquire)!=d_readIdx+i+1) {
+      break;
+    }
+    values[i] = cell->d_value;
+    cell->d_sequence.store(d_readIdx+i+d_mask+1, std::memory_order_release);
+  }
+  d_readIdx += i;
+  return i;
+}
+
+}
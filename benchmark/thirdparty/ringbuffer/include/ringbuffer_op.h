@@ -5,6 +5,10 @@
 
 namespace RingBuffer {
 
+typedef u_int64_t Word;
+  // Compact message of one 8 byte word e.g. a 'Benchmark::Slice::rawValue'. Eight fit one cache line where one 'Op'
+  // takes all of it.
+
 struct alignas(64) Op {
   // DATA
   u_int64_t           d_op;
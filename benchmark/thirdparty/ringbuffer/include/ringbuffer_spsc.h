@@ -2,12 +2,16 @@
 
 // PURPOSE: Multi-threaded safe ring-buffer supporting 'append' for writers, and 'read' for readers
 //
-// CLASSES: RingBuffer::SPSC: Single producer (SP) single consumer (SC) buffer with fixed capacity k_SPSC_CAPACITY
-//                            operating on objects of type 'RingBuffer::Op'
+// CLASSES: RingBuffer::BasicSPSC: Single producer (SP) single consumer (SC) buffer with capacity fixed at construction,
+//                                 k_SPSC_CAPACITY by default, operating on objects of type 'VALUE'
+//          RingBuffer::SPSC:      'BasicSPSC' of 'RingBuffer::Op'
+//          RingBuffer::WordSPSC:  'BasicSPSC' of 8 byte 'RingBuffer::Word'
+//
+// Batch 'append, read' move many objects for one acquire load of the other side's index, when its cached copy is
+// stale, and one release store of their own index. Handing off objects one at a time pays both per object.
 
 #include <atomic>
 #include <thread>
-#include <array>
 
 #include <ringbuffer_op.h>
 
@@ -17,57 +21,85 @@ namespace RingBuffer {
 
 const u_int64_t k_SPSC_CAPACITY = 5000;
 
-struct SPSC {
+template<typename VALUE>
+struct BasicSPSC {
   // DATA
   alignas(64) std::atomic<size_t>             d_readIdx;
   alignas(64) size_t                          d_readIdxCached;
   alignas(64) std::atomic<size_t>             d_writeIdx;
   alignas(64) size_t                          d_writeIdxCached;
-  alignas(64) std::array<Op,k_SPSC_CAPACITY>  d_data;
+  alignas(64) const u_int64_t                 d_capacity;
+  VALUE                                      *d_data;
 
 public:
   // CREATORS
-  SPSC();
-    // Construct SPSC (single-producer, single-consumer) queue operating on 'Op' objects with fixed capacity
-    // k_SPSC_CAPACITY.
+  explicit BasicSPSC(u_int64_t capacity = k_SPSC_CAPACITY);
+    // Construct SPSC (single-producer, single-consumer) queue operating on 'VALUE' objects with specified 'capacity'
+    // slots. One slot is always left empty so at most 'capacity-1' objects are queued. Behavior is defined provided
+    // 'capacity>1'.
 
-  SPSC(const SPSC& other);
+  BasicSPSC(const BasicSPSC& other) = delete;
     // Copy constructor not provided
 
-  ~SPSC() = default;
+  ~BasicSPSC();
     // Destroy this object
 
   // MANIPULATORS
-  bool append(const Op& value);
+  bool append(const VALUE& value);
     // Return true if specified 'value' was appended to queue and false. Note that false is returned when queue full.
     // Behavior is defined provided the producer thread only calls 'append'.
 
-  bool read(Op& value);
+  u_int64_t append(const VALUE *values, u_int64_t count);
+    // Return the number of the first of specified 'count' 'values' appended to queue in order, which is less than
+    // 'count' only if the queue filled. All appended are published to the reader at once. Behavior is defined
+    // provided the producer thread only calls 'append'.
+
+  bool read(VALUE& value);
     // Return true if next object for reader was copied into specified 'value' and false othewise. Note that false
     // means queue empty or there's no current object to read e.g. reader already end of queue. Behavior is defined
     // provided the consumer thread only calls 'read'.
 
-  SPSC& operator=(const SPSC& rhs) = delete;
+  u_int64_t read(VALUE *values, u_int64_t count);
+    // Return the number of objects, at most specified 'count', copied in order into specified 'values'. 0 means
+    // queue empty. Their slots are handed back to the writer at once. Behavior is defined provided the consumer
+    // thread only calls 'read'.
+
+  BasicSPSC& operator=(const BasicSPSC& rhs) = delete;
     // Assignment operator not provided
 };
 
+typedef BasicSPSC<Op>   SPSC;
+typedef BasicSPSC<Word> WordSPSC;
+
 // INLINE DEFINITIONS
 // CREATORS
+template<typename VALUE>
 inline
-SPSC::SPSC()
+BasicSPSC<VALUE>::BasicSPSC(u_int64_t capacity)
 : d_readIdx(0)
 , d_readIdxCached(0)
 , d_writeIdx(0)
 , d_writeIdxCached(0)
+, d_capacity(capacity)
+, d_data(new VALUE[capacity])
 {
+  assert(capacity>1);
+}
+
+template<typename VALUE>
+inline
+BasicSPSC<VALUE>::~BasicSPSC() {
+  delete [] d_data;
+  d_data = 0;
 }
 
 // MANIPULATORS
+template<typename VALUE>
 inline
-bool SPSC::append(const Op& value) {
+bool BasicSPSC<VALUE>::append(const VALUE& value) {
   auto const writeIdx = d_writeIdx.load(std::memory_order_relaxed);
   auto nextWriteIdx = d_writeIdx + 1;
-  if (nextWriteIdx == k_SPSC_CAPACITY) {
+  if (nextWriteIdx == d_capacity) {
     nextWriteIdx = 0;
   }
   if (nextWriteIdx == d_readIdxCached) {
@@ -81,8 +113,37 @@ bool SPSC::append(const Op& value) {
   return true;
 }
 
+template<typename VALUE>
 inline
-bool SPSC::read(Op& value) {
+u_int64_t BasicSPSC<VALUE>::append(const VALUE *values, u_int64_t count) {
+  const u_int64_t writeIdx = d_writeIdx.load(std::memory_order_relaxed);
+  u_int64_t space = (d_readIdxCached+d_capacity-writeIdx-1) % d_capacity;
+  if (space<count) {
+    d_readIdxCached = d_readIdx.load(std::memory_order_acquire);
+    space = (d_readIdxCached+d_capacity-writeIdx-1) % d_capacity;
+  }
+  if (count>space) {
+    count = space;
+  }
+  if (count==0) {
+    return 0;
+  }
+
+  // At most two runs: up to the end of 'd_data' then from its start
+  const u_int64_t first = count<d_capacity-writeIdx ? count : d_capacity-writeIdx;
+  for (u_int64_t i=0; i<first; ++i) {
+    d_data[writeIdx+i] = values[i];
+  }
+  for (u_int64_t i=first; i<count; ++i) {
+    d_data[i-first] = values[i];
+  }
+  d_writeIdx.store((writeIdx+count) % d_capacity, std::memory_order_release);
+  return count;
+}
+
+template<typename VALUE>
+inline
+bool BasicSPSC<VALUE>::read(VALUE& value) {
   auto const readIdx = d_readIdx.load(std::memory_order_relaxed);
   if (readIdx == d_writeIdxCached) {
     d_writeIdxCached = d_writeIdx.load(std::memory_order_acquire);
@@ -92,11 +153,38 @@ bool SPSC::read(Op& value) {
   }
   value = d_data[readIdx];
   auto nextReadIdx = d_readIdx + 1;
-  if (nextReadIdx == k_SPSC_CAPACITY) {
+  if (nextReadIdx == d_capacity) {
     nextReadIdx = 0;
   }
   d_readIdx.store(nextReadIdx, std::memory_order_release);
   return true;
 }
 
+template<typename VALUE>
+inline
+u_int64_t BasicSPSC<VALUE>::read(VALUE *values, u_int64_t count) {
+  const u_int64_t readIdx = d_readIdx.load(std::memory_order_relaxed);
+  u_int64_t queued = (d_writeIdxCached+d_capacity-readIdx) % d_capacity;
+  if (queued<count) {
+    d_writeIdxCached = d_writeIdx.load(std::memory_order_acquire);
+    queued = (d_writeIdxCached+d_capacity-readIdx) % d_capacity;
+  }
+  if (count>queued) {
+    count = queued;
+  }
+  if (count==0) {
+    return 0;
+  }
+
+  const u_int64_t first = count<d_capacity-readIdx ? count : d_capacity-readIdx;
+  for (u_int64_t i=0; i<first; ++i) {
+    values[i] = d_data[readIdx+i];
+  }
+  for (u_int64_t i=first; i<count; ++i) {
+    values[i] = d_data[i-first];
+  }
+  d_readIdx.store((readIdx+count) % d_capacity, std::memory_order_release);
+  return count;
+}
+
 }
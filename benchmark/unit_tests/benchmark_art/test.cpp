@@ -0,0 +1,83 @@
+#include <art.h>
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+struct Visit {
+  // Keys handed to the 'art_iter_from' callback, stopping after 'd_limit'
+  std::vector<std::string> d_keys;
+  unsigned                 d_limit;
+};
+
+static int visit(void *data, const unsigned char *key, uint32_t keyLen, void *) {
+  Visit *state = static_cast<Visit*>(data);
+  state->d_keys.push_back(std::string(reinterpret_cast<const char*>(key), keyLen));
+  return state->d_keys.size()>=state->d_limit ? 1 : 0;
+}
+
+static std::vector<std::string> expected(const std::set<std::string>& keys, const std::string& from, unsigned limit) {
+  std::vector<std::string> result;
+  for (auto iter = keys.lower_bound(from); iter!=keys.end() && result.size()<limit; ++iter) {
+    result.push_back(*iter);
+  }
+  return result;
+}
+
+TEST(art, iterFrom) {
+  // Short keys, keys sharing prefixes longer than MAX_PREFIX_LEN, and enough fan-out for NODE48 ('mid') and NODE256
+  // ('fan'). Each key ends with a 0 terminator as libart needs so no key is a prefix of another
+  std::set<std::string> keys;
+  for (unsigned i=0; i<300; ++i) {
+    keys.insert(std::string("k") + std::to_string(i*7));
+    keys.insert(std::string("shared-prefix-longer-than-ten-") + std::to_string(i));
+  }
+  for (unsigned c=1; c<256; c+=3) {
+    keys.insert(std::string("fan") + static_cast<char>(c));
+  }
+  for (unsigned c=1; c<256; c+=6) {
+    keys.insert(std::string("mid") + static_cast<char>(c));
+  }
+
+  art_tree tree;
+  ASSERT_EQ(0, art_tree_init(&tree));
+  for (const std::string& key: keys) {
+    const std::string terminated = key + '\0';
+    ASSERT_EQ(nullptr, art_insert(&tree, reinterpret_cast<const unsigned char*>(terminated.c_str()),
+      terminated.size(), 0));
+  }
+
+  // Probes: every key, an empty key, and keys falling before, between and after stored keys
+  std::vector<std::string> probes;
+  probes.push_back("");
+  probes.push_back("\xff");
+  probes.push_back("shared-prefix-longer");
+  probes.push_back("shared-prefix-longer-than-ten-");
+  probes.push_back("shared-prefix-longer-than-tea");
+  probes.push_back("shared-prefix-longer-than-tez");
+  for (const std::string& key: keys) {
+    probes.push_back(key);
+    probes.push_back(key.substr(0, key.size()/2));
+    probes.push_back(key + "\x01");
+    std::string less(key);
+    --less.back();
+    probes.push_back(less);
+  }
+
+  // A probe's keys are compared with a terminator: 'key+0' sorts right after 'key' so use set order on terminated keys
+  std::set<std::string> terminated;
+  for (const std::string& key: keys) {
+    terminated.insert(key + '\0');
+  }
+  for (const std::string& probe: probes) {
+    for (unsigned limit: {1U, 10U, 1000U}) {
+      Visit state;
+      state.d_limit = limit;
+      art_iter_from(&tree, reinterpret_cast<const unsigned char*>(probe.data()), probe.size(), visit, &state);
+      EXPECT_EQ(expected(terminated, probe, limit), state.d_keys) << "probe '" << probe << "' limit " << limit;
+    }
+  }
+
+  EXPECT_EQ(0, art_tree_destroy(&tree));
+}
@@ -0,0 +1,318 @@
+#include <benchmark_delegation.h>
+#include <benchmark_textscan.h>
+#include <gtest/gtest.h>
+#include <test_inmemoryfile.h>
+
+#include <ringbuffer_mpsc.h>
+#include <ringbuffer_spsc.h>
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::string distinctWord(unsigned i) {
+  // Distinct keys so every owner sees each key once
+  return std::to_string(i*7919U) + "key";
+}
+
+struct ShardAdapter {
+  // Keys only adapter counting what every shard did. Only its owner thread touches a shard's keys.
+
+  // TYPES
+  typedef char KeyType;
+
+  // ENUMS
+  enum {
+    k_STATIC = 0,
+  };
+
+  // CLASS DATA
+  static std::atomic<u_int64_t> s_inserted;   // keys inserted over all shards
+  static std::atomic<u_int64_t> s_found;      // keys found over all shards
+  static std::atomic<unsigned>  s_live;       // shards not yet destroyed
+
+  // DATA
+  std::set<std::string>         d_keys;
+  std::thread::id               d_owner;
+
+  explicit ShardAdapter(const Benchmark::Config&)
+  : d_owner(std::this_thread::get_id())
+  {
+    ++s_live;
+  }
+
+  ~ShardAdapter() {
+    EXPECT_EQ(d_owner, std::this_thread::get_id());
+    --s_live;
+  }
+
+  bool insert(Benchmark::Slice<char>& key) {
+    EXPECT_EQ(d_owner, std::this_thread::get_id());
+    const bool inserted = d_keys.emplace(key.data(), key.size()).second;
+    s_inserted += inserted;
+    return inserted;
+  }
+
+  bool find(Benchmark::Slice<char>& key) {
+    EXPECT_EQ(d_owner, std::this_thread::get_id());
+    const bool found = d_keys.count(std::string(key.data(), key.size()))>0;
+    s_found += found;
+    return found;
+  }
+};
+
+std::atomic<u_int64_t> ShardAdapter::s_inserted(0);
+std::atomic<u_int64_t> ShardAdapter::s_found(0);
+std::atomic<unsigned>  ShardAdapter::s_live(0);
+
+TEST(delegation, spec) {
+  Benchmark::DelegationSpec spec;
+  EXPECT_TRUE(spec.empty());
+
+  ASSERT_EQ(0, spec.configure("4"));
+  EXPECT_FALSE(spec.empty());
+  EXPECT_EQ(4U, spec.owners());
+  EXPECT_EQ(Benchmark::DelegationSpec::e_SPSC, spec.ring());
+  EXPECT_EQ(Benchmark::DelegationSpec::e_HASH, spec.shard());
+  EXPECT_EQ("4", spec.spec());
+  EXPECT_FALSE(spec.reply());
+
+  ASSERT_EQ(0, spec.configure("2,mpsc,range"));
+  EXPECT_EQ(2U, spec.owners());
+  EXPECT_EQ(Benchmark::DelegationSpec::e_MPSC, spec.ring());
+  EXPECT_EQ(Benchmark::DelegationSpec::e_RANGE, spec.shard());
+
+  ASSERT_EQ(0, spec.configure("3,range,spsc"));
+  EXPECT_EQ(Benchmark::DelegationSpec::e_SPSC, spec.ring());
+  EXPECT_EQ(Benchmark::DelegationSpec::e_RANGE, spec.shard());
+  EXPECT_EQ(0U, spec.batch());
+
+  ASSERT_EQ(0, spec.configure("2,32"));
+  EXPECT_EQ(32U, spec.batch());
+  EXPECT_EQ(Benchmark::DelegationSpec::e_SPSC, spec.ring());
+  ASSERT_EQ(0, spec.configure("2,256,mpsc"));
+  EXPECT_EQ(256U, spec.batch());
+  EXPECT_EQ(Benchmark::DelegationSpec::e_MPSC, spec.ring());
+  EXPECT_FALSE(spec.reply());
+  ASSERT_EQ(0, spec.configure("2,reply,mpsc,8"));
+  EXPECT_TRUE(spec.reply());
+  EXPECT_EQ(8U, spec.batch());
+
+  for (const char *bad: {"", "0", "257", "x", "2,", "2,mpsc,spsc", "2,hash,hash", "2,ring", "2;mpsc", "2,0",
+    "2,257", "2,8,8", "2,8x", "2,-8",
+    "2,reply,reply", "2,replies"}) {
+    EXPECT_NE(0, spec.configure(bad)) << bad;
+    EXPECT_TRUE(spec.empty()) << bad;
+  }
+}
+
+TEST(delegation, owner) {
+  Benchmark::DelegationSpec spec;
+  const std::string low("\x01low");
+  const std::string high("\xfehigh");
+
+  // Range: first byte decides and owners' ranges are in key order
+  ASSERT_EQ(0, spec.configure("4,range"));
+  EXPECT_EQ(0U, spec.owner(low.data(), low.size()));
+  EXPECT_EQ(3U, spec.owner(high.data(), high.size()));
+  unsigned last(0);
+  for (unsigned i=0; i<256; ++i) {
+    const u_int8_t byte = static_cast<u_int8_t>(i);
+    const unsigned owner = spec.owner(&byte, 1);
+    EXPECT_GE(owner, last);
+    EXPECT_LT(owner, 4U);
+    last = owner;
+  }
+
+  // Hash: keys with a common first byte still spread over every owner
+  ASSERT_EQ(0, spec.configure("4,hash"));
+  std::vector<unsigned> count(4, 0);
+  for (unsigned i=0; i<1000; ++i) {
+    const std::string key = "k" + std::to_string(i);
+    const unsigned owner = spec.owner(key.data(), key.size());
+    ASSERT_LT(owner, 4U);
+    EXPECT_EQ(owner, spec.owner(key.data(), key.size()));
+    ++count[owner];
+  }
+  for (unsigned i=0; i<4; ++i) {
+    EXPECT_GT(count[i], 150U);
+  }
+}
+
+TEST(delegation, spsc) {
+  // Small ring wraps many times: every op arrives once in order. Waits yield so one core suffices
+  RingBuffer::SPSC ring(8);
+  const u_int64_t count(10000);
+  std::thread producer([&]() {
+    for (u_int64_t i=1; i<=count; ++i) {
+      while (!ring.append(RingBuffer::Op(0, i))) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  RingBuffer::Op op;
+  for (u_int64_t i=1; i<=count; ++i) {
+    while (!ring.read(op)) {
+      std::this_thread::yield();
+    }
+    ASSERT_EQ(i, op.d_arg0);
+  }
+  producer.join();
+  EXPECT_FALSE(ring.read(op));
+}
+
+TEST(delegation, mpsc) {
+  // Small ring many producers: each producer's ops arrive once in the order appended
+  RingBuffer::MPSC ring(16);
+  const unsigned producers(4);
+  const u_int64_t count(5000);
+  std::vector<std::thread> threads;
+  for (unsigned p=0; p<producers; ++p) {
+    threads.emplace_back([&, p]() {
+      for (u_int64_t i=1; i<=count; ++i) {
+        while (!ring.append(RingBuffer::Op(p, i))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::vector<u_int64_t> last(producers, 0);
+  RingBuffer::Op op;
+  for (u_int64_t i=0; i<producers*count; ++i) {
+    while (!ring.read(op)) {
+      std::this_thread::yield();
+    }
+    ASSERT_LT(op.d_op, producers);
+    ASSERT_EQ(last[op.d_op]+1, op.d_arg0);
+    last[op.d_op] = op.d_arg0;
+  }
+  for (auto& thread: threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(ring.read(op));
+}
+
+TEST(delegation, batch) {
+  // Batches wrap the ring and fill it part way: every word arrives once in order on either ring
+  RingBuffer::WordSPSC pair(13);
+  RingBuffer::WordMPSC queue(16);
+  const u_int64_t count(20000);
+  for (unsigned producers: {1U, 3U}) {
+    std::vector<std::thread> threads;
+    for (unsigned p=0; p<producers; ++p) {
+      threads.emplace_back([&, p]() {
+        // Word 'p<<32 | i' from producer 'p', sent in batches of 1 to 11
+        RingBuffer::Word words[11];
+        for (u_int64_t i=1; i<=count;) {
+          const u_int64_t size = (i%11)+1<count-i+1 ? (i%11)+1 : count-i+1;
+          for (u_int64_t j=0; j<size; ++j) {
+            words[j] = (u_int64_t)p<<32 | (i+j);
+          }
+          for (u_int64_t sent=0; sent<size;) {
+            const u_int64_t n = producers==1 ? pair.append(words+sent, size-sent) : queue.append(words+sent, size-sent);
+            if (n==0) {
+              std::this_thread::yield();
+            }
+            sent += n;
+          }
+          i += size;
+        }
+      });
+    }
+
+    std::vector<u_int64_t> last(producers, 0);
+    RingBuffer::Word words[7];
+    for (u_int64_t i=0; i<producers*count;) {
+      const u_int64_t n = producers==1 ? pair.read(words, 7) : queue.read(words, 7);
+      if (n==0) {
+        std::this_thread::yield();
+      }
+      for (u_int64_t j=0; j<n; ++j) {
+        const unsigned p = static_cast<unsigned>(words[j]>>32);
+        ASSERT_LT(p, producers);
+        ASSERT_EQ(last[p]+1, words[j] & 0xFFFFFFFFU);
+        last[p] = words[j] & 0xFFFFFFFFU;
+      }
+      i += n;
+    }
+    for (auto& thread: threads) {
+      thread.join();
+    }
+    EXPECT_EQ(0U, pair.read(words, 7));
+    EXPECT_EQ(0U, queue.read(words, 7));
+  }
+}
+
+TEST(delegation, run) {
+  const unsigned words(20000);
+  InMemoryFile data(words, distinctWord);
+  Benchmark::NumaReplicas files(data.file());
+
+  for (const char *text: {"1", "2,spsc,hash", "3,mpsc,hash", "3,spsc,range", "2,mpsc,range", "1,1", "2,spsc,8",
+    "3,mpsc,64", "3,range,256"}) {
+    Benchmark::DelegationSpec spec;
+    ASSERT_EQ(0, spec.configure(text));
+    Benchmark::Config config;
+    config.d_threads = 3;
+
+    ShardAdapter::s_inserted = 0;
+    ShardAdapter::s_found = 0;
+    Benchmark::ScalingStats insertStats;
+    Benchmark::ScalingStats findStats;
+    {
+      Benchmark::Delegation<ShardAdapter> delegation(config, spec, files);
+      delegation.insert("insert run 0", insertStats);
+      EXPECT_EQ(words, ShardAdapter::s_inserted.load()) << text;
+
+      // Shards persist so finds hit every key inserted, twice
+      delegation.find("find run 0", findStats);
+      delegation.find("find run 1", findStats);
+      EXPECT_EQ(2*words, ShardAdapter::s_found.load()) << text;
+      EXPECT_EQ(spec.owners(), ShardAdapter::s_live.load()) << text;
+    }
+    EXPECT_EQ(0U, ShardAdapter::s_live.load()) << text;
+    EXPECT_FALSE(insertStats.empty());
+    EXPECT_FALSE(findStats.empty());
+  }
+}
+
+TEST(delegation, roundTrip) {
+  // Every one of a client's keys is answered: all found after inserting them, none found in empty shards. Waiting
+  // for answers with one core takes a context switch per round trip so unbatched runs get fewer words.
+  const struct {
+    const char *text;
+    unsigned    words;
+  } runs[] = {
+    {"1,reply",                 100},
+    {"3,mpsc,reply",            100},
+    {"3,mpsc,1,reply",          100},
+    {"2,spsc,8,reply",          2000},
+    {"3,mpsc,hash,16,reply",    2000},
+    {"2,range,mpsc,256,reply",  2000},
+  };
+  for (const auto& run: runs) {
+    const char *text = run.text;
+    const unsigned words = run.words;
+    InMemoryFile data(words, distinctWord);
+    Benchmark::NumaReplicas files(data.file());
+
+    Benchmark::DelegationSpec spec;
+    ASSERT_EQ(0, spec.configure(text));
+    ASSERT_TRUE(spec.reply());
+    Benchmark::Config config;
+    config.d_threads = 3;
+
+    Benchmark::ScalingStats insertStats;
+    Benchmark::ScalingStats roundTripStats;
+    Benchmark::Delegation<ShardAdapter> delegation(config, spec, files);
+    EXPECT_EQ(0U, delegation.roundTrip("round trip run 0", roundTripStats)) << text;
+    delegation.insert("insert run 0", insertStats);
+    EXPECT_EQ(words, delegation.roundTrip("round trip run 1", roundTripStats)) << text;
+    EXPECT_EQ(words, delegation.roundTrip("round trip run 2", roundTripStats)) << text;
+    EXPECT_FALSE(roundTripStats.empty());
+  }
+}
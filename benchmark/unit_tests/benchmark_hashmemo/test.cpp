@@ -0,0 +1,86 @@
+#include <benchmark_hashmemo.h>
+#include <benchmark_textscan.h>
+#include <gtest/gtest.h>
+#include <test_inmemoryfile.h>
+
+#include <string>
+#include <vector>
+
+static std::string memoWord(unsigned i, unsigned minSize) {
+  // Keys 'minSize' to 'minSize+2' bytes long so the stride depends on 'minSize'
+  return std::string(minSize, 'k') + std::to_string(i).substr(0, i%3);
+}
+
+struct Fnv {
+  // FNV-1a: a hash no library provides so the test needs none
+  std::size_t operator()(const Benchmark::Slice<char>& key) const {
+    std::size_t hash = 0xcbf29ce484222325UL;
+    for (unsigned i=0; i<key.size(); ++i) {
+      hash = (hash ^ static_cast<u_int8_t>(key.data()[i])) * 0x100000001b3UL;
+    }
+    return hash;
+  }
+};
+
+TEST(hashmemo, build) {
+  for (unsigned minSize: {0U, 1U, 4U, 13U}) {
+    InMemoryFile data(1000, [minSize](unsigned i) { return memoWord(i, minSize); });
+    Benchmark::HashMemo memo;
+    EXPECT_TRUE(memo.empty());
+    ASSERT_EQ(0, memo.build<Fnv>(data.file()));
+    EXPECT_FALSE(memo.empty());
+    EXPECT_LE(memo.stride(), sizeof(unsigned)+minSize);
+    EXPECT_GT(2*memo.stride(), sizeof(unsigned)+minSize);
+
+    // Every key scanned has its own hash
+    Benchmark::Slice<char> word;
+    Benchmark::TextScan<char> scanner(data.file());
+    u_int64_t count(0);
+    while (!scanner.eof()) {
+      scanner.next(word);
+      ++count;
+      std::size_t hash(0);
+      ASSERT_TRUE(memo.lookup(word, &hash));
+      EXPECT_EQ(Fnv()(word), hash);
+    }
+    EXPECT_EQ(count, memo.size());
+    EXPECT_EQ(1000U, count);
+
+    // Keys elsewhere are not memoized
+    const std::string copy(minSize+1, 'k');
+    std::size_t hash(0);
+    EXPECT_FALSE(memo.lookup(Benchmark::Slice<char>(copy.data(), copy.size()), &hash));
+
+    memo.free();
+    EXPECT_TRUE(memo.empty());
+  }
+}
+
+TEST(hashmemo, passthrough) {
+  InMemoryFile data(100, [](unsigned i) { return memoWord(i, 2); });
+  const std::string other("not in file");
+  Benchmark::Slice<char> outside(other.data(), other.size());
+  Benchmark::char_slice_memo<Fnv> hasher;
+
+  // Nothing installed: hash computed
+  EXPECT_EQ(0, Benchmark::HashMemo::installed());
+  EXPECT_EQ(Fnv()(outside), hasher(outside));
+
+  {
+    Benchmark::HashMemo memo;
+    ASSERT_EQ(0, memo.build<Fnv>(data.file()));
+    memo.install();
+    EXPECT_EQ(&memo, Benchmark::HashMemo::installed());
+
+    Benchmark::Slice<char> word;
+    Benchmark::TextScan<char> scanner(data.file());
+    while (!scanner.eof()) {
+      scanner.next(word);
+      EXPECT_EQ(Fnv()(word), hasher(word));
+    }
+    EXPECT_EQ(Fnv()(outside), hasher(outside));
+  }
+
+  // Destroying the installed memo uninstalls it
+  EXPECT_EQ(0, Benchmark::HashMemo::installed());
+}
@@ -0,0 +1,100 @@
+#include <benchmark_keyindex.h>
+#include <benchmark_textscan.h>
+#include <gtest/gtest.h>
+#include <test_inmemoryfile.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+static std::string keyWord(unsigned i) {
+  return "key" + std::to_string(i);
+}
+
+TEST(keyindex, order) {
+  Benchmark::KeyIndex::Order order;
+  EXPECT_EQ(0, Benchmark::KeyIndex::parseOrder("file", &order));
+  EXPECT_EQ(Benchmark::KeyIndex::e_FILE, order);
+  EXPECT_EQ(0, Benchmark::KeyIndex::parseOrder("shuffled", &order));
+  EXPECT_EQ(Benchmark::KeyIndex::e_SHUFFLED, order);
+  EXPECT_EQ(0, Benchmark::KeyIndex::parseOrder("uniform", &order));
+  EXPECT_EQ(Benchmark::KeyIndex::e_UNIFORM, order);
+  EXPECT_EQ(0, Benchmark::KeyIndex::parseOrder("zipfian", &order));
+  EXPECT_EQ(Benchmark::KeyIndex::e_ZIPFIAN, order);
+  EXPECT_NE(0, Benchmark::KeyIndex::parseOrder("latest", &order));
+
+  for (unsigned i=Benchmark::KeyIndex::e_FILE; i<=Benchmark::KeyIndex::e_ZIPFIAN; ++i) {
+    EXPECT_EQ(0, Benchmark::KeyIndex::parseOrder(
+      Benchmark::KeyIndex::orderName(static_cast<Benchmark::KeyIndex::Order>(i)), &order));
+    EXPECT_EQ(i, static_cast<unsigned>(order));
+  }
+}
+
+TEST(keyindex, file) {
+  InMemoryFile data(1000, keyWord);
+  const std::vector<u_int64_t> expected = data.scanned();
+
+  Benchmark::KeyIndex index;
+  EXPECT_TRUE(index.empty());
+  ASSERT_EQ(0, index.build(data.file(), Benchmark::KeyIndex::e_FILE, 1));
+  ASSERT_EQ(expected.size(), index.size());
+  for (u_int64_t i=0; i<index.size(); ++i) {
+    EXPECT_EQ(expected[i], index[i]);
+    EXPECT_EQ(Benchmark::Slice<char>(expected[i]), index.key<char>(i));
+  }
+
+  index.free();
+  EXPECT_TRUE(index.empty());
+}
+
+TEST(keyindex, shuffled) {
+  InMemoryFile data(1000, keyWord);
+  std::vector<u_int64_t> expected = data.scanned();
+
+  Benchmark::KeyIndex index;
+  ASSERT_EQ(0, index.build(data.file(), Benchmark::KeyIndex::e_SHUFFLED, 1));
+  ASSERT_EQ(expected.size(), index.size());
+
+  // A permutation which is not file order
+  std::vector<u_int64_t> keys;
+  for (u_int64_t i=0; i<index.size(); ++i) {
+    keys.push_back(index[i]);
+  }
+  EXPECT_NE(expected, keys);
+  std::sort(keys.begin(), keys.end());
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(expected, keys);
+
+  // Same seed same order
+  Benchmark::KeyIndex again;
+  ASSERT_EQ(0, again.build(data.file(), Benchmark::KeyIndex::e_SHUFFLED, 1));
+  for (u_int64_t i=0; i<index.size(); ++i) {
+    EXPECT_EQ(index[i], again[i]);
+  }
+}
+
+TEST(keyindex, distribution) {
+  InMemoryFile data(1000, keyWord);
+  const std::vector<u_int64_t> expected = data.scanned();
+
+  unsigned hottest[2];
+  const Benchmark::KeyIndex::Order orders[2] = { Benchmark::KeyIndex::e_UNIFORM, Benchmark::KeyIndex::e_ZIPFIAN };
+  for (unsigned i=0; i<2; ++i) {
+    Benchmark::KeyIndex index;
+    ASSERT_EQ(0, index.build(data.file(), orders[i], 1));
+    ASSERT_EQ(expected.size(), index.size());
+    std::map<u_int64_t, unsigned> count;
+    for (u_int64_t j=0; j<index.size(); ++j) {
+      EXPECT_NE(expected.end(), std::find(expected.begin(), expected.end(), index[j]));
+      ++count[index[j]];
+    }
+    hottest[i] = 0;
+    for (const auto& item: count) {
+      hottest[i] = std::max(hottest[i], item.second);
+    }
+  }
+
+  // Zipfian's hottest key is far hotter than any uniformly drawn key
+  EXPECT_GT(hottest[1], 4*hottest[0]);
+}
@@ -0,0 +1,73 @@
+#include <benchmark_kvrecord.h>
+#include <benchmark_kvscan.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+TEST(kvrecord, create) {
+  const std::string k("hello");
+  const std::string v("world, how are you?");
+  Benchmark::Slice<char> key(k.data(), k.size());
+  Benchmark::Slice<char> value(v.data(), v.size());
+
+  char *record = Benchmark::KVRecord::create(key, value);
+  ASSERT_TRUE(record!=0);
+
+  Benchmark::Slice<char> heldKey = Benchmark::KVRecord::key<char>(record);
+  EXPECT_EQ(heldKey.size(), k.size());
+  EXPECT_EQ(0, memcmp(heldKey.data(), k.data(), k.size()));
+  EXPECT_TRUE(heldKey.data()!=k.data());
+
+  Benchmark::Slice<char> heldValue = Benchmark::KVRecord::value<char>(record);
+  EXPECT_EQ(heldValue.size(), v.size());
+  EXPECT_EQ(0, memcmp(heldValue.data(), v.data(), v.size()));
+  EXPECT_TRUE(heldValue.data()!=v.data());
+
+  EXPECT_EQ(record, Benchmark::KVRecord::fromKey(heldKey));
+  EXPECT_TRUE(Benchmark::KVRecord::equal(record, value));
+
+  Benchmark::KVRecord::destroy(record);
+}
+
+TEST(kvrecord, assign) {
+  const std::string k("key");
+  const std::string v0("value0");
+  const std::string v1("value1");
+  const std::string v2("longer value");
+  Benchmark::Slice<unsigned char> key((const unsigned char*)k.data(), k.size());
+  Benchmark::Slice<unsigned char> value0((const unsigned char*)v0.data(), v0.size());
+  Benchmark::Slice<unsigned char> value1((const unsigned char*)v1.data(), v1.size());
+  Benchmark::Slice<unsigned char> value2((const unsigned char*)v2.data(), v2.size());
+
+  char *record = Benchmark::KVRecord::create(key, value0);
+  EXPECT_TRUE(Benchmark::KVRecord::equal(record, value0));
+  EXPECT_FALSE(Benchmark::KVRecord::equal(record, value1));
+
+  // Same size: copied in place
+  EXPECT_TRUE(Benchmark::KVRecord::assign(record, value1));
+  EXPECT_TRUE(Benchmark::KVRecord::equal(record, value1));
+
+  // Different size: unchanged
+  EXPECT_FALSE(Benchmark::KVRecord::assign(record, value2));
+  EXPECT_TRUE(Benchmark::KVRecord::equal(record, value1));
+
+  Benchmark::KVRecord::destroy(record);
+}
+
+TEST(kvrecord, valueOf) {
+  // A record has the same layout as a 'bin-text-kv' pair so 'KVScan::valueOf' finds the value after its key
+  const std::string k("abc");
+  const std::string v("0123456789");
+  Benchmark::Slice<char> key(k.data(), k.size());
+  Benchmark::Slice<char> value(v.data(), v.size());
+
+  char *record = Benchmark::KVRecord::create(key, value);
+
+  Benchmark::Slice<char> found;
+  Benchmark::KVScan<char>::valueOf(Benchmark::KVRecord::key<char>(record), found);
+  EXPECT_EQ(found.size(), v.size());
+  EXPECT_EQ(0, memcmp(found.data(), v.data(), v.size()));
+  EXPECT_EQ(found.data(), Benchmark::KVRecord::value<char>(record).data());
+
+  Benchmark::KVRecord::destroy(record);
+}
@@ -0,0 +1,23 @@
+#include <benchmark_misskeys.h>
+#include <gtest/gtest.h>
+#include <test_inmemoryfile.h>
+
+#include <string>
+#include <vector>
+
+TEST(misskeys, mutate) {
+  // Empty keys first, between and last so a probe written outside its own bytes would clobber a neighbour
+  const std::vector<std::string> words = {"", "abc", std::string("key\0", 4), "", "x", std::string(1, '\0'), ""};
+  const std::vector<std::string> expected = {"\x80", "ab\xe3", std::string("ke\xf9\0", 4), "\x80", "\xf8",
+    "\x80", "\x80"};
+  InMemoryFile data(words.size(), [&words](unsigned i) { return words[i]; });
+
+  Benchmark::MissKeys keys;
+  EXPECT_TRUE(keys.empty());
+  ASSERT_EQ(0, keys.mutate(data.file()));
+  ASSERT_EQ(expected.size(), keys.size());
+  for (unsigned i=0; i<expected.size(); ++i) {
+    const Benchmark::Slice<char> key = keys.key<char>(i);
+    EXPECT_EQ(expected[i], std::string(key.data(), key.size())) << i;
+  }
+}
@@ -154,3 +154,78 @@ TEST(slice, addMuliKeyAllPerms) {
     memManager.print();
   } while (std::next_permutation(index.begin(), index.end()));
 }
+
+TEST(slice, deleteMuliKeyAllPerms) {
+  std::vector<unsigned> index;
+  for (unsigned i=0; i<NUM_VALUES; ++i) {
+    index.push_back(i);
+  }
+
+  do {
+    Patricia::Tree *tree = memManager.allocTree();
+    for (unsigned i=0; i<NUM_VALUES; ++i) {
+      Benchmark::UKey key(VALUES[i].d_data, VALUES[i].d_size);
+      EXPECT_EQ(Patricia::insertKey(tree, key), Patricia::Errno::e_OK);
+    }
+
+    // Delete in permutation order. Keys deleted are gone; the rest are still found
+    for (unsigned i=0; i<NUM_VALUES; ++i) {
+      Benchmark::UKey key(VALUES[index[i]].d_data, VALUES[index[i]].d_size);
+      EXPECT_EQ(Patricia::deleteKey(tree, key), Patricia::Errno::e_OK);
+      EXPECT_EQ(Patricia::deleteKey(tree, key), Patricia::Errno::e_NOT_FOUND);
+      for (unsigned j=0; j<NUM_VALUES; ++j) {
+        Benchmark::UKey other(VALUES[index[j]].d_data, VALUES[index[j]].d_size);
+        EXPECT_EQ(Patricia::findKey(tree, other), j<=i ? Patricia::Errno::e_NOT_FOUND : Patricia::Errno::e_OK);
+      }
+    }
+    EXPECT_TRUE(tree->root==0);
+
+    // Reinsert into the drained tree
+    for (unsigned i=0; i<NUM_VALUES; ++i) {
+      Benchmark::UKey key(VALUES[index[i]].d_data, VALUES[index[i]].d_size);
+      EXPECT_EQ(Patricia::insertKey(tree, key), Patricia::Errno::e_OK);
+      EXPECT_EQ(Patricia::findKey(tree, key), Patricia::Errno::e_OK);
+    }
+
+    memManager.freeTree(tree);
+  } while (std::next_permutation(index.begin(), index.end()));
+  memManager.print();
+}
+
+TEST(slice, findKeys) {
+  // 'findKeys' agrees with 'findKey' for present and absent keys and on an empty tree. Keys repeat so there are
+  // more than 'k_FIND_BATCH_WIDTH' of them
+  Patricia::Tree *tree = memManager.allocTree();
+  std::vector<Benchmark::UKey> keys;
+  for (unsigned j=0; j<3; ++j) {
+    for (unsigned i=0; i<NUM_SORTED_VALUES; ++i) {
+      keys.push_back(Benchmark::UKey(SORTED_VALUES[i].d_data, SORTED_VALUES[i].d_size));
+    }
+    for (unsigned i=0; i<NUM_VALUES; ++i) {
+      keys.push_back(Benchmark::UKey(VALUES[i].d_data, VALUES[i].d_size));
+    }
+  }
+  std::vector<int> results(keys.size(), -1);
+
+  Patricia::findKeys(tree, keys.data(), results.data(), keys.size());
+  for (unsigned i=0; i<keys.size(); ++i) {
+    EXPECT_EQ(results[i], Patricia::Errno::e_NOT_FOUND);
+  }
+
+  for (unsigned i=0; i<NUM_VALUES; ++i) {
+    EXPECT_EQ(Patricia::insertKey(tree, Benchmark::UKey(VALUES[i].d_data, VALUES[i].d_size)), Patricia::Errno::e_OK);
+  }
+
+  for (unsigned count=0; count<=keys.size(); ++count) {
+    std::fill(results.begin(), results.end(), -1);
+    Patricia::findKeys(tree, keys.data(), results.data(), count);
+    for (unsigned i=0; i<count; ++i) {
+      EXPECT_EQ(results[i], Patricia::findKey(tree, keys[i]));
+      EXPECT_EQ(results[i], i%(NUM_VALUES+NUM_SORTED_VALUES)<NUM_SORTED_VALUES ? Patricia::Errno::e_NOT_FOUND
+                                                                                 : Patricia::Errno::e_OK);
+    }
+  }
+
+  Patricia::destroyTree(tree);
+  memManager.freeTree(tree);
+}
@@ -0,0 +1,63 @@
+#include <benchmark_workload.h>
+#include <gtest/gtest.h>
+
+TEST(workload, core) {
+  Benchmark::Workload workload;
+
+  EXPECT_EQ(0, workload.configure("a", ""));
+  EXPECT_TRUE(workload.has(Benchmark::Workload::e_READ));
+  EXPECT_TRUE(workload.has(Benchmark::Workload::e_UPDATE));
+  EXPECT_FALSE(workload.has(Benchmark::Workload::e_INSERT));
+  EXPECT_EQ(Benchmark::Workload::e_ZIPFIAN, workload.distribution());
+
+  EXPECT_EQ(0, workload.configure("D", ""));
+  EXPECT_TRUE(workload.has(Benchmark::Workload::e_INSERT));
+  EXPECT_EQ(Benchmark::Workload::e_LATEST, workload.distribution());
+
+  EXPECT_EQ(0, workload.configure("e", "uniform"));
+  EXPECT_TRUE(workload.has(Benchmark::Workload::e_SCAN));
+  EXPECT_EQ(Benchmark::Workload::e_UNIFORM, workload.distribution());
+
+  EXPECT_NE(0, workload.configure("g", ""));
+  EXPECT_NE(0, workload.configure("a", "gaussian"));
+}
+
+TEST(workload, mix) {
+  Benchmark::Workload workload;
+
+  EXPECT_EQ(0, workload.configure("95r:5u", ""));
+  EXPECT_EQ("95r:5u", workload.spec());
+  EXPECT_TRUE(workload.has(Benchmark::Workload::e_READ));
+  EXPECT_TRUE(workload.has(Benchmark::Workload::e_UPDATE));
+  EXPECT_FALSE(workload.has(Benchmark::Workload::e_SCAN));
+  EXPECT_EQ(Benchmark::Workload::e_UNIFORM, workload.distribution());
+
+  EXPECT_EQ(0, workload.configure("100r", "zipfian"));
+  EXPECT_EQ(0, workload.configure("20r:20u:20i:20s:20m", "latest"));
+  EXPECT_TRUE(workload.has(Benchmark::Workload::e_RMW));
+
+  // Bad mixes leave the previous configuration alone
+  EXPECT_NE(0, workload.configure("95r:4u", ""));
+  EXPECT_NE(0, workload.configure("95r:5x", ""));
+  EXPECT_NE(0, workload.configure("95r5u", ""));
+  EXPECT_NE(0, workload.configure("95r::5u", ""));
+  EXPECT_NE(0, workload.configure("r:u", ""));
+  EXPECT_NE(0, workload.configure("", ""));
+  EXPECT_EQ("20r:20u:20i:20s:20m", workload.spec());
+}
+
+TEST(workload, generate) {
+  const char *fn = "url.bin";
+  Benchmark::LoadFile file;
+  if (file.load(fn)!=0) {
+    printf("load failed\n");
+    return;
+  }
+
+  Benchmark::Workload workload;
+  ASSERT_EQ(0, workload.configure("d", ""));
+  ASSERT_EQ(0, workload.generate(file, 1));
+  EXPECT_FALSE(workload.empty());
+  EXPECT_TRUE(workload.preloaded()>0);
+  workload.print();
+}
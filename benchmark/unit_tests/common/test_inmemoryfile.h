@@ -0,0 +1,93 @@
+#pragma once
+
+// PURPOSE: Test data without huge pages
+//
+// CLASSES:
+//  InMemoryFile: 'bin-text' file built in memory from a word generator and presented through a 'LoadFile'
+
+#include <benchmark_loadfile.h>
+#include <benchmark_slice.h>
+#include <benchmark_textscan.h>
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+class InMemoryFile {
+  // DATA
+  std::vector<char>       d_buffer;
+  Benchmark::LoadFile     d_file;
+
+public:
+  // CREATORS
+  template<typename WORD>
+  InMemoryFile(unsigned words, WORD word);
+    // Create a file holding specified 'words' words where word 'i' is the 'std::string' specified 'word(i)' returns
+
+  InMemoryFile(const InMemoryFile& other) = delete;
+    // Copy constructor not provided
+
+  ~InMemoryFile();
+    // Destroy this object. Not shared memory: keep 'LoadFile::free' from detaching it.
+
+  // ACCESSORS
+  const Benchmark::LoadFile& file() const;
+    // Return the file
+
+  std::vector<u_int64_t> scanned() const;
+    // Return the 'Slice::rawValue' of every key the scan loop every phase uses visits, in file order
+
+  InMemoryFile& operator=(const InMemoryFile& rhs) = delete;
+    // Assignment operator not provided
+
+private:
+  // PRIVATE MANIPULATORS
+  void append(unsigned value);
+    // Append specified 'value' in host byte order
+};
+
+// INLINE DEFINITIONS
+// CREATORS
+template<typename WORD>
+inline
+InMemoryFile::InMemoryFile(unsigned words, WORD word) {
+  append(words);
+  for (unsigned i=0; i<words; ++i) {
+    const std::string value = word(i);
+    append(static_cast<unsigned>(value.size()));
+    d_buffer.insert(d_buffer.end(), value.begin(), value.end());
+  }
+  d_file.d_data = d_buffer.data();
+  d_file.d_fileSize = d_buffer.size();
+}
+
+inline
+InMemoryFile::~InMemoryFile() {
+  d_file.d_data = 0;
+}
+
+// ACCESSORS
+inline
+const Benchmark::LoadFile& InMemoryFile::file() const {
+  return d_file;
+}
+
+inline
+std::vector<u_int64_t> InMemoryFile::scanned() const {
+  std::vector<u_int64_t> keys;
+  Benchmark::Slice<char> word;
+  Benchmark::TextScan<char> scanner(d_file);
+  while (!scanner.eof()) {
+    scanner.next(word);
+    keys.push_back(word.rawValue());
+  }
+  return keys;
+}
+
+// PRIVATE MANIPULATORS
+inline
+void InMemoryFile::append(unsigned value) {
+  const char *ptr = reinterpret_cast<const char*>(&value);
+  d_buffer.insert(d_buffer.end(), ptr, ptr+sizeof(value));
+}
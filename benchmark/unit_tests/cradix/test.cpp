@@ -1,8 +1,14 @@
 #include <benchmark_slice.h>
 #include <cradix_tree.h>
+#include <cradix_concurrenttree.h>
 #include <cradix_memmanager.h>
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <atomic>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
 #include <vector>
 
 static const struct {
@@ -639,3 +645,598 @@ TEST (cradix, multiInsertPermuations) {
     EXPECT_EQ(mstats.d_sizeBytes, bufferSize);
   } while(std::next_permutation(perm.begin(), perm.end()));
 }
+
+TEST (cradix, node256_clearOffset) {
+  int32_t newMin, newMax;
+  CRadix::MemManager mem(bufferSize, 4);
+
+  // Span ['a', 'e'] holding a, c, e in capacity 8
+  u_int32_t nodeOffset = mem.newNode256(8, 'a', 100);
+  CRadix::Node256 *nodePtr = mem.ptr(nodeOffset);
+  EXPECT_TRUE(nodePtr->trySetOffset('c', 200, newMin, newMax));
+  EXPECT_TRUE(nodePtr->trySetOffset('e', 300, newMin, newMax));
+  EXPECT_EQ(nodePtr->size(), 5);
+  EXPECT_EQ(nodePtr->capacity(), 8);
+
+  // Interior clear keeps span
+  nodePtr->clearOffset('c');
+  EXPECT_EQ(nodePtr->minIndex(), 'a');
+  EXPECT_EQ(nodePtr->maxIndex(), 'e');
+  EXPECT_EQ(nodePtr->tryOffset('c'), 0);
+
+  // Clearing min shrinks past the cleared 'c' and shifts 'e' down
+  nodePtr->clearOffset('a');
+  EXPECT_EQ(nodePtr->minIndex(), 'e');
+  EXPECT_EQ(nodePtr->maxIndex(), 'e');
+  EXPECT_EQ(nodePtr->offset('e'), 300);
+  EXPECT_EQ(nodePtr->spareCapacity(), 7);
+  EXPECT_EQ(nodePtr->capacity(), 8);
+
+  // Freed slots are usable again without reallocation
+  EXPECT_TRUE(nodePtr->trySetOffset('b', 400, newMin, newMax));
+  EXPECT_EQ(nodePtr->offset('b'), 400);
+  EXPECT_EQ(nodePtr->offset('e'), 300);
+  nodePtr->clearOffset('e');
+  EXPECT_EQ(nodePtr->minIndex(), 'b');
+  EXPECT_EQ(nodePtr->maxIndex(), 'b');
+  EXPECT_EQ(nodePtr->capacity(), 8);
+  EXPECT_FALSE(nodePtr->isDead());
+}
+
+TEST (cradix, removePermutations) {
+  // Remove every reference key in a sample of orders checking after each removal that exactly the keys not yet
+  // removed are found and iterated, and that a drained tree holds no inner nodes and can be refilled
+  std::vector<unsigned> perm;
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+    perm.push_back(i);
+  }
+  std::mt19937 rng(7);
+
+  for (unsigned sample=0; sample<500; ++sample) {
+    std::shuffle(perm.begin(), perm.end(), rng);
+
+    CRadix::MemManager mem(bufferSize, 4);
+    CRadix::Tree tree(&mem);
+    for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+      Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+      EXPECT_EQ(tree.insert(key), CRadix::e_OK);
+    }
+
+    std::set<std::string> live;
+    for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+      live.insert(std::string((const char*)REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size));
+    }
+
+    for (unsigned i=0; i<perm.size(); ++i) {
+      Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[perm[i]].d_data, REFERENCE_VALUES[perm[i]].d_size);
+      EXPECT_EQ(tree.remove(key), CRadix::e_OK);
+      EXPECT_EQ(tree.remove(key), CRadix::e_NOT_FOUND);
+      EXPECT_EQ(tree.find(key), CRadix::e_NOT_FOUND);
+      live.erase(std::string((const char*)key.data(), key.size()));
+
+      for (unsigned j=0; j<NUM_REFERENCE_VALUES; ++j) {
+        Benchmark::Slice<unsigned char> other(REFERENCE_VALUES[j].d_data, REFERENCE_VALUES[j].d_size);
+        const bool expected = live.count(std::string((const char*)other.data(), other.size()))!=0;
+        EXPECT_EQ(tree.find(other), expected ? CRadix::e_EXISTS : CRadix::e_NOT_FOUND);
+      }
+
+      std::vector<std::string> iterated;
+      for (CRadix::Iterator iter = tree.begin(); !iter.end(); iter.next()) {
+        iterated.push_back(std::string((const char*)iter.key(), iter.keySize()));
+      }
+      EXPECT_EQ(iterated, std::vector<std::string>(live.begin(), live.end()));
+
+      CRadix::TreeStats stats;
+      tree.statistics(&stats);
+      EXPECT_EQ(stats.d_terminalCount, live.size());
+    }
+
+    CRadix::TreeStats stats;
+    tree.statistics(&stats);
+    EXPECT_EQ(stats.d_innerNodeCount, 0);
+    EXPECT_EQ(stats.d_leafCount, 0);
+
+    // Every inner node made by insert is dead now
+    CRadix::MemStats mstats;
+    mem.statistics(&mstats);
+    EXPECT_EQ(mstats.d_deadCount+1, mstats.d_allocCount);
+
+    for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+      Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[perm[i]].d_data, REFERENCE_VALUES[perm[i]].d_size);
+      EXPECT_EQ(tree.insert(key), CRadix::e_OK);
+      EXPECT_EQ(tree.find(key), CRadix::e_EXISTS);
+    }
+    tree.statistics(&stats);
+    EXPECT_EQ(stats.d_terminalCount, NUM_REFERENCE_VALUES);
+  }
+}
+
+TEST (cradix, removeMissing) {
+  CRadix::MemManager mem(bufferSize, 4);
+  CRadix::Tree tree(&mem);
+
+  const u_int8_t abc[] = {'a', 'b', 'c'};
+  Benchmark::Slice<unsigned char> a(abc, 1);
+  Benchmark::Slice<unsigned char> ab(abc, 2);
+  Benchmark::Slice<unsigned char> abcKey(abc, 3);
+
+  EXPECT_EQ(tree.remove(a), CRadix::e_NOT_FOUND);
+  EXPECT_EQ(tree.insert(abcKey), CRadix::e_OK);
+
+  // Prefixes of a key are not keys; nor are extensions of one
+  EXPECT_EQ(tree.remove(a), CRadix::e_NOT_FOUND);
+  EXPECT_EQ(tree.remove(ab), CRadix::e_NOT_FOUND);
+  EXPECT_EQ(tree.find(abcKey), CRadix::e_EXISTS);
+
+  // Removing the shorter key keeps the longer
+  EXPECT_EQ(tree.insert(a), CRadix::e_OK);
+  EXPECT_EQ(tree.remove(a), CRadix::e_OK);
+  EXPECT_EQ(tree.find(a), CRadix::e_NOT_FOUND);
+  EXPECT_EQ(tree.find(abcKey), CRadix::e_EXISTS);
+  EXPECT_EQ(tree.remove(abcKey), CRadix::e_OK);
+  EXPECT_EQ(tree.find(abcKey), CRadix::e_NOT_FOUND);
+}
+
+TEST (cradix, memManagerReuse) {
+  CRadix::MemManager mem(bufferSize, 4);
+  CRadix::MemStats mstats;
+
+  // Same capacity comes back from the free list most recently freed first
+  u_int32_t a = mem.newNode256(4, 'a', 0);
+  u_int32_t b = mem.newNode256(4, 'b', 0);
+  u_int32_t c = mem.newNode256(8, 'c', 0);
+  mem.freeNode256(a);
+  mem.freeNode256(b);
+  EXPECT_TRUE(mem.ptr(a)->isDead());
+  EXPECT_EQ(mem.newNode256(4, 'x', 1), b);
+  EXPECT_EQ(mem.newNode256(4, 'y', 2), a);
+  EXPECT_FALSE(mem.ptr(a)->isDead());
+  EXPECT_EQ(mem.ptr(a)->offset('y'), 2);
+  EXPECT_EQ(mem.ptr(a)->capacity(), 4);
+
+  // Other capacities are not mixed in
+  mem.freeNode256(c);
+  u_int32_t d = mem.newNode256(4, 'd', 0);
+  EXPECT_NE(d, c);
+  EXPECT_EQ(mem.newNode256(8, 'e', 0), c);
+
+  // Copy-allocation retires the old node and reuses a dead one of the new capacity
+  int32_t newMin, newMax;
+  CRadix::Node256 *dPtr = mem.ptr(d);
+  EXPECT_FALSE(dPtr->trySetOffset('z', 3, newMin, newMax));
+  mem.freeNode256(mem.newNode256(newMax-newMin+1, 'q', 0));
+  mem.statistics(&mstats);
+  const u_int64_t before = mstats.d_currentSizeBytes;
+  u_int32_t e = mem.copyAllocateNode256(newMin, newMax, 0, d);
+  EXPECT_TRUE(mem.ptr(d)->isDead());
+  EXPECT_EQ(mem.ptr(e)->offset('d'), 0);
+  mem.statistics(&mstats);
+  EXPECT_EQ(mstats.d_currentSizeBytes, before);
+
+  EXPECT_EQ(mstats.d_freeCount, 4);
+  EXPECT_EQ(mstats.d_allocCount, 9);
+  EXPECT_DOUBLE_EQ(mstats.reuseRate(), 4.0/9.0);
+}
+
+TEST (cradix, churnStopsGrowing) {
+  // Once one insert/remove cycle has run, later cycles are served from free lists
+  CRadix::MemManager mem(bufferSize, 4);
+  CRadix::Tree tree(&mem);
+  CRadix::MemStats mstats;
+  u_int64_t footprint(0);
+
+  for (unsigned cycle=0; cycle<10; ++cycle) {
+    for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+      Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+      EXPECT_EQ(tree.insert(key), CRadix::e_OK);
+    }
+    for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+      Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+      EXPECT_EQ(tree.remove(key), CRadix::e_OK);
+    }
+    mem.statistics(&mstats);
+    if (cycle==0) {
+      footprint = mstats.d_currentSizeBytes;
+    } else {
+      EXPECT_EQ(mstats.d_currentSizeBytes, footprint);
+    }
+  }
+
+  EXPECT_GT(mstats.reuseRate(), 0.85);
+  EXPECT_EQ(mstats.d_deadCount+1, mstats.d_allocCount);
+}
+
+TEST (cradix, compact) {
+  // Compaction keeps every key, iteration order and the ability to insert and remove, while dropping dead nodes
+  // and spare capacity. Running out of memory leaves the tree as it was
+  CRadix::MemManager mem(bufferSize, 4);
+  CRadix::Tree tree(&mem);
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.insert(key), CRadix::e_OK);
+  }
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; i+=3) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.remove(key), CRadix::e_OK);
+  }
+
+  std::vector<std::string> before;
+  for (CRadix::Iterator iter = tree.begin(); !iter.end(); iter.next()) {
+    before.push_back(std::string((const char*)iter.key(), iter.keySize()));
+  }
+  CRadix::TreeStats stats;
+  tree.statistics(&stats);
+  const u_int64_t innerNodeCount = stats.d_innerNodeCount;
+
+  CRadix::MemManager tiny(CRadix::k_MEMMANAGER_MIN_MEMORY, 4);
+  EXPECT_EQ(tree.compact(&tiny), CRadix::e_MEMORY_ERROR);
+  EXPECT_EQ(tree.memManager(), &mem);
+
+  CRadix::MemManager compacted(bufferSize, 4);
+  EXPECT_EQ(tree.compact(&compacted), CRadix::e_OK);
+  EXPECT_EQ(tree.memManager(), &compacted);
+
+  // Nothing dead, nothing spare and smaller than before
+  CRadix::MemStats oldStats, newStats;
+  mem.statistics(&oldStats);
+  compacted.statistics(&newStats);
+  EXPECT_EQ(newStats.d_deadCount, 0);
+  EXPECT_LT(newStats.d_currentSizeBytes, oldStats.d_currentSizeBytes);
+  tree.statistics(&stats);
+  EXPECT_EQ(stats.d_innerNodeCount, innerNodeCount);
+  EXPECT_EQ(newStats.d_allocCount, innerNodeCount+1);
+
+  // Wipe the old memory so any stale link shows up
+  memset(mem.d_basePtr, 0xff, bufferSize);
+
+  std::vector<std::string> after;
+  for (CRadix::Iterator iter = tree.begin(); !iter.end(); iter.next()) {
+    after.push_back(std::string((const char*)iter.key(), iter.keySize()));
+  }
+  EXPECT_EQ(before, after);
+
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.find(key), i%3==0 ? CRadix::e_NOT_FOUND : CRadix::e_EXISTS);
+  }
+
+  // Compacted nodes are full so new keys copy-allocate them
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; i+=3) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.insert(key), CRadix::e_OK);
+  }
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.find(key), CRadix::e_EXISTS);
+    EXPECT_EQ(tree.remove(key), CRadix::e_OK);
+  }
+  tree.statistics(&stats);
+  EXPECT_EQ(stats.d_terminalCount, 0);
+}
+
+TEST (cradix, values) {
+  // Every reference key holds its own value whether it ends on a leaf or is a prefix of longer keys, and values
+  // follow their keys through node reallocation, removal of longer keys and compaction
+  CRadix::MemManager mem(bufferSize, 4);
+  CRadix::Tree tree(&mem);
+  u_int64_t value(0);
+
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.find(key, &value), CRadix::e_NOT_FOUND);
+    EXPECT_EQ(tree.insert(key, 1000+i), CRadix::e_OK);
+    EXPECT_EQ(tree.insert(key, 1), CRadix::e_EXISTS);
+  }
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.find(key), CRadix::e_EXISTS);
+    EXPECT_EQ(tree.find(key, &value), CRadix::e_EXISTS);
+    EXPECT_EQ(value, 1000+i);
+  }
+
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.upsert(key, 2000+i), CRadix::e_EXISTS);
+  }
+
+  CRadix::MemManager compacted(bufferSize, 4);
+  EXPECT_EQ(tree.compact(&compacted), CRadix::e_OK);
+
+  // Remove every other key; the rest keep their values
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; i+=2) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.remove(key), CRadix::e_OK);
+  }
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    if (i%2==0) {
+      EXPECT_EQ(tree.find(key, &value), CRadix::e_NOT_FOUND);
+      EXPECT_EQ(tree.upsert(key, 3000+i), CRadix::e_OK);
+      EXPECT_EQ(tree.find(key, &value), CRadix::e_EXISTS);
+      EXPECT_EQ(value, 3000+i);
+    } else {
+      EXPECT_EQ(tree.find(key, &value), CRadix::e_EXISTS);
+      EXPECT_EQ(value, 2000+i);
+    }
+  }
+
+  // Keys inserted without a value hold 0 until given one
+  const u_int8_t xyz[] = {'x', 'y', 'z'};
+  Benchmark::Slice<unsigned char> x(xyz, 1);
+  Benchmark::Slice<unsigned char> xy(xyz, 2);
+  Benchmark::Slice<unsigned char> xyzKey(xyz, 3);
+  EXPECT_EQ(tree.insert(xyzKey), CRadix::e_OK);
+  EXPECT_EQ(tree.insert(x), CRadix::e_OK);
+  EXPECT_EQ(tree.insert(x), CRadix::e_EXISTS);
+  EXPECT_EQ(tree.find(x, &value), CRadix::e_EXISTS);
+  EXPECT_EQ(value, 0);
+  EXPECT_EQ(tree.upsert(x, 7), CRadix::e_EXISTS);
+  EXPECT_EQ(tree.upsert(xyzKey, 8), CRadix::e_EXISTS);
+  EXPECT_EQ(tree.insert(xy, 9), CRadix::e_OK);
+
+  // Removing the longest key turns 'xy' back into a leaf keeping its value
+  EXPECT_EQ(tree.remove(xyzKey), CRadix::e_OK);
+  EXPECT_EQ(tree.find(xy, &value), CRadix::e_EXISTS);
+  EXPECT_EQ(value, 9);
+  EXPECT_EQ(tree.find(x, &value), CRadix::e_EXISTS);
+  EXPECT_EQ(value, 7);
+  EXPECT_EQ(tree.remove(xy), CRadix::e_OK);
+  EXPECT_EQ(tree.find(x, &value), CRadix::e_EXISTS);
+  EXPECT_EQ(value, 7);
+
+  std::vector<std::string> iterated;
+  for (CRadix::Iterator iter = tree.begin(); !iter.end(); iter.next()) {
+    iterated.push_back(std::string((const char*)iter.key(), iter.keySize()));
+  }
+  EXPECT_EQ(iterated.size(), NUM_REFERENCE_VALUES+1);
+  EXPECT_TRUE(std::is_sorted(iterated.begin(), iterated.end()));
+}
+
+TEST (cradix, seekScan) {
+  // 'lowerBound, scan, scanPrefix' agree with std::set for reference keys, their prefixes and near misses, before
+  // and after removing some keys, and for keys longer than the iterator's inline depth
+  CRadix::MemManager mem(bufferSize, 4);
+  CRadix::Tree tree(&mem);
+  std::set<std::string> live;
+
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.insert(key), CRadix::e_OK);
+    live.insert(std::string((const char*)key.data(), key.size()));
+  }
+  const std::string deep(CRadix::Iterator::k_INLINE_DEPTH+40, 'q');
+  for (unsigned i=CRadix::Iterator::k_INLINE_DEPTH-2; i<=deep.size(); i+=7) {
+    Benchmark::Slice<unsigned char> key((const u_int8_t*)deep.data(), i);
+    EXPECT_EQ(tree.insert(key), CRadix::e_OK);
+    live.insert(deep.substr(0, i));
+  }
+
+  std::vector<std::string> probes(1, std::string());
+  for (const auto& key: live) {
+    probes.push_back(key);
+    probes.push_back(key.substr(0, key.size()/2));
+    probes.push_back(key+'\x00');
+    probes.push_back(key+'\xff');
+    std::string bigger(key);
+    bigger.back() = (char)((u_int8_t)bigger.back()+1);
+    probes.push_back(bigger);
+    std::string smaller(key);
+    smaller.back() = (char)((u_int8_t)smaller.back()-1);
+    probes.push_back(smaller);
+  }
+
+  auto check = [&]() {
+    for (const auto& probe: probes) {
+      Benchmark::Slice<unsigned char> key((const u_int8_t*)probe.data(), probe.size());
+
+      // Seek then walk a few keys
+      auto expected = live.lower_bound(probe);
+      CRadix::Iterator iter = tree.lowerBound(key);
+      for (unsigned i=0; i<3 && expected!=live.end(); ++i, ++expected, iter.next()) {
+        ASSERT_FALSE(iter.end());
+        EXPECT_EQ(std::string((const char*)iter.key(), iter.keySize()), *expected);
+      }
+      if (expected==live.end()) {
+        EXPECT_TRUE(iter.end());
+      }
+
+      // Bounded scan up to the next probe-sized step
+      std::vector<std::string> visited;
+      auto visitor = [&](const u_int8_t *data, u_int16_t size) {
+        visited.push_back(std::string((const char*)data, size));
+      };
+      const std::string endKey = probe+"m";
+      Benchmark::Slice<unsigned char> end((const u_int8_t*)endKey.data(), endKey.size());
+      const u_int64_t scanned = tree.scan(key, end, 5, visitor);
+      EXPECT_EQ(scanned, visited.size());
+      std::vector<std::string> want;
+      for (auto i=live.lower_bound(probe); i!=live.end() && *i<endKey && want.size()<5; ++i) {
+        want.push_back(*i);
+      }
+      EXPECT_EQ(visited, want);
+
+      // Prefix scan without limit
+      visited.clear();
+      want.clear();
+      const u_int64_t prefixed = tree.scanPrefix(key, ~0UL, visitor);
+      EXPECT_EQ(prefixed, visited.size());
+      for (auto i=live.lower_bound(probe); i!=live.end() && i->compare(0, probe.size(), probe)==0; ++i) {
+        want.push_back(*i);
+      }
+      EXPECT_EQ(visited, want);
+    }
+  };
+
+  check();
+
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; i+=3) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.remove(key), CRadix::e_OK);
+    live.erase(std::string((const char*)key.data(), key.size()));
+  }
+
+  check();
+
+  // Empty tree
+  CRadix::MemManager emptyMem(bufferSize, 4);
+  CRadix::Tree empty(&emptyMem);
+  Benchmark::Slice<unsigned char> key((const u_int8_t*)deep.data(), 1);
+  EXPECT_TRUE(empty.lowerBound(key).end());
+}
+
+TEST (cradix, findBatch) {
+  // 'findBatch' agrees with 'find' for present keys, their prefixes and near misses whatever the batch size
+  CRadix::MemManager mem(bufferSize, 4);
+  CRadix::Tree tree(&mem);
+
+  std::vector<std::string> probes;
+  for (unsigned i=0; i<NUM_REFERENCE_VALUES; ++i) {
+    Benchmark::Slice<unsigned char> key(REFERENCE_VALUES[i].d_data, REFERENCE_VALUES[i].d_size);
+    EXPECT_EQ(tree.insert(key), CRadix::e_OK);
+    const std::string word((const char*)key.data(), key.size());
+    probes.push_back(word);
+    probes.push_back(word+'\x00');
+    if (word.size()>1) {
+      probes.push_back(word.substr(0, word.size()-1));
+    }
+    std::string bigger(word);
+    bigger.back() = (char)((u_int8_t)bigger.back()+1);
+    probes.push_back(bigger);
+  }
+
+  std::vector<Benchmark::Slice<unsigned char>> keys;
+  std::vector<int> expected;
+  for (const auto& probe: probes) {
+    keys.push_back(Benchmark::Slice<unsigned char>((const u_int8_t*)probe.data(), probe.size()));
+    expected.push_back(tree.find(keys.back()));
+  }
+
+  for (unsigned count: {0U, 1U, 7U, (unsigned)CRadix::Tree::k_FIND_BATCH_WIDTH, (unsigned)keys.size()}) {
+    std::vector<int> results(count, -1);
+    tree.findBatch(keys.data(), results.data(), count);
+    for (unsigned i=0; i<count; ++i) {
+      EXPECT_EQ(results[i], expected[i]);
+    }
+  }
+}
+
+static std::vector<std::string> randomKeys(unsigned count, unsigned seed) {
+  // Sorted distinct keys of 1 to 12 bytes over a small alphabet so many share prefixes and nodes
+  std::mt19937 gen(seed);
+  std::set<std::string> keys;
+  while (keys.size()<count) {
+    std::string key(1+gen()%12, 'a');
+    for (auto& byte: key) {
+      byte = (char)('a'+gen()%8);
+    }
+    keys.insert(key);
+  }
+  return std::vector<std::string>(keys.begin(), keys.end());
+}
+
+TEST (cradix, concurrentInsert) {
+  // One thread: ConcurrentTree builds the same tree Tree does
+  std::vector<std::string> keys = randomKeys(2000, 11);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(5));
+
+  CRadix::MemManager mem(bufferSize, 4);
+  CRadix::MemManager otherMem(bufferSize, 4);
+  CRadix::ConcurrentTree tree(&mem);
+  CRadix::Tree other(&otherMem);
+
+  for (const auto& word: keys) {
+    Benchmark::Slice<unsigned char> key((const u_int8_t*)word.data(), word.size());
+    EXPECT_EQ(tree.find(key), CRadix::e_NOT_FOUND);
+    EXPECT_EQ(tree.insert(key), CRadix::e_OK);
+    EXPECT_EQ(tree.insert(key), CRadix::e_EXISTS);
+    EXPECT_EQ(tree.find(key), CRadix::e_EXISTS);
+    EXPECT_EQ(other.insert(key), CRadix::e_OK);
+  }
+
+  CRadix::TreeStats stats;
+  CRadix::TreeStats otherStats;
+  tree.tree().statistics(&stats);
+  other.statistics(&otherStats);
+  EXPECT_EQ(stats.d_innerNodeCount, otherStats.d_innerNodeCount);
+  EXPECT_EQ(stats.d_leafCount, otherStats.d_leafCount);
+  EXPECT_EQ(stats.d_terminalCount, otherStats.d_terminalCount);
+  EXPECT_EQ(stats.d_maxDepth, otherStats.d_maxDepth);
+  EXPECT_EQ(tree.tree().currentMaxDepth(), other.currentMaxDepth());
+
+  std::sort(keys.begin(), keys.end());
+  unsigned i(0);
+  for (CRadix::Iterator iter = tree.tree().begin(); !iter.end(); iter.next(), ++i) {
+    ASSERT_LT(i, keys.size());
+    EXPECT_EQ(std::string((const char*)iter.key(), iter.keySize()), keys[i]);
+  }
+  EXPECT_EQ(i, keys.size());
+}
+
+TEST (cradix, concurrentThreads) {
+  // Readers never miss a key inserted before they started while writers grow, copy and relink the nodes holding it
+  const unsigned k_WRITERS = 4;
+  const unsigned k_READERS = 2;
+  const std::vector<std::string> keys = randomKeys(20000, 17);
+
+  CRadix::MemManager mem(0x4000000, 4);
+  CRadix::ConcurrentTree tree(&mem);
+
+  // Even keys first. Writers then insert odd keys
+  for (unsigned i=0; i<keys.size(); i+=2) {
+    Benchmark::Slice<unsigned char> key((const u_int8_t*)keys[i].data(), keys[i].size());
+    ASSERT_EQ(tree.insert(key), CRadix::e_OK);
+  }
+
+  std::atomic<bool> done(false);
+  std::atomic<unsigned> misses(0);
+  std::atomic<unsigned> inserted(0);
+  std::vector<std::thread> threads;
+
+  for (unsigned r=0; r<k_READERS; ++r) {
+    threads.emplace_back([&]() {
+      do {
+        for (unsigned i=0; i<keys.size(); i+=2) {
+          Benchmark::Slice<unsigned char> key((const u_int8_t*)keys[i].data(), keys[i].size());
+          if (tree.find(key)!=CRadix::e_EXISTS) {
+            ++misses;
+          }
+        }
+      } while (!done.load());
+    });
+  }
+
+  std::vector<std::thread> writers;
+  for (unsigned w=0; w<k_WRITERS; ++w) {
+    writers.emplace_back([&, w]() {
+      for (unsigned i=2*w+1; i<keys.size(); i+=2*k_WRITERS) {
+        Benchmark::Slice<unsigned char> key((const u_int8_t*)keys[i].data(), keys[i].size());
+        if (tree.insert(key)==CRadix::e_OK) {
+          ++inserted;
+        }
+      }
+    });
+  }
+
+  for (auto& writer: writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto& thread: threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(misses.load(), 0U);
+  EXPECT_EQ(inserted.load(), keys.size()/2);
+
+  // Every key is found and iteration gives all of them in order
+  for (const auto& word: keys) {
+    Benchmark::Slice<unsigned char> key((const u_int8_t*)word.data(), word.size());
+    EXPECT_EQ(tree.find(key), CRadix::e_EXISTS);
+  }
+  unsigned i(0);
+  for (CRadix::Iterator iter = tree.tree().begin(); !iter.end(); iter.next(), ++i) {
+    ASSERT_LT(i, keys.size());
+    EXPECT_EQ(std::string((const char*)iter.key(), iter.keySize()), keys[i]);
+  }
+  EXPECT_EQ(i, keys.size());
+}
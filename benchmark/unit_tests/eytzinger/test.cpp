@@ -0,0 +1,196 @@
+#include <eytzinger_index.h>
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+static Benchmark::UKey slice(const std::string& key) {
+  return Benchmark::UKey(reinterpret_cast<const unsigned char*>(key.data()), key.size());
+}
+
+static std::vector<std::string> makeKeys() {
+  // Short keys, keys exactly 8 bytes, keys sharing their first 8 bytes so only the tail decides, and high bytes
+  std::vector<std::string> keys = {"a", "ab", "abc", "abcdefgh", "abcdefgh0", "abcdefgh1", "abcdefghij", "b",
+    "prefix00-apple", "prefix00-apricot", "prefix00-a", "prefix00", "\xff", "\xff\xff\xff\xff\xff\xff\xff\xff\x01",
+    "z\x80z"};
+  for (unsigned i=0; i<40; ++i) {
+    keys.push_back("k" + std::to_string(i*7919));
+    keys.push_back("shared-prefix-" + std::to_string(i));
+  }
+  return keys;
+}
+
+static std::vector<std::string> makeProbes(const std::vector<std::string>& keys) {
+  // Every key plus keys before, between and after them
+  std::vector<std::string> probes = keys;
+  for (const auto& key: keys) {
+    probes.push_back(key+'\0');
+    probes.push_back(key+'x');
+    probes.push_back(key.substr(0, key.size()-1));
+  }
+  probes.push_back("\x01");
+  probes.push_back("abcdefg");
+  probes.push_back("prefix00-b");
+  probes.push_back("\xff\xff\xff\xff\xff\xff\xff\xff");
+  probes.push_back("\xff\xff\xff\xff\xff\xff\xff\xff\xff");
+  return probes;
+}
+
+TEST(eytzinger, prefix) {
+  // Prefix order agrees with key order whenever prefixes differ
+  const std::vector<std::string> keys = makeProbes(makeKeys());
+  for (const auto& lhs: keys) {
+    for (const auto& rhs: keys) {
+      if (lhs.empty() || rhs.empty()) {
+        continue;
+      }
+      const u_int64_t lp = Eytzinger::Index::prefix(slice(lhs).data(), lhs.size());
+      const u_int64_t rp = Eytzinger::Index::prefix(slice(rhs).data(), rhs.size());
+      const int rc = Eytzinger::Index::compare(slice(lhs), slice(rhs));
+      EXPECT_EQ(lhs.compare(rhs)<0, rc<0) << lhs << " " << rhs;
+      EXPECT_EQ(lhs==rhs, rc==0) << lhs << " " << rhs;
+      if (lp<rp) {
+        EXPECT_LT(rc, 0) << lhs << " " << rhs;
+      } else if (lp>rp) {
+        EXPECT_GT(rc, 0) << lhs << " " << rhs;
+      }
+    }
+  }
+}
+
+TEST(eytzinger, empty) {
+  Eytzinger::Index index;
+  const std::string key("a");
+  EXPECT_EQ(0UL, index.size());
+  EXPECT_EQ(Eytzinger::e_NOT_FOUND, index.find(slice(key)));
+  EXPECT_EQ(0UL, index.build());
+  EXPECT_EQ(Eytzinger::e_NOT_FOUND, index.find(slice(key)));
+
+  unsigned visits(0);
+  auto visitor = [&](const u_int8_t *, u_int16_t) { ++visits; };
+  EXPECT_EQ(0UL, index.scan(slice(key), 10, visitor));
+  EXPECT_EQ(0U, visits);
+}
+
+TEST(eytzinger, find) {
+  // Every tree shape from 1 key to all of them: full last level, partial, and a single path
+  const std::vector<std::string> keys = makeKeys();
+  const std::vector<std::string> probes = makeProbes(keys);
+  for (unsigned n=1; n<=keys.size(); ++n) {
+    Eytzinger::Index index;
+    std::set<std::string> held;
+    for (unsigned i=0; i<n; ++i) {
+      index.add(slice(keys[i]));
+      held.insert(keys[i]);
+    }
+    EXPECT_EQ(n, index.pending());
+    ASSERT_EQ(held.size(), index.build());
+    EXPECT_EQ(0UL, index.pending());
+
+    for (const auto& probe: probes) {
+      if (probe.empty()) {
+        continue;
+      }
+      const bool expected = held.count(probe)>0;
+      EXPECT_EQ(expected ? Eytzinger::e_EXISTS : Eytzinger::e_NOT_FOUND, index.find(slice(probe))) << n << probe;
+
+      Benchmark::UKey found;
+      if (index.find(slice(probe), &found)==Eytzinger::e_EXISTS) {
+        EXPECT_EQ(probe, std::string(reinterpret_cast<const char*>(found.data()), found.size()));
+      }
+    }
+  }
+}
+
+TEST(eytzinger, duplicates) {
+  // Later copies of a key are dropped: searched keys before staged ones, then staged in order added
+  const std::vector<std::string> first = {"dup", "one", "dup-longer-than-8", "two"};
+  const std::vector<std::string> second = {"dup", "dup-longer-than-8", "three", "dup"};
+
+  Eytzinger::Index index;
+  for (const auto& key: first) {
+    index.add(slice(key));
+  }
+  std::vector<Benchmark::UKey> dropped;
+  EXPECT_EQ(4UL, index.build(&dropped));
+  EXPECT_TRUE(dropped.empty());
+
+  for (const auto& key: second) {
+    index.add(slice(key));
+  }
+  EXPECT_EQ(Eytzinger::e_NOT_FOUND, index.find(slice(second[2])));
+  EXPECT_EQ(5UL, index.build(&dropped));
+  ASSERT_EQ(3UL, dropped.size());
+  for (const auto& key: dropped) {
+    EXPECT_TRUE(key.data()==slice(second[0]).data() || key.data()==slice(second[1]).data() ||
+      key.data()==slice(second[3]).data());
+  }
+
+  for (const auto& key: first) {
+    Benchmark::UKey found;
+    ASSERT_EQ(Eytzinger::e_EXISTS, index.find(slice(key), &found));
+    EXPECT_EQ(slice(key).data(), found.data());
+  }
+  EXPECT_EQ(Eytzinger::e_EXISTS, index.find(slice(second[2])));
+
+  std::vector<Benchmark::UKey> all;
+  index.allKeys(all);
+  EXPECT_EQ(5UL, all.size());
+}
+
+TEST(eytzinger, findBatch) {
+  const std::vector<std::string> keys = makeKeys();
+  const std::vector<std::string> probes = makeProbes(keys);
+  Eytzinger::Index index;
+  for (unsigned i=0; i<keys.size(); i+=2) {
+    index.add(slice(keys[i]));
+  }
+  index.build();
+
+  std::vector<Benchmark::UKey> batch;
+  for (const auto& probe: probes) {
+    if (!probe.empty()) {
+      batch.push_back(slice(probe));
+    }
+  }
+
+  // Batches narrower than, as wide as, and wider than 'k_FIND_BATCH_WIDTH'
+  for (unsigned count: {1U, 5U, 16U, 17U, 40U, static_cast<unsigned>(batch.size())}) {
+    std::vector<int> results(count, -1);
+    index.findBatch(batch.data(), results.data(), count);
+    for (unsigned i=0; i<count; ++i) {
+      EXPECT_EQ(index.find(batch[i]), results[i]) << count << " " << i;
+    }
+  }
+}
+
+TEST(eytzinger, scan) {
+  const std::vector<std::string> keys = makeKeys();
+  const std::vector<std::string> probes = makeProbes(keys);
+  Eytzinger::Index index;
+  std::set<std::string> held;
+  for (const auto& key: keys) {
+    index.add(slice(key));
+    held.insert(key);
+  }
+  index.build();
+
+  for (const auto& probe: probes) {
+    if (probe.empty()) {
+      continue;
+    }
+    for (unsigned limit: {1U, 3U, 1000U}) {
+      std::vector<std::string> expected;
+      for (auto iter = held.lower_bound(probe); iter!=held.end() && expected.size()<limit; ++iter) {
+        expected.push_back(*iter);
+      }
+      std::vector<std::string> visited;
+      auto visitor = [&](const u_int8_t *key, u_int16_t size) {
+        visited.push_back(std::string(reinterpret_cast<const char*>(key), size));
+      };
+      EXPECT_EQ(expected.size(), index.scan(slice(probe), limit, visitor)) << probe;
+      EXPECT_EQ(expected, visited) << probe;
+    }
+  }
+}
@@ -0,0 +1,95 @@
+#include <intel_latency_recorder.h>
+#include <gtest/gtest.h>
+
+TEST(latency_recorder, bucket) {
+  // Small values are exact
+  for (u_int64_t i=0; i<2*Intel::LatencyRecorder::k_SUB_BUCKETS; ++i) {
+    EXPECT_EQ(i, Intel::LatencyRecorder::bucket(i));
+    EXPECT_EQ(i, Intel::LatencyRecorder::highestEquivalentValue(i));
+  }
+
+  // Larger values land in a bucket whose range holds them within ~3%
+  for (u_int64_t value=64; value<(1ULL<<40); value=value*3+7) {
+    const unsigned bucket = Intel::LatencyRecorder::bucket(value);
+    ASSERT_TRUE(bucket<Intel::LatencyRecorder::k_BUCKETS);
+    const u_int64_t high = Intel::LatencyRecorder::highestEquivalentValue(bucket);
+    EXPECT_TRUE(value<=high);
+    EXPECT_TRUE((double)(high-value)<=(double)value/32.0);
+    EXPECT_EQ(bucket, Intel::LatencyRecorder::bucket(high));
+    EXPECT_EQ(bucket+1, Intel::LatencyRecorder::bucket(high+1));
+  }
+
+  EXPECT_EQ(Intel::LatencyRecorder::k_BUCKETS-1, Intel::LatencyRecorder::bucket(~0ULL));
+  EXPECT_EQ(~0ULL, Intel::LatencyRecorder::highestEquivalentValue(Intel::LatencyRecorder::k_BUCKETS-1));
+}
+
+TEST(latency_recorder, percentile) {
+  Intel::LatencyRecorder latency(1);
+  EXPECT_EQ(0UL, latency.samples());
+  EXPECT_EQ(0UL, latency.percentile(50.0));
+  EXPECT_EQ(0UL, latency.max());
+
+  for (u_int64_t i=1; i<=1000; ++i) {
+    latency.record(i);
+  }
+
+  EXPECT_EQ(1000UL, latency.samples());
+  EXPECT_EQ(1000UL, latency.max());
+  EXPECT_EQ(1000UL, latency.percentile(100.0));
+
+  const u_int64_t p50 = latency.percentile(50.0);
+  const u_int64_t p99 = latency.percentile(99.0);
+  EXPECT_TRUE(p50>=500 && p50<=500+500/32);
+  EXPECT_TRUE(p99>=990 && p99<=1000);
+  EXPECT_TRUE(p50<=p99);
+
+  latency.reset();
+  EXPECT_EQ(0UL, latency.samples());
+  EXPECT_EQ(0UL, latency.max());
+}
+
+TEST(latency_recorder, sampling) {
+  Intel::LatencyRecorder off(0);
+  for (unsigned i=0; i<100; ++i) {
+    off.begin();
+    off.end();
+  }
+  EXPECT_EQ(0UL, off.samples());
+
+  Intel::LatencyRecorder all(1);
+  for (unsigned i=0; i<100; ++i) {
+    all.begin();
+    all.end();
+  }
+  EXPECT_EQ(100UL, all.samples());
+
+  Intel::LatencyRecorder some(8);
+  for (unsigned i=0; i<100; ++i) {
+    some.begin();
+    some.end();
+  }
+  EXPECT_EQ(12UL, some.samples());
+}
+
+TEST(latency_recorder, merge) {
+  // Merging halves recorded apart gives what recording everything in one would
+  Intel::LatencyRecorder odd(1);
+  Intel::LatencyRecorder even(1);
+  Intel::LatencyRecorder all(1);
+  for (u_int64_t i=1; i<=1000; ++i) {
+    (i%2 ? odd : even).record(i*3);
+    all.record(i*3);
+  }
+
+  even.merge(odd);
+  EXPECT_EQ(all.samples(), even.samples());
+  EXPECT_EQ(all.max(), even.max());
+  for (double pct: {1.0, 50.0, 99.0, 99.9, 100.0}) {
+    EXPECT_EQ(all.percentile(pct), even.percentile(pct));
+  }
+
+  Intel::LatencyRecorder empty(1);
+  even.merge(empty);
+  EXPECT_EQ(all.samples(), even.samples());
+  EXPECT_EQ(all.max(), even.max());
+}
@@ -1,4 +1,5 @@
 #include <ctype.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -14,12 +15,14 @@ static_assert(sizeof(unsigned)==4);
 struct Config {
   enum Mode {
     CONVERT_TEXT = 0,
+    CONVERT_KV   = 1,
     UNDEFINED    = 99,
   };
 
   Config()
   : d_mode(UNDEFINED)
   , d_verbosity(0)
+  , d_valueSize(0)
   , d_cstringTerminator(false)
   , d_keyPerLine(false)
   {
@@ -27,6 +30,7 @@ struct Config {
 
   Mode            d_mode;
   unsigned int    d_verbosity;
+  unsigned int    d_valueSize;
   bool            d_cstringTerminator;
   bool            d_keyPerLine;
   std::string     d_inFilename;
@@ -42,8 +46,12 @@ void usageAndExit() {
   printf("                                'convert-text': convert <inputFilename> to <outputFilename> in which the input\n");
   printf("                                                file contains one key per whitespace separated word or one key\n");
   printf("                                                per line. See -l\n");
+  printf("                                'convert-kv'  : convert <inputFilename> to <outputFilename> in which each line of\n");
+  printf("                                                the input file holds one key-value pair: the key is the first\n");
+  printf("                                                whitespace separated word, and the value is the rest of the line.\n");
+  printf("                                                With -s the value is synthesized instead. See -s\n");
   printf("\n");
-  printf("       -i <inputFilename>       optional : required when <mode> is 'convert-text' otherwise not used\n");
+  printf("       -i <inputFilename>       optional : required when <mode> is 'convert-text, convert-kv' otherwise not used\n");
   printf("\n");
   printf("       -o <outputFilename>      mandatory: output file which contains output as per <mode>\n");
   printf("\n");
@@ -51,6 +59,10 @@ void usageAndExit() {
   printf("\n");
   printf("       -l                       optional : construe each line as one key\n");
   printf("\n");
+  printf("       -s <valueSize>           optional : 'convert-kv' only. Ignore any value text in <inputFilename> and instead\n");
+  printf("                                           write a synthesized value of <valueSize> bytes in [1, 0xfffe] for\n");
+  printf("                                           each key. Keys are then found as per 'convert-text' including -l\n");
+  printf("\n");
   printf("       -v                       optional : show strings written to output file\n");
   printf("\n");
   printf("Program assumes UNIX line delimited files. DOS files with '\\r' should be stripped first.\n");
@@ -59,7 +71,7 @@ void usageAndExit() {
 
 void parseCommandLine(int argc, char **argv) {                                                                          
   int opt;
-  const char *switches = "m:i:o:tvl";
+  const char *switches = "m:i:o:s:tvl";
 
   while ((opt = getopt(argc, argv, switches)) != -1) {
     switch (opt) {
@@ -67,6 +79,8 @@ void parseCommandLine(int argc, char **argv) {
         {
           if (0==strcmp(optarg, "convert-text")) {
             config.d_mode = Config::CONVERT_TEXT;
+          } else if (0==strcmp(optarg, "convert-kv")) {
+            config.d_mode = Config::CONVERT_KV;
           } else {
             usageAndExit();
           }
@@ -93,6 +107,17 @@ void parseCommandLine(int argc, char **argv) {
         }
         break;
 
+      case 's':
+        {
+          int sz = atoi(optarg);
+          if (sz>0 && sz<=0xfffe) {
+            config.d_valueSize = sz;
+          } else {
+            usageAndExit();
+          }
+        }
+        break;
+
       case 't':
         {
           config.d_cstringTerminator = true;
@@ -127,6 +152,12 @@ void parseCommandLine(int argc, char **argv) {
   if (config.d_mode==Config::CONVERT_TEXT && config.d_inFilename.empty()) {
     usageAndExit();
   }
+  if (config.d_mode==Config::CONVERT_KV && config.d_inFilename.empty()) {
+    usageAndExit();
+  }
+  if (config.d_mode!=Config::CONVERT_KV && config.d_valueSize) {
+    usageAndExit();
+  }
 }
 
 int convertTextHelper(int fid, char *data, const char *end, unsigned int& words) {
@@ -227,6 +258,164 @@ int convertTextHelper(int fid, char *data, const char *end, unsigned int& words)
   return 0;
 }
 
+int writeRecord(int fid, const char *start, unsigned int sz, bool terminate, unsigned long& offset) {
+  // Write one [u32 elementCount][bytes][terminator?] record. 'elementCount' is
+  // inclusive of the terminator if any. Return 0 on success and non-zero
+  // otherwise
+  const char terminator(0);
+  unsigned int outputSize(sz);
+  if (terminate) {
+    ++outputSize;
+  }
+  if (write(fid, &outputSize, sizeof(outputSize))==-1) {
+    printf("write error: %s (errno=%d)\n", strerror(errno), errno);
+    return -1;
+  }
+  offset += sizeof(outputSize);
+
+  if (write(fid, start, sz)==-1) {
+    printf("write error: %s (errno=%d)\n", strerror(errno), errno);
+    return -1;
+  }
+  offset += sz;
+
+  if (terminate) {
+    if (write(fid, &terminator, sizeof(terminator))==-1) {
+      printf("write error: %s (errno=%d)\n", strerror(errno), errno);
+      return -1;
+    }
+    ++offset;
+  }
+
+  return 0;
+}
+
+void printRecord(const char *start, unsigned int sz, bool terminate) {
+  for (unsigned int i=0; i<sz; ++i) {
+    if (isprint(*(start+i))) {
+      putchar(*(start+i));
+    } else {
+      unsigned char uc = static_cast<unsigned char>(*(start+i));
+      printf("0x%02x", uc);
+    }
+  }
+  if (terminate) {
+    printf("0x00");
+  }
+}
+
+int convertKVHelper(int fid, char *data, const char *end, unsigned int& pairs) {
+  char *ptr = data;
+
+  // first pair starts 4 bytes into file after 4 byte pair count
+  unsigned long offset = 4;
+
+  // Synthesized values are rewritten per pair from this buffer
+  std::string synthesized;
+  if (config.d_valueSize) {
+    synthesized.resize(config.d_valueSize);
+  }
+
+  while(ptr<end) {
+    // strip leading whitespaces
+    while(ptr<end && isspace(*ptr)) {
+      ++ptr;
+    }
+
+    // Find end of key
+    char *start(ptr);
+    if (config.d_valueSize && config.d_keyPerLine) {
+      // key per line
+      for(; ptr<end; ++ptr) {
+        if (*ptr=='\n') {
+          break;
+        }
+      }
+    } else {
+      // Find end-of-word
+      for(; ptr<end; ++ptr) {
+        if (isspace(*ptr)) {
+          break;
+        }
+      }
+    }
+    const unsigned int keySize = ptr-start;
+
+    // Skip empty keys
+    if (keySize==0) {
+      continue;
+    }
+
+    // Find value: either synthesized or the rest of the line
+    const char *value(0);
+    unsigned int valueSize(0);
+    if (config.d_valueSize) {
+      // Deterministic per pair so runs over the same file see the same values
+      for (unsigned int i=0; i<config.d_valueSize; ++i) {
+        synthesized[i] = static_cast<char>('a' + ((pairs+i) % 26));
+      }
+      value = synthesized.data();
+      valueSize = config.d_valueSize;
+    } else {
+      // strip whitespace between key and value but stay on this line
+      while(ptr<end && *ptr!='\n' && isspace(*ptr)) {
+        ++ptr;
+      }
+      value = ptr;
+      for(; ptr<end; ++ptr) {
+        if (*ptr=='\n') {
+          break;
+        }
+      }
+      // strip trailing whitespace
+      const char *valueEnd(ptr);
+      while(valueEnd>value && isspace(*(valueEnd-1))) {
+        --valueEnd;
+      }
+      valueSize = valueEnd-value;
+    }
+
+    // Error out if key or value is empty or too big
+    if (keySize>0xfffe) {
+      printf("ERROR: key size %u exceeds maximum of 0xfffe\n", keySize);
+      return -1;
+    }
+    if (valueSize==0) {
+      printf("ERROR: key '%.*s' has no value\n", keySize, start);
+      return -1;
+    }
+    if (valueSize>0xfffe) {
+      printf("ERROR: value size %u exceeds maximum of 0xfffe\n", valueSize);
+      return -1;
+    }
+
+    const unsigned long previousPairOffset = offset;
+
+    if (writeRecord(fid, start, keySize, config.d_cstringTerminator, offset)!=0) {
+      return -1;
+    }
+    // Values are never terminated
+    if (writeRecord(fid, value, valueSize, false, offset)!=0) {
+      return -1;
+    }
+
+    ++pairs;
+
+    if (config.d_verbosity) {
+      printf("pair: %09d, offset: %lu, keySize: %u, valueSize: %u, key '", pairs, previousPairOffset, keySize,
+        valueSize);
+      printRecord(start, keySize, config.d_cstringTerminator);
+      printf("' value '");
+      printRecord(value, valueSize, false);
+      printf("'\n");
+    }
+  }
+
+  printf("wrote %u key-value pairs\n", pairs);
+
+  return 0;
+}
+
 int convertText() {
   int fin = open(config.d_inFilename.c_str(), O_RDONLY);
   if (fin == -1) {
@@ -324,8 +513,13 @@ int convertText() {
   // Prepare to write
   printf("writing '%s' ...\n", config.d_outFilename.c_str());
 
-  // Find words and convert/write them
-  if (convertTextHelper(fout, data, data+fstat.st_size, words)!=0) {
+  // Find words or key-value pairs and convert/write them
+  if (config.d_mode==Config::CONVERT_KV) {
+    rc = convertKVHelper(fout, data, data+fstat.st_size, words);
+  } else {
+    rc = convertTextHelper(fout, data, data+fstat.st_size, words);
+  }
+  if (rc!=0) {
     close(fin);
     close(fout);
     free(data);
@@ -358,7 +552,7 @@ int convertText() {
 
 int main(int argc, char **argv) {
   parseCommandLine(argc, argv);                                                                                         
-  if (config.d_mode==Config::CONVERT_TEXT) {
+  if (config.d_mode==Config::CONVERT_TEXT || config.d_mode==Config::CONVERT_KV) {
     return convertText();
   }
   return 1;